@@ -230,7 +230,8 @@ void MessageProcessor::handleMovementUpdate(Uint8* messageBuffer,
 
     // If the player entity is present, process it and erase it from the
     // message.
-    std::vector<MovementState>& movementStates{movementUpdate->movementStates};
+    std::pmr::vector<MovementState>& movementStates{
+        movementUpdate->movementStates};
     for (auto it = movementStates.begin(); it != movementStates.end(); ++it) {
         MovementState& movementState{*it};
         if (movementState.entity == playerEntity) {
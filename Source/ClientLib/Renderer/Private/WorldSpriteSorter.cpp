@@ -20,6 +20,7 @@
 #include "Floor.h"
 #include "VariantTools.h"
 #include "Timer.h"
+#include "tracy/Tracy.hpp"
 #include <SDL3/SDL_rect.h>
 #include <cmath>
 #include <algorithm>
@@ -108,25 +109,21 @@ void WorldSpriteSorter::gatherSpriteInfo(const Camera& camera, double alpha)
 
 void WorldSpriteSorter::gatherTileSpriteInfo(const Camera& camera)
 {
+    ZoneScoped;
+
     // Gather all tiles that are in view.
+    // Note: Tiles in empty chunks are skipped.
     TileExtent tileViewExtent{
         camera.getTileViewExtent(world.tileMap.getTileExtent())};
-    for (int z{tileViewExtent.z}; z <= tileViewExtent.zMax(); ++z) {
-        for (int y{tileViewExtent.y}; y <= tileViewExtent.yMax(); ++y) {
-            for (int x{tileViewExtent.x}; x <= tileViewExtent.xMax(); ++x) {
-                TilePosition tilePosition{x, y, z};
-
-                // Push all of this tile's sprites into the appropriate vectors.
-                // Note: tile will be nullptr if the chunk is empty.
-                if (const Tile* tile{world.tileMap.cgetTile(tilePosition)}) {
-                    pushTerrainSprites(*tile, camera, tilePosition);
-                    pushFloorSprite(*tile, camera, tilePosition);
-                    pushWallSprites(*tile, camera, tilePosition);
-                    pushObjectSprites(*tile, camera, tilePosition);
-                }
-            }
-        }
-    }
+    world.tileMap.forEachTile(
+        tileViewExtent,
+        [&](const TilePosition& tilePosition, const Tile& tile) {
+            // Push all of this tile's sprites into the appropriate vectors.
+            pushTerrainSprites(tile, camera, tilePosition);
+            pushFloorSprite(tile, camera, tilePosition);
+            pushWallSprites(tile, camera, tilePosition);
+            pushObjectSprites(tile, camera, tilePosition);
+        });
 
     // Gather all of the UI's phantom tile sprites that weren't already used.
     for (const PhantomSpriteInfo& info : phantomSprites) {
@@ -253,7 +250,7 @@ void WorldSpriteSorter::pushTerrainSprites(const Tile& tile,
     std::span<const TileLayer> terrains{
         tile.getLayers(TileLayer::Type::Terrain)};
     for (const TileLayer& terrain : terrains) {
-        GraphicRef graphic{terrain.getGraphic()};
+        GraphicRef graphic{terrain.getGraphic(graphicData)};
         if (graphic.getGraphicID() != NULL_GRAPHIC_ID) {
             Uint8 graphicValue{terrain.graphicValue};
 
@@ -273,7 +270,7 @@ void WorldSpriteSorter::pushTerrainSprites(const Tile& tile,
             pushTileSprite(graphic, camera,
                            {tilePosition, TileOffset{},
                             TileLayer::Type::Terrain,
-                            terrain.graphicSet.get().numericID, graphicValue},
+                            terrain.graphicSetID, graphicValue},
                            false);
         }
     }
@@ -284,12 +281,12 @@ void WorldSpriteSorter::pushFloorSprite(const Tile& tile, const Camera& camera,
 {
     std::span<const TileLayer> floors{tile.getLayers(TileLayer::Type::Floor)};
     for (const TileLayer& floor : floors) {
-        GraphicRef graphic{floor.getGraphic()};
+        GraphicRef graphic{floor.getGraphic(graphicData)};
         if (graphic.getGraphicID() != NULL_GRAPHIC_ID) {
             pushTileSprite(
                 graphic, camera,
                 {tilePosition, floor.tileOffset, TileLayer::Type::Floor,
-                 floor.graphicSet.get().numericID, floor.graphicValue},
+                 floor.graphicSetID, floor.graphicValue},
                 false);
         }
     }
@@ -305,7 +302,7 @@ void WorldSpriteSorter::pushWallSprites(const Tile& tile, const Camera& camera,
 
     std::span<const TileLayer> walls{tile.getLayers(TileLayer::Type::Wall)};
     for (const TileLayer& wall : walls) {
-        GraphicRef graphic{wall.getGraphic()};
+        GraphicRef graphic{wall.getGraphic(graphicData)};
         if (graphic.getGraphicID() != NULL_GRAPHIC_ID) {
             // If the UI wants this sprite replaced with a phantom, replace it.
             auto phantomSpriteInfo = std::find_if(
@@ -340,7 +337,7 @@ void WorldSpriteSorter::pushWallSprites(const Tile& tile, const Camera& camera,
 
             pushTileSprite(graphic, camera,
                            {tilePosition, tileOffset, TileLayer::Type::Wall,
-                            wall.graphicSet.get().numericID, wall.graphicValue},
+                            wall.graphicSetID, wall.graphicValue},
                            false);
         }
     }
@@ -352,12 +349,12 @@ void WorldSpriteSorter::pushObjectSprites(const Tile& tile,
 {
     std::span<const TileLayer> objects{tile.getLayers(TileLayer::Type::Object)};
     for (const TileLayer& object : objects) {
-        GraphicRef graphic{object.getGraphic()};
+        GraphicRef graphic{object.getGraphic(graphicData)};
         if (graphic.getGraphicID() != NULL_GRAPHIC_ID) {
             pushTileSprite(
                 graphic, camera,
                 {tilePosition, object.tileOffset, TileLayer::Type::Object,
-                 object.graphicSet.get().numericID, object.graphicValue},
+                 object.graphicSetID, object.graphicValue},
                 false);
         }
     }
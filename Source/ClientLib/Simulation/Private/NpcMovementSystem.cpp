@@ -12,6 +12,7 @@
 #include "SharedConfig.h"
 #include "Log.h"
 #include "entt/entity/registry.hpp"
+#include "tracy/Tracy.hpp"
 #include <memory>
 
 namespace AM
@@ -24,6 +25,7 @@ NpcMovementSystem::NpcMovementSystem(const SimulationContext& inSimContext)
 , network{inSimContext.network}
 , entityMover{world.registry, world.tileMap, world.entityLocator,
               world.collisionLocator}
+, activityTracker{world.registry}
 , npcMovementUpdateQueue{inSimContext.networkEventDispatcher}
 , lastProcessedTick{0}
 {
@@ -90,10 +92,16 @@ void NpcMovementSystem::initLastProcessedTick()
 
 void NpcMovementSystem::moveAllNpcs()
 {
+    // Note: Sleeping NPCs have no inputs and are grounded, so moving them
+    //       would do nothing.
     auto movementGroup{EnttGroups::getMovementGroup(world.registry)};
-    for (auto [entity, input, position, previousPosition, movement,
-               movementMods, rotation, collision, collisionBitSets,
-               graphicState] : movementGroup.each()) {
+    activityTracker.forEachActive(movementGroup, [&](entt::entity entity) {
+        auto [input, position, previousPosition, movement, movementMods,
+              rotation, collision, collisionBitSets]
+            = movementGroup.get<Input, Position, PreviousPosition, Movement,
+                                MovementModifiers, Rotation, Collision,
+                                CollisionBitSets>(entity);
+
         // Save their old position.
         previousPosition = position;
 
@@ -109,7 +117,16 @@ void NpcMovementSystem::moveAllNpcs()
              .collision{collision},
              .collisionBitSets{collisionBitSets},
              .deltaSeconds{SharedConfig::SIM_TICK_TIMESTEP_S}});
-    }
+
+        // If the NPC has come to rest, put it to sleep.
+        return !(MovementActivityTracker::canSleep(input, movement, position,
+                                                   previousPosition));
+    });
+
+    TracyPlot("ActiveNpcMovementEntities",
+              static_cast<int64_t>(activityTracker.getActiveEntityCount()));
+    TracyPlot("SleepingNpcMovementEntities",
+              static_cast<int64_t>(activityTracker.getSleepingEntityCount()));
 }
 
 void NpcMovementSystem::applyUpdateMessage(
@@ -154,6 +171,10 @@ void NpcMovementSystem::applyUpdateMessage(
         // Move their collision box to their new position.
         collision.worldBounds
             = Transforms::modelToWorldEntity(collision.modelBounds, position);
+
+        // Since we assigned the components directly, the tracker won't see
+        // the change. Wake the entity manually.
+        activityTracker.wake(entity);
     }
 }
 
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "EntityMover.h"
+#include "MovementActivityTracker.h"
 #include "QueuedEvents.h"
 #include <SDL3/SDL_stdinc.h>
 
@@ -40,7 +41,7 @@ private:
     void initLastProcessedTick();
 
     /**
-     * Moves all NPCs using their current inputs.
+     * Moves all active NPCs using their current inputs.
      */
     void moveAllNpcs();
 
@@ -69,6 +70,9 @@ private:
 
     EntityMover entityMover;
 
+    /** Tracks which NPCs need to be moved. */
+    MovementActivityTracker activityTracker;
+
     EventQueue<std::shared_ptr<const MovementUpdate>> npcMovementUpdateQueue;
 
     /** The last tick that we processed update data for. */
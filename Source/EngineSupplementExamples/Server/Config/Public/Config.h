@@ -1,6 +1,8 @@
 #pragma once
 
 #include "SpawnStrategy.h"
+#include "DatabaseMode.h"
+#include "EntityPersistenceFormat.h"
 #include "SharedConfig.h"
 #include "ConstexprTools.h"
 #include <SDL3/SDL_stdinc.h>
@@ -61,6 +63,158 @@ public:
         in seconds. */
     static constexpr float SAVE_PERIOD_S{60 * 15};
 
+    /** How long the sim thread may spend capturing a save, in seconds. The
+        rest of the save happens on a background thread. If capturing takes
+        longer than this, we log it.
+        Note: Should be a small fraction of SIM_TICK_TIMESTEP_S. */
+    static constexpr float SAVE_CAPTURE_BUDGET_S{0.005f};
+
+    /** How the world database should be run. See DatabaseMode.h. */
+    static constexpr DatabaseMode DATABASE_MODE{DatabaseMode::InMemory};
+
+    /** (InMemory mode) How many pages to copy in each backup step. */
+    static constexpr int DATABASE_BACKUP_STEP_PAGES{256};
+
+    /** (InMemory mode) How long to wait between backup steps, in
+        milliseconds. Spreads the backup's disk I/O out over time. */
+    static constexpr int DATABASE_BACKUP_STEP_DELAY_MS{1};
+
+    /** (WalFile mode) How much of World.db to memory-map, in bytes. */
+    static constexpr Sint64 DATABASE_MMAP_SIZE{256 * 1024 * 1024};
+
+    /** The layout that non-client entities are persisted in. See
+        EntityPersistenceFormat.h.
+        Note: If this is changed, existing data will be loaded from the old
+              format and converted on the next save. */
+    static constexpr EntityPersistenceFormat ENTITY_PERSISTENCE_FORMAT{
+        EntityPersistenceFormat::Rows};
+
+    /** How long a tile map chunk must go unused (not near any entity,
+        streamed to a client, or edited) before it's evicted from memory,
+        in seconds. */
+    static constexpr float CHUNK_EVICTION_IDLE_S{60 * 10};
+
+    /** The number of bytes that loaded tile map chunks may use. If this is
+        exceeded, the least recently used chunks will be evicted early.
+        Note: Chunks that are currently in use are never evicted, so this
+              is a soft limit. */
+    static constexpr std::size_t CHUNK_MEMORY_BUDGET{256 * 1024 * 1024};
+
+    /** How often we check for tile map chunks to evict, in seconds. */
+    static constexpr float CHUNK_EVICTION_CHECK_PERIOD_S{10};
+
+    /** The max number of compiled scripts that each Lua environment will
+        cache. If this is exceeded, the least recently used script is
+        dropped. */
+    static constexpr std::size_t LUA_SCRIPT_CACHE_MAX_ENTRIES{1024};
+
+    /** The max number of Lua instructions that a single script run may
+        execute before it's stopped with an error. */
+    static constexpr std::size_t LUA_SCRIPT_INSTRUCTION_BUDGET{1'000'000};
+
+    /** The max amount of time that a single script run may take before it's
+        stopped with an error, in seconds.
+        Note: Time spent inside a single bound C++ function can't be
+              interrupted, so this is only checked between instructions. */
+    static constexpr double LUA_SCRIPT_TIME_BUDGET_S{0.02};
+
+    /** How many Lua instructions run between each budget check. Lower values
+        stop runaway scripts sooner, but add overhead to every script. */
+    static constexpr int LUA_SCRIPT_BUDGET_CHECK_INTERVAL{1000};
+
+    /** If a script run takes longer than this, in seconds, we log it along
+        with the script's accumulated timing statistics. */
+    static constexpr double LUA_SCRIPT_SLOW_RUN_S{0.002};
+
+    /** The max amount of time that may be spent running coroutine scripts
+        (e.g. entity item handlers) each tick, in seconds. Scripts that don't
+        fit are resumed on a later tick. */
+    static constexpr double LUA_COROUTINE_TICK_BUDGET_S{0.005};
+
+    /** AI entities within this distance of a client run every tick. */
+    static constexpr float AI_LOD_NEAR_DISTANCE{SharedConfig::AOI_RADIUS / 2};
+
+    /** AI entities that are in a client's AOI, but further than
+        AI_LOD_NEAR_DISTANCE, run once every this many ticks. */
+    static constexpr Uint32 AI_LOD_MID_TICK_INTERVAL{4};
+
+    /** AI entities that aren't in any client's AOI run once every this many
+        ticks. If 0, they sleep until a client approaches. */
+    static constexpr Uint32 AI_LOD_FAR_TICK_INTERVAL{0};
+
+    /** How often we log each AI type's run statistics, in seconds. */
+    static constexpr double AI_STATS_LOG_PERIOD_S{60};
+
+    /** If true, AI types that support it (see ParallelAILogic in AILogic.h)
+        are ticked in parallel on a worker pool. */
+    static constexpr bool AI_PARALLEL_TICK{false};
+
+    /** The number of worker threads used for parallel AI. The sim thread
+        also helps, so this should be 1 less than the desired parallelism. */
+    static constexpr unsigned int AI_PARALLEL_WORKER_COUNT{3};
+
+    /** The number of AI entities in each parallel work chunk. Each chunk
+        gets its own command buffer. */
+    static constexpr std::size_t AI_PARALLEL_CHUNK_SIZE{64};
+
+    /** The number of worker threads that run path searches. */
+    static constexpr unsigned int PATHFINDING_WORKER_COUNT{2};
+
+    /** The size of the agent that paths are found for. Tiles and edges that
+        an agent of this size can't fit through are considered blocked. */
+    static constexpr float PATHFINDING_AGENT_RADIUS{
+        SharedConfig::TILE_WORLD_WIDTH / 4.f};
+    static constexpr float PATHFINDING_AGENT_HEIGHT{
+        SharedConfig::TILE_WORLD_HEIGHT / 2.f};
+
+    /** The max number of nav chunks that we'll build per tick. */
+    static constexpr unsigned int PATHFINDING_CHUNK_BUILDS_PER_TICK{16};
+
+    /** When a path is requested, we build the nav chunks in the box around
+        its start and goal, plus this many chunks on each side. */
+    static constexpr int PATHFINDING_REQUEST_CHUNK_MARGIN{1};
+
+    /** If the box around a request's start and goal contains more than this
+        many chunks, we only build the start and goal chunks up front. */
+    static constexpr std::size_t PATHFINDING_MAX_PREBUILT_CHUNKS{64};
+
+    /** The number of times that a request will be sent to a worker (which
+        may ask for more nav chunks each time) before we give up on it. */
+    static constexpr unsigned int PATHFINDING_MAX_ATTEMPTS{8};
+
+    /** The max number of abstract graph nodes that a path search will
+        expand before giving up. */
+    static constexpr std::size_t PATHFINDING_MAX_ABSTRACT_EXPANSIONS{4096};
+
+    /** Flow fields cover the chunks within this many chunks of their goal's
+        chunk. */
+    static constexpr int FLOW_FIELD_CHUNK_RADIUS{2};
+
+    /** Flow fields are shared by every goal within a square cell of this
+        many tiles. The first goal that's requested in a cell is the one
+        that its field leads to. */
+    static constexpr int FLOW_FIELD_GOAL_CELL_WIDTH{4};
+
+    /** The max number of flow fields that we'll build per tick. The nav
+        chunks that they cover count against
+        PATHFINDING_CHUNK_BUILDS_PER_TICK. */
+    static constexpr unsigned int FLOW_FIELD_BUILDS_PER_TICK{2};
+
+    /** If a flow field isn't requested for this many ticks, it's thrown
+        out. */
+    static constexpr unsigned int FLOW_FIELD_IDLE_TICKS{
+        SharedConfig::SIM_TICKS_PER_SECOND * 5};
+
+    /** How many ticks into the future we'll buffer client inputs and
+        tick-synchronized cast requests for. Messages for later ticks are
+        dropped (inputs) or processed immediately (casts). */
+    static constexpr std::size_t INPUT_SORTER_WINDOW_TICKS{10};
+    static constexpr std::size_t CAST_SORTER_WINDOW_TICKS{10};
+
+    /** How many messages each of the sorters' per-tick buffers reserves space
+        for. They'll grow if needed, but this avoids early allocations. */
+    static constexpr std::size_t SORTER_RESERVED_EVENTS_PER_TICK{64};
+
     //-------------------------------------------------------------------------
     // Network
     //-------------------------------------------------------------------------
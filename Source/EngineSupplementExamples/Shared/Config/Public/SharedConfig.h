@@ -66,6 +66,14 @@ public:
         partitioning grid (CollisionLocator). */
     static constexpr std::size_t COLLISION_LOCATOR_CELL_HEIGHT{2};
 
+    /** If true, CollisionLocator will merge adjacent wall and object collision
+        volumes within each chunk into larger boxes. This reduces the number
+        of volumes that movement and raycasts need to test against, at the
+        cost of some extra work whenever a tile is edited.
+        Off by default. Worth enabling for maps with large, mostly static
+        wall layouts. */
+    static constexpr bool MERGE_TILE_COLLISION_VOLUMES{false};
+
     /** The number of world units around an entity that are considered to be
         within the entity's "Area of Interest" cylinder.
         Used in the simulation to tell if data is relevant to a client. */
@@ -0,0 +1,102 @@
+#include "AICommandBuffer.h"
+#include "World.h"
+#include "EntityInitScript.h"
+#include "Log.h"
+#include <type_traits>
+
+namespace AM
+{
+namespace Server
+{
+void AICommandBuffer::setInput(entt::entity entity,
+                               const Input::StateArr& inputStates)
+{
+    commands.emplace_back(SetInputCommand{entity, inputStates});
+}
+
+void AICommandBuffer::castEntityInteraction(
+    const CastHelper::CastEntityInteractionParams& params)
+{
+    commands.emplace_back(params);
+}
+
+void AICommandBuffer::castSpell(const CastHelper::CastSpellParams& params)
+{
+    commands.emplace_back(params);
+}
+
+void AICommandBuffer::spawnEntity(const Position& position,
+                                  std::string_view initScript)
+{
+    commands.emplace_back(
+        SpawnEntityCommand{position, std::string{initScript}});
+}
+
+void AICommandBuffer::apply(World& world)
+{
+    using EntityInteractionParams = CastHelper::CastEntityInteractionParams;
+    using SpellParams = CastHelper::CastSpellParams;
+
+    for (const Command& command : commands) {
+        std::visit(
+            [&](const auto& params) {
+                using T = std::decay_t<decltype(params)>;
+                if constexpr (std::is_same_v<T, SetInputCommand>) {
+                    // If the entity still exists and its input changed,
+                    // update it.
+                    Input* input{world.registry.try_get<Input>(params.entity)};
+                    if (input && (input->inputStates != params.inputStates)) {
+                        world.registry.patch<Input>(
+                            params.entity, [&](Input& updatedInput) {
+                                updatedInput.inputStates = params.inputStates;
+                            });
+                    }
+                }
+                else if constexpr (std::is_same_v<T,
+                                                  EntityInteractionParams>) {
+                    if (world.registry.valid(params.casterEntity)) {
+                        world.castHelper.castEntityInteraction(params);
+                    }
+                }
+                else if constexpr (std::is_same_v<T, SpellParams>) {
+                    if (world.registry.valid(params.casterEntity)) {
+                        world.castHelper.castSpell(params);
+                    }
+                }
+                else if constexpr (std::is_same_v<T, SpawnEntityCommand>) {
+                    entt::entity newEntity{
+                        world.createEntity(params.position)};
+                    if (newEntity == entt::null) {
+                        LOG_ERROR("AI failed to spawn entity: position is "
+                                  "outside of the tile map bounds.");
+                    }
+                    else if (!(params.initScript.empty())) {
+                        std::string result{world.runEntityInitScript(
+                            newEntity, EntityInitScript{params.initScript})};
+                        if (!(result.empty())) {
+                            LOG_ERROR("AI spawned entity's init script "
+                                      "failed: %s",
+                                      result.c_str());
+                        }
+                    }
+                }
+            },
+            command);
+    }
+
+    commands.clear();
+}
+
+void AICommandBuffer::clear()
+{
+    commands.clear();
+}
+
+const std::vector<AICommandBuffer::Command>&
+    AICommandBuffer::getCommands() const
+{
+    return commands;
+}
+
+} // namespace Server
+} // namespace AM
@@ -2,30 +2,203 @@
 #include "SimulationContext.h"
 #include "Simulation.h"
 #include "ProjectAITypes.h"
+#include "AILogic.h"
+#include "AICommandBuffer.h"
+#include "ClientSimData.h"
+#include "Position.h"
+#include "Config.h"
 #include "Log.h"
+#include "tracy/Tracy.hpp"
+#include "entt/core/type_info.hpp"
 #include "boost/mp11/algorithm.hpp"
+#include <algorithm>
+#include <utility>
 
 namespace AM
 {
 namespace Server
 {
+/** The number of worker threads that parallel AI uses. */
+static constexpr std::size_t WORKER_COUNT{
+    Config::AI_PARALLEL_TICK ? Config::AI_PARALLEL_WORKER_COUNT : 0};
 
 AISystem::AISystem(const SimulationContext& inSimContext)
-: world{inSimContext.simulation.getWorld()}
+: simulation{inSimContext.simulation}
+, world{inSimContext.simulation.getWorld()}
+, nearestClientDistancesSquared{}
+, aiTypeStats(boost::mp11::mp_size<ProjectAITypes>::value)
+, statsLogTimer{}
+, dueEntities{}
+, workerPool{WORKER_COUNT, Config::AI_PARALLEL_CHUNK_SIZE}
 {
 }
 
+AISystem::~AISystem() = default;
+
 void AISystem::processAITick()
 {
-    // For each AI type in the list, update all AI components of that type.
-    boost::mp11::mp_for_each<ProjectAITypes>([&](auto I) {
-        using AIType = decltype(I);
+    ZoneScoped;
+
+    // Figure out how far each entity is from the nearest client.
+    updateClientDistances();
+
+    // For each AI type in the list, update all of that type's AI components
+    // that are due this tick.
+    Uint32 currentTick{simulation.getCurrentTick()};
+    std::size_t totalRunCount{0};
+    boost::mp11::mp_for_each<
+        boost::mp11::mp_iota<boost::mp11::mp_size<ProjectAITypes>>>(
+        [&](auto I) {
+            using AIType = boost::mp11::mp_at_c<ProjectAITypes, I>;
+            ZoneScoped;
+            constexpr auto typeName{entt::type_name<AIType>::value()};
+            ZoneName(typeName.data(), typeName.size());
+
+            Timer typeTimer{};
+            std::size_t runCount{0};
+            if constexpr (Config::AI_PARALLEL_TICK
+                          && ParallelAILogic<AIType>) {
+                runCount = tickParallel<AIType>(currentTick);
+            }
+            else {
+                auto view{world.registry.view<AIType>()};
+                for (auto [entity, aiLogic] : view.each()) {
+                    if (isDue(entity, currentTick)) {
+                        aiLogic.tick(world, entity);
+                        runCount++;
+                    }
+                }
+            }
+
+            AITypeStats& stats{aiTypeStats[I]};
+            stats.runCount += runCount;
+            stats.totalTime += typeTimer.getTime();
+            totalRunCount += runCount;
+        });
+
+    TracyPlot("AIRunCount", static_cast<int64_t>(totalRunCount));
+
+    if (statsLogTimer.getTime() >= Config::AI_STATS_LOG_PERIOD_S) {
+        logStats();
+        statsLogTimer.reset();
+    }
+}
+
+void AISystem::updateClientDistances()
+{
+    // Reset every entity to "far".
+    std::size_t entityCount{world.registry.storage<entt::entity>().size()};
+    nearestClientDistancesSquared.assign(entityCount, FAR_DISTANCE);
+
+    // For each entity in each client's AOI, track the distance to the
+    // nearest client.
+    auto view{world.registry.view<ClientSimData, Position>()};
+    for (auto [clientEntity, client, clientPosition] : view.each()) {
+        for (entt::entity entity : client.entitiesInAOI) {
+            // Note: AOI lists are updated at the end of the tick, so they
+            //       may hold entities that have since been destroyed.
+            const Position* position{world.registry.try_get<Position>(entity)};
+            if (!position) {
+                continue;
+            }
+
+            std::size_t index{entt::to_entity(entity)};
+            if (index >= nearestClientDistancesSquared.size()) {
+                nearestClientDistancesSquared.resize(index + 1, FAR_DISTANCE);
+            }
 
-        auto view{world.registry.view<AIType>()};
-        for (auto [entity, aiLogic] : view.each()) {
-            aiLogic.tick(world, entity);
+            float& nearestDistance{nearestClientDistancesSquared[index]};
+            nearestDistance = std::min(
+                nearestDistance, position->squaredDistanceTo(clientPosition));
         }
-    });
+    }
+}
+
+Uint32 AISystem::getTickInterval(entt::entity entity) const
+{
+    std::size_t index{entt::to_entity(entity)};
+    float distanceSquared{(index < nearestClientDistancesSquared.size())
+                              ? nearestClientDistancesSquared[index]
+                              : FAR_DISTANCE};
+
+    constexpr float NEAR_DISTANCE_SQUARED{Config::AI_LOD_NEAR_DISTANCE
+                                          * Config::AI_LOD_NEAR_DISTANCE};
+    if (distanceSquared <= NEAR_DISTANCE_SQUARED) {
+        return 1;
+    }
+    else if (distanceSquared != FAR_DISTANCE) {
+        return Config::AI_LOD_MID_TICK_INTERVAL;
+    }
+    else {
+        return Config::AI_LOD_FAR_TICK_INTERVAL;
+    }
+}
+
+bool AISystem::isDue(entt::entity entity, Uint32 currentTick) const
+{
+    // If the AI is asleep, it isn't due.
+    Uint32 interval{getTickInterval(entity)};
+    if (interval == 0) {
+        return false;
+    }
+
+    // Offset each entity by its ID, so that entities with the same interval
+    // are spread evenly across that interval's ticks.
+    Uint32 offset{static_cast<Uint32>(entt::to_entity(entity))};
+    return ((currentTick + offset) % interval) == 0;
+}
+
+template<typename AIType>
+std::size_t AISystem::tickParallel(Uint32 currentTick)
+{
+    // Gather the AI that's due this tick.
+    dueEntities.clear();
+    for (entt::entity entity : world.registry.view<AIType>()) {
+        if (isDue(entity, currentTick)) {
+            dueEntities.push_back(entity);
+        }
+    }
+    if (dueEntities.empty()) {
+        return 0;
+    }
+
+    // Tick the AI on the worker pool.
+    // Note: AI only gets const access to the world. Any changes are recorded
+    //       in its chunk's command buffer.
+    auto& aiStorage{world.registry.storage<AIType>()};
+    const World& constWorld{world};
+    std::span<AICommandBuffer> commandBuffers{workerPool.run(
+        dueEntities, [&](entt::entity entity, AICommandBuffer& commandBuffer) {
+            aiStorage.get(entity).tickParallel(constWorld, entity,
+                                               commandBuffer);
+        })};
+
+    // Apply the recorded changes, in chunk order.
+    for (AICommandBuffer& commandBuffer : commandBuffers) {
+        commandBuffer.apply(world);
+    }
+
+    return dueEntities.size();
+}
+
+void AISystem::logStats()
+{
+    boost::mp11::mp_for_each<
+        boost::mp11::mp_iota<boost::mp11::mp_size<ProjectAITypes>>>(
+        [&](auto I) {
+            using AIType = boost::mp11::mp_at_c<ProjectAITypes, I>;
+            constexpr auto typeName{entt::type_name<AIType>::value()};
+
+            AITypeStats& stats{aiTypeStats[I]};
+            double averageTime{(stats.runCount > 0)
+                                   ? (stats.totalTime / stats.runCount)
+                                   : 0};
+            LOG_INFO("AI %.*s: %zu runs, %.3fms total, %.3fus average.",
+                     static_cast<int>(typeName.size()), typeName.data(),
+                     stats.runCount, (stats.totalTime * 1000),
+                     (averageTime * 1000 * 1000));
+            stats = {};
+        });
 }
 
 } // End namespace Server
@@ -0,0 +1,95 @@
+#include "AIWorkerPool.h"
+#include "AMAssert.h"
+#include <algorithm>
+
+namespace AM
+{
+namespace Server
+{
+AIWorkerPool::AIWorkerPool(std::size_t workerCount, std::size_t inChunkSize)
+: chunkSize{inChunkSize}
+, entities{}
+, tickFunction{nullptr}
+, commandBuffers{}
+, chunkCount{0}
+, nextChunkIndex{0}
+, exitRequested{false}
+, startBarrier{static_cast<std::ptrdiff_t>(workerCount + 1)}
+, finishBarrier{static_cast<std::ptrdiff_t>(workerCount + 1)}
+, workers{}
+{
+    AM_ASSERT(chunkSize > 0, "AI chunk size must be non-zero.");
+
+    for (std::size_t i{0}; i < workerCount; ++i) {
+        workers.emplace_back(&AIWorkerPool::workerLoop, this);
+    }
+}
+
+AIWorkerPool::~AIWorkerPool()
+{
+    // Tell the workers to exit and wait for them.
+    exitRequested = true;
+    startBarrier.arrive_and_wait();
+    workers.clear();
+}
+
+std::span<AICommandBuffer> AIWorkerPool::run(
+    std::span<const entt::entity> inEntities,
+    const std::function<void(entt::entity, AICommandBuffer&)>&
+        inTickFunction)
+{
+    if (inEntities.empty()) {
+        return {};
+    }
+
+    // Split the entities into chunks, each with its own command buffer.
+    entities = inEntities;
+    tickFunction = &inTickFunction;
+    chunkCount = (entities.size() + chunkSize - 1) / chunkSize;
+    if (commandBuffers.size() < chunkCount) {
+        commandBuffers.resize(chunkCount);
+    }
+
+    // Run every chunk, using the workers and this thread.
+    // Note: The start barrier publishes the run's state to the workers, and
+    //       the finish barrier publishes their buffers back to us.
+    nextChunkIndex = 0;
+    startBarrier.arrive_and_wait();
+    runChunks();
+    finishBarrier.arrive_and_wait();
+
+    return {commandBuffers.data(), chunkCount};
+}
+
+void AIWorkerPool::runChunks()
+{
+    std::size_t chunkIndex{nextChunkIndex.fetch_add(1)};
+    while (chunkIndex < chunkCount) {
+        std::size_t begin{chunkIndex * chunkSize};
+        std::size_t end{std::min(begin + chunkSize, entities.size())};
+        AICommandBuffer& commandBuffer{commandBuffers[chunkIndex]};
+        commandBuffer.clear();
+        for (std::size_t i{begin}; i < end; ++i) {
+            (*tickFunction)(entities[i], commandBuffer);
+        }
+
+        chunkIndex = nextChunkIndex.fetch_add(1);
+    }
+}
+
+void AIWorkerPool::workerLoop()
+{
+    while (true) {
+        // Wait for a run to start (or for an exit request).
+        startBarrier.arrive_and_wait();
+        if (exitRequested) {
+            return;
+        }
+
+        runChunks();
+        finishBarrier.arrive_and_wait();
+    }
+}
+
+} // End namespace Server
+} // End namespace AM
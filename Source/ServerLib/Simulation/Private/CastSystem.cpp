@@ -17,6 +17,8 @@
 #include "ClientSimData.h"
 #include "Cylinder.h"
 #include "SharedConfig.h"
+#include "Config.h"
+#include <utility>
 
 namespace AM
 {
@@ -26,12 +28,17 @@ namespace Server
 CastSystem::CastSystem(const SimulationContext& inSimContext)
 : simulation{inSimContext.simulation}
 , world{inSimContext.simulation.getWorld()}
+, timingWheel{inSimContext.simulation.getTimingWheel()}
 , network{inSimContext.network}
 , itemData{inSimContext.itemData}
 , castableData{inSimContext.castableData}
 , playerCastCooldownObserver{}
+, newCastObserver{}
+, movedCasters{}
+, castsToStart{}
 , castRequestQueue{inSimContext.networkEventDispatcher}
-, castRequestSorter{}
+, castRequestSorter{Config::CAST_SORTER_WINDOW_TICKS,
+                    Config::SORTER_RESERVED_EVENTS_PER_TICK}
 {
     // Observe player CastCooldown construction events.
     playerCastCooldownObserver.bind(world.registry);
@@ -40,6 +47,12 @@ CastSystem::CastSystem(const SimulationContext& inSimContext)
 
     // Note: When CastCooldown is loaded from the DB, it gets initialized in
     //       LoadHelper::initTimerComponents.
+
+    // Observe new casts, and casters moving.
+    newCastObserver.bind(world.registry);
+    newCastObserver.on_construct<CastState>();
+    world.registry.on_update<Position>()
+        .connect<&CastSystem::onPositionUpdated>(this);
 }
 
 void CastSystem::sendCastCooldownInits()
@@ -86,12 +99,14 @@ void CastSystem::processCastRequests()
         // If this castable is tick-synchronized, sort the request.
         if (castable->isTickSynchronized) {
             // Push the cast request into the sorter.
-            SorterBase::ValidityResult result{
-                castRequestSorter.push(*castRequest, castRequest->tickNum)};
+            // Note: The request is only moved from if it was valid.
+            SorterBase::ValidityResult result{castRequestSorter.push(
+                std::move(*castRequest), castRequest->tickNum)};
 
-            // If the cast request was late, process it immediately (it may
-            // still succeed).
+            // If the cast request was late, track it and process it
+            // immediately (it may still succeed).
             if (result != SorterBase::ValidityResult::Valid) {
+                trackUnsortedRequest(castRequest->netID, result);
                 processCastRequest(*castRequest);
             }
             else {
@@ -108,15 +123,33 @@ void CastSystem::processCastRequests()
     }
 
     // Process all cast requests for this tick.
-    std::queue<CastRequest>& queue{castRequestSorter.getCurrentQueue()};
-    for (; !(queue.empty()); queue.pop()) {
-        processCastRequest(queue.front());
+    for (const CastRequest& castRequest :
+         castRequestSorter.getCurrentEvents()) {
+        processCastRequest(castRequest);
     }
 
     // Advance the sorter to the next tick.
     castRequestSorter.advance();
 }
 
+void CastSystem::trackUnsortedRequest(NetworkID clientID,
+                                      SorterBase::ValidityResult validity)
+{
+    entt::entity clientEntity{world.getClientEntity(clientID)};
+    if (clientEntity == entt::null) {
+        // Client doesn't exist (may have disconnected).
+        return;
+    }
+
+    ClientSimData& client{world.registry.get<ClientSimData>(clientEntity)};
+    if (validity == SorterBase::ValidityResult::TooLow) {
+        client.tooLowMessageCount++;
+    }
+    else {
+        client.tooHighMessageCount++;
+    }
+}
+
 void CastSystem::processCastRequest(const CastRequest& castRequest)
 {
     // Find the entity ID of the client that sent this request.
@@ -158,41 +191,71 @@ void CastSystem::processCastRequest(const CastRequest& castRequest)
 
 void CastSystem::updateCasts()
 {
-    auto view{world.registry.view<CastState>()};
-    Uint32 currentTick{simulation.getCurrentTick()};
+    entt::registry& registry{world.registry};
 
-    // Iterate each entity that is currently casting.
-    for (auto [entity, castState] : view.each()) {
-        // If this cast is unstarted, start it.
-        if (castState.endTick == 0) {
-            startCast(castState);
+    // If any ongoing casts had their caster move, cancel them.
+    // Note: Casts that haven't started yet are allowed, since the caster
+    //       may have moved before sending the request.
+    for (entt::entity entity : movedCasters) {
+        if (!(registry.valid(entity))) {
             continue;
         }
-
-        // If the entity has moved, cancel the cast.
-        Position& position{world.registry.get<Position>(entity)};
-        if (PreviousPosition
-            * prevPosition{world.registry.try_get<PreviousPosition>(entity)}) {
-            if (position != *prevPosition) {
-                cancelCast(castState);
-                continue;
-            }
+        CastState* castState{registry.try_get<CastState>(entity)};
+        if (castState && (castState->endTick != 0)) {
+            cancelCast(*castState);
         }
-
-        // If the cast has reached its finish time, finish it.
-        if (currentTick == castState.endTick) {
-            // Check that the cast is still valid, cancel it if not.
-            if (!castIsValid(castState.castInfo, position)) {
-                cancelCast(castState);
-                continue;
-            }
-
-            finishCast(castState);
+    }
+    movedCasters.clear();
+
+    // Start any new casts.
+    // Note: Starting a cast may finish it (or start another), which modifies
+    //       CastState, so we copy the observer before iterating.
+    castsToStart.assign(newCastObserver.begin(), newCastObserver.end());
+    newCastObserver.clear();
+    for (entt::entity entity : castsToStart) {
+        if (!(registry.valid(entity))) {
             continue;
         }
+        CastState* castState{registry.try_get<CastState>(entity)};
+        if (castState && (castState->endTick == 0)) {
+            startCast(*castState);
+        }
+    }
+}
+
+void CastSystem::onPositionUpdated(entt::registry& registry,
+                                   entt::entity entity)
+{
+    // Note: MovementSystem only patches Position when it changed.
+    if (registry.all_of<CastState>(entity)) {
+        movedCasters.push_back(entity);
     }
 }
 
+void CastSystem::onCastTimerFired(entt::entity casterEntity, Uint32 endTick)
+{
+    // If the caster was destroyed, there's nothing to finish.
+    // Note: Cancelled casts cancel their timer, so we shouldn't see a cast
+    //       that isn't ours. We check endTick anyway, to be safe.
+    if (!(world.registry.valid(casterEntity))) {
+        return;
+    }
+    CastState* castState{world.registry.try_get<CastState>(casterEntity)};
+    if (!castState || (castState->endTick != endTick)) {
+        return;
+    }
+
+    // Check that the cast is still valid, cancel it if not.
+    castState->finishTimerID = 0;
+    const Position& position{world.registry.get<Position>(casterEntity)};
+    if (!castIsValid(castState->castInfo, position)) {
+        cancelCast(*castState);
+        return;
+    }
+
+    finishCast(*castState);
+}
+
 void CastSystem::startCast(CastState& castState)
 {
     // Note: CastHelper ensures that castState.castInfo.casterEntity is the
@@ -218,6 +281,7 @@ void CastSystem::startCast(CastState& castState)
     if (castInfo.castable->triggersGCD) {
         castCooldown.gcdTicksRemaining
             = SharedConfig::CAST_GLOBAL_COOLDOWN_TICKS;
+        world.registry.patch<CastCooldown>(castInfo.casterEntity);
     }
 
     // If this is an instant cast, finish it immediately.
@@ -225,10 +289,19 @@ void CastSystem::startCast(CastState& castState)
         finishCast(castState);
     }
     else {
-        // Not an instant cast. Set its end tick.
+        // Not an instant cast. Set its end tick and schedule its completion.
+        // Note: castTimeTicks may truncate to 0. If so, the wheel will fire
+        //       the timer next tick.
         Uint32 castTimeTicks{static_cast<Uint32>(
             castInfo.castable->castTime / SharedConfig::SIM_TICK_TIMESTEP_S)};
         castState.endTick = currentTick + castTimeTicks;
+
+        entt::entity casterEntity{castInfo.casterEntity};
+        Uint32 endTick{castState.endTick};
+        castState.finishTimerID
+            = timingWheel.schedule(endTick, [this, casterEntity, endTick]() {
+                  onCastTimerFired(casterEntity, endTick);
+              });
     }
 }
 
@@ -243,10 +316,16 @@ void CastSystem::cancelCast(CastState& castState)
         sendCastFailed(castState, CastFailureType::Movement);
     }
 
+    // If the cast is waiting on its finish timer, cancel it.
+    if (castState.finishTimerID != 0) {
+        timingWheel.cancel(castState.finishTimerID);
+    }
+
     // Reset the GCD.
     CastCooldown& castCooldown{
         world.registry.get<CastCooldown>(castInfo.casterEntity)};
     castCooldown.gcdTicksRemaining = 0;
+    world.registry.patch<CastCooldown>(castInfo.casterEntity);
 
     // Cancel the cast.
     world.registry.erase<CastState>(castInfo.casterEntity);
@@ -265,6 +344,7 @@ void CastSystem::finishCast(CastState& castState)
             world.registry.get<CastCooldown>(castInfo.casterEntity)};
         castCooldown.cooldowns.emplace_back(castInfo.castable->castableID,
                                             castTimeTicks);
+        world.registry.patch<CastCooldown>(castInfo.casterEntity);
     }
 
     // Handle the cast.
@@ -0,0 +1,75 @@
+#include "ChunkResidencySystem.h"
+#include "SimulationContext.h"
+#include "Simulation.h"
+#include "World.h"
+#include "Position.h"
+#include "ChunkExtent.h"
+#include "Config.h"
+#include "SharedConfig.h"
+#include "tracy/Tracy.hpp"
+
+namespace AM
+{
+namespace Server
+{
+ChunkResidencySystem::ChunkResidencySystem(
+    const SimulationContext& inSimContext)
+: simulation{inSimContext.simulation}
+, world{inSimContext.simulation.getWorld()}
+, evictionTimer{}
+, occupiedColumns{}
+{
+}
+
+void ChunkResidencySystem::updateResidency()
+{
+    ZoneScoped;
+
+    TileMap& tileMap{world.tileMap};
+    tileMap.setCurrentTick(simulation.getCurrentTick());
+
+    // Gather the chunk columns that contain an entity.
+    // Note: We load every chunk along the Z axis, so we only need to visit
+    //       each column once.
+    const ChunkExtent& mapChunkExtent{tileMap.getChunkExtent()};
+    occupiedColumns.clear();
+    for (auto [entity, position] : world.registry.view<Position>().each()) {
+        ChunkPosition chunkPosition{position};
+        chunkPosition.z = mapChunkExtent.z;
+        occupiedColumns.insert(chunkPosition);
+    }
+
+    // Load the chunks around each occupied column (and mark them as used).
+    for (const ChunkPosition& column : occupiedColumns) {
+        ChunkExtent loadExtent{(column.x - LOAD_RADIUS),
+                               (column.y - LOAD_RADIUS),
+                               mapChunkExtent.z,
+                               ((LOAD_RADIUS * 2) + 1),
+                               ((LOAD_RADIUS * 2) + 1),
+                               mapChunkExtent.zLength};
+        tileMap.loadExtentIfNecessary(loadExtent);
+    }
+
+    // If it's time, evict any chunks that have gone unused.
+    if (evictionTimer.getTime() >= Config::CHUNK_EVICTION_CHECK_PERIOD_S) {
+        static constexpr Uint32 EVICTION_IDLE_TICKS{static_cast<Uint32>(
+            Config::CHUNK_EVICTION_IDLE_S
+            * SharedConfig::SIM_TICKS_PER_SECOND)};
+        tileMap.evictChunks(EVICTION_IDLE_TICKS, Config::CHUNK_MEMORY_BUDGET);
+        evictionTimer.reset();
+    }
+
+    TracyPlot("ChunkFaultIns",
+              static_cast<int64_t>(tileMap.getChunkFaultInCount()));
+    TracyPlot("ChunkEvictions",
+              static_cast<int64_t>(tileMap.getChunkEvictionCount()));
+    TracyPlot("ResidentChunks",
+              static_cast<int64_t>(tileMap.getResidentChunkCount()));
+    TracyPlot("ResidentChunkBytes",
+              static_cast<int64_t>(tileMap.getResidentChunkMemory()));
+    TracyPlot("UnloadedChunks",
+              static_cast<int64_t>(tileMap.getUnloadedChunkCount()));
+}
+
+} // End namespace Server
+} // End namespace AM
@@ -21,7 +21,8 @@ namespace Server
 {
 ChunkStreamingSystem::ChunkStreamingSystem(
     const SimulationContext& inSimContext)
-: world{inSimContext.simulation.getWorld()}
+: simulation{inSimContext.simulation}
+, world{inSimContext.simulation.getWorld()}
 , network{inSimContext.network}
 , chunkDataRequestQueue{inSimContext.networkEventDispatcher}
 {
@@ -42,7 +43,10 @@ void ChunkStreamingSystem::sendChunkUpdate(
     const ChunkDataRequest& chunkDataRequest)
 {
     // Add the requested chunks to the message.
-    ChunkUpdate chunkUpdate{};
+    // Note: The message is serialized immediately, so it can live in the
+    //       frame arena.
+    ChunkUpdate chunkUpdate{std::pmr::vector<ChunkWireSnapshot>{
+        &(simulation.getFrameArena())}};
     for (const ChunkPosition& requestedChunk :
          chunkDataRequest.requestedChunks) {
         addChunkToMessage(requestedChunk, chunkUpdate);
@@ -55,6 +59,9 @@ void ChunkStreamingSystem::sendChunkUpdate(
 void ChunkStreamingSystem::addChunkToMessage(const ChunkPosition& chunkPosition,
                                              ChunkUpdate& chunkUpdate)
 {
+    // If the chunk hasn't been loaded from disk yet, load it.
+    world.tileMap.loadChunkIfNecessary(chunkPosition);
+
     if (const Chunk* chunk{world.tileMap.cgetChunk(chunkPosition)}) {
         // Push the new chunk and get a ref to it.
         chunkUpdate.chunks.emplace_back();
@@ -78,8 +85,7 @@ void ChunkStreamingSystem::addChunkToMessage(const ChunkPosition& chunkPosition,
             // Add all of this tile's layers.
             for (const TileLayer& layer : tile.getAllLayers()) {
                 std::size_t paletteIndex{chunkSnapshot.getPaletteIndex(
-                    layer.type, layer.graphicSet.get().numericID,
-                    layer.graphicValue)};
+                    layer.type, layer.graphicSetID, layer.graphicValue)};
                 chunkSnapshot.tileLayers[tileLayersIndex]
                     = static_cast<Uint8>(paletteIndex);
                 tileLayersIndex++;
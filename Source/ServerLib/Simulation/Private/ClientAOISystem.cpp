@@ -65,7 +65,7 @@ void onComponentDestroyed(entt::registry& registry, entt::entity entity)
  */
 void addComponentsToVector(entt::registry& registry, entt::entity entity,
                            const std::vector<Uint8>& componentIndices,
-                           std::vector<ReplicatedComponent>& componentVec)
+                           std::pmr::vector<ReplicatedComponent>& componentVec)
 {
     for (Uint8 componentIndex : componentIndices) {
         boost::mp11::mp_with_index<boost::mp11::mp_size<ReplicatedComponent>>(
@@ -167,7 +167,12 @@ void ClientAOISystem::processEntitiesThatEntered(ClientSimData& client)
 
     // Send the client an EntityInit containing each entity that entered its
     // AOI.
-    EntityInit entityInit{simulation.getCurrentTick()};
+    // Note: The message is serialized immediately, so it can live in the
+    //       frame arena.
+    std::pmr::memory_resource* frameArena{&(simulation.getFrameArena())};
+    EntityInit entityInit{simulation.getCurrentTick(),
+                          std::pmr::vector<EntityInit::EntityData>{frameArena}};
+    entityInit.entityData.reserve(entitiesThatEntered.size());
     for (entt::entity entityThatEntered : entitiesThatEntered) {
         const auto& inRangeInitComponentList{
             registry.get<InRangeInitComponentList>(entityThatEntered)};
@@ -178,7 +183,8 @@ void ClientAOISystem::processEntitiesThatEntered(ClientSimData& client)
         //       component, because there may be a build mode that cares about 
         //       it.
         EntityInit::EntityData& entityData{entityInit.entityData.emplace_back(
-            entityThatEntered, registry.get<Position>(entityThatEntered))};
+            entityThatEntered, registry.get<Position>(entityThatEntered),
+            std::pmr::vector<ReplicatedComponent>{frameArena})};
         addComponentsToVector(registry, entityThatEntered,
                               inRangeInitComponentList.typeIndices,
                               entityData.components);
@@ -141,9 +141,11 @@ void ComponentSyncSystem::sendSelfUpdates()
     entt::registry& registry{world.registry};
 
     // Add components to the each entity's ComponentUpdate.
+    ComponentUpdateMap componentUpdateMap{&(simulation.getFrameArena())};
     addConstructDestroyComponents<SelfInitComponentTypes>(
-        selfConstructObservers, selfDestroyObservers);
-    addUpdateComponents<SelfUpdateComponentTypes>(selfUpdateObservers);
+        componentUpdateMap, selfConstructObservers, selfDestroyObservers);
+    addUpdateComponents<SelfUpdateComponentTypes>(componentUpdateMap,
+                                                  selfUpdateObservers);
 
     // Send the update to the each entity's client.
     for (auto& [updatedEntity, componentUpdate] : componentUpdateMap) {
@@ -166,8 +168,6 @@ void ComponentSyncSystem::sendSelfUpdates()
         // Send the message.
         network.send(client.netID, message, componentUpdate.tickNum);
     }
-
-    componentUpdateMap.clear();
 }
 
 void ComponentSyncSystem::sendInRangeUpdates()
@@ -179,9 +179,12 @@ void ComponentSyncSystem::sendInRangeUpdates()
     //       There may be ways to optimize by making it client-by-client like
     //       MovementSyncSystem.
     // Add components to the each entity's ComponentUpdate.
+    ComponentUpdateMap componentUpdateMap{&(simulation.getFrameArena())};
     addConstructDestroyComponents<InRangeInitComponentTypes>(
-        inRangeConstructObservers, inRangeDestroyObservers);
-    addUpdateComponents<InRangeUpdateComponentTypes>(inRangeUpdateObservers);
+        componentUpdateMap, inRangeConstructObservers,
+        inRangeDestroyObservers);
+    addUpdateComponents<InRangeUpdateComponentTypes>(componentUpdateMap,
+                                                     inRangeUpdateObservers);
 
     // Send each update to all nearby clients.
     auto view{registry.view<Position, ClientSimData>()};
@@ -219,13 +222,12 @@ void ComponentSyncSystem::sendInRangeUpdates()
             }
         }
     }
-
-    componentUpdateMap.clear();
 }
 
 template<typename ComponentTypeList>
 void ComponentSyncSystem::addConstructDestroyComponents(
-    auto& constructObservers, auto& destroyObservers)
+    ComponentUpdateMap& componentUpdateMap, auto& constructObservers,
+    auto& destroyObservers)
 {
     entt::registry& registry{world.registry};
 
@@ -249,13 +251,13 @@ void ComponentSyncSystem::addConstructDestroyComponents(
 
             if constexpr (std::is_empty_v<ComponentType>) {
                 // Note: Can't registry.get() empty types.
-                componentUpdateMap[entity].updatedComponents.push_back(
-                    ComponentType{});
+                getComponentUpdate(componentUpdateMap, entity)
+                    .updatedComponents.push_back(ComponentType{});
             }
             else {
                 const auto& component{registry.get<ComponentType>(entity)};
-                componentUpdateMap[entity].updatedComponents.emplace_back(
-                    component);
+                getComponentUpdate(componentUpdateMap, entity)
+                    .updatedComponents.emplace_back(component);
             }
         }
 
@@ -268,8 +270,9 @@ void ComponentSyncSystem::addConstructDestroyComponents(
             }
 
             // Note: The message uses the index from ReplicatedComponentTypes.
-            componentUpdateMap[entity].destroyedComponents.emplace_back(
-                static_cast<Uint8>(replicatedTypeIndex));
+            getComponentUpdate(componentUpdateMap, entity)
+                .destroyedComponents.emplace_back(
+                    static_cast<Uint8>(replicatedTypeIndex));
         }
 
         constructObservers[observedTypeIndex].clear();
@@ -278,7 +281,8 @@ void ComponentSyncSystem::addConstructDestroyComponents(
 }
 
 template<typename ComponentTypeList>
-void ComponentSyncSystem::addUpdateComponents(auto& updateObservers)
+void ComponentSyncSystem::addUpdateComponents(
+    ComponentUpdateMap& componentUpdateMap, auto& updateObservers)
 {
     entt::registry& registry{world.registry};
 
@@ -302,13 +306,13 @@ void ComponentSyncSystem::addUpdateComponents(auto& updateObservers)
 
             if constexpr (std::is_empty_v<ComponentType>) {
                 // Note: Can't registry.get() empty types.
-                componentUpdateMap[entity].updatedComponents.push_back(
-                    ComponentType{});
+                getComponentUpdate(componentUpdateMap, entity)
+                    .updatedComponents.push_back(ComponentType{});
             }
             else {
                 const auto& component{registry.get<ComponentType>(entity)};
-                componentUpdateMap[entity].updatedComponents.emplace_back(
-                    component);
+                getComponentUpdate(componentUpdateMap, entity)
+                    .updatedComponents.emplace_back(component);
             }
         }
 
@@ -316,5 +320,26 @@ void ComponentSyncSystem::addUpdateComponents(auto& updateObservers)
     });
 }
 
+ComponentUpdate& ComponentSyncSystem::getComponentUpdate(
+    ComponentUpdateMap& componentUpdateMap, entt::entity entity)
+{
+    auto it{componentUpdateMap.find(entity)};
+    if (it != componentUpdateMap.end()) {
+        return it->second;
+    }
+
+    // Note: The map's allocator isn't propagated to the message's vectors, so
+    //       we need to pass it in manually.
+    std::pmr::memory_resource* resource{
+        componentUpdateMap.get_allocator().resource()};
+    return componentUpdateMap
+        .try_emplace(entity,
+                     ComponentUpdate{
+                         0, entity,
+                         std::pmr::vector<ReplicatedComponent>{resource},
+                         std::pmr::vector<Uint8>{resource}})
+        .first->second;
+}
+
 } // namespace Server
 } // namespace AM
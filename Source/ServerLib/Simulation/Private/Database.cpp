@@ -1,12 +1,14 @@
 #include "Database.h"
 #include "PersistedComponentDefs.h"
 #include "Paths.h"
+#include "Config.h"
 #include "AMAssert.h"
 #include "Log.h"
 #include "SQLiteCpp/VariadicBind.h"
 #include "SQLiteCpp/Backup.h"
 #include <sqlite3.h>
 #include <array>
+#include <chrono>
 
 #ifdef SQLITECPP_ENABLE_ASSERT_HANDLER
 namespace SQLite
@@ -24,8 +26,25 @@ namespace AM
 {
 namespace Server
 {
+namespace
+{
+/**
+ * Returns the path of the database that we should write to.
+ */
+std::string getWriteDatabasePath()
+{
+    if constexpr (Config::DATABASE_MODE == DatabaseMode::WalFile) {
+        return Paths::BASE_PATH + "/World.db";
+    }
+    else {
+        return ":memory:";
+    }
+}
+} // namespace
+
 Database::Database()
-: database{":memory:", SQLite::OPEN_READWRITE | SQLite::OPEN_CREATE}
+: database{getWriteDatabasePath(),
+           SQLite::OPEN_READWRITE | SQLite::OPEN_CREATE}
 , backupDatabase{(Paths::BASE_PATH + "/World.db"),
                  SQLite::OPEN_READWRITE | SQLite::OPEN_CREATE}
 , currentTransaction{}
@@ -34,9 +53,13 @@ Database::Database()
 , backupMutex{}
 , backupCondVar{}
 , backupRequested{false}
+, pendingWriter{}
+, requestTimer{}
 , insertEntityQuery{nullptr}
 , deleteEntityQuery{nullptr}
 , iterateEntitiesQuery{nullptr}
+, insertComponentColumnQuery{nullptr}
+, iterateComponentColumnsQuery{nullptr}
 , insertItemQuery{nullptr}
 , deleteItemQuery{nullptr}
 , iterateItemsQuery{nullptr}
@@ -46,11 +69,18 @@ Database::Database()
 , getGlobalStoredValueMapQuery{nullptr}
 {
     // If any of our tables don't exist in World.db, initialize them.
+    if constexpr (Config::DATABASE_MODE == DatabaseMode::WalFile) {
+        configureWalConnection(database);
+        configureWalConnection(backupDatabase);
+    }
     initTables();
 
-    // Load the data from World.db into our in-memory database.
-    SQLite::Backup backup(database, backupDatabase);
-    backup.executeStep(-1);
+    // If we're running in-memory, load the data from World.db into our
+    // in-memory database.
+    if constexpr (Config::DATABASE_MODE == DatabaseMode::InMemory) {
+        SQLite::Backup backup(database, backupDatabase);
+        backup.executeStep(-1);
+    }
 
     // Note: We build these queries after initTables() because they'll
     //       segfault if there's no DB with the expected fields.
@@ -67,6 +97,17 @@ Database::Database()
     iterateEntitiesQuery = std::make_unique<SQLite::Statement>(
         backupDatabase, "SELECT * FROM entities");
 
+    insertComponentColumnQuery = std::make_unique<SQLite::Statement>(
+        database, R"(
+            INSERT INTO component_columns VALUES (?, ?, ?, ?)
+            ON CONFLICT(component_set, type_id) DO UPDATE SET
+                version=excluded.version,
+                serialized_column=excluded.serialized_column
+        )");
+    iterateComponentColumnsQuery = std::make_unique<SQLite::Statement>(
+        backupDatabase,
+        "SELECT * FROM component_columns ORDER BY component_set, type_id");
+
     insertItemQuery = std::make_unique<SQLite::Statement>(
         database, R"(
             INSERT INTO items VALUES (?, ?, ?, ?)
@@ -146,6 +187,25 @@ void Database::backupToFile()
     // Wake the backup thread.
     {
         std::unique_lock lock{backupMutex};
+        requestTimer.reset();
+        backupRequested = true;
+    }
+    backupCondVar.notify_one();
+}
+
+void Database::writeAndBackup(std::function<void(Database&)> writer)
+{
+    if (backupRequested) {
+        LOG_ERROR("Tried to begin database write while a backup was already "
+                  "underway.");
+        return;
+    }
+
+    // Queue the writer and wake the backup thread.
+    {
+        std::unique_lock lock{backupMutex};
+        pendingWriter = std::move(writer);
+        requestTimer.reset();
         backupRequested = true;
     }
     backupCondVar.notify_one();
@@ -190,6 +250,59 @@ void Database::deleteEntityData(entt::entity entity)
     }
 }
 
+void Database::deleteAllEntityData()
+{
+    try {
+        database.exec("DELETE FROM entities");
+    } catch (std::exception& e) {
+        LOG_ERROR("Failed to delete all entity data: %s", e.what());
+    }
+}
+
+bool Database::hasEntityData()
+{
+    return backupDatabase.execAndGet("SELECT EXISTS(SELECT 1 FROM entities)")
+               .getInt()
+           != 0;
+}
+
+void Database::saveComponentColumn(PersistedComponentSet componentSet,
+                                   Uint16 typeID, Uint16 version,
+                                   std::span<const Uint8> serializedColumn)
+{
+    try {
+        insertComponentColumnQuery->bind(1, static_cast<int>(componentSet));
+        insertComponentColumnQuery->bind(2, static_cast<int>(typeID));
+        insertComponentColumnQuery->bind(3, static_cast<int>(version));
+        insertComponentColumnQuery->bind(
+            4, serializedColumn.data(),
+            static_cast<int>(serializedColumn.size()));
+
+        insertComponentColumnQuery->exec();
+
+        insertComponentColumnQuery->reset();
+    } catch (std::exception& e) {
+        LOG_ERROR("Failed to save component column: %s", e.what());
+    }
+}
+
+void Database::deleteAllComponentColumns()
+{
+    try {
+        database.exec("DELETE FROM component_columns");
+    } catch (std::exception& e) {
+        LOG_ERROR("Failed to delete all component columns: %s", e.what());
+    }
+}
+
+bool Database::hasComponentColumnData()
+{
+    return backupDatabase
+               .execAndGet("SELECT EXISTS(SELECT 1 FROM component_columns)")
+               .getInt()
+           != 0;
+}
+
 void Database::saveItemData(ItemID itemID,
                             std::span<const Uint8> serializedItem,
                             ItemVersion version, std::string_view initScript)
@@ -295,6 +408,21 @@ void Database::initTables()
             )");
         }
 
+        // Entity components, one column per component type (only used if
+        // Config::ENTITY_PERSISTENCE_FORMAT is Columnar).
+        if (!backupDatabase.tableExists("component_columns")) {
+            backupDatabase.exec(R"(
+                CREATE TABLE component_columns
+                (
+                    component_set      INTEGER,
+                    type_id            INTEGER,
+                    version            INTEGER,
+                    serialized_column  BLOB,
+                    PRIMARY KEY (component_set, type_id)
+                ) STRICT
+            )");
+        }
+
         // Items.
         if (!backupDatabase.tableExists("items")) {
             backupDatabase.exec(R"(
@@ -400,20 +528,88 @@ void Database::checkDataVersions()
     }
 }
 
+void Database::configureWalConnection(SQLite::Database& connection)
+{
+    try {
+        // Note: WAL mode is persistent, but the rest are per-connection.
+        // Note: With WAL, NORMAL only risks losing the latest commits on
+        //       power loss, not corruption.
+        connection.exec("PRAGMA journal_mode=WAL");
+        connection.exec("PRAGMA synchronous=NORMAL");
+        connection.exec("PRAGMA mmap_size="
+                        + std::to_string(Config::DATABASE_MMAP_SIZE));
+    } catch (std::exception& e) {
+        LOG_FATAL("Failed to configure database: %s", e.what());
+    }
+}
+
+void Database::backupInSteps()
+{
+    try {
+        // Copy a few pages at a time, sleeping in between to spread out the
+        // disk I/O.
+        // Note: Only this thread modifies the in-memory database, so the
+        //       backup will never need to restart.
+        SQLite::Backup backup(backupDatabase, database);
+        while (backup.executeStep(Config::DATABASE_BACKUP_STEP_PAGES)
+               != SQLITE_DONE) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(
+                Config::DATABASE_BACKUP_STEP_DELAY_MS));
+        }
+    } catch (std::exception& e) {
+        LOG_ERROR("Failed to save database to file: %s", e.what());
+    }
+}
+
+void Database::checkpointWal()
+{
+    try {
+        // Note: PASSIVE won't wait on readers. Anything it can't move now
+        //       will be moved by a later checkpoint.
+        database.exec("PRAGMA wal_checkpoint(PASSIVE)");
+    } catch (std::exception& e) {
+        LOG_ERROR("Failed to checkpoint database: %s", e.what());
+    }
+}
+
 void Database::performBackup()
 {
     while (!exitRequested) {
-        // Wait until this thread is signaled by backupToFile().
+        // Wait until this thread is signaled by backupToFile() or
+        // writeAndBackup().
         std::unique_lock lock{backupMutex};
         backupCondVar.wait(lock, [this] { return backupRequested.load(); });
 
-        // Execute all backup steps at once.
-        try {
-            SQLite::Backup backup(backupDatabase, database);
-            backup.executeStep(-1);
-        } catch (std::exception& e) {
-            LOG_ERROR("Failed to save database to file: %s", e.what());
+        // If a write was queued, perform it.
+        Timer stageTimer{};
+        if (pendingWriter) {
+            startTransaction();
+            pendingWriter(*this);
+            commitTransaction();
+            pendingWriter = nullptr;
+        }
+        double writeTime{stageTimer.getTimeAndReset()};
+
+        // Persist the data to World.db.
+        // Note: In WalFile mode, the data was persisted when we committed.
+        //       We just need to keep the WAL from growing.
+        if constexpr (Config::DATABASE_MODE == DatabaseMode::WalFile) {
+            checkpointWal();
+        }
+        else {
+            backupInSteps();
         }
+        double backupTime{stageTimer.getTime()};
+
+        // Note: "Durable" is how long the data took to reach World.db after
+        //       the save was requested. Anything newer would be lost in a
+        //       crash.
+        LOG_INFO("Database write: %.6fs, %s: %.6fs, durable after %.6fs.",
+                 writeTime,
+                 ((Config::DATABASE_MODE == DatabaseMode::WalFile)
+                      ? "checkpoint"
+                      : "backup"),
+                 backupTime, requestTimer.getTime());
 
         backupRequested = false;
     }
@@ -150,8 +150,8 @@ DialogueSystem::TopicPair DialogueSystem::runChoice(
     // Run the choice's action script, pushing dialogue events into the
     // response.
     dialogueLua.nextTopicName = "";
-    auto scriptResult{dialogueLua.luaState.script(choice.actionScript,
-                                                  &sol::script_pass_on_error)};
+    auto scriptResult{
+        dialogueLua.scriptCache.run(dialogueLua.luaState, choice.actionScript)};
 
     if (!(scriptResult.valid())) {
         sol::error err = scriptResult;
@@ -193,8 +193,8 @@ DialogueSystem::TopicPair DialogueSystem::runTopic(const Dialogue& dialogue,
 {
     // Run the topic script, pushing dialogue events into the response.
     dialogueLua.nextTopicName = "";
-    auto scriptResult{dialogueLua.luaState.script(topic.topicScript,
-                                                  &sol::script_pass_on_error)};
+    auto scriptResult{
+        dialogueLua.scriptCache.run(dialogueLua.luaState, topic.topicScript)};
 
     if (!(scriptResult.valid())) {
         sol::error err = scriptResult;
@@ -274,16 +274,13 @@ bool DialogueSystem::runChoiceCondition(const Dialogue::Choice& choice,
                                         NetworkID clientID,
                                         bool sendAccessErrorMessage)
 {
-    // Append "r=" to the script so the result gets saved to a variable.
-    workString.clear();
-    workString.append("r=");
-    workString.append(choice.conditionScript);
-
     // Run the condition script.
+    // Note: The cache compiles it as "return (script)", so the result gets
+    //       returned to us.
     dialogueChoiceConditionLua.luaState["self"] = targetEntity;
     dialogueChoiceConditionLua.luaState["target"] = clientEntity;
-    auto scriptResult{dialogueChoiceConditionLua.luaState.script(
-        workString, &sol::script_pass_on_error)};
+    auto scriptResult{dialogueChoiceConditionLua.scriptCache.run(
+        dialogueChoiceConditionLua.luaState, choice.conditionScript)};
 
     if (!(scriptResult.valid())) {
         sol::error err = scriptResult;
@@ -295,7 +292,7 @@ bool DialogueSystem::runChoiceCondition(const Dialogue::Choice& choice,
     }
 
     // Validate the result.
-    const auto& conditionResult{dialogueChoiceConditionLua.luaState["r"]};
+    sol::object conditionResult{scriptResult.get<sol::object>()};
     if (!(conditionResult.is<bool>())) {
         // We always send this error, since it's a malformed script.
         network.serializeAndSend(
@@ -6,9 +6,11 @@
 #include "Peer.h"
 #include "Input.h"
 #include "ClientSimData.h"
+#include "Config.h"
 #include "Log.h"
 #include "tracy/Tracy.hpp"
 #include <memory>
+#include <utility>
 
 namespace AM
 {
@@ -18,7 +20,8 @@ InputSystem::InputSystem(const SimulationContext& inSimContext)
 : simulation{inSimContext.simulation}
 , world{inSimContext.simulation.getWorld()}
 , inputChangeRequestQueue{inSimContext.networkEventDispatcher}
-, inputChangeRequestSorter{}
+, inputChangeRequestSorter{Config::INPUT_SORTER_WINDOW_TICKS,
+                           Config::SORTER_RESERVED_EVENTS_PER_TICK}
 {
 }
 
@@ -27,45 +30,29 @@ void InputSystem::processInputMessages()
     ZoneScoped;
 
     // Sort any waiting client input requests.
-    while (const InputChangeRequest* inputChangeRequest{
+    while (InputChangeRequest* inputChangeRequest{
         inputChangeRequestQueue.peek()}) {
         // Push the request into the sorter.
+        // Note: The request is only moved from if it was valid.
         SorterBase::ValidityResult result{inputChangeRequestSorter.push(
-            *inputChangeRequest, inputChangeRequest->tickNum)};
+            std::move(*inputChangeRequest), inputChangeRequest->tickNum)};
 
         // If we had to drop a request, handle it.
         if (result != SorterBase::ValidityResult::Valid) {
             LOG_INFO("Dropped message from %u. Tick: %u, received: %u",
                      inputChangeRequest->netID, simulation.getCurrentTick(),
                      inputChangeRequest->tickNum);
-            handleDroppedMessage(inputChangeRequest->netID);
+            handleDroppedMessage(inputChangeRequest->netID, result);
         }
 
         inputChangeRequestQueue.pop();
     }
 
     // Process all client input requests for this tick.
-    std::queue<InputChangeRequest>& queue{
-        inputChangeRequestSorter.getCurrentQueue()};
-    Uint32 currentTick{simulation.getCurrentTick()};
-    for (; !(queue.empty()); queue.pop()) {
-        // Get the next request.
-        InputChangeRequest& inputChangeRequest{queue.front()};
-
-        // If the input is from an earlier tick, drop it and continue.
-        if (inputChangeRequest.tickNum < currentTick) {
-            LOG_INFO("Dropped message from %u. Tick: %u, received: %u",
-                     inputChangeRequest.netID, currentTick,
-                     inputChangeRequest.tickNum);
-            handleDroppedMessage(inputChangeRequest.netID);
-            inputChangeRequestQueue.pop();
-            continue;
-        }
-        // If the message is from a later tick, we're done.
-        else if (inputChangeRequest.tickNum > currentTick) {
-            break;
-        }
-
+    // Note: The sorter advances in lockstep with the sim, so these are all
+    //       for the current tick.
+    for (const InputChangeRequest& inputChangeRequest :
+         inputChangeRequestSorter.getCurrentEvents()) {
         // Update the client entity's inputs.
         entt::entity clientEntity{
             world.getClientEntity(inputChangeRequest.netID)};
@@ -84,7 +71,8 @@ void InputSystem::processInputMessages()
     inputChangeRequestSorter.advance();
 }
 
-void InputSystem::handleDroppedMessage(NetworkID clientID)
+void InputSystem::handleDroppedMessage(NetworkID clientID,
+                                       SorterBase::ValidityResult validity)
 {
     // Find the entity ID of the client that sent this request.
     entt::entity clientEntity{world.getClientEntity(clientID)};
@@ -93,7 +81,15 @@ void InputSystem::handleDroppedMessage(NetworkID clientID)
         return;
     }
 
+    // Track the drop, so late clients can be spotted.
     entt::registry& registry{world.registry};
+    ClientSimData& client{registry.get<ClientSimData>(clientEntity)};
+    if (validity == SorterBase::ValidityResult::TooLow) {
+        client.tooLowMessageCount++;
+    }
+    else {
+        client.tooHighMessageCount++;
+    }
     Input& entityInput{registry.get<Input>(clientEntity)};
 
     // Default the entity's inputs so they don't run off a cliff.
@@ -18,6 +18,8 @@
 #include "Log.h"
 #include "sol/sol.hpp"
 #include <algorithm>
+#include <string>
+#include <utility>
 
 namespace AM
 {
@@ -47,6 +49,9 @@ ItemSystem::ItemSystem(const SimulationContext& inSimContext)
 
 void ItemSystem::processUseItemInteractions()
 {
+    // Resume any handler scripts that are waiting on a later tick.
+    entityItemHandlerLua.scheduler.resumeScripts();
+
     // Process any waiting messages.
     CombineItemsRequest combineItemsRequest{};
     while (combineItemsRequestQueue.pop(combineItemsRequest)) {
@@ -371,21 +376,36 @@ void ItemSystem::runEntityItemHandlerScript(
     NetworkID clientID, entt::entity clientEntity, entt::entity targetEntity,
     const Item* item, const EntityItemHandlerScript& itemHandlerScript)
 {
-    // Run the given handler script.
-    entityItemHandlerLua.clientID = clientID;
-    entityItemHandlerLua.item = item;
-    entityItemHandlerLua.luaState["self"] = targetEntity;
-    entityItemHandlerLua.luaState["target"] = clientEntity;
-    entityItemHandlerLua.luaState["itemID"] = item->stringID;
-    auto result{entityItemHandlerLua.luaState.script(
-        itemHandlerScript.script, &sol::script_pass_on_error)};
-
-    // If there was an error while running the handler script, tell the
-    // user.
-    if (!(result.valid())) {
-        sol::error err = result;
-        network.serializeAndSend(clientID, SystemMessage{err.what()});
-    }
+    // Handler scripts run as coroutines, so they may yield and be resumed
+    // on a later tick. Before each resume, we restore the script's context.
+    // If the item or either entity has since been removed, the script is
+    // cancelled.
+    ItemID itemID{item->numericID};
+    auto restoreContext = [this, clientID, clientEntity, targetEntity,
+                           itemID]() {
+        const Item* item{itemData.getItem(itemID)};
+        if (!item || !(world.registry.valid(clientEntity))
+            || !(world.registry.valid(targetEntity))) {
+            return false;
+        }
+
+        entityItemHandlerLua.clientID = clientID;
+        entityItemHandlerLua.item = item;
+        entityItemHandlerLua.luaState["self"] = targetEntity;
+        entityItemHandlerLua.luaState["target"] = clientEntity;
+        entityItemHandlerLua.luaState["itemID"] = item->stringID;
+        return true;
+    };
+
+    // If there's an error while running the handler script, tell the user.
+    auto reportError = [this, clientID](std::string_view error) {
+        network.serializeAndSend(clientID, SystemMessage{std::string{error}});
+    };
+
+    // Start the handler script.
+    entityItemHandlerLua.scheduler.start(itemHandlerScript.script,
+                                         std::move(restoreContext),
+                                         std::move(reportError));
 }
 
 } // namespace Server
@@ -2,6 +2,7 @@
 #include "World.h"
 #include "Simulation.h"
 #include "Database.h"
+#include "Config.h"
 #include "ItemData.h"
 #include "EnginePersistedComponentTypes.h"
 #include "ProjectPersistedComponentTypes.h"
@@ -17,13 +18,20 @@
 #include "CastCooldown.h"
 #include "SaveTimestamp.h"
 #include "PersistedComponentDefs.h"
+#include "PersistedComponentSnapshot.h"
 #include "Deserialize.h"
 #include "ByteTools.h"
+#include "Timer.h"
 #include "Log.h"
 #include "entt/core/type_info.hpp"
 #include "boost/mp11/algorithm.hpp"
 #include <algorithm>
-#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <queue>
+#include <memory>
 #include <span>
 #include <string_view>
 #include <type_traits>
@@ -35,20 +43,422 @@ namespace AM
 namespace Server
 {
 
+/** The number of entities that the reader thread groups into each batch. */
+static constexpr std::size_t ENTITY_LOAD_BATCH_SIZE{1024};
+
+/** The number of batches that each worker thread may have queued or in
+    flight. Bounds the pipeline's memory usage if the sim thread falls
+    behind. */
+static constexpr std::size_t ENTITY_LOAD_BATCHES_PER_WORKER{4};
+
+/**
+ * An entity that has been deserialized and is ready to be added to the
+ * registry.
+ */
+struct StagedEntity {
+    /** The entity's saved ID. */
+    entt::entity entity{entt::null};
+
+    /** The entity's position. Every entity has one. */
+    Position position{};
+
+    /** The entity's other persisted components. */
+    PersistedComponentSnapshot components{};
+};
+
+/**
+ * A group of entities, as it moves through the load pipeline.
+ */
+struct EntityLoadBatch {
+    struct RawEntity {
+        entt::entity entity{entt::null};
+        std::size_t engineSize{0};
+        std::size_t projectSize{0};
+    };
+
+    /** Each entity's serialized engine and project components, back to
+        back, in the same order as rawEntities. Filled by the reader. */
+    std::vector<Uint8> rawData{};
+    std::vector<RawEntity> rawEntities{};
+
+    /** The entities that were successfully staged. Filled by a worker. */
+    std::vector<StagedEntity> stagedEntities{};
+
+    /** true once a worker has filled stagedEntities. */
+    bool isStaged{false};
+};
+
 LoadHelper::LoadHelper(World& inWorld, Simulation& inSimulation,
                        ItemData& inItemData)
 : world{inWorld}
 , simulation{inSimulation}
 , itemData{inItemData}
+, entityFormatNeedsMigration{false}
 {
 }
 
 void LoadHelper::loadNonClientEntities()
 {
-    // Iterate and load each entity in the database (we only store non-client 
-    // entities in the database).
-    world.database->iterateEntities(
-        std::bind_front(&LoadHelper::loadEntity, this));
+    constexpr bool useColumns{Config::ENTITY_PERSISTENCE_FORMAT
+                              == EntityPersistenceFormat::Columnar};
+
+    // If the configured format has no data but the other one does, the
+    // format was changed since the last save. Load the old data so it can
+    // be re-saved in the new format.
+    bool hasRows{world.database->hasEntityData()};
+    bool hasColumns{world.database->hasComponentColumnData()};
+    bool loadFromColumns{useColumns ? (hasColumns || !hasRows)
+                                    : (hasColumns && !hasRows)};
+    entityFormatNeedsMigration = (loadFromColumns != useColumns);
+    if (entityFormatNeedsMigration) {
+        LOG_INFO("Entity persistence format changed. Loading entities from "
+                 "the %s format, they'll be migrated on the next save.",
+                 (loadFromColumns ? "columnar" : "row"));
+    }
+
+    if (loadFromColumns) {
+        loadColumnarEntities();
+    }
+    else {
+        loadRowEntities();
+    }
+}
+
+bool LoadHelper::getEntityFormatNeedsMigration() const
+{
+    return entityFormatNeedsMigration;
+}
+
+void LoadHelper::loadRowEntities()
+{
+    Timer timer{};
+
+    // Leave a thread for the reader and one for us, but always have at least
+    // one worker.
+    unsigned int threadCount{std::thread::hardware_concurrency()};
+    unsigned int workerCount{(threadCount > 2) ? (threadCount - 2) : 1};
+    const std::size_t maxBatchesInFlight{workerCount
+                                         * ENTITY_LOAD_BATCHES_PER_WORKER};
+
+    // Pipeline state, guarded by pipelineMutex.
+    std::mutex pipelineMutex{};
+    std::condition_variable pipelineCondVar{};
+    // Every batch that's been read but not yet added, in read order.
+    std::deque<std::unique_ptr<EntityLoadBatch>> batches{};
+    // The batches that are waiting for a worker.
+    std::queue<EntityLoadBatch*> unstagedBatches{};
+    bool readIsComplete{false};
+
+    // Reader: Pull each entity's data out of the database (we only store
+    // non-client entities in the database) and group them into batches.
+    std::thread readerThread{[&]() {
+        auto batch{std::make_unique<EntityLoadBatch>()};
+        auto queueBatch = [&]() {
+            std::unique_lock lock{pipelineMutex};
+            pipelineCondVar.wait(lock, [&] {
+                return (batches.size() < maxBatchesInFlight);
+            });
+            unstagedBatches.push(batch.get());
+            batches.push_back(std::move(batch));
+            pipelineCondVar.notify_all();
+            batch = std::make_unique<EntityLoadBatch>();
+        };
+
+        try {
+            world.database->iterateEntities(
+                [&](entt::entity entity,
+                    std::span<const Uint8> serializedEngineComponents,
+                    std::span<const Uint8> serializedProjectComponents) {
+                    // Copy the data, since the spans are only valid until
+                    // the next row is read.
+                    batch->rawData.insert(batch->rawData.end(),
+                                          serializedEngineComponents.begin(),
+                                          serializedEngineComponents.end());
+                    batch->rawData.insert(batch->rawData.end(),
+                                          serializedProjectComponents.begin(),
+                                          serializedProjectComponents.end());
+                    batch->rawEntities.emplace_back(
+                        entity, serializedEngineComponents.size(),
+                        serializedProjectComponents.size());
+
+                    if (batch->rawEntities.size() == ENTITY_LOAD_BATCH_SIZE) {
+                        queueBatch();
+                    }
+                });
+        } catch (std::exception& e) {
+            LOG_FATAL("Failed to read entities from database: %s", e.what());
+        }
+
+        if (!(batch->rawEntities.empty())) {
+            queueBatch();
+        }
+
+        std::unique_lock lock{pipelineMutex};
+        readIsComplete = true;
+        pipelineCondVar.notify_all();
+    }};
+
+    // Workers: Stage each batch.
+    std::vector<std::thread> workerThreads{};
+    for (unsigned int i{0}; i < workerCount; ++i) {
+        workerThreads.emplace_back([&]() {
+            while (true) {
+                EntityLoadBatch* batch{nullptr};
+                {
+                    std::unique_lock lock{pipelineMutex};
+                    pipelineCondVar.wait(lock, [&] {
+                        return (!(unstagedBatches.empty()) || readIsComplete);
+                    });
+                    if (unstagedBatches.empty()) {
+                        // Nothing left to stage.
+                        return;
+                    }
+
+                    batch = unstagedBatches.front();
+                    unstagedBatches.pop();
+                }
+
+                stageBatch(*batch);
+
+                std::unique_lock lock{pipelineMutex};
+                batch->isStaged = true;
+                pipelineCondVar.notify_all();
+            }
+        });
+    }
+
+    // Add each staged batch to the registry, in the order it was read.
+    std::size_t loadedCount{0};
+    while (true) {
+        std::unique_ptr<EntityLoadBatch> batch{};
+        {
+            std::unique_lock lock{pipelineMutex};
+            pipelineCondVar.wait(lock, [&] {
+                return (!(batches.empty()) && batches.front()->isStaged)
+                       || (batches.empty() && readIsComplete);
+            });
+            if (batches.empty()) {
+                // Everything has been loaded.
+                break;
+            }
+
+            batch = std::move(batches.front());
+            batches.pop_front();
+
+            // Let the reader know there's room for another batch.
+            pipelineCondVar.notify_all();
+        }
+
+        for (StagedEntity& stagedEntity : batch->stagedEntities) {
+            addStagedEntity(stagedEntity);
+        }
+        loadedCount += batch->stagedEntities.size();
+    }
+
+    readerThread.join();
+    for (std::thread& workerThread : workerThreads) {
+        workerThread.join();
+    }
+
+    double timeTaken{timer.getTime()};
+    LOG_INFO("Loaded %zu entities in %.6fs (%.0f entities/s, %u worker "
+             "threads).",
+             loadedCount, timeTaken,
+             ((timeTaken > 0) ? (loadedCount / timeTaken) : 0.0),
+             workerCount);
+}
+
+void LoadHelper::loadColumnarEntities()
+{
+    Timer timer{};
+
+    // Read every column.
+    // Note: We copy the data, since the spans are only valid until the next
+    //       row is read.
+    std::vector<SerializedColumn> columns{};
+    world.database->iterateComponentColumns(
+        [&](PersistedComponentSet componentSet, Uint16 typeID,
+            Uint16 version, std::span<const Uint8> serializedColumn) {
+            columns.emplace_back(
+                componentSet, typeID, version,
+                std::vector<Uint8>{serializedColumn.begin(),
+                                   serializedColumn.end()});
+        });
+
+    // Create each entity, using the Position column.
+    // Note: We do this separately because we know every entity has a
+    //       Position, and we need it for createEntity() (and we want to
+    //       use createEntity() to centralize logic and avoid bugs).
+    using PositionEntry = EnginePersistedComponentTypes::EntryFor<Position>;
+    std::vector<entt::entity> entities{};
+    std::vector<Position> positions{};
+    if (const SerializedColumn* positionColumn{findColumn(
+            columns, PersistedComponentSet::Engine, PositionEntry::TYPE_ID)}) {
+        deserializeColumn<PositionEntry>(*positionColumn, false, entities,
+                                         positions);
+    }
+
+    for (std::size_t i{0}; i < entities.size(); ++i) {
+        entt::entity newEntity{world.createEntity(positions[i], entities[i])};
+        if (newEntity != entities[i]) {
+            LOG_FATAL("Created entity ID doesn't match saved entity ID. "
+                      "Created: %u, saved: %u",
+                      newEntity, entities[i]);
+        }
+    }
+
+    // Add the rest of the columns, in the same order that the row format
+    // adds each entity's components.
+    addColumns<EnginePersistedComponentTypes>(columns);
+    addColumns<ProjectPersistedComponentTypes>(columns);
+
+    // Init any components with lazy-updated timers.
+    for (entt::entity entity : entities) {
+        initTimerComponents(entity);
+    }
+
+    double timeTaken{timer.getTime()};
+    LOG_INFO("Loaded %zu entities from %zu columns in %.6fs (%.0f "
+             "entities/s).",
+             entities.size(), columns.size(), timeTaken,
+             ((timeTaken > 0) ? (entities.size() / timeTaken) : 0.0));
+}
+
+const LoadHelper::SerializedColumn*
+    LoadHelper::findColumn(const std::vector<SerializedColumn>& columns,
+                           PersistedComponentSet componentSet, Uint16 typeID)
+{
+    for (const SerializedColumn& column : columns) {
+        if ((column.componentSet == componentSet)
+            && (column.typeID == typeID)) {
+            return &column;
+        }
+    }
+
+    return nullptr;
+}
+
+template<typename ComponentList>
+void LoadHelper::addColumns(const std::vector<SerializedColumn>& columns)
+{
+    constexpr bool isEngineList{
+        std::is_same_v<ComponentList, EnginePersistedComponentTypes>};
+    constexpr PersistedComponentSet componentSet{
+        isEngineList ? PersistedComponentSet::Engine
+                     : PersistedComponentSet::Project};
+
+    boost::mp11::mp_for_each<typename ComponentList::EntryTypes>(
+        [&](auto entry) {
+            using Entry = decltype(entry);
+            using Component = typename Entry::Component;
+
+            // Note: We skip Position since it's handled elsewhere.
+            if constexpr (!std::is_same_v<Component, Position>) {
+                const SerializedColumn* column{
+                    findColumn(columns, componentSet, Entry::TYPE_ID)};
+                if (!column) {
+                    return;
+                }
+
+                std::vector<entt::entity> entities{};
+                std::vector<Component> components{};
+                deserializeColumn<Entry>(*column, true, entities, components);
+
+                // Engine components that imply other components need to be
+                // added one at a time. Everything else can be bulk-added to
+                // its storage.
+                constexpr bool needsCustomAdd{
+                    isEngineList
+                    && (std::is_same_v<Component, Input>
+                        || std::is_same_v<Component, Rotation>
+                        || std::is_same_v<Component, CollisionBitSets>
+                        || std::is_same_v<Component, GraphicState>)};
+                if constexpr (needsCustomAdd) {
+                    for (std::size_t i{0}; i < entities.size(); ++i) {
+                        addEngineComponent(entities[i], components[i]);
+                    }
+                }
+                else if constexpr (std::is_empty_v<Component>) {
+                    world.registry.insert<Component>(entities.begin(),
+                                                     entities.end());
+                }
+                else {
+                    world.registry.insert<Component>(entities.begin(),
+                                                     entities.end(),
+                                                     components.begin());
+                }
+            }
+        });
+}
+
+template<typename Entry>
+void LoadHelper::deserializeColumn(
+    const SerializedColumn& column, bool entitiesMustExist,
+    std::vector<entt::entity>& entities,
+    std::vector<typename Entry::Component>& components) const
+{
+    using Component = typename Entry::Component;
+    constexpr auto componentName{entt::type_name<Component>::value()};
+
+    std::span<const Uint8> data{column.data};
+    if (data.size() < COLUMN_HEADER_SIZE) {
+        LOG_ERROR("Malformed column for component %.*s (ID: %u): too small "
+                  "for a column header.",
+                  static_cast<int>(componentName.size()), componentName.data(),
+                  Entry::TYPE_ID);
+        return;
+    }
+
+    Uint32 entityCount{ByteTools::read32(data.data())};
+    entities.reserve(entityCount);
+    components.reserve(entityCount);
+
+    std::size_t readOffset{COLUMN_HEADER_SIZE};
+    for (Uint32 i{0}; i < entityCount; ++i) {
+        std::size_t remainingSize{data.size() - readOffset};
+        if (remainingSize < COLUMN_RECORD_HEADER_SIZE) {
+            LOG_ERROR("Malformed column for component %.*s (ID: %u): %zu "
+                      "trailing bytes is too small for a record header.",
+                      static_cast<int>(componentName.size()),
+                      componentName.data(), Entry::TYPE_ID, remainingSize);
+            return;
+        }
+
+        const Uint8* header{data.data() + readOffset};
+        entt::entity entity{static_cast<entt::entity>(
+            ByteTools::read32(header + COLUMN_RECORD_ENTITY_OFFSET))};
+        Uint32 payloadSize{
+            ByteTools::read32(header + COLUMN_RECORD_PAYLOAD_SIZE_OFFSET)};
+        readOffset += COLUMN_RECORD_HEADER_SIZE;
+
+        remainingSize = data.size() - readOffset;
+        if (payloadSize > remainingSize) {
+            LOG_ERROR("Malformed column for component %.*s (ID: %u): entity "
+                      "%u declares a %u-byte payload, but only %zu bytes "
+                      "remain.",
+                      static_cast<int>(componentName.size()),
+                      componentName.data(), Entry::TYPE_ID, entity,
+                      payloadSize, remainingSize);
+            return;
+        }
+
+        SerializedComponent serializedComponent{
+            column.typeID, column.version,
+            data.subspan(readOffset, payloadSize)};
+        readOffset += payloadSize;
+
+        // If the entity failed to load, skip it.
+        if (entitiesMustExist && !(world.registry.valid(entity))) {
+            continue;
+        }
+
+        Component component{};
+        if (deserializeComponent<Entry>(entity, serializedComponent,
+                                        component)) {
+            entities.emplace_back(entity);
+            components.emplace_back(std::move(component));
+        }
+    }
 }
 
 void LoadHelper::loadItems()
@@ -101,9 +511,37 @@ void LoadHelper::loadStoredValues()
     world.database->getGlobalStoredValueMap(std::move(loadGlobalMap));
 }
 
-void LoadHelper::loadEntity(
-    entt::entity entity, std::span<const Uint8> serializedEngineComponents,
-    std::span<const Uint8> serializedProjectComponents)
+void LoadHelper::stageBatch(EntityLoadBatch& batch) const
+{
+    batch.stagedEntities.reserve(batch.rawEntities.size());
+
+    std::span<const Uint8> rawData{batch.rawData};
+    std::size_t readOffset{0};
+    for (const EntityLoadBatch::RawEntity& rawEntity : batch.rawEntities) {
+        std::span<const Uint8> serializedEngineComponents{
+            rawData.subspan(readOffset, rawEntity.engineSize)};
+        readOffset += rawEntity.engineSize;
+        std::span<const Uint8> serializedProjectComponents{
+            rawData.subspan(readOffset, rawEntity.projectSize)};
+        readOffset += rawEntity.projectSize;
+
+        StagedEntity& stagedEntity{batch.stagedEntities.emplace_back()};
+        if (!stageEntity(rawEntity.entity, serializedEngineComponents,
+                         serializedProjectComponents, stagedEntity)) {
+            // Failed to stage, skip this entity.
+            batch.stagedEntities.pop_back();
+        }
+    }
+
+    // We don't need the raw data anymore, free it.
+    batch.rawData = {};
+    batch.rawEntities = {};
+}
+
+bool LoadHelper::stageEntity(entt::entity entity,
+                             std::span<const Uint8> serializedEngineComponents,
+                             std::span<const Uint8> serializedProjectComponents,
+                             StagedEntity& stagedEntity) const
 {
     // Build the lists of each component's position within the buffer.
     // Note: These lists are expected to have been saved in sorted order by 
@@ -112,11 +550,11 @@ void LoadHelper::loadEntity(
     std::vector<SerializedComponent> projectComponents{};
     if (!parseComponents(serializedEngineComponents, engineComponents, entity,
                          "engine")) {
-        return;
+        return false;
     }
     if (!parseComponents(serializedProjectComponents, projectComponents,
                          entity, "project")) {
-        return;
+        return false;
     }
 
     // Find the Position component within the engine list and deserialize it.
@@ -135,25 +573,43 @@ void LoadHelper::loadEntity(
         || (positionIt->typeID != PositionEntry::TYPE_ID)) {
         LOG_ERROR("Tried to load entity %u with no Position.",
                   entity);
-        return;
+        return false;
     }
 
-    Position position{};
-    if (!deserializeComponent<PositionEntry>(entity, *positionIt, position)) {
-        return;
+    stagedEntity.entity = entity;
+    if (!deserializeComponent<PositionEntry>(entity, *positionIt,
+                                             stagedEntity.position)) {
+        return false;
     }
 
+    // Deserialize the entity's other persisted components.
+    auto stageComponent = [&](auto&& component) {
+        using Component = std::decay_t<decltype(component)>;
+        std::get<std::optional<Component>>(stagedEntity.components)
+            .emplace(std::move(component));
+    };
+    loadComponents<EnginePersistedComponentTypes>(entity, engineComponents,
+                                                  stageComponent);
+    loadComponents<ProjectPersistedComponentTypes>(entity, projectComponents,
+                                                   stageComponent);
+
+    return true;
+}
+
+void LoadHelper::addStagedEntity(StagedEntity& stagedEntity)
+{
     // Add the entity to the registry.
-    entt::entity newEntity{world.createEntity(position, entity)};
-    if (newEntity != entity) {
+    entt::entity newEntity{
+        world.createEntity(stagedEntity.position, stagedEntity.entity)};
+    if (newEntity != stagedEntity.entity) {
         LOG_FATAL("Created entity ID doesn't match saved entity ID. "
                   "Created: %u, saved: %u",
-                  newEntity, entity);
+                  newEntity, stagedEntity.entity);
     }
 
-    // Load the entity's persisted components into the registry.
-    loadEngineComponents(newEntity, engineComponents);
-    loadProjectComponents(newEntity, projectComponents);
+    // Add the entity's persisted components to the registry.
+    addEngineComponents(newEntity, stagedEntity);
+    addProjectComponents(newEntity, stagedEntity);
 
     // Init any components with lazy-updated timers.
     initTimerComponents(newEntity);
@@ -209,58 +665,78 @@ bool LoadHelper::parseComponents(
     return true;
 }
 
-void LoadHelper::loadEngineComponents(
-    entt::entity entity,
-    const std::vector<SerializedComponent>& serializedComponents)
+/**
+ * Calls componentCallback on each component from ComponentList that's
+ * present in the given snapshot, in ComponentList's order.
+ */
+template<typename ComponentList, typename ComponentCallback>
+void forEachSnapshotComponent(PersistedComponentSnapshot& snapshot,
+                              ComponentCallback&& componentCallback)
 {
-    loadComponents<EnginePersistedComponentTypes>(
-        entity, serializedComponents, [&](const auto& component) {
-            using Component = std::decay_t<decltype(component)>;
-            if constexpr (std::is_same_v<Component, Input>) {
-                // Note: We don't use the persisted Input state, but we persist
-                //       it to flag that the entity is movement-enabled.
-                world.addMovementComponents(entity);
-            }
-            else if constexpr (std::is_same_v<Component, Rotation>) {
-                // Note: If movement or graphics components are
-                //       added first, this will be a replace.
-                world.registry.emplace_or_replace<Rotation>(entity, component);
-            }
-            else if constexpr (std::is_same_v<Component, CollisionBitSets>) {
-                if (world.registry.all_of<Collision>(entity)) {
-                    // Note: If graphics components are added first, this will
-                    //       be a replace.
-                    world.registry.emplace_or_replace<CollisionBitSets>(
-                        entity, component);
-                }
-                else {
-                    LOG_ERROR("Can't load CollisionBitSets for entity %u: "
-                              "entity has no Collision "
-                              "(addGraphicsComponents failed?)",
-                              entity);
-                }
-            }
-            else if constexpr (std::is_same_v<Component, GraphicState>) {
-                // Note: We only persist GraphicState, but it implies the rest
-                //       of the graphics components.
-                if (!world.addGraphicsComponents(entity, component)) {
-                    LOG_ERROR(
-                        "Failed to load graphics components for entity: %u",
-                        entity);
-                }
-            }
-            else {
-                world.registry.emplace<Component>(entity, component);
+    boost::mp11::mp_for_each<typename ComponentList::ComponentTypes>(
+        [&](auto I) {
+            using Component = decltype(I);
+            if (std::optional<Component>& component{
+                    std::get<std::optional<Component>>(snapshot)}) {
+                componentCallback(*component);
             }
         });
 }
 
-void LoadHelper::loadProjectComponents(
-    entt::entity entity,
-    const std::vector<SerializedComponent>& serializedComponents)
+void LoadHelper::addEngineComponents(entt::entity entity,
+                                     StagedEntity& stagedEntity)
+{
+    forEachSnapshotComponent<EnginePersistedComponentTypes>(
+        stagedEntity.components, [&](const auto& component) {
+            addEngineComponent(entity, component);
+        });
+}
+
+template<typename Component>
+void LoadHelper::addEngineComponent(entt::entity entity,
+                                    const Component& component)
+{
+    if constexpr (std::is_same_v<Component, Input>) {
+        // Note: We don't use the persisted Input state, but we persist it to
+        //       flag that the entity is movement-enabled.
+        world.addMovementComponents(entity);
+    }
+    else if constexpr (std::is_same_v<Component, Rotation>) {
+        // Note: If movement or graphics components are added first, this
+        //       will be a replace.
+        world.registry.emplace_or_replace<Rotation>(entity, component);
+    }
+    else if constexpr (std::is_same_v<Component, CollisionBitSets>) {
+        if (world.registry.all_of<Collision>(entity)) {
+            // Note: If graphics components are added first, this will be a
+            //       replace.
+            world.registry.emplace_or_replace<CollisionBitSets>(entity,
+                                                                component);
+        }
+        else {
+            LOG_ERROR("Can't load CollisionBitSets for entity %u: entity has "
+                      "no Collision (addGraphicsComponents failed?)",
+                      entity);
+        }
+    }
+    else if constexpr (std::is_same_v<Component, GraphicState>) {
+        // Note: We only persist GraphicState, but it implies the rest of the
+        //       graphics components.
+        if (!world.addGraphicsComponents(entity, component)) {
+            LOG_ERROR("Failed to load graphics components for entity: %u",
+                      entity);
+        }
+    }
+    else {
+        world.registry.emplace<Component>(entity, component);
+    }
+}
+
+void LoadHelper::addProjectComponents(entt::entity entity,
+                                      StagedEntity& stagedEntity)
 {
-    loadComponents<ProjectPersistedComponentTypes>(
-        entity, serializedComponents, [&](const auto& component) {
+    forEachSnapshotComponent<ProjectPersistedComponentTypes>(
+        stagedEntity.components, [&](const auto& component) {
             using Component = std::decay_t<decltype(component)>;
             world.registry.emplace<Component>(entity, component);
         });
@@ -270,7 +746,7 @@ template<typename ComponentList, typename ComponentCallback>
 void LoadHelper::loadComponents(
     entt::entity entity,
     const std::vector<SerializedComponent>& serializedComponents,
-    ComponentCallback&& componentCallback)
+    ComponentCallback&& componentCallback) const
 {
     std::size_t serializedIndex{0};
     boost::mp11::mp_for_each<typename ComponentList::EntryTypes>(
@@ -303,7 +779,7 @@ void LoadHelper::loadComponents(
                 Component component{};
                 if (deserializeComponent<Entry>(entity, serializedComponent,
                                                 component)) {
-                    componentCallback(component);
+                    componentCallback(std::move(component));
                 }
             }
 
@@ -146,6 +146,11 @@ void EngineLuaBindings::addEntityItemHandlerBindings()
         "sendSystemMessage", [&](std::string_view message) {
             sendSystemMessage(message, entityItemHandlerLua.clientID);
         });
+    // Note: Handler scripts run as coroutines. wait() yields the given
+    //       number of ticks to the scheduler, which resumes the script after
+    //       that many ticks have passed.
+    entityItemHandlerLua.luaState.set_function(
+        "wait", sol::yielding([](int ticks) { return ticks; }));
 }
 
 void EngineLuaBindings::addItemInitBindings()
@@ -516,6 +521,9 @@ void EngineLuaBindings::storeUint(entt::entity entity,
                 "\": value doesn't exist and value limit is reached");
             throw std::runtime_error{workString};
         }
+
+        // Mark the component as updated, so the new value gets saved.
+        world.registry.patch<StoredValues>(entity);
     }
     else {
         // We were given entt::null, use the global store.
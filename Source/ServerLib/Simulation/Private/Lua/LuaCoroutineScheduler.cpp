@@ -0,0 +1,151 @@
+#include "LuaCoroutineScheduler.h"
+#include "Config.h"
+#include "tracy/Tracy.hpp"
+#include <algorithm>
+#include <utility>
+
+namespace AM
+{
+namespace Server
+{
+LuaCoroutineScheduler::LuaCoroutineScheduler(sol::state& inLuaState,
+                                             LuaScriptCache& inScriptCache)
+: luaState{inLuaState}
+, scriptCache{inScriptCache}
+, queuedTasks{}
+, waitingTasks{}
+, nextWaitID{0}
+, waitWheel{}
+, resumingTasks{}
+, tickTimeUsed{0}
+{
+}
+
+void LuaCoroutineScheduler::start(std::string_view script,
+                                  RestoreContextFunction restoreContext,
+                                  ReportErrorFunction reportError)
+{
+    // Get the compiled script.
+    std::string errorString{};
+    std::shared_ptr<LuaScriptCache::CachedScript> cachedScript{
+        scriptCache.getScript(luaState, script, errorString)};
+    if (!cachedScript) {
+        reportError(errorString);
+        return;
+    }
+
+    // Set up a coroutine to run the script on.
+    ScriptTask task{};
+    task.cachedScript = std::move(cachedScript);
+    task.thread = sol::thread::create(luaState.lua_state());
+    task.coroutine
+        = sol::coroutine{task.thread.state(), task.cachedScript->function};
+    task.restoreContext = std::move(restoreContext);
+    task.reportError = std::move(reportError);
+
+    // If there's time left in this tick, start running the script. If it
+    // doesn't finish (or if there's no time left), queue it.
+    if (getRemainingTickTime() <= 0) {
+        queuedTasks.push_back(std::move(task));
+    }
+    else if (resume(task)) {
+        requeue(std::move(task));
+    }
+}
+
+void LuaCoroutineScheduler::resumeScripts()
+{
+    tickTimeUsed = 0;
+
+    // Move any waiting scripts that are now due into the queue.
+    waitWheel.advance(waitWheel.getCurrentTick() + 1);
+
+    resumingTasks.clear();
+    std::swap(resumingTasks, queuedTasks);
+    for (ScriptTask& task : resumingTasks) {
+        // If this tick's budget is used up, keep the script queued.
+        // Otherwise, resume it and requeue it if it yields again.
+        if (getRemainingTickTime() <= 0) {
+            queuedTasks.push_back(std::move(task));
+        }
+        else if (resume(task)) {
+            requeue(std::move(task));
+        }
+    }
+    resumingTasks.clear();
+
+    TracyPlot("LuaCoroutineQueueDepth",
+              static_cast<int64_t>(getQueueDepth()));
+}
+
+std::size_t LuaCoroutineScheduler::getQueueDepth() const
+{
+    return queuedTasks.size() + waitingTasks.size();
+}
+
+bool LuaCoroutineScheduler::resume(ScriptTask& task)
+{
+    // If the script's context is no longer valid, cancel it.
+    if (!(task.restoreContext())) {
+        return false;
+    }
+
+    // Run the script until it yields, finishes, or errors.
+    // Note: If the script runs out of time, the budget hook yields it.
+    task.budget.timeLimitS
+        = std::min(Config::LUA_SCRIPT_TIME_BUDGET_S, getRemainingTickTime());
+    task.budget.yieldWhenOutOfTime = true;
+    LuaScriptBudgetScope budgetScope{task.thread.thread_state(),
+                                     task.budget};
+    sol::protected_function_result result{task.coroutine()};
+
+    double runTime{task.budget.timer.getTime()};
+    tickTimeUsed += runTime;
+    scriptCache.recordRunTime(*(task.cachedScript), runTime);
+
+    if (result.status() == sol::call_status::yielded) {
+        // If the script called wait(ticks), wait that long. Otherwise, it
+        // ran out of time, so resume it next tick.
+        task.ticksUntilResume = 1;
+        if ((result.return_count() > 0)
+            && (result.get_type() == sol::type::number)) {
+            task.ticksUntilResume
+                = static_cast<Uint32>(std::max(result.get<int>(), 1));
+        }
+        return true;
+    }
+    else if (!(result.valid())) {
+        sol::error err = result;
+        task.reportError(err.what());
+    }
+
+    return false;
+}
+
+void LuaCoroutineScheduler::requeue(ScriptTask&& task)
+{
+    // If the script should be resumed next tick, queue it directly.
+    if (task.ticksUntilResume <= 1) {
+        queuedTasks.push_back(std::move(task));
+        return;
+    }
+
+    // Park the script until it's due.
+    // Note: resumeScripts() advances the wheel before resuming, so a delay
+    //       of N ticks is resumed by the Nth call from now.
+    Uint32 waitID{nextWaitID++};
+    waitWheel.scheduleAfter(task.ticksUntilResume, [this, waitID]() {
+        auto taskIt{waitingTasks.find(waitID)};
+        queuedTasks.push_back(std::move(taskIt->second));
+        waitingTasks.erase(taskIt);
+    });
+    waitingTasks.emplace(waitID, std::move(task));
+}
+
+double LuaCoroutineScheduler::getRemainingTickTime() const
+{
+    return Config::LUA_COROUTINE_TICK_BUDGET_S - tickTimeUsed;
+}
+
+} // namespace Server
+} // namespace AM
@@ -0,0 +1,78 @@
+#include "LuaScriptBudget.h"
+#include "Config.h"
+
+namespace AM
+{
+namespace Server
+{
+/**
+ * Returns the slot in the given thread's extra space that holds a pointer to
+ * the currently running script's budget.
+ */
+LuaScriptBudget*& getBudgetSlot(lua_State* luaThread)
+{
+    return *static_cast<LuaScriptBudget**>(lua_getextraspace(luaThread));
+}
+
+/**
+ * Called by Lua every LUA_SCRIPT_BUDGET_CHECK_INTERVAL instructions while a
+ * budgeted script is running. If the script has exceeded its budget, raises
+ * an error or yields.
+ */
+void budgetHook(lua_State* luaThread, lua_Debug*)
+{
+    LuaScriptBudget* budget{getBudgetSlot(luaThread)};
+    if (!budget) {
+        return;
+    }
+
+    budget->instructionCount += Config::LUA_SCRIPT_BUDGET_CHECK_INTERVAL;
+    if (budget->instructionCount > Config::LUA_SCRIPT_INSTRUCTION_BUDGET) {
+        luaL_error(luaThread,
+                   "Script exceeded its instruction budget (%d instructions).",
+                   static_cast<int>(Config::LUA_SCRIPT_INSTRUCTION_BUDGET));
+    }
+    else if (budget->timer.getTime() > budget->timeLimitS) {
+        if (budget->yieldWhenOutOfTime) {
+            // If we're inside a C call or metamethod that can't be yielded
+            // across, defer the yield to a later check. The instruction
+            // budget still bounds how long we can run.
+            if (!lua_isyieldable(luaThread)) {
+                return;
+            }
+
+            // Note: Count hooks are allowed to yield, as long as they return
+            //       no values. The scheduler will resume us on a later tick.
+            lua_yield(luaThread, 0);
+        }
+        else {
+            // Note: Lua's error formatting doesn't support float precision,
+            //       so we print the limit as integer milliseconds.
+            luaL_error(luaThread, "Script exceeded its time budget (%dms).",
+                       static_cast<int>(budget->timeLimitS * 1000));
+        }
+    }
+}
+
+LuaScriptBudgetScope::LuaScriptBudgetScope(lua_State* inLuaThread,
+                                           LuaScriptBudget& budget)
+: luaThread{inLuaThread}
+, previousHook{lua_gethook(luaThread)}
+, previousMask{lua_gethookmask(luaThread)}
+, previousCount{lua_gethookcount(luaThread)}
+, previousBudget{getBudgetSlot(luaThread)}
+{
+    budget.timer.reset();
+    getBudgetSlot(luaThread) = &budget;
+    lua_sethook(luaThread, &budgetHook, LUA_MASKCOUNT,
+                Config::LUA_SCRIPT_BUDGET_CHECK_INTERVAL);
+}
+
+LuaScriptBudgetScope::~LuaScriptBudgetScope()
+{
+    lua_sethook(luaThread, previousHook, previousMask, previousCount);
+    getBudgetSlot(luaThread) = previousBudget;
+}
+
+} // namespace Server
+} // namespace AM
@@ -0,0 +1,150 @@
+#include "LuaScriptCache.h"
+#include "LuaScriptBudget.h"
+#include "Config.h"
+#include "Log.h"
+#include <algorithm>
+#include <functional>
+
+namespace AM
+{
+namespace Server
+{
+LuaScriptCache::LuaScriptCache(std::string_view inSourcePrefix,
+                               std::string_view inSourceSuffix)
+: sourcePrefix{inSourcePrefix}
+, sourceSuffix{inSourceSuffix}
+, cachedScripts{}
+, lruOrder{}
+, workString{}
+, workError{}
+{
+}
+
+sol::protected_function_result LuaScriptCache::run(sol::state& luaState,
+                                                   std::string_view script)
+{
+    // Get the compiled script.
+    CacheEntry* cacheEntry{findOrCompile(luaState, script, workError)};
+
+    // If the script failed to compile, run it through script() to get the
+    // error in the form that callers expect.
+    if (!cacheEntry) {
+        // Note: If we have a prefix or suffix, findOrCompile() left the
+        //       wrapped source in workString.
+        std::string_view source{script};
+        if (!(sourcePrefix.empty()) || !(sourceSuffix.empty())) {
+            source = workString;
+        }
+        return luaState.script(source, &sol::script_pass_on_error);
+    }
+
+    // Run the script with its budget enforced.
+    CachedScript& cachedScript{*(cacheEntry->script)};
+    LuaScriptBudget budget{};
+    budget.timeLimitS = Config::LUA_SCRIPT_TIME_BUDGET_S;
+    LuaScriptBudgetScope budgetScope{luaState.lua_state(), budget};
+    sol::protected_function_result result{cachedScript.function()};
+
+    recordRunTime(cachedScript, budget.timer.getTime());
+
+    return result;
+}
+
+std::shared_ptr<LuaScriptCache::CachedScript>
+    LuaScriptCache::getScript(sol::state& luaState, std::string_view script,
+                              std::string& errorString)
+{
+    CacheEntry* cacheEntry{findOrCompile(luaState, script, errorString)};
+    if (!cacheEntry) {
+        return nullptr;
+    }
+
+    return cacheEntry->script;
+}
+
+LuaScriptCache::CacheEntry*
+    LuaScriptCache::findOrCompile(sol::state& luaState,
+                                  std::string_view script,
+                                  std::string& errorString)
+{
+    // If the script is already compiled, mark it as most recently used and
+    // return it.
+    std::size_t scriptHash{std::hash<std::string_view>{}(script)};
+    auto scriptIt{cachedScripts.find(scriptHash)};
+    if ((scriptIt != cachedScripts.end())
+        && (scriptIt->second.script->source == script)) {
+        CacheEntry& cacheEntry{scriptIt->second};
+        lruOrder.splice(lruOrder.begin(), lruOrder, cacheEntry.lruIt);
+        return &cacheEntry;
+    }
+
+    // Compile the script.
+    std::string_view source{script};
+    if (!(sourcePrefix.empty()) || !(sourceSuffix.empty())) {
+        workString.clear();
+        workString.append(sourcePrefix);
+        workString.append(script);
+        workString.append(sourceSuffix);
+        source = workString;
+    }
+    sol::load_result loadResult{luaState.load(source)};
+    if (!(loadResult.valid())) {
+        sol::error err = loadResult;
+        errorString = err.what();
+        return nullptr;
+    }
+
+    // If this is a hash collision, drop the old entry.
+    if (scriptIt != cachedScripts.end()) {
+        lruOrder.erase(scriptIt->second.lruIt);
+        cachedScripts.erase(scriptIt);
+    }
+
+    // If the cache is full, drop the least recently used script. If it's
+    // still in use, it'll be recompiled on its next run.
+    if (!(lruOrder.empty())
+        && (cachedScripts.size() >= Config::LUA_SCRIPT_CACHE_MAX_ENTRIES)) {
+        cachedScripts.erase(lruOrder.back());
+        lruOrder.pop_back();
+    }
+
+    // Cache the script.
+    lruOrder.push_front(scriptHash);
+    CacheEntry& cacheEntry{cachedScripts[scriptHash]};
+    cacheEntry.script = std::make_shared<CachedScript>();
+    cacheEntry.script->source = script;
+    cacheEntry.script->function = loadResult.get<sol::protected_function>();
+    cacheEntry.lruIt = lruOrder.begin();
+
+    return &cacheEntry;
+}
+
+void LuaScriptCache::recordRunTime(CachedScript& cachedScript, double runTime)
+{
+    cachedScript.runCount++;
+    cachedScript.totalRunTime += runTime;
+    cachedScript.maxRunTime = std::max(cachedScript.maxRunTime, runTime);
+
+    // If this run was slow, log it.
+    if (runTime > Config::LUA_SCRIPT_SLOW_RUN_S) {
+        // Note: We only print the start of the script, to keep logs readable.
+        constexpr std::size_t MAX_PRINTED_LENGTH{64};
+        std::string_view scriptStart{cachedScript.source};
+        scriptStart = scriptStart.substr(0, MAX_PRINTED_LENGTH);
+        LOG_INFO("Slow Lua script run: %.3fms. Runs: %zu, average: %.3fms, "
+                 "max: %.3fms. Script: \"%.*s\"",
+                 runTime * 1000, cachedScript.runCount,
+                 (cachedScript.totalRunTime / cachedScript.runCount) * 1000,
+                 cachedScript.maxRunTime * 1000,
+                 static_cast<int>(scriptStart.size()), scriptStart.data());
+    }
+}
+
+void LuaScriptCache::clear()
+{
+    cachedScripts.clear();
+    lruOrder.clear();
+}
+
+} // namespace Server
+} // namespace AM
@@ -76,7 +76,9 @@ void MovementSyncSystem::collectEntitiesToSend(ClientSimData& client)
 void MovementSyncSystem::sendEntityUpdate(ClientSimData& client)
 {
     auto movementGroup{EnttGroups::getMovementGroup(world.registry)};
-    MovementUpdate movementUpdate{};
+    MovementUpdate movementUpdate{
+        0, std::pmr::vector<MovementState>{&(simulation.getFrameArena())}};
+    movementUpdate.movementStates.reserve(entitiesToSend.size());
 
     // Add the entities to the message.
     for (entt::entity entityToSend : entitiesToSend) {
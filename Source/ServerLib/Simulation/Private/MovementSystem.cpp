@@ -17,19 +17,32 @@ MovementSystem::MovementSystem(const SimulationContext& inSimContext)
 , entityMover{world.registry, world.tileMap, world.entityLocator,
               world.collisionLocator}
 {
+    // Wake any entities that were loaded before we started observing, so
+    // they can settle.
+    for (entt::entity entity : EnttGroups::getMovementGroup(world.registry)) {
+        world.movementActivityTracker.wake(entity);
+    }
 }
 
 void MovementSystem::processMovements()
 {
     ZoneScoped;
 
-    // Move all entities that have the required components.
+    // Move all active entities that have the required components.
+    // Note: Sleeping entities have no inputs and are grounded, so moving
+    //       them would do nothing.
     auto movementGroup = EnttGroups::getMovementGroup(world.registry);
-    for (auto [entity, input, position, previousPosition, movement,
-               movementMods, rotation, collision, collisionBitSets] :
-         movementGroup.each()) {
-        // Save their old position.
+    MovementActivityTracker& activityTracker{world.movementActivityTracker};
+    activityTracker.forEachActive(movementGroup, [&](entt::entity entity) {
+        auto [input, position, previousPosition, movement, movementMods,
+              rotation, collision, collisionBitSets]
+            = movementGroup.get<Input, Position, PreviousPosition, Movement,
+                                MovementModifiers, Rotation, Collision,
+                                CollisionBitSets>(entity);
+
+        // Save their old position and rotation.
         previousPosition = position;
+        Rotation::Direction previousDirection{rotation.direction};
 
         // Move the entity.
         entityMover.moveEntity(
@@ -43,7 +56,24 @@ void MovementSystem::processMovements()
              .collision{collision},
              .collisionBitSets{collisionBitSets},
              .deltaSeconds{SharedConfig::SIM_TICK_TIMESTEP_S}});
-    }
+
+        // If the entity moved or turned, mark it as changed so it gets saved.
+        if (position != previousPosition) {
+            world.registry.patch<Position>(entity);
+        }
+        if (rotation.direction != previousDirection) {
+            world.registry.patch<Rotation>(entity);
+        }
+
+        // If the entity has come to rest, put it to sleep.
+        return !(MovementActivityTracker::canSleep(input, movement, position,
+                                                   previousPosition));
+    });
+
+    TracyPlot("ActiveMovementEntities",
+              static_cast<int64_t>(activityTracker.getActiveEntityCount()));
+    TracyPlot("SleepingMovementEntities",
+              static_cast<int64_t>(activityTracker.getSleepingEntityCount()));
 }
 
 } // namespace Server
@@ -0,0 +1,233 @@
+#include "FlowField.h"
+#include "NavGraph.h"
+#include "tracy/Tracy.hpp"
+#include <algorithm>
+#include <array>
+#include <functional>
+#include <limits>
+#include <queue>
+#include <utility>
+
+namespace AM
+{
+namespace Server
+{
+static constexpr float FLOW_DIAGONAL_COST{1.41421356f};
+static constexpr float FLOW_DIAGONAL_COMPONENT{0.70710678f};
+
+/** The 8 directions that an agent can move in, as tile offsets. */
+static constexpr std::array<std::array<int, 2>, 8> FLOW_STEP_OFFSETS{
+    {{1, 0}, {-1, 0}, {0, 1}, {0, -1}, {1, 1}, {1, -1}, {-1, 1}, {-1, -1}}};
+
+/** FLOW_STEP_OFFSETS, as normalized vectors. */
+static constexpr std::array<Vector3, 8> DIRECTION_VECTORS{
+    {{1, 0, 0},
+     {-1, 0, 0},
+     {0, 1, 0},
+     {0, -1, 0},
+     {FLOW_DIAGONAL_COMPONENT, FLOW_DIAGONAL_COMPONENT, 0},
+     {FLOW_DIAGONAL_COMPONENT, -FLOW_DIAGONAL_COMPONENT, 0},
+     {-FLOW_DIAGONAL_COMPONENT, FLOW_DIAGONAL_COMPONENT, 0},
+     {-FLOW_DIAGONAL_COMPONENT, -FLOW_DIAGONAL_COMPONENT, 0}}};
+
+/**
+ * A field's cost field: the nav flags of each tile in its region.
+ */
+struct FlowCostField {
+    /** Each tile's NavChunk::Flag bits. Row-major. */
+    std::vector<Uint8> tileFlags{};
+
+    int width{0};
+    int height{0};
+
+    /**
+     * Returns true if an agent can move 1 tile along a single axis from the
+     * given tile, without leaving the region.
+     */
+    bool canStepStraight(int x, int y, int dx, int dy) const
+    {
+        if (dx == 1) {
+            return (x + 1 < width)
+                   && (tileFlags[(y * width) + x]
+                       & NavChunk::PassablePositiveX);
+        }
+        else if (dx == -1) {
+            return (x > 0)
+                   && (tileFlags[(y * width) + (x - 1)]
+                       & NavChunk::PassablePositiveX);
+        }
+        else if (dy == 1) {
+            return (y + 1 < height)
+                   && (tileFlags[(y * width) + x]
+                       & NavChunk::PassablePositiveY);
+        }
+        else {
+            return (y > 0)
+                   && (tileFlags[((y - 1) * width) + x]
+                       & NavChunk::PassablePositiveY);
+        }
+    }
+
+    /**
+     * Returns true if an agent can move from the given tile in the given
+     * direction, without leaving the region.
+     */
+    bool canStep(int x, int y, int dx, int dy) const
+    {
+        if ((dx == 0) || (dy == 0)) {
+            return canStepStraight(x, y, dx, dy);
+        }
+
+        // Diagonal moves can't cut corners (matches NavGraph's searches).
+        return canStepStraight(x, y, dx, 0)
+               && canStepStraight((x + dx), y, 0, dy)
+               && canStepStraight(x, y, 0, dy)
+               && canStepStraight(x, (y + dy), dx, 0);
+    }
+};
+
+FlowField::FlowField(const TilePosition& inGoalTile,
+                     const ChunkExtent& inChunkExtent,
+                     const NavGraph& navGraph)
+: goalTile{inGoalTile}
+, chunkExtent{inChunkExtent}
+, tileExtent{chunkExtent}
+, directions{}
+{
+    ZoneScoped;
+
+    // Note: If the goal is outside of the region, we leave directions empty
+    //       and every point will be treated as outside of the field.
+    int goalIndex{getTileIndex(goalTile)};
+    if (goalIndex == -1) {
+        return;
+    }
+    directions.assign((tileExtent.xLength * tileExtent.yLength), NO_DIRECTION);
+
+    // Build the cost field, by copying each chunk's tile flags into place.
+    static constexpr int CHUNK_WIDTH{
+        static_cast<int>(SharedConfig::CHUNK_WIDTH)};
+    FlowCostField costField{
+        std::vector<Uint8>(directions.size(), 0), tileExtent.xLength,
+        tileExtent.yLength};
+    for (int chunkY{0}; chunkY < chunkExtent.yLength; ++chunkY) {
+        for (int chunkX{0}; chunkX < chunkExtent.xLength; ++chunkX) {
+            std::shared_ptr<const NavChunk> navChunk{navGraph.getNavChunk(
+                {chunkExtent.x + chunkX, chunkExtent.y + chunkY,
+                 chunkExtent.z})};
+            if (!navChunk) {
+                continue;
+            }
+
+            for (int y{0}; y < CHUNK_WIDTH; ++y) {
+                int fieldIndex{(((chunkY * CHUNK_WIDTH) + y) * costField.width)
+                               + (chunkX * CHUNK_WIDTH)};
+                std::copy_n(navChunk->tileFlags.begin() + (y * CHUNK_WIDTH),
+                            CHUNK_WIDTH,
+                            costField.tileFlags.begin() + fieldIndex);
+            }
+        }
+    }
+
+    // Build the integration field, by running Dijkstra's from the goal.
+    // Note: Edges are symmetric, so the cost from the goal to a tile is the
+    //       same as the cost from the tile to the goal.
+    std::vector<float> integrationField(
+        directions.size(), std::numeric_limits<float>::infinity());
+    integrationField[goalIndex] = 0;
+    std::priority_queue<std::pair<float, int>,
+                        std::vector<std::pair<float, int>>,
+                        std::greater<std::pair<float, int>>>
+        openList{};
+    openList.push({0.f, goalIndex});
+    while (!(openList.empty())) {
+        auto [cost, index]{openList.top()};
+        openList.pop();
+        if (cost > integrationField[index]) {
+            // Stale entry.
+            continue;
+        }
+
+        int x{index % costField.width};
+        int y{index / costField.width};
+        for (const auto& [dx, dy] : FLOW_STEP_OFFSETS) {
+            if (!costField.canStep(x, y, dx, dy)) {
+                continue;
+            }
+
+            int nextIndex{((y + dy) * costField.width) + (x + dx)};
+            float nextCost{
+                cost + (((dx != 0) && (dy != 0)) ? FLOW_DIAGONAL_COST : 1.f)};
+            if (nextCost < integrationField[nextIndex]) {
+                integrationField[nextIndex] = nextCost;
+                openList.push({nextCost, nextIndex});
+            }
+        }
+    }
+
+    // Build the direction field, by pointing each reachable tile at its
+    // cheapest neighbor.
+    for (int index{0}; index < static_cast<int>(directions.size()); ++index) {
+        float bestCost{integrationField[index]};
+        if ((index == goalIndex)
+            || (bestCost == std::numeric_limits<float>::infinity())) {
+            continue;
+        }
+
+        int x{index % costField.width};
+        int y{index / costField.width};
+        for (Uint8 direction{0}; direction < FLOW_STEP_OFFSETS.size();
+             ++direction) {
+            const auto& [dx, dy]{FLOW_STEP_OFFSETS[direction]};
+            if (!costField.canStep(x, y, dx, dy)) {
+                continue;
+            }
+
+            int nextIndex{((y + dy) * costField.width) + (x + dx)};
+            if (integrationField[nextIndex] < bestCost) {
+                bestCost = integrationField[nextIndex];
+                directions[index] = direction;
+            }
+        }
+    }
+}
+
+bool FlowField::contains(const Vector3& position) const
+{
+    return !(directions.empty())
+           && (getTileIndex(TilePosition{position}) != -1);
+}
+
+Vector3 FlowField::getDirection(const Vector3& position) const
+{
+    int index{getTileIndex(TilePosition{position})};
+    if (directions.empty() || (index == -1)
+        || (directions[index] == NO_DIRECTION)) {
+        return {};
+    }
+
+    return DIRECTION_VECTORS[directions[index]];
+}
+
+const TilePosition& FlowField::getGoalTile() const
+{
+    return goalTile;
+}
+
+const ChunkExtent& FlowField::getChunkExtent() const
+{
+    return chunkExtent;
+}
+
+int FlowField::getTileIndex(const TilePosition& tilePosition) const
+{
+    if (!(tileExtent.contains(tilePosition))) {
+        return -1;
+    }
+
+    return ((tilePosition.y - tileExtent.y) * tileExtent.xLength)
+           + (tilePosition.x - tileExtent.x);
+}
+
+} // namespace Server
+} // namespace AM
@@ -0,0 +1,291 @@
+#include "HierarchicalPathfinder.h"
+#include "Config.h"
+#include "tracy/Tracy.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <limits>
+
+namespace AM
+{
+namespace Server
+{
+/**
+ * Returns the octile distance between the given tiles. Used as the abstract
+ * search's heuristic.
+ */
+float getTileOctileDistance(const TilePosition& tileA,
+                            const TilePosition& tileB)
+{
+    static constexpr float DIAGONAL_COST{1.41421356f};
+    int dx{std::abs(tileA.x - tileB.x)};
+    int dy{std::abs(tileA.y - tileB.y)};
+    int diagonalSteps{std::min(dx, dy)};
+    int straightSteps{std::max(dx, dy) - diagonalSteps};
+    return static_cast<float>(straightSteps)
+           + (static_cast<float>(diagonalSteps) * DIAGONAL_COST);
+}
+
+HierarchicalPathfinder::HierarchicalPathfinder(NavGraph& inNavGraph)
+: navGraph{inNavGraph}
+, goalTile{}
+, goalChunkPosition{}
+, mapChunkExtent{}
+, nodes{}
+, nodeIndices{}
+, openList{}
+, clusterCache{}
+, missingChunks{}
+, startDistances{}
+, goalDistances{}
+{
+}
+
+HierarchicalPathfinder::Status HierarchicalPathfinder::findPath(
+    const TilePosition& startTile, const TilePosition& inGoalTile,
+    const ChunkExtent& inMapChunkExtent, std::vector<TilePosition>& outPath,
+    std::vector<ChunkPosition>& outMissingChunks)
+{
+    ZoneScoped;
+
+    // Clear out the last search's state.
+    goalTile = inGoalTile;
+    goalChunkPosition = NavGraph::toChunkPosition(goalTile);
+    mapChunkExtent = inMapChunkExtent;
+    nodes.clear();
+    nodeIndices.clear();
+    openList = {};
+    clusterCache.clear();
+    missingChunks.clear();
+    outPath.clear();
+
+    // Paths are searched on a single Z level.
+    ChunkPosition startChunkPosition{NavGraph::toChunkPosition(startTile)};
+    if ((startTile.z != goalTile.z)
+        || !(mapChunkExtent.contains(startChunkPosition))
+        || !(mapChunkExtent.contains(goalChunkPosition))) {
+        return Status::NotFound;
+    }
+
+    // Get the start and goal chunks.
+    std::shared_ptr<const NavChunk> startNavChunk{
+        navGraph.getNavChunk(startChunkPosition)};
+    std::shared_ptr<const NavChunk> goalNavChunk{
+        navGraph.getNavChunk(goalChunkPosition)};
+    if (!startNavChunk || !goalNavChunk) {
+        if (!startNavChunk) {
+            outMissingChunks.push_back(startChunkPosition);
+        }
+        if (!goalNavChunk) {
+            outMissingChunks.push_back(goalChunkPosition);
+        }
+        return Status::NeedsChunks;
+    }
+
+    // If either end can't be stood on, there's no path.
+    Uint8 startFlags{
+        startNavChunk->tileFlags[startNavChunk->getTileIndex(startTile)]};
+    Uint8 goalFlags{
+        goalNavChunk->tileFlags[goalNavChunk->getTileIndex(goalTile)]};
+    if (!(startFlags & NavChunk::Walkable)
+        || !(goalFlags & NavChunk::Walkable)) {
+        return Status::NotFound;
+    }
+
+    // If both ends are in the same chunk, try to stay within it.
+    outPath.push_back(startTile);
+    if (startTile == goalTile) {
+        return Status::Found;
+    }
+    else if ((startChunkPosition == goalChunkPosition)
+             && NavGraph::findLocalPath(*startNavChunk, startTile, goalTile,
+                                        outPath)) {
+        return Status::Found;
+    }
+
+    // Connect the start and goal tiles to their chunks' portals.
+    NavGraph::findDistances(*startNavChunk, startTile, startDistances);
+    NavGraph::findDistances(*goalNavChunk, goalTile, goalDistances);
+
+    // Run A* over the abstract graph.
+    nodes.push_back({startTile, 0.f, -1, false});
+    nodeIndices.emplace(startTile, 0);
+    openList.push({getTileOctileDistance(startTile, goalTile), 0});
+    int goalNodeIndex{-1};
+    std::size_t expansionCount{0};
+    while (!(openList.empty())) {
+        int nodeIndex{openList.top().second};
+        openList.pop();
+        if (nodes[nodeIndex].isClosed) {
+            continue;
+        }
+        else if (nodes[nodeIndex].tilePosition == goalTile) {
+            goalNodeIndex = nodeIndex;
+            break;
+        }
+        else if (expansionCount
+                 == Config::PATHFINDING_MAX_ABSTRACT_EXPANSIONS) {
+            break;
+        }
+
+        nodes[nodeIndex].isClosed = true;
+        expandNode(nodeIndex);
+        expansionCount++;
+    }
+
+    if ((goalNodeIndex != -1) && refinePath(goalNodeIndex, outPath)) {
+        return Status::Found;
+    }
+
+    // If we may have missed a path because some chunks weren't ready,
+    // report them.
+    outPath.clear();
+    if (!(missingChunks.empty())) {
+        std::sort(missingChunks.begin(), missingChunks.end());
+        missingChunks.erase(
+            std::unique(missingChunks.begin(), missingChunks.end()),
+            missingChunks.end());
+        outMissingChunks.insert(outMissingChunks.end(), missingChunks.begin(),
+                                missingChunks.end());
+        return Status::NeedsChunks;
+    }
+
+    return Status::NotFound;
+}
+
+void HierarchicalPathfinder::expandNode(int nodeIndex)
+{
+    // Note: We copy these since relaxNode() may reallocate nodes.
+    TilePosition tilePosition{nodes[nodeIndex].tilePosition};
+    float cost{nodes[nodeIndex].cost};
+    ChunkPosition chunkPosition{NavGraph::toChunkPosition(tilePosition)};
+    const NavCluster* cluster{getCluster(chunkPosition)};
+    if (!cluster) {
+        return;
+    }
+
+    // Add the edges to this chunk's portals.
+    const std::vector<NavCluster::Portal>& portals{cluster->portals};
+    if (nodeIndex == 0) {
+        // The start node isn't a portal, so use its distances.
+        const NavChunk& navChunk{*(cluster->navChunk)};
+        for (const NavCluster::Portal& portal : portals) {
+            float distance{
+                startDistances[navChunk.getTileIndex(portal.tilePosition)]};
+            relaxNode(portal.tilePosition, (cost + distance), nodeIndex);
+        }
+    }
+    else {
+        // Note: A corner tile may be in portals twice. Both entries have the
+        //       same distances, so we only need the first.
+        auto portalIt{std::find_if(portals.begin(), portals.end(),
+                                   [&](const NavCluster::Portal& portal) {
+                                       return portal.tilePosition
+                                              == tilePosition;
+                                   })};
+        if (portalIt != portals.end()) {
+            std::size_t fromIndex{
+                static_cast<std::size_t>(portalIt - portals.begin())};
+            for (std::size_t toIndex{0}; toIndex < portals.size();
+                 ++toIndex) {
+                relaxNode(portals[toIndex].tilePosition,
+                          (cost + cluster->getDistance(fromIndex, toIndex)),
+                          nodeIndex);
+            }
+        }
+    }
+
+    // If this is the goal's chunk, add the edge to the goal.
+    if (chunkPosition == goalChunkPosition) {
+        const NavChunk& navChunk{*(cluster->navChunk)};
+        float distance{goalDistances[navChunk.getTileIndex(tilePosition)]};
+        relaxNode(goalTile, (cost + distance), nodeIndex);
+    }
+
+    // Add the edges that cross into neighboring chunks.
+    for (const NavCluster::Portal& portal : portals) {
+        if (portal.tilePosition == tilePosition) {
+            relaxNode(portal.linkedTilePosition, (cost + 1.f), nodeIndex);
+        }
+    }
+}
+
+void HierarchicalPathfinder::relaxNode(const TilePosition& tilePosition,
+                                       float cost, int parentIndex)
+{
+    if (cost == std::numeric_limits<float>::infinity()) {
+        return;
+    }
+
+    auto [nodeIndexIt, wasAdded]{nodeIndices.try_emplace(
+        tilePosition, static_cast<int>(nodes.size()))};
+    int nodeIndex{nodeIndexIt->second};
+    if (wasAdded) {
+        nodes.push_back({tilePosition, std::numeric_limits<float>::infinity(),
+                         -1, false});
+    }
+
+    Node& node{nodes[nodeIndex]};
+    if (!(node.isClosed) && (cost < node.cost)) {
+        node.cost = cost;
+        node.parentIndex = parentIndex;
+        openList.push(
+            {cost + getTileOctileDistance(tilePosition, goalTile), nodeIndex});
+    }
+}
+
+const NavCluster*
+    HierarchicalPathfinder::getCluster(const ChunkPosition& chunkPosition)
+{
+    auto clusterIt{clusterCache.find(chunkPosition)};
+    if (clusterIt == clusterCache.end()) {
+        // Note: We cache nulls as well, so missing chunks are only reported
+        //       once.
+        clusterIt = clusterCache
+                        .emplace(chunkPosition,
+                                 navGraph.getCluster(chunkPosition,
+                                                     mapChunkExtent,
+                                                     missingChunks))
+                        .first;
+    }
+
+    return clusterIt->second.get();
+}
+
+bool HierarchicalPathfinder::refinePath(int goalNodeIndex,
+                                        std::vector<TilePosition>& outPath)
+{
+    // Walk back from the goal node to get the abstract path.
+    std::vector<int> abstractPath{};
+    for (int nodeIndex{goalNodeIndex}; nodeIndex != -1;
+         nodeIndex = nodes[nodeIndex].parentIndex) {
+        abstractPath.push_back(nodeIndex);
+    }
+    std::reverse(abstractPath.begin(), abstractPath.end());
+
+    // Fill in the tiles between each pair of nodes. outPath already holds
+    // the start tile.
+    for (std::size_t i{1}; i < abstractPath.size(); ++i) {
+        const TilePosition& fromTile{nodes[abstractPath[i - 1]].tilePosition};
+        const TilePosition& toTile{nodes[abstractPath[i]].tilePosition};
+        ChunkPosition fromChunkPosition{NavGraph::toChunkPosition(fromTile)};
+        if (fromChunkPosition == NavGraph::toChunkPosition(toTile)) {
+            // Both are in the same chunk, search within it.
+            const NavCluster* cluster{getCluster(fromChunkPosition)};
+            if (!cluster
+                || !NavGraph::findLocalPath(*(cluster->navChunk), fromTile,
+                                            toTile, outPath)) {
+                return false;
+            }
+        }
+        else {
+            // This is a step across a chunk border.
+            outPath.push_back(toTile);
+        }
+    }
+
+    return true;
+}
+
+} // namespace Server
+} // namespace AM
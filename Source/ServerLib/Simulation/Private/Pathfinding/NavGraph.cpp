@@ -0,0 +1,405 @@
+#include "NavGraph.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <functional>
+#include <limits>
+#include <queue>
+#include <utility>
+
+namespace AM
+{
+namespace Server
+{
+static constexpr int CHUNK_WIDTH{static_cast<int>(SharedConfig::CHUNK_WIDTH)};
+static constexpr float INFINITE_COST{std::numeric_limits<float>::infinity()};
+static constexpr float DIAGONAL_COST{1.41421356f};
+
+/** The 8 directions that a search can step in. */
+static constexpr std::array<std::array<int, 2>, 8> STEP_DIRECTIONS{
+    {{1, 0}, {-1, 0}, {0, 1}, {0, -1}, {1, 1}, {1, -1}, {-1, 1}, {-1, -1}}};
+
+/** A search's open list, ordered by lowest cost. Each element is a
+    (cost, local tile index) pair. */
+using NavOpenList
+    = std::priority_queue<std::pair<float, int>,
+                          std::vector<std::pair<float, int>>,
+                          std::greater<std::pair<float, int>>>;
+
+/**
+ * Returns true if an agent can move 1 tile along a single axis from the
+ * given tile, without leaving the chunk.
+ */
+bool canStepStraight(const NavChunk& navChunk, int x, int y, int dx, int dy)
+{
+    if (dx == 1) {
+        return (x + 1 < CHUNK_WIDTH)
+               && (navChunk.getFlags(x, y) & NavChunk::PassablePositiveX);
+    }
+    else if (dx == -1) {
+        return (x > 0)
+               && (navChunk.getFlags(x - 1, y) & NavChunk::PassablePositiveX);
+    }
+    else if (dy == 1) {
+        return (y + 1 < CHUNK_WIDTH)
+               && (navChunk.getFlags(x, y) & NavChunk::PassablePositiveY);
+    }
+    else {
+        return (y > 0)
+               && (navChunk.getFlags(x, y - 1) & NavChunk::PassablePositiveY);
+    }
+}
+
+/**
+ * Returns true if an agent can move from the given tile in the given
+ * direction, without leaving the chunk.
+ */
+bool canStepInChunk(const NavChunk& navChunk, int x, int y, int dx, int dy)
+{
+    if ((dx == 0) || (dy == 0)) {
+        return canStepStraight(navChunk, x, y, dx, dy);
+    }
+
+    // Diagonal moves can't cut corners, so both of the L-shaped routes
+    // around the diagonal must be open.
+    return canStepStraight(navChunk, x, y, dx, 0)
+           && canStepStraight(navChunk, (x + dx), y, 0, dy)
+           && canStepStraight(navChunk, x, y, 0, dy)
+           && canStepStraight(navChunk, x, (y + dy), dx, 0);
+}
+
+/**
+ * Returns the octile distance between the given local tile indices.
+ */
+float getOctileDistance(int indexA, int indexB)
+{
+    int dx{std::abs((indexA % CHUNK_WIDTH) - (indexB % CHUNK_WIDTH))};
+    int dy{std::abs((indexA / CHUNK_WIDTH) - (indexB / CHUNK_WIDTH))};
+    int diagonalSteps{std::min(dx, dy)};
+    int straightSteps{std::max(dx, dy) - diagonalSteps};
+    return static_cast<float>(straightSteps)
+           + (static_cast<float>(diagonalSteps) * DIAGONAL_COST);
+}
+
+/**
+ * Pushes a portal into the given cluster for the middle of each contiguous
+ * run of crossable tiles along one of its borders.
+ *
+ * @param crossable For each tile along the border, true if it can be
+ *                  crossed.
+ * @param firstTile The first tile along the border, within the cluster's
+ *                  chunk.
+ * @param stepX, stepY The offset between tiles along the border.
+ * @param crossX, crossY The offset from a border tile to its linked tile.
+ */
+void addBorderPortals(NavCluster& cluster,
+                      const std::array<bool, CHUNK_WIDTH>& crossable,
+                      const TilePosition& firstTile, int stepX, int stepY,
+                      int crossX, int crossY)
+{
+    int runStart{-1};
+    for (int i{0}; i <= CHUNK_WIDTH; ++i) {
+        bool isCrossable{(i < CHUNK_WIDTH) && crossable[i]};
+        if (isCrossable && (runStart == -1)) {
+            runStart = i;
+        }
+        else if (!isCrossable && (runStart != -1)) {
+            int middle{(runStart + i - 1) / 2};
+            TilePosition tilePosition{firstTile.x + (middle * stepX),
+                                      firstTile.y + (middle * stepY),
+                                      firstTile.z};
+            TilePosition linkedTilePosition{tilePosition.x + crossX,
+                                            tilePosition.y + crossY,
+                                            tilePosition.z};
+            cluster.portals.push_back({tilePosition, linkedTilePosition});
+            runStart = -1;
+        }
+    }
+}
+
+std::shared_ptr<const NavChunk>
+    NavGraph::getNavChunk(const ChunkPosition& chunkPosition) const
+{
+    std::shared_lock lock{navChunksMutex};
+    auto navChunkIt{navChunks.find(chunkPosition)};
+    if (navChunkIt != navChunks.end()) {
+        return navChunkIt->second;
+    }
+
+    return nullptr;
+}
+
+void NavGraph::setNavChunk(std::shared_ptr<const NavChunk> navChunk)
+{
+    std::unique_lock lock{navChunksMutex};
+    ChunkPosition chunkPosition{navChunk->position};
+    navChunks[chunkPosition] = std::move(navChunk);
+}
+
+void NavGraph::eraseNavChunk(const ChunkPosition& chunkPosition)
+{
+    {
+        std::unique_lock lock{navChunksMutex};
+        navChunks.erase(chunkPosition);
+    }
+
+    // Erase the clusters that depend on this chunk (its own, and its +x and
+    // +y neighbors'). If a worker is concurrently building one of them from
+    // the old chunk, it'll be caught as stale by getCluster().
+    std::scoped_lock lock{clustersMutex};
+    clusters.erase(chunkPosition);
+    clusters.erase(
+        ChunkPosition{chunkPosition.x + 1, chunkPosition.y, chunkPosition.z});
+    clusters.erase(
+        ChunkPosition{chunkPosition.x, chunkPosition.y + 1, chunkPosition.z});
+}
+
+std::shared_ptr<const NavCluster>
+    NavGraph::getCluster(const ChunkPosition& chunkPosition,
+                         const ChunkExtent& mapChunkExtent,
+                         std::vector<ChunkPosition>& missingChunks)
+{
+    if (!(mapChunkExtent.contains(chunkPosition))) {
+        return nullptr;
+    }
+
+    // Get the nav chunks that this cluster depends on.
+    bool isReady{true};
+    std::shared_ptr<const NavChunk> navChunk{getNavChunk(chunkPosition)};
+    if (!navChunk) {
+        missingChunks.push_back(chunkPosition);
+        isReady = false;
+    }
+
+    std::shared_ptr<const NavChunk> negativeXNavChunk{};
+    ChunkPosition negativeXPosition{chunkPosition.x - 1, chunkPosition.y,
+                                    chunkPosition.z};
+    if (mapChunkExtent.contains(negativeXPosition)) {
+        negativeXNavChunk = getNavChunk(negativeXPosition);
+        if (!negativeXNavChunk) {
+            missingChunks.push_back(negativeXPosition);
+            isReady = false;
+        }
+    }
+
+    std::shared_ptr<const NavChunk> negativeYNavChunk{};
+    ChunkPosition negativeYPosition{chunkPosition.x, chunkPosition.y - 1,
+                                    chunkPosition.z};
+    if (mapChunkExtent.contains(negativeYPosition)) {
+        negativeYNavChunk = getNavChunk(negativeYPosition);
+        if (!negativeYNavChunk) {
+            missingChunks.push_back(negativeYPosition);
+            isReady = false;
+        }
+    }
+
+    if (!isReady) {
+        return nullptr;
+    }
+
+    // If we have a cluster that was built from these same nav chunks, use it.
+    {
+        std::scoped_lock lock{clustersMutex};
+        auto clusterIt{clusters.find(chunkPosition)};
+        if (clusterIt != clusters.end()) {
+            const NavCluster& cluster{*(clusterIt->second)};
+            if ((cluster.navChunk == navChunk)
+                && (cluster.negativeXNavChunk == negativeXNavChunk)
+                && (cluster.negativeYNavChunk == negativeYNavChunk)) {
+                return clusterIt->second;
+            }
+        }
+    }
+
+    // Build a new cluster outside of the lock, so other workers aren't held
+    // up. If 2 workers build the same cluster, the last one wins.
+    std::shared_ptr<const NavCluster> cluster{
+        buildCluster(navChunk, negativeXNavChunk, negativeYNavChunk)};
+    {
+        std::scoped_lock lock{clustersMutex};
+        clusters[chunkPosition] = cluster;
+    }
+
+    return cluster;
+}
+
+ChunkPosition NavGraph::toChunkPosition(const TilePosition& tilePosition)
+{
+    auto floorDivide{[](int value) {
+        return (value >= 0) ? (value / CHUNK_WIDTH)
+                            : ((value - CHUNK_WIDTH + 1) / CHUNK_WIDTH);
+    }};
+    return {floorDivide(tilePosition.x), floorDivide(tilePosition.y),
+            tilePosition.z};
+}
+
+void NavGraph::findDistances(const NavChunk& navChunk,
+                             const TilePosition& startTile,
+                             ChunkTileArray<float>& outDistances)
+{
+    outDistances.fill(INFINITE_COST);
+
+    // Run Dijkstra's from the start tile.
+    int startIndex{navChunk.getTileIndex(startTile)};
+    outDistances[startIndex] = 0;
+    NavOpenList openList{};
+    openList.push({0.f, startIndex});
+    while (!(openList.empty())) {
+        auto [cost, index]{openList.top()};
+        openList.pop();
+        if (cost > outDistances[index]) {
+            // Stale entry.
+            continue;
+        }
+
+        int x{index % CHUNK_WIDTH};
+        int y{index / CHUNK_WIDTH};
+        for (const auto& [dx, dy] : STEP_DIRECTIONS) {
+            if (!canStepInChunk(navChunk, x, y, dx, dy)) {
+                continue;
+            }
+
+            int nextIndex{((y + dy) * CHUNK_WIDTH) + (x + dx)};
+            float nextCost{cost
+                           + (((dx != 0) && (dy != 0)) ? DIAGONAL_COST : 1.f)};
+            if (nextCost < outDistances[nextIndex]) {
+                outDistances[nextIndex] = nextCost;
+                openList.push({nextCost, nextIndex});
+            }
+        }
+    }
+}
+
+bool NavGraph::findLocalPath(const NavChunk& navChunk,
+                             const TilePosition& startTile,
+                             const TilePosition& goalTile,
+                             std::vector<TilePosition>& outPath)
+{
+    int startIndex{navChunk.getTileIndex(startTile)};
+    int goalIndex{navChunk.getTileIndex(goalTile)};
+
+    ChunkTileArray<float> costs{};
+    costs.fill(INFINITE_COST);
+    ChunkTileArray<int> parents{};
+    ChunkTileArray<bool> isClosed{};
+
+    // Run A* from the start tile.
+    costs[startIndex] = 0;
+    parents[startIndex] = -1;
+    NavOpenList openList{};
+    openList.push({getOctileDistance(startIndex, goalIndex), startIndex});
+    bool foundGoal{false};
+    while (!(openList.empty())) {
+        int index{openList.top().second};
+        openList.pop();
+        if (isClosed[index]) {
+            continue;
+        }
+        else if (index == goalIndex) {
+            foundGoal = true;
+            break;
+        }
+        isClosed[index] = true;
+
+        int x{index % CHUNK_WIDTH};
+        int y{index / CHUNK_WIDTH};
+        for (const auto& [dx, dy] : STEP_DIRECTIONS) {
+            if (!canStepInChunk(navChunk, x, y, dx, dy)) {
+                continue;
+            }
+
+            int nextIndex{((y + dy) * CHUNK_WIDTH) + (x + dx)};
+            float nextCost{costs[index]
+                           + (((dx != 0) && (dy != 0)) ? DIAGONAL_COST : 1.f)};
+            if (!isClosed[nextIndex] && (nextCost < costs[nextIndex])) {
+                costs[nextIndex] = nextCost;
+                parents[nextIndex] = index;
+                openList.push(
+                    {nextCost + getOctileDistance(nextIndex, goalIndex),
+                     nextIndex});
+            }
+        }
+    }
+
+    if (!foundGoal) {
+        return false;
+    }
+
+    // Walk back from the goal, then put the tiles in start -> goal order.
+    TilePosition origin{navChunk.position};
+    std::size_t firstNewIndex{outPath.size()};
+    for (int index{goalIndex}; index != startIndex; index = parents[index]) {
+        outPath.emplace_back(origin.x + (index % CHUNK_WIDTH),
+                             origin.y + (index / CHUNK_WIDTH), origin.z);
+    }
+    std::reverse(outPath.begin() + firstNewIndex, outPath.end());
+
+    return true;
+}
+
+std::shared_ptr<const NavCluster>
+    NavGraph::buildCluster(std::shared_ptr<const NavChunk> navChunk,
+                           std::shared_ptr<const NavChunk> negativeXNavChunk,
+                           std::shared_ptr<const NavChunk> negativeYNavChunk)
+{
+    auto cluster{std::make_shared<NavCluster>()};
+    TilePosition origin{navChunk->position};
+
+    // Find the portals on each side. The -x and -y edges are owned by the
+    // neighboring chunks, so we get their crossability from them.
+    std::array<bool, CHUNK_WIDTH> crossable{};
+    for (int i{0}; i < CHUNK_WIDTH; ++i) {
+        crossable[i] = (navChunk->getFlags((CHUNK_WIDTH - 1), i)
+                        & NavChunk::PassablePositiveX);
+    }
+    addBorderPortals(*cluster, crossable,
+                     {origin.x + (CHUNK_WIDTH - 1), origin.y, origin.z}, 0, 1,
+                     1, 0);
+
+    for (int i{0}; i < CHUNK_WIDTH; ++i) {
+        crossable[i] = (navChunk->getFlags(i, (CHUNK_WIDTH - 1))
+                        & NavChunk::PassablePositiveY);
+    }
+    addBorderPortals(*cluster, crossable,
+                     {origin.x, origin.y + (CHUNK_WIDTH - 1), origin.z}, 1, 0,
+                     0, 1);
+
+    if (negativeXNavChunk) {
+        for (int i{0}; i < CHUNK_WIDTH; ++i) {
+            crossable[i] = (negativeXNavChunk->getFlags((CHUNK_WIDTH - 1), i)
+                            & NavChunk::PassablePositiveX);
+        }
+        addBorderPortals(*cluster, crossable, origin, 0, 1, -1, 0);
+    }
+
+    if (negativeYNavChunk) {
+        for (int i{0}; i < CHUNK_WIDTH; ++i) {
+            crossable[i] = (negativeYNavChunk->getFlags(i, (CHUNK_WIDTH - 1))
+                            & NavChunk::PassablePositiveY);
+        }
+        addBorderPortals(*cluster, crossable, origin, 1, 0, 0, -1);
+    }
+
+    // Find the distance between each pair of portals.
+    std::size_t portalCount{cluster->portals.size()};
+    cluster->distances.resize(portalCount * portalCount);
+    ChunkTileArray<float> tileDistances{};
+    for (std::size_t i{0}; i < portalCount; ++i) {
+        findDistances(*navChunk, cluster->portals[i].tilePosition,
+                      tileDistances);
+        for (std::size_t j{0}; j < portalCount; ++j) {
+            cluster->distances[(i * portalCount) + j]
+                = tileDistances[navChunk->getTileIndex(
+                    cluster->portals[j].tilePosition)];
+        }
+    }
+
+    cluster->navChunk = std::move(navChunk);
+    cluster->negativeXNavChunk = std::move(negativeXNavChunk);
+    cluster->negativeYNavChunk = std::move(negativeYNavChunk);
+
+    return cluster;
+}
+
+} // namespace Server
+} // namespace AM
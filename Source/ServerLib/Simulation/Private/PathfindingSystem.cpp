@@ -0,0 +1,533 @@
+#include "PathfindingSystem.h"
+#include "SimulationContext.h"
+#include "Simulation.h"
+#include "World.h"
+#include "CollisionLayerType.h"
+#include "BoundingBox.h"
+#include "Tile.h"
+#include "TileLayer.h"
+#include "Terrain.h"
+#include "Config.h"
+#include "tracy/Tracy.hpp"
+#include <algorithm>
+#include <array>
+#include <cstdlib>
+#include <variant>
+
+namespace AM
+{
+namespace Server
+{
+/** How far above a tile's floor the agent's volume starts. Keeps flat
+    terrain from counting as an obstacle. */
+static constexpr float FLOOR_CLEARANCE{1};
+
+/** Returns the tiles that a tile update changed. */
+struct ChangedTileExtentGetter {
+    TileExtent operator()(const TileExtentClearLayers& tileUpdate)
+    {
+        return tileUpdate.tileExtent;
+    }
+
+    // TileAddLayer, TileRemoveLayer, TileClearLayers
+    template<typename T>
+    TileExtent operator()(const T& tileUpdate)
+    {
+        const TilePosition& tilePosition{tileUpdate.tilePosition};
+        return {tilePosition.x, tilePosition.y, tilePosition.z, 1, 1, 1};
+    }
+};
+
+/**
+ * Returns a volume that contains an agent standing on either of the given
+ * tiles, and everything in between.
+ */
+BoundingBox getAgentVolume(const TilePosition& tileA,
+                           const TilePosition& tileB)
+{
+    Vector3 pointA{tileA.getCenteredBottomPoint()};
+    Vector3 pointB{tileB.getCenteredBottomPoint()};
+    return {{std::min(pointA.x, pointB.x) - Config::PATHFINDING_AGENT_RADIUS,
+             std::min(pointA.y, pointB.y) - Config::PATHFINDING_AGENT_RADIUS,
+             pointA.z + FLOOR_CLEARANCE},
+            {std::max(pointA.x, pointB.x) + Config::PATHFINDING_AGENT_RADIUS,
+             std::max(pointA.y, pointB.y) + Config::PATHFINDING_AGENT_RADIUS,
+             pointA.z + Config::PATHFINDING_AGENT_HEIGHT}};
+}
+
+/**
+ * Returns the flow field goal cell that contains the given tile (see
+ * Config::FLOW_FIELD_GOAL_CELL_WIDTH).
+ */
+TilePosition getFlowFieldGoalCell(const TilePosition& tilePosition)
+{
+    static constexpr int CELL_WIDTH{Config::FLOW_FIELD_GOAL_CELL_WIDTH};
+    auto floorDivide{[](int value) {
+        return (value >= 0) ? (value / CELL_WIDTH)
+                            : ((value - CELL_WIDTH + 1) / CELL_WIDTH);
+    }};
+    return {floorDivide(tilePosition.x), floorDivide(tilePosition.y),
+            tilePosition.z};
+}
+
+PathfindingSystem::PathfindingSystem(const SimulationContext& inSimContext)
+: world{inSimContext.simulation.getWorld()}
+, navGraph{}
+, flowFields{}
+, flowFieldBuildQueue{}
+, nextRequestID{0}
+, pendingRequests{}
+, chunkWaitQueue{}
+, taskMutex{}
+, taskCondition{}
+, taskQueue{}
+, resultMutex{}
+, taskResults{}
+, workers{}
+{
+    for (unsigned int i{0}; i < Config::PATHFINDING_WORKER_COUNT; ++i) {
+        workers.emplace_back(
+            [this](std::stop_token stopToken) { workerLoop(stopToken); });
+    }
+}
+
+PathRequestID PathfindingSystem::requestPath(const Vector3& start,
+                                             const Vector3& goal,
+                                             PathCallback callback)
+{
+    PathRequestID requestID{nextRequestID++};
+    TilePosition startTile{start};
+    TilePosition goalTile{goal};
+    PendingRequest& request{
+        pendingRequests
+            .emplace(requestID, PendingRequest{startTile, goalTile,
+                                               std::move(callback)})
+            .first->second};
+
+    // Queue the chunks that the path will most likely pass through: the box
+    // around the start and goal, plus a margin. If the path needs to go
+    // further, the worker will ask for more.
+    // Note: If the request is invalid (e.g. the tiles are on different Z
+    //       levels), the worker will immediately fail it.
+    ChunkPosition startChunk{NavGraph::toChunkPosition(startTile)};
+    ChunkPosition goalChunk{NavGraph::toChunkPosition(goalTile)};
+    if (startTile.z == goalTile.z) {
+        static constexpr int MARGIN{Config::PATHFINDING_REQUEST_CHUNK_MARGIN};
+        ChunkExtent requestExtent{
+            std::min(startChunk.x, goalChunk.x) - MARGIN,
+            std::min(startChunk.y, goalChunk.y) - MARGIN,
+            startChunk.z,
+            std::abs(startChunk.x - goalChunk.x) + 1 + (MARGIN * 2),
+            std::abs(startChunk.y - goalChunk.y) + 1 + (MARGIN * 2),
+            1};
+        requestExtent
+            = requestExtent.intersectWith(world.tileMap.getChunkExtent());
+
+        if (requestExtent.size() <= Config::PATHFINDING_MAX_PREBUILT_CHUNKS) {
+            for (int y{requestExtent.y}; y <= requestExtent.yMax(); ++y) {
+                for (int x{requestExtent.x}; x <= requestExtent.xMax(); ++x) {
+                    request.chunksToBuild.emplace_back(x, y,
+                                                       requestExtent.z);
+                }
+            }
+        }
+        else {
+            // Too big to build up front, just start with the ends.
+            // Note: Out-of-bounds chunks are fine, they'll be skipped.
+            request.chunksToBuild.push_back(startChunk);
+            request.chunksToBuild.push_back(goalChunk);
+        }
+    }
+
+    chunkWaitQueue.push_back(requestID);
+
+    return requestID;
+}
+
+void PathfindingSystem::cancelRequest(PathRequestID requestID)
+{
+    // Note: If a worker is running this request, its result will be
+    //       ignored since the request is no longer pending.
+    pendingRequests.erase(requestID);
+}
+
+const FlowField* PathfindingSystem::getFlowField(const Vector3& goal)
+{
+    // If we already have a field for this goal's cell, use it (or keep
+    // waiting for it to be built).
+    TilePosition goalTile{goal};
+    TilePosition goalCell{getFlowFieldGoalCell(goalTile)};
+    auto flowFieldIt{flowFields.find(goalCell)};
+    if (flowFieldIt != flowFields.end()) {
+        CachedFlowField& cachedFlowField{flowFieldIt->second};
+        cachedFlowField.idleTicks = 0;
+        return (cachedFlowField.flowField ? &(*cachedFlowField.flowField)
+                                          : nullptr);
+    }
+
+    // Queue the field to be built, covering the chunks around the goal.
+    ChunkPosition goalChunk{NavGraph::toChunkPosition(goalTile)};
+    static constexpr int RADIUS{Config::FLOW_FIELD_CHUNK_RADIUS};
+    ChunkExtent fieldExtent{(goalChunk.x - RADIUS),
+                            (goalChunk.y - RADIUS),
+                            goalChunk.z,
+                            ((RADIUS * 2) + 1),
+                            ((RADIUS * 2) + 1),
+                            1};
+    fieldExtent = fieldExtent.intersectWith(world.tileMap.getChunkExtent());
+    flowFields.emplace(goalCell, CachedFlowField{goalTile, fieldExtent});
+    flowFieldBuildQueue.push_back(goalCell);
+
+    return nullptr;
+}
+
+void PathfindingSystem::invalidateChangedTiles()
+{
+    ZoneScoped;
+
+    ChangedTileExtentGetter extentGetter{};
+    for (const auto& updateVariant : world.tileMap.getTileUpdateHistory()) {
+        invalidateTileExtent(std::visit(extentGetter, updateVariant));
+    }
+}
+
+void PathfindingSystem::processPathRequests()
+{
+    ZoneScoped;
+
+    // Deliver any finished results.
+    std::vector<PathTaskResult> finishedResults{};
+    {
+        std::scoped_lock lock{resultMutex};
+        finishedResults.swap(taskResults);
+    }
+
+    for (PathTaskResult& taskResult : finishedResults) {
+        auto requestIt{pendingRequests.find(taskResult.requestID)};
+        if (requestIt == pendingRequests.end()) {
+            // Request was cancelled.
+            continue;
+        }
+
+        // If the worker needs more chunks and we haven't given up on this
+        // request, queue them. Otherwise, it's finished.
+        PendingRequest& request{requestIt->second};
+        if ((taskResult.status
+             == HierarchicalPathfinder::Status::NeedsChunks)
+            && (request.attemptCount < Config::PATHFINDING_MAX_ATTEMPTS)) {
+            request.chunksToBuild = std::move(taskResult.missingChunks);
+            chunkWaitQueue.push_back(taskResult.requestID);
+        }
+        else {
+            finishRequest(taskResult.requestID, taskResult);
+        }
+    }
+
+    // Build the chunks that waiting requests need, and give the requests
+    // that are ready to the workers.
+    const ChunkExtent& mapChunkExtent{world.tileMap.getChunkExtent()};
+    unsigned int buildCount{0};
+    while (!(chunkWaitQueue.empty())) {
+        auto requestIt{pendingRequests.find(chunkWaitQueue.front())};
+        if (requestIt == pendingRequests.end()) {
+            // Request was cancelled.
+            chunkWaitQueue.pop_front();
+            continue;
+        }
+
+        PendingRequest& request{requestIt->second};
+        std::vector<ChunkPosition>& chunksToBuild{request.chunksToBuild};
+        while (!(chunksToBuild.empty())
+               && (buildCount < Config::PATHFINDING_CHUNK_BUILDS_PER_TICK)) {
+            // Note: Multiple requests may want the same chunk.
+            const ChunkPosition& chunkPosition{chunksToBuild.back()};
+            if (mapChunkExtent.contains(chunkPosition)
+                && !navGraph.getNavChunk(chunkPosition)) {
+                buildNavChunk(chunkPosition);
+                buildCount++;
+            }
+            chunksToBuild.pop_back();
+        }
+
+        // If we ran out of build budget, continue next tick.
+        if (!(chunksToBuild.empty())) {
+            break;
+        }
+
+        request.attemptCount++;
+        {
+            std::scoped_lock lock{taskMutex};
+            taskQueue.push_back({requestIt->first, request.startTile,
+                                 request.goalTile, mapChunkExtent});
+        }
+        taskCondition.notify_one();
+        chunkWaitQueue.pop_front();
+    }
+
+    // Build any queued flow fields with the remaining chunk budget.
+    buildQueuedFlowFields(buildCount);
+
+    // Throw out any flow fields that haven't been used in a while.
+    for (auto it{flowFields.begin()}; it != flowFields.end();) {
+        CachedFlowField& cachedFlowField{it->second};
+        if (cachedFlowField.idleTicks >= Config::FLOW_FIELD_IDLE_TICKS) {
+            it = flowFields.erase(it);
+        }
+        else {
+            cachedFlowField.idleTicks++;
+            ++it;
+        }
+    }
+
+    TracyPlot("PathRequestsPending",
+              static_cast<int64_t>(pendingRequests.size()));
+    TracyPlot("FlowFieldCount", static_cast<int64_t>(flowFields.size()));
+}
+
+void PathfindingSystem::finishRequest(PathRequestID requestID,
+                                      PathTaskResult& taskResult)
+{
+    PathResult pathResult{requestID};
+    if (taskResult.status == HierarchicalPathfinder::Status::Found) {
+        pathResult.status = PathResult::Status::Found;
+        pathResult.waypoints.reserve(taskResult.path.size());
+        for (const TilePosition& tilePosition : taskResult.path) {
+            pathResult.waypoints.push_back(
+                tilePosition.getCenteredBottomPoint());
+        }
+    }
+
+    // Erase the request before calling the callback, in case it makes a new
+    // request.
+    auto requestIt{pendingRequests.find(requestID)};
+    PathCallback callback{std::move(requestIt->second.callback)};
+    pendingRequests.erase(requestIt);
+
+    callback(pathResult);
+}
+
+void PathfindingSystem::buildQueuedFlowFields(unsigned int& buildCount)
+{
+    unsigned int fieldBuildCount{0};
+    while (!(flowFieldBuildQueue.empty())
+           && (fieldBuildCount < Config::FLOW_FIELD_BUILDS_PER_TICK)) {
+        // If the field was thrown out, skip it.
+        auto flowFieldIt{flowFields.find(flowFieldBuildQueue.front())};
+        if ((flowFieldIt == flowFields.end())
+            || flowFieldIt->second.flowField) {
+            flowFieldBuildQueue.pop_front();
+            continue;
+        }
+
+        // Build the nav chunks that the field covers.
+        CachedFlowField& cachedFlowField{flowFieldIt->second};
+        const ChunkExtent& fieldExtent{cachedFlowField.chunkExtent};
+        bool chunksAreReady{true};
+        for (int y{fieldExtent.y}; y <= fieldExtent.yMax(); ++y) {
+            for (int x{fieldExtent.x}; x <= fieldExtent.xMax(); ++x) {
+                ChunkPosition chunkPosition{x, y, fieldExtent.z};
+                if (navGraph.getNavChunk(chunkPosition)) {
+                    continue;
+                }
+                else if (buildCount
+                         < Config::PATHFINDING_CHUNK_BUILDS_PER_TICK) {
+                    buildNavChunk(chunkPosition);
+                    buildCount++;
+                }
+                else {
+                    chunksAreReady = false;
+                }
+            }
+        }
+
+        // If we ran out of build budget, continue next tick.
+        if (!chunksAreReady) {
+            break;
+        }
+
+        cachedFlowField.flowField.emplace(cachedFlowField.goalTile,
+                                          fieldExtent, navGraph);
+        fieldBuildCount++;
+        flowFieldBuildQueue.pop_front();
+    }
+}
+
+void PathfindingSystem::invalidateTileExtent(const TileExtent& tileExtent)
+{
+    // Our -x and -y neighbors own the edges that lead into these tiles, so
+    // they're also affected.
+    ChunkPosition minChunk{NavGraph::toChunkPosition(
+        {tileExtent.x - 1, tileExtent.y - 1, tileExtent.z})};
+    ChunkPosition maxChunk{NavGraph::toChunkPosition(
+        {tileExtent.xMax(), tileExtent.yMax(), tileExtent.z})};
+
+    // Tiles on the level above may be supported by these tiles, so they're
+    // also affected.
+    // Note: Chunks are 1 tile tall, so tile Z == chunk Z.
+    ChunkExtent changedExtent{minChunk.x,
+                              minChunk.y,
+                              tileExtent.z,
+                              (maxChunk.x - minChunk.x + 1),
+                              (maxChunk.y - minChunk.y + 1),
+                              (tileExtent.zLength + 1)};
+    for (int z{changedExtent.z}; z <= changedExtent.zMax(); ++z) {
+        for (int y{changedExtent.y}; y <= changedExtent.yMax(); ++y) {
+            for (int x{changedExtent.x}; x <= changedExtent.xMax(); ++x) {
+                navGraph.eraseNavChunk({x, y, z});
+            }
+        }
+    }
+
+    // Throw out any flow fields that cover the changed chunks. They'll be
+    // rebuilt the next time that they're requested.
+    std::erase_if(flowFields, [&](const auto& pair) {
+        const ChunkExtent& fieldExtent{pair.second.chunkExtent};
+        return !(fieldExtent.intersectWith(changedExtent).isEmpty());
+    });
+}
+
+void PathfindingSystem::buildNavChunk(const ChunkPosition& chunkPosition)
+{
+    ZoneScoped;
+
+    // Our edges reach into the +x and +y neighbors, so make sure that they're
+    // loaded along with this chunk. Tiles may be supported by the level
+    // below, so load those chunks too.
+    TileMap& tileMap{world.tileMap};
+    const ChunkExtent& mapChunkExtent{tileMap.getChunkExtent()};
+    for (int z{chunkPosition.z - 1}; z <= chunkPosition.z; ++z) {
+        for (const ChunkPosition& position :
+             {ChunkPosition{chunkPosition.x, chunkPosition.y, z},
+              ChunkPosition{chunkPosition.x + 1, chunkPosition.y, z},
+              ChunkPosition{chunkPosition.x, chunkPosition.y + 1, z}}) {
+            if (mapChunkExtent.contains(position)) {
+                tileMap.loadChunkIfNecessary(position);
+            }
+        }
+    }
+
+    // Find which tiles can be stood on (they have something underfoot and
+    // an agent fits), including the row and column just past this chunk.
+    static constexpr int CHUNK_WIDTH{
+        static_cast<int>(SharedConfig::CHUNK_WIDTH)};
+    static constexpr int WALKABLE_WIDTH{CHUNK_WIDTH + 1};
+    std::array<bool, (WALKABLE_WIDTH * WALKABLE_WIDTH)> isWalkable{};
+    const TileExtent& mapTileExtent{tileMap.getTileExtent()};
+    TilePosition origin{chunkPosition};
+    for (int y{0}; y < WALKABLE_WIDTH; ++y) {
+        for (int x{0}; x < WALKABLE_WIDTH; ++x) {
+            TilePosition tilePosition{origin.x + x, origin.y + y, origin.z};
+            isWalkable[(y * WALKABLE_WIDTH) + x]
+                = mapTileExtent.contains(tilePosition)
+                  && hasSupport(tilePosition)
+                  && isVolumeClear(getAgentVolume(tilePosition, tilePosition));
+        }
+    }
+
+    // Fill in each tile's flags. An edge is passable if both tiles are
+    // walkable and nothing (e.g. a wall) is in between them.
+    auto navChunk{std::make_shared<NavChunk>()};
+    navChunk->position = chunkPosition;
+    for (int y{0}; y < CHUNK_WIDTH; ++y) {
+        for (int x{0}; x < CHUNK_WIDTH; ++x) {
+            if (!isWalkable[(y * WALKABLE_WIDTH) + x]) {
+                continue;
+            }
+
+            TilePosition tilePosition{origin.x + x, origin.y + y, origin.z};
+            Uint8 flags{NavChunk::Walkable};
+
+            TilePosition positiveXTile{tilePosition.x + 1, tilePosition.y,
+                                       tilePosition.z};
+            if (isWalkable[(y * WALKABLE_WIDTH) + x + 1]
+                && isVolumeClear(getAgentVolume(tilePosition, positiveXTile))) {
+                flags |= NavChunk::PassablePositiveX;
+            }
+
+            TilePosition positiveYTile{tilePosition.x, tilePosition.y + 1,
+                                       tilePosition.z};
+            if (isWalkable[((y + 1) * WALKABLE_WIDTH) + x]
+                && isVolumeClear(getAgentVolume(tilePosition, positiveYTile))) {
+                flags |= NavChunk::PassablePositiveY;
+            }
+
+            navChunk->tileFlags[(y * CHUNK_WIDTH) + x] = flags;
+        }
+    }
+
+    navGraph.setNavChunk(std::move(navChunk));
+}
+
+bool PathfindingSystem::hasSupport(const TilePosition& tilePosition)
+{
+    // The bottom level of the map is always solid ground.
+    const TileMap& tileMap{world.tileMap};
+    if (tilePosition.z == tileMap.getTileExtent().z) {
+        return true;
+    }
+
+    // A floor or terrain in this tile can be stood on.
+    if (const Tile* tile{tileMap.cgetTile(tilePosition)}) {
+        if (tile->findLayer(TileLayer::Type::Floor)
+            || tile->findLayer(TileLayer::Type::Terrain)) {
+            return true;
+        }
+    }
+
+    // So can full-height terrain in the tile below.
+    TilePosition belowPosition{tilePosition.x, tilePosition.y,
+                               (tilePosition.z - 1)};
+    if (const Tile* belowTile{tileMap.cgetTile(belowPosition)}) {
+        for (const TileLayer& layer :
+             belowTile->getLayers(TileLayer::Type::Terrain)) {
+            if (Terrain::getTotalHeight(layer.graphicValue)
+                == Terrain::Height::Full) {
+                return true;
+            }
+        }
+    }
+
+    return false;
+}
+
+bool PathfindingSystem::isVolumeClear(const BoundingBox& volume)
+{
+    return world.collisionLocator
+        .getCollisions(volume, (CollisionLayerType::TerrainWall
+                                | CollisionLayerType::Object))
+        .empty();
+}
+
+void PathfindingSystem::workerLoop(std::stop_token stopToken)
+{
+    HierarchicalPathfinder pathfinder{navGraph};
+    while (true) {
+        // Wait for a task.
+        PathTask task{};
+        {
+            std::unique_lock lock{taskMutex};
+            if (!taskCondition.wait(lock, stopToken, [this] {
+                    return !(taskQueue.empty());
+                })) {
+                // A stop was requested.
+                return;
+            }
+
+            task = taskQueue.front();
+            taskQueue.pop_front();
+        }
+
+        // Run the search and pass back the result.
+        PathTaskResult taskResult{task.requestID};
+        taskResult.status = pathfinder.findPath(
+            task.startTile, task.goalTile, task.mapChunkExtent,
+            taskResult.path, taskResult.missingChunks);
+        {
+            std::scoped_lock lock{resultMutex};
+            taskResults.push_back(std::move(taskResult));
+        }
+    }
+}
+
+} // namespace Server
+} // namespace AM
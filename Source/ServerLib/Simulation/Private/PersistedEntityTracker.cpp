@@ -0,0 +1,102 @@
+#include "PersistedEntityTracker.h"
+#include "PersistedComponentSnapshot.h"
+#include "ClientSimData.h"
+#include "boost/mp11/algorithm.hpp"
+#include "entt/entity/registry.hpp"
+
+namespace AM
+{
+namespace Server
+{
+PersistedEntityTracker::PersistedEntityTracker(entt::registry& inRegistry)
+: registry{inRegistry}
+, changedEntities{}
+, destroyedEntities{}
+, lastClientEntity{entt::null}
+{
+    // When a persisted component is added or updated, mark its entity as
+    // changed.
+    changedEntities.bind(registry);
+    boost::mp11::mp_for_each<PersistedComponentTypes>([&](auto I) {
+        using Component = decltype(I);
+        changedEntities.template on_construct<Component>()
+            .template on_update<Component>();
+
+        // Note: We don't let the observer handle on_destroy, since it would
+        //       hold on to destroyed entities. Instead, we add the entity
+        //       ourselves and remove it again if the entity is destroyed.
+        registry.on_destroy<Component>()
+            .template connect<&PersistedEntityTracker::onComponentDestroyed>(
+                this);
+    });
+
+    // When an entity is destroyed, drop it from the changed set (so its ID
+    // can be safely reused) and record it as destroyed.
+    registry.on_destroy<ClientSimData>()
+        .connect<&PersistedEntityTracker::onClientSimDataDestroyed>(this);
+    registry.on_destroy<entt::entity>()
+        .connect<&PersistedEntityTracker::onEntityDestroyed>(this);
+}
+
+PersistedEntityTracker::~PersistedEntityTracker()
+{
+    boost::mp11::mp_for_each<PersistedComponentTypes>([&](auto I) {
+        using Component = decltype(I);
+        registry.on_destroy<Component>()
+            .template disconnect<
+                &PersistedEntityTracker::onComponentDestroyed>(this);
+    });
+    registry.on_destroy<ClientSimData>()
+        .disconnect<&PersistedEntityTracker::onClientSimDataDestroyed>(this);
+    registry.on_destroy<entt::entity>()
+        .disconnect<&PersistedEntityTracker::onEntityDestroyed>(this);
+}
+
+void PersistedEntityTracker::markChanged(entt::entity entity)
+{
+    if (!(changedEntities.contains(entity))) {
+        changedEntities.push(entity);
+    }
+}
+
+const EnttObserver& PersistedEntityTracker::getChangedEntities() const
+{
+    return changedEntities;
+}
+
+const std::vector<entt::entity>&
+    PersistedEntityTracker::getDestroyedEntities() const
+{
+    return destroyedEntities;
+}
+
+void PersistedEntityTracker::clear()
+{
+    changedEntities.clear();
+    destroyedEntities.clear();
+}
+
+void PersistedEntityTracker::onComponentDestroyed(entt::entity entity)
+{
+    markChanged(entity);
+}
+
+void PersistedEntityTracker::onClientSimDataDestroyed(entt::entity entity)
+{
+    lastClientEntity = entity;
+}
+
+void PersistedEntityTracker::onEntityDestroyed(entt::entity entity)
+{
+    changedEntities.remove(entity);
+
+    // Skip client entities (they aren't persisted).
+    bool isClientEntity{entity == lastClientEntity};
+    lastClientEntity = entt::null;
+    if (!isClientEntity) {
+        destroyedEntities.push_back(entity);
+    }
+}
+
+} // namespace Server
+} // namespace AM
@@ -8,14 +8,22 @@
 #include "EnginePersistedComponentTypes.h"
 #include "ProjectPersistedComponentTypes.h"
 #include "PersistedComponentDefs.h"
+#include "PersistedComponentSnapshot.h"
+#include "Position.h"
 #include "ClientSimData.h"
 #include "SaveTimestamp.h"
+#include "Item.h"
+#include "BinaryBuffer.h"
 #include "Serialize.h"
 #include "ByteTools.h"
 #include "Log.h"
 #include "boost/mp11/algorithm.hpp"
 #include "entt/core/type_info.hpp"
+#include "tracy/Tracy.hpp"
+#include <algorithm>
+#include <memory>
 #include <limits>
+#include <tuple>
 #include <type_traits>
 
 namespace AM
@@ -23,6 +31,89 @@ namespace AM
 namespace Server
 {
 
+/**
+ * Every non-client entity's instance of a single component type.
+ */
+template<typename Component>
+struct ComponentColumn {
+    std::vector<entt::entity> entities{};
+    std::vector<Component> components{};
+
+    /** If false, this component type didn't change and the column is empty
+        (it shouldn't be written). */
+    bool isChanged{false};
+};
+
+/** A column for each persisted component type. */
+using PersistedComponentColumns = boost::mp11::mp_rename<
+    boost::mp11::mp_transform<ComponentColumn, PersistedComponentTypes>,
+    std::tuple>;
+
+/**
+ * Returns Component's index within PersistedComponentTypes.
+ */
+template<typename Component>
+constexpr std::size_t getColumnIndex()
+{
+    return boost::mp11::mp_find<PersistedComponentTypes, Component>::value;
+}
+
+/**
+ * Returns the number of columns in columns that are marked as changed.
+ */
+std::size_t countChangedColumns(const PersistedComponentColumns& columns)
+{
+    return std::apply(
+        [](const auto&... column) {
+            return (std::size_t{0} + ... + (column.isChanged ? 1 : 0));
+        },
+        columns);
+}
+
+/**
+ * The data captured by a single save.
+ *
+ * Captured on the sim thread, then serialized and written to the database
+ * on the database's backup thread. Nothing else touches it in between.
+ */
+struct SaveBatch {
+    struct EntitySnapshot {
+        entt::entity entity{entt::null};
+        PersistedComponentSnapshot components{};
+    };
+
+    struct ItemSnapshot {
+        Item item{};
+        ItemVersion version{0};
+        std::string initScript{};
+    };
+
+    /** The non-client entities that changed since the last save. */
+    std::vector<EntitySnapshot> savedEntities{};
+
+    /** The entities that were destroyed since the last save. */
+    std::vector<entt::entity> deletedEntities{};
+
+    /** (Columnar format) Every non-client entity's persisted components,
+        for each component type that changed since the last save.
+        Only set if a component type changed. */
+    std::unique_ptr<PersistedComponentColumns> columns{};
+
+    /** If true, delete the entity data that's stored in the format that
+        isn't configured. */
+    bool deleteOldEntityFormat{false};
+
+    /** The items that changed since the last save. */
+    std::vector<ItemSnapshot> savedItems{};
+
+    EntityStoredValueIDMap entityStoredValueIDMap{};
+    GlobalStoredValueMap globalStoredValueMap{};
+
+    /** Scratch buffers used while serializing data. */
+    BinaryBuffer workBuffer1{};
+    BinaryBuffer workBuffer2{};
+};
+
 /**
  * Appends Component to outputBuffer using the persisted component record
  * format.
@@ -70,13 +161,36 @@ void serializeComponent(typename Entry::Component& component,
 }
 
 /**
- * Serializes each component from ComponentList that entity possesses.
+ * Copies each persisted component that entity possesses into snapshot.
+ */
+void captureComponents(entt::registry& registry, entt::entity entity,
+                       PersistedComponentSnapshot& snapshot)
+{
+    boost::mp11::mp_for_each<PersistedComponentTypes>([&](auto I) {
+        using Component = decltype(I);
+        if (!registry.all_of<Component>(entity)) {
+            return;
+        }
+
+        if constexpr (std::is_empty_v<Component>) {
+            // Note: Can't registry.get() empty types.
+            std::get<std::optional<Component>>(snapshot).emplace();
+        }
+        else {
+            std::get<std::optional<Component>>(snapshot).emplace(
+                registry.get<Component>(entity));
+        }
+    });
+}
+
+/**
+ * Serializes each component from ComponentList that's present in snapshot.
  *
  * Note: ComponentList requires its entries to be ordered by ascending ID, so 
  *       the serialized records will also be ordered.
  */
 template<typename ComponentList>
-void serializeComponents(entt::registry& registry, entt::entity entity,
+void serializeComponents(PersistedComponentSnapshot& snapshot,
                          BinaryBuffer& outputBuffer)
 {
     outputBuffer.clear();
@@ -85,20 +199,195 @@ void serializeComponents(entt::registry& registry, entt::entity entity,
             using Entry = decltype(entry);
             using Component = typename Entry::Component;
 
-            if (!registry.all_of<Component>(entity)) {
-                return;
+            if (std::optional<Component>& component{
+                    std::get<std::optional<Component>>(snapshot)}) {
+                serializeComponent<Entry>(*component, outputBuffer);
             }
+        });
+}
 
-            if constexpr (std::is_empty_v<Component>) {
-                // Note: Can't registry.get() empty types.
-                Component component{};
-                serializeComponent<Entry>(component, outputBuffer);
-            }
-            else {
-                serializeComponent<Entry>(registry.get<Component>(entity),
-                                          outputBuffer);
+/**
+ * Serializes column into outputBuffer using the columnar format.
+ *
+ * See the columnar format comment in PersistedComponentDefs.h for format
+ * info.
+ */
+template<typename Entry>
+void serializeColumn(ComponentColumn<typename Entry::Component>& column,
+                     BinaryBuffer& outputBuffer)
+{
+    using Component = typename Entry::Component;
+    constexpr auto componentName{entt::type_name<Component>::value()};
+
+    outputBuffer.clear();
+    outputBuffer.resize(COLUMN_HEADER_SIZE);
+    Uint32 entityCount{0};
+    for (std::size_t i{0}; i < column.entities.size(); ++i) {
+        Component& component{column.components[i]};
+        std::size_t payloadSize{Serialize::measureSize(component)};
+        if (payloadSize > std::numeric_limits<Uint32>::max()) {
+            LOG_ERROR("Can't save component %.*s (ID: %u, version: %u): "
+                      "serialized size exceeds Uint32.",
+                      static_cast<int>(componentName.size()),
+                      componentName.data(), Entry::TYPE_ID, Entry::VERSION);
+            continue;
+        }
+
+        const std::size_t recordOffset{outputBuffer.size()};
+        const std::size_t payloadOffset{recordOffset
+                                        + COLUMN_RECORD_HEADER_SIZE};
+        outputBuffer.resize(payloadOffset + payloadSize);
+
+        Uint8* header{outputBuffer.data() + recordOffset};
+        ByteTools::write32(static_cast<Uint32>(column.entities[i]),
+                           header + COLUMN_RECORD_ENTITY_OFFSET);
+        ByteTools::write32(static_cast<Uint32>(payloadSize),
+                           header + COLUMN_RECORD_PAYLOAD_SIZE_OFFSET);
+
+        std::size_t bytesWritten{Serialize::toBuffer(outputBuffer.data(),
+                                                     outputBuffer.size(),
+                                                     component, payloadOffset)};
+        if (bytesWritten != payloadSize) {
+            outputBuffer.resize(recordOffset);
+            LOG_ERROR("Failed to save component %.*s (ID: %u, version: %u): "
+                      "measured size was %zu bytes, but serialization wrote "
+                      "%zu.",
+                      static_cast<int>(componentName.size()),
+                      componentName.data(), Entry::TYPE_ID, Entry::VERSION,
+                      payloadSize, bytesWritten);
+            continue;
+        }
+
+        entityCount++;
+    }
+
+    ByteTools::write32(entityCount, outputBuffer.data());
+}
+
+/**
+ * Serializes and writes the column of each changed component in
+ * ComponentList.
+ *
+ * @param columnCount Incremented for each column that was written.
+ * @return The number of component records that were written.
+ */
+template<typename ComponentList>
+std::size_t writeColumns(PersistedComponentSet componentSet,
+                         PersistedComponentColumns& columns,
+                         Database& database, BinaryBuffer& workBuffer,
+                         std::size_t& columnCount)
+{
+    std::size_t recordCount{0};
+    boost::mp11::mp_for_each<typename ComponentList::EntryTypes>(
+        [&](auto entry) {
+            using Entry = decltype(entry);
+            using Component = typename Entry::Component;
+
+            ComponentColumn<Component>& column{
+                std::get<ComponentColumn<Component>>(columns)};
+            if (!(column.isChanged)) {
+                return;
             }
+
+            serializeColumn<Entry>(column, workBuffer);
+            database.saveComponentColumn(componentSet, Entry::TYPE_ID,
+                                         Entry::VERSION, workBuffer);
+            recordCount += column.entities.size();
+            columnCount++;
         });
+
+    return recordCount;
+}
+
+/**
+ * Serializes the given batch's data and writes it to the given database.
+ *
+ * Note: This runs on the database's backup thread, inside a transaction.
+ */
+void writeSaveBatch(SaveBatch& saveBatch, Database& database)
+{
+    ZoneScoped;
+    Timer timer{};
+    BinaryBuffer& workBuffer1{saveBatch.workBuffer1};
+    BinaryBuffer& workBuffer2{saveBatch.workBuffer2};
+
+    // If we're migrating from the other entity format, delete its data.
+    // Note: This is in the same transaction as the re-saved data, so the
+    //       old data can't be lost without the new data being written.
+    if (saveBatch.deleteOldEntityFormat) {
+        if constexpr (Config::ENTITY_PERSISTENCE_FORMAT
+                      == EntityPersistenceFormat::Columnar) {
+            database.deleteAllEntityData();
+        }
+        else {
+            database.deleteAllComponentColumns();
+        }
+    }
+
+    // Delete any destroyed entities (does nothing if they aren't present).
+    for (entt::entity entity : saveBatch.deletedEntities) {
+        database.deleteEntityData(entity);
+    }
+
+    // Save any changed entities.
+    for (SaveBatch::EntitySnapshot& entitySnapshot : saveBatch.savedEntities) {
+        serializeComponents<EnginePersistedComponentTypes>(
+            entitySnapshot.components, workBuffer1);
+        serializeComponents<ProjectPersistedComponentTypes>(
+            entitySnapshot.components, workBuffer2);
+
+        database.saveEntityData(entitySnapshot.entity, workBuffer1,
+                                workBuffer2);
+    }
+
+    // If we're using the columnar format, rewrite any changed columns.
+    std::size_t columnRecordCount{0};
+    std::size_t columnCount{0};
+    if (saveBatch.columns) {
+        columnRecordCount
+            = writeColumns<EnginePersistedComponentTypes>(
+                  PersistedComponentSet::Engine, *saveBatch.columns, database,
+                  workBuffer1, columnCount)
+              + writeColumns<ProjectPersistedComponentTypes>(
+                  PersistedComponentSet::Project, *saveBatch.columns,
+                  database, workBuffer1, columnCount);
+    }
+
+    // Save any changed items.
+    for (SaveBatch::ItemSnapshot& itemSnapshot : saveBatch.savedItems) {
+        workBuffer1.clear();
+        workBuffer1.resize(Serialize::measureSize(itemSnapshot.item));
+        Serialize::toBuffer(workBuffer1.data(), workBuffer1.size(),
+                            itemSnapshot.item);
+
+        database.saveItemData(itemSnapshot.item.numericID, workBuffer1,
+                              itemSnapshot.version, itemSnapshot.initScript);
+    }
+
+    // Save the stored value maps.
+    workBuffer1.clear();
+    workBuffer1.resize(
+        Serialize::measureSize(saveBatch.entityStoredValueIDMap));
+    Serialize::toBuffer(workBuffer1.data(), workBuffer1.size(),
+                        saveBatch.entityStoredValueIDMap);
+    database.saveEntityStoredValueIDMap(workBuffer1);
+
+    workBuffer1.clear();
+    workBuffer1.resize(Serialize::measureSize(saveBatch.globalStoredValueMap));
+    Serialize::toBuffer(workBuffer1.data(), workBuffer1.size(),
+                        saveBatch.globalStoredValueMap);
+    database.saveGlobalStoredValueMap(workBuffer1);
+
+    // Note: Stored values are always saved, as 2 rows.
+    std::size_t rowCount{saveBatch.deletedEntities.size()
+                         + saveBatch.savedEntities.size() + columnCount
+                         + saveBatch.savedItems.size() + 2};
+    LOG_INFO("Wrote %zu entities, %zu entity deletions, %zu component "
+             "records in %zu columns, and %zu items (%zu rows) in %.6fs "
+             "(background).",
+             saveBatch.savedEntities.size(), saveBatch.deletedEntities.size(),
+             columnRecordCount, columnCount, saveBatch.savedItems.size(),
+             rowCount, timer.getTime());
 }
 
 SaveSystem::SaveSystem(const SimulationContext& inSimContext)
@@ -106,116 +395,258 @@ SaveSystem::SaveSystem(const SimulationContext& inSimContext)
 , world{inSimContext.simulation.getWorld()}
 , itemData{inSimContext.itemData}
 , updatedItems{}
+, persistedEntityTracker{world.registry}
+, changedColumns(boost::mp11::mp_size<PersistedComponentTypes>::value, false)
+, deleteOldEntityFormat{false}
 , saveTimer{}
-, workBuffer1{}
-, workBuffer2{}
+, captureTimer{}
 {
     // When an item is created or updated, add it to updatedItems.
     itemData.itemCreated.connect<&SaveSystem::itemUpdated>(this);
     itemData.itemUpdated.connect<&SaveSystem::itemUpdated>(this);
+
+    // If we're using the columnar format, also track which component types
+    // changed, so we only rewrite their columns.
+    if constexpr (Config::ENTITY_PERSISTENCE_FORMAT
+                  == EntityPersistenceFormat::Columnar) {
+        entt::registry& registry{world.registry};
+        boost::mp11::mp_for_each<PersistedComponentTypes>([&](auto I) {
+            using Component = decltype(I);
+            registry.on_construct<Component>()
+                .template connect<&SaveSystem::onColumnChanged<Component>>(
+                    this);
+            registry.on_update<Component>()
+                .template connect<&SaveSystem::onColumnChanged<Component>>(
+                    this);
+            registry.on_destroy<Component>()
+                .template connect<&SaveSystem::onColumnChanged<Component>>(
+                    this);
+        });
+    }
+}
+
+SaveSystem::~SaveSystem()
+{
+    if constexpr (Config::ENTITY_PERSISTENCE_FORMAT
+                  == EntityPersistenceFormat::Columnar) {
+        entt::registry& registry{world.registry};
+        boost::mp11::mp_for_each<PersistedComponentTypes>([&](auto I) {
+            using Component = decltype(I);
+            registry.on_construct<Component>()
+                .template disconnect<&SaveSystem::onColumnChanged<Component>>(
+                    this);
+            registry.on_update<Component>()
+                .template disconnect<&SaveSystem::onColumnChanged<Component>>(
+                    this);
+            registry.on_destroy<Component>()
+                .template disconnect<&SaveSystem::onColumnChanged<Component>>(
+                    this);
+        });
+    }
 }
 
 void SaveSystem::saveIfNecessary()
 {
-    // If enough time has passed and a backup isn't still underway, save
-    // everything to the database.
+    // If enough time has passed and the last save has been fully backed up,
+    // save everything.
     if ((saveTimer.getTime() >= Config::SAVE_PERIOD_S)
         && !(world.database->backupIsInProgress())) {
-        LOG_INFO("Saving entities, items, and map...");
+        ZoneScopedN("SaveCapture");
+        captureTimer.reset();
 
-        // Save all of our data to the in-memory database.
-        world.database->startTransaction();
+        // Capture copies of everything that changed.
+        auto saveBatch{std::make_shared<SaveBatch>()};
+        captureNonClientEntities(*saveBatch);
+        captureItems(*saveBatch);
+        captureStoredValues(*saveBatch);
 
-        saveNonClientEntities();
-        saveItems();
-        saveStoredValues();
-        // TODO: Track changed tiles and save to the database.
-        world.tileMap.save("TileMap.bin");
+        // Note: This only snapshots the changed chunks. They're written to
+        //       the map's chunk store on a separate thread.
+        world.tileMap.save();
 
-        world.database->commitTransaction();
+        // Serialize the captured data and write it to the database, then
+        // backup the database to file, all on the database's thread.
+        world.database->writeAndBackup([saveBatch](Database& database) {
+            writeSaveBatch(*saveBatch, database);
+        });
 
-        // Backup the in-memory database to the file database.
-        world.database->backupToFile();
+        double captureTime{captureTimer.getTime()};
+        TracyPlot("SaveCaptureMs", (captureTime * 1000));
+        LOG_INFO("Captured %zu entities, %zu entity deletions, %zu "
+                 "columns, and %zu items in %.6fs. Writing in background.",
+                 saveBatch->savedEntities.size(),
+                 saveBatch->deletedEntities.size(),
+                 (saveBatch->columns ? countChangedColumns(*saveBatch->columns)
+                                     : 0),
+                 saveBatch->savedItems.size(), captureTime);
+        if (captureTime > Config::SAVE_CAPTURE_BUDGET_S) {
+            LOG_INFO("Save capture took longer than its budget (%.6fs > "
+                     "%.6fs).",
+                     captureTime,
+                     static_cast<double>(Config::SAVE_CAPTURE_BUDGET_S));
+        }
 
         saveTimer.reset();
     }
 }
 
+void SaveSystem::clearChangedEntities()
+{
+    persistedEntityTracker.clear();
+    std::fill(changedColumns.begin(), changedColumns.end(), false);
+}
+
+void SaveSystem::migrateEntityPersistenceFormat()
+{
+    // Mark every non-client entity as changed, so the next save writes all
+    // of them in the configured format.
+    // Note: Every entity has a Position.
+    if constexpr (Config::ENTITY_PERSISTENCE_FORMAT
+                  == EntityPersistenceFormat::Columnar) {
+        std::fill(changedColumns.begin(), changedColumns.end(), true);
+    }
+    else {
+        for (entt::entity entity : world.registry.view<Position>(
+                 entt::exclude_t<ClientSimData>{})) {
+            persistedEntityTracker.markChanged(entity);
+        }
+    }
+
+    deleteOldEntityFormat = true;
+}
+
 void SaveSystem::itemUpdated(ItemID itemID)
 {
     updatedItems.emplace_back(itemID);
 }
 
-void SaveSystem::saveNonClientEntities()
+void SaveSystem::captureNonClientEntities(SaveBatch& saveBatch)
 {
-    // Note: If doing a full save ever starts taking too long, we can add
-    //       an observer that tracks changes to non-client entities and only
-    //       save those.
+    constexpr bool useColumns{Config::ENTITY_PERSISTENCE_FORMAT
+                              == EntityPersistenceFormat::Columnar};
 
-    // Queue all of our entity save queries.
+    // If we're migrating from the other format, have this batch delete its
+    // data.
+    saveBatch.deleteOldEntityFormat = deleteOldEntityFormat;
+    deleteOldEntityFormat = false;
+
+    // Delete each entity that was destroyed since the last save.
+    // Note: In the columnar format, destroying the entity's components
+    //       marked their columns as changed.
+    if constexpr (!useColumns) {
+        saveBatch.deletedEntities
+            = persistedEntityTracker.getDestroyedEntities();
+    }
+
+    // Update each entity that changed since the last save.
+    // Note: In the columnar format, entity data is captured by column below.
     Uint32 currentTick{simulation.getCurrentTick()};
-    auto view{
-        world.registry.view<entt::entity>(entt::exclude_t<ClientSimData>{})};
-    for (entt::entity entity : view) {
+    for (entt::entity entity : persistedEntityTracker.getChangedEntities()) {
+        // Skip client entities (they aren't persisted).
+        if (world.registry.all_of<ClientSimData>(entity)) {
+            continue;
+        }
+
         // Update the entity's SaveTimestamp.
         SaveTimestamp& saveTimestamp{
             world.registry.get_or_emplace<SaveTimestamp>(entity)};
         saveTimestamp.lastSavedTick = currentTick;
 
-        // Save the entity's data.
-        serializeComponents<EnginePersistedComponentTypes>(
-            world.registry, entity, workBuffer1);
-        serializeComponents<ProjectPersistedComponentTypes>(
-            world.registry, entity, workBuffer2);
+        // Copy the entity's data.
+        if constexpr (useColumns) {
+            // Note: Updating SaveTimestamp in-place doesn't signal.
+            changedColumns[getColumnIndex<SaveTimestamp>()] = true;
+        }
+        else {
+            SaveBatch::EntitySnapshot& entitySnapshot{
+                saveBatch.savedEntities.emplace_back(entity)};
+            captureComponents(world.registry, entity,
+                              entitySnapshot.components);
+        }
+    }
+
+    persistedEntityTracker.clear();
 
-        world.database->saveEntityData(entity, workBuffer1, workBuffer2);
+    // If we're using the columnar format, capture any changed columns.
+    if constexpr (useColumns) {
+        captureComponentColumns(saveBatch);
     }
 }
 
-void SaveSystem::saveItems()
+void SaveSystem::captureComponentColumns(SaveBatch& saveBatch)
+{
+    // If no component types changed, there's nothing to capture.
+    if (std::find(changedColumns.begin(), changedColumns.end(), true)
+        == changedColumns.end()) {
+        return;
+    }
+
+    // Copy each changed component storage into its column.
+    entt::registry& registry{world.registry};
+    saveBatch.columns = std::make_unique<PersistedComponentColumns>();
+    boost::mp11::mp_for_each<PersistedComponentTypes>([&](auto I) {
+        using Component = decltype(I);
+        if (!(changedColumns[getColumnIndex<Component>()])) {
+            return;
+        }
+
+        ComponentColumn<Component>& column{
+            std::get<ComponentColumn<Component>>(*saveBatch.columns)};
+        column.isChanged = true;
+
+        auto view{registry.view<Component>(entt::exclude_t<ClientSimData>{})};
+        column.entities.reserve(view.size_hint());
+        column.components.reserve(view.size_hint());
+        for (entt::entity entity : view) {
+            column.entities.emplace_back(entity);
+            if constexpr (std::is_empty_v<Component>) {
+                // Note: Can't registry.get() empty types.
+                column.components.emplace_back();
+            }
+            else {
+                column.components.emplace_back(
+                    registry.get<Component>(entity));
+            }
+        }
+    });
+
+    std::fill(changedColumns.begin(), changedColumns.end(), false);
+}
+
+template<typename Component>
+void SaveSystem::onColumnChanged(entt::registry& registry,
+                                 entt::entity entity)
+{
+    // Skip client entities (they aren't persisted).
+    if (registry.all_of<ClientSimData>(entity)) {
+        return;
+    }
+
+    changedColumns[getColumnIndex<Component>()] = true;
+}
+
+void SaveSystem::captureItems(SaveBatch& saveBatch)
 {
     // Remove duplicates from the vector.
     std::sort(updatedItems.begin(), updatedItems.end());
     updatedItems.erase(std::unique(updatedItems.begin(), updatedItems.end()),
                        updatedItems.end());
 
-    // Queue all of our item save queries.
+    // Copy each updated item.
     for (ItemID itemID : updatedItems) {
         const Item* updatedItem{itemData.getItem(itemID)};
-
-        workBuffer1.clear();
-        workBuffer1.resize(Serialize::measureSize(*updatedItem));
-        Serialize::toBuffer(workBuffer1.data(), workBuffer1.size(),
-                            *updatedItem);
-
-        world.database->saveItemData(
-            updatedItem->numericID, workBuffer1,
-            itemData.getItemVersion(updatedItem->numericID),
-            itemData.getItemInitScript(updatedItem->numericID).script);
+        saveBatch.savedItems.emplace_back(
+            *updatedItem, itemData.getItemVersion(itemID),
+            itemData.getItemInitScript(itemID).script);
     }
 
     updatedItems.clear();
 }
 
-void SaveSystem::saveStoredValues()
+void SaveSystem::captureStoredValues(SaveBatch& saveBatch)
 {
-    // Serialize the entity stored value ID map.
-    workBuffer1.clear();
-    workBuffer1.resize(Serialize::measureSize(world.entityStoredValueIDMap));
-    Serialize::toBuffer(workBuffer1.data(), workBuffer1.size(),
-                        world.entityStoredValueIDMap);
-
-    // Queue the save query.
-    world.database->saveEntityStoredValueIDMap(workBuffer1);
-
-    // Serialize the global stored value map.
-    workBuffer1.clear();
-    workBuffer1.resize(Serialize::measureSize(world.globalStoredValueMap));
-    Serialize::toBuffer(workBuffer1.data(), workBuffer1.size(),
-                        world.globalStoredValueMap);
-
-    // Queue the save query.
-    world.database->saveGlobalStoredValueMap(workBuffer1);
+    saveBatch.entityStoredValueIDMap = world.entityStoredValueIDMap;
+    saveBatch.globalStoredValueMap = world.globalStoredValueMap;
 }
 
 } // namespace Server
@@ -30,8 +30,10 @@ Simulation::Simulation(const SimulationContext& inSimContext)
 , itemInitLua{std::make_unique<ItemInitLua>()}
 , dialogueLua{std::make_unique<DialogueLua>()}
 , dialogueChoiceConditionLua{std::make_unique<DialogueChoiceConditionLua>()}
+, frameArena{FRAME_ARENA_SIZE}
 , world{inSimContext}
 , currentTick{0}
+, timingWheel{currentTick}
 , engineLuaBindings{*entityInitLua,
                     *entityItemHandlerLua,
                     *itemInitLua,
@@ -45,9 +47,11 @@ Simulation::Simulation(const SimulationContext& inSimContext)
 , clientConnectionSystem{inSimContext}
 , nceLifetimeSystem{inSimContext}
 , componentChangeSystem{inSimContext}
+, chunkResidencySystem{inSimContext}
 , tileUpdateSystem{inSimContext}
 , inputSystem{inSimContext}
 , movementSystem{inSimContext}
+, pathfindingSystem{inSimContext}
 , aiSystem{inSimContext}
 , castSystem{inSimContext}
 , itemSystem{inSimContext}
@@ -66,6 +70,16 @@ Simulation::Simulation(const SimulationContext& inSimContext)
 
     // Load the saved world state.
     world.load();
+
+    // The loaded entities match what's in the database, so they don't need
+    // to be saved.
+    saveSystem.clearChangedEntities();
+
+    // If the entities were saved in the format that isn't configured, re-save
+    // them in the configured format.
+    if (world.loadHelper.getEntityFormatNeedsMigration()) {
+        saveSystem.migrateEntityPersistenceFormat();
+    }
 }
 
 Simulation::~Simulation() = default;
@@ -100,11 +114,26 @@ DialogueChoiceConditionLua& Simulation::getDialogueChoiceConditionLua()
     return *dialogueChoiceConditionLua;
 }
 
+PathfindingSystem& Simulation::getPathfindingSystem()
+{
+    return pathfindingSystem;
+}
+
+TimingWheel& Simulation::getTimingWheel()
+{
+    return timingWheel;
+}
+
 Uint32 Simulation::getCurrentTick() const
 {
     return currentTick;
 }
 
+FrameArena& Simulation::getFrameArena()
+{
+    return frameArena;
+}
+
 void Simulation::tick()
 {
     ZoneScoped;
@@ -122,12 +151,23 @@ void Simulation::tick()
     // Process requests to change components.
     componentChangeSystem.processChangeRequests();
 
+    // Load any unloaded map chunks that are near an entity.
+    chunkResidencySystem.updateResidency();
+
     // Receive and process tile update requests.
     tileUpdateSystem.updateTiles();
 
     // Call the project's pre-movement logic.
     extension->afterMapAndConnectionUpdates();
 
+    // Throw out any pathfinding data that this tick's tile updates made
+    // stale. Must happen before sendTileUpdates() clears the history.
+    pathfindingSystem.invalidateChangedTiles();
+
+    // Wake any sleeping entities that are near a changed tile, so they'll
+    // react to it.
+    tileUpdateSystem.wakeEntitiesNearUpdates();
+
     // Send updated tile state to nearby clients.
     tileUpdateSystem.sendTileUpdates();
 
@@ -137,12 +177,19 @@ void Simulation::tick()
     // Move all of our entities.
     movementSystem.processMovements();
 
+    // Deliver finished path requests and start new ones.
+    pathfindingSystem.processPathRequests();
+
     // Run all of our AI.
     aiSystem.processAITick();
 
     // Process any cast requests and ongoing casts.
     castSystem.processCasts();
 
+    // Fire any timers that are due this tick (cast completions, the
+    // project's delayed events, etc).
+    timingWheel.advance(currentTick);
+
     // Process any waiting "use item" interaction messages.
     itemSystem.processUseItemInteractions();
 
@@ -190,6 +237,13 @@ void Simulation::tick()
     // Call the project's post-everything logic.
     extension->afterAll();
 
+    // Free this tick's temporary allocations.
+    TracyPlot("FrameArenaAllocations",
+              static_cast<int64_t>(frameArena.getAllocationCount()));
+    TracyPlot("FrameArenaBytes",
+              static_cast<int64_t>(frameArena.getAllocatedBytes()));
+    frameArena.reset();
+
     currentTick++;
 
     FrameMark;
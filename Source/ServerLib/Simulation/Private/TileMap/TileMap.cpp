@@ -4,7 +4,6 @@
 #include "Sprite.h"
 #include "Paths.h"
 #include "Position.h"
-#include "Serialize.h"
 #include "Deserialize.h"
 #include "ByteTools.h"
 #include "TileMapSnapshot.h"
@@ -13,8 +12,10 @@
 #include "Morton.h"
 #include "SharedConfig.h"
 #include "Timer.h"
+#include "tracy/Tracy.hpp"
 #include "Log.h"
 #include "AMAssert.h"
+#include <algorithm>
 
 namespace AM
 {
@@ -22,75 +23,265 @@ namespace Server
 {
 TileMap::TileMap(const GraphicData& inGraphicData,
                  CollisionLocator& inCollisionLocator)
+: TileMap(inGraphicData, inCollisionLocator, Paths::BASE_PATH + "TileMap")
+{
+}
+
+TileMap::TileMap(const GraphicData& inGraphicData,
+                 CollisionLocator& inCollisionLocator,
+                 const std::string& chunkStorePath)
 : TileMapBase{inGraphicData, inCollisionLocator, true}
+, chunkStore{chunkStorePath}
+, unloadedChunks{}
+, faultInSnapshot{}
+, chunkFaultInCount{0}
+, currentTick{0}
+, chunkLastUsedTicks{}
+, evictionCandidates{}
+, chunkEvictionCount{0}
+, residentChunkMemory{0}
+, tileMapWriter{chunkStore}
 {
     // Prime a timer.
     Timer timer;
 
-    // Deserialize the file into a snapshot.
-    TileMapSnapshot mapSnapshot;
-    std::string mapPath{Paths::BASE_PATH + "TileMap.bin"};
-    bool loadSuccessful{Deserialize::fromFile(mapPath, mapSnapshot)};
-    if (!loadSuccessful) {
-        LOG_FATAL("Failed to deserialize map at path: %s", mapPath.c_str());
+    // If we don't have a chunk store yet, build one from the old format.
+    if (!chunkStore.exists()) {
+        convertLegacyMap(chunkStorePath + ".bin");
     }
 
-    // Load the map snapshot.
-    load(mapSnapshot);
+    // Open the chunk store and load the map's header data.
+    // Note: The chunks themselves are loaded as they're needed.
+    if (!chunkStore.open()) {
+        LOG_FATAL("Failed to open the map's chunk store.");
+    }
+    load();
 
     // Print the time taken.
     double timeTaken{timer.getTime()};
-    LOG_INFO("Map loaded in %.6fs. Size: (%u, %u, %u)ch.", timeTaken,
-             chunkExtent.xLength, chunkExtent.yLength, chunkExtent.zLength);
+    LOG_INFO("Map opened in %.6fs. Size: (%u, %u, %u)ch. Stored chunks: %zu. "
+             "Collision grid memory: %zu bytes.",
+             timeTaken, chunkExtent.xLength, chunkExtent.yLength,
+             chunkExtent.zLength, unloadedChunks.size(),
+             collisionLocator.getGridMemoryUsage());
 }
 
 TileMap::~TileMap()
 {
-    // Save the map state to TileMap.bin.
-    save("TileMap.bin");
+    // Save any unsaved changes.
+    // Note: tileMapWriter's destructor will wait for the write to finish.
+    save();
 }
 
-void TileMap::save(const std::string& fileName)
+void TileMap::save()
 {
+    ZoneScoped;
+
+    // If nothing changed, there's nothing to save.
+    // Note: If the last write failed, we still send a request so that its
+    //       chunks get retried.
+    const std::unordered_set<ChunkPosition>& dirtyChunks{getDirtyChunks()};
+    if (dirtyChunks.empty() && !(tileMapWriter.lastWriteFailed())) {
+        return;
+    }
+
     LOG_INFO("Saving map...");
 
     // Prime a timer.
     Timer timer{};
 
-    /* Save this map's state into a snapshot. */
-    // Save the header data.
-    TileMapSnapshot mapSnapshot{};
-    mapSnapshot.version = MAP_FORMAT_VERSION;
-    mapSnapshot.xLengthChunks = static_cast<Uint16>(chunkExtent.xLength);
-    mapSnapshot.yLengthChunks = static_cast<Uint16>(chunkExtent.yLength);
-    mapSnapshot.zLengthChunks = static_cast<Uint16>(chunkExtent.zLength);
+    // Snapshot each chunk that changed.
+    TileMapWriter::WriteRequest writeRequest{};
+    writeRequest.version = MAP_FORMAT_VERSION;
+    writeRequest.xLengthChunks = static_cast<Uint16>(chunkExtent.xLength);
+    writeRequest.yLengthChunks = static_cast<Uint16>(chunkExtent.yLength);
+    writeRequest.zLengthChunks = static_cast<Uint16>(chunkExtent.zLength);
+    writeRequest.chunks.reserve(dirtyChunks.size());
+    for (const ChunkPosition& chunkPosition : dirtyChunks) {
+        // If the chunk was emptied and erased, mark it as removed.
+        auto chunkIt{chunks.find(chunkPosition)};
+        if (chunkIt == chunks.end()) {
+            writeRequest.chunks.emplace(chunkPosition, std::nullopt);
+            continue;
+        }
+
+        ChunkSnapshot& chunkSnapshot{
+            writeRequest.chunks[chunkPosition].emplace()};
+        saveChunkToSnapshot(chunkIt->second, chunkSnapshot);
+    }
+    std::size_t dirtyChunkCount{dirtyChunks.size()};
+    clearDirtyChunks();
+
+    // Hand the request to the writer thread.
+    tileMapWriter.write(std::move(writeRequest));
 
-    // Save our tiles into the snapshot as chunks.
-    for (auto& [chunkPosition, chunk] : chunks) {
-        ChunkSnapshot& chunkSnapshot{mapSnapshot.chunks[chunkPosition]};
-        saveChunkToSnapshot(chunk, chunkSnapshot);
+    // Print the time taken.
+    double timeTaken{timer.getTime()};
+    LOG_INFO("Snapshotted %zu changed chunks in %.6fs. Writing in background.",
+             dirtyChunkCount, timeTaken);
+}
+
+bool TileMap::saveIsInProgress()
+{
+    return tileMapWriter.writeIsInProgress();
+}
+
+void TileMap::loadChunkIfNecessary(const ChunkPosition& chunkPosition)
+{
+    if (unloadedChunks.contains(chunkPosition)) {
+        faultInChunk(chunkPosition);
     }
 
-    // Serialize the map snapshot and write it to the file.
-    bool saveSuccessful{
-        Serialize::toFile((Paths::BASE_PATH + fileName), mapSnapshot)};
-    if (saveSuccessful) {
-        // Print the time taken.
-        double timeTaken{timer.getTime()};
-        LOG_INFO("Saved %u chunks in %.6fs.", chunkExtent.size(), timeTaken);
+    // If the chunk exists, mark it as used.
+    // Note: Empty chunks aren't stored, so there's nothing to track.
+    if (chunks.contains(chunkPosition)) {
+        chunkLastUsedTicks[chunkPosition] = currentTick;
     }
-    else {
-        LOG_FATAL("Failed to serialize and save the map.");
+}
+
+void TileMap::loadExtentIfNecessary(const ChunkExtent& extent)
+{
+    ChunkExtent clippedExtent{extent.intersectWith(chunkExtent)};
+    for (int z{clippedExtent.z}; z <= clippedExtent.zMax(); ++z) {
+        for (int y{clippedExtent.y}; y <= clippedExtent.yMax(); ++y) {
+            for (int x{clippedExtent.x}; x <= clippedExtent.xMax(); ++x) {
+                loadChunkIfNecessary({x, y, z});
+            }
+        }
     }
 }
 
-void TileMap::load(TileMapSnapshot& mapSnapshot)
+void TileMap::setCurrentTick(Uint32 inCurrentTick)
 {
-    /* Load the snapshot into this map. */
+    currentTick = inCurrentTick;
+}
+
+std::size_t TileMap::evictChunks(Uint32 maxIdleTicks,
+                                 std::size_t memoryBudget)
+{
+    ZoneScoped;
+
+    // If a save is underway, the store may not have our latest chunk data
+    // yet. Wait until it's done.
+    if (saveIsInProgress()) {
+        return 0;
+    }
+
+    // If the last save failed, the store is missing some of our changes.
+    // Retry it, and wait until it succeeds.
+    if (tileMapWriter.lastWriteFailed()) {
+        save();
+        return 0;
+    }
+
+    // Gather the chunks that weren't used on this tick, and total up the
+    // memory used by every loaded chunk.
+    evictionCandidates.clear();
+    residentChunkMemory = 0;
+    for (const auto& [chunkPosition, chunk] : chunks) {
+        residentChunkMemory += chunk.getMemoryUsage();
+
+        // Note: If we don't have a use tick for this chunk, it was created
+        //       since the last call, so we treat it as used now.
+        Uint32 lastUsedTick{
+            chunkLastUsedTicks.try_emplace(chunkPosition, currentTick)
+                .first->second};
+        if (lastUsedTick != currentTick) {
+            evictionCandidates.emplace_back(lastUsedTick, chunkPosition);
+        }
+    }
+
+    // Evict the least recently used chunks that are either idle or pushing
+    // us over budget.
+    std::sort(evictionCandidates.begin(), evictionCandidates.end());
+    const std::unordered_set<ChunkPosition>& dirtyChunks{getDirtyChunks()};
+    bool writeBackNeeded{false};
+    std::size_t evictedCount{0};
+    for (const auto& [lastUsedTick, chunkPosition] : evictionCandidates) {
+        bool isIdle{(currentTick - lastUsedTick) >= maxIdleTicks};
+        bool isOverBudget{residentChunkMemory > memoryBudget};
+        if (!isIdle && !isOverBudget) {
+            // The rest of the candidates were used more recently.
+            break;
+        }
+
+        // If the chunk has unsaved changes, it needs to be written back
+        // before we can evict it.
+        if (dirtyChunks.contains(chunkPosition)) {
+            writeBackNeeded = true;
+            continue;
+        }
+
+        residentChunkMemory -= chunks.at(chunkPosition).getMemoryUsage();
+        evictChunk(chunkPosition);
+        evictedCount++;
+    }
+
+    // Drop the use ticks of any chunks that were erased after being emptied.
+    std::erase_if(chunkLastUsedTicks, [this](const auto& pair) {
+        return !(chunks.contains(pair.first));
+    });
+
+    // Write back any dirty chunks, so they can be evicted next time.
+    if (writeBackNeeded) {
+        save();
+    }
+
+    if (evictedCount > 0) {
+        LOG_INFO("Evicted %zu idle map chunks. Resident: %zu chunks, %zu "
+                 "bytes.",
+                 evictedCount, chunks.size(), residentChunkMemory);
+    }
+
+    return evictedCount;
+}
+
+std::size_t TileMap::getUnloadedChunkCount() const
+{
+    return unloadedChunks.size();
+}
+
+std::size_t TileMap::getChunkFaultInCount() const
+{
+    return chunkFaultInCount;
+}
+
+std::size_t TileMap::getChunkEvictionCount() const
+{
+    return chunkEvictionCount;
+}
+
+std::size_t TileMap::getResidentChunkCount() const
+{
+    return chunks.size();
+}
+
+std::size_t TileMap::getResidentChunkMemory() const
+{
+    return residentChunkMemory;
+}
+
+void TileMap::convertLegacyMap(const std::string& mapPath)
+{
+    LOG_INFO("Chunk store not found. Converting %s...", mapPath.c_str());
+
+    TileMapSnapshot mapSnapshot;
+    if (!Deserialize::fromFile(mapPath, mapSnapshot)) {
+        LOG_FATAL("Failed to deserialize map at path: %s", mapPath.c_str());
+    }
+
+    if (!chunkStore.importSnapshot(mapSnapshot)) {
+        LOG_FATAL("Failed to convert map to a chunk store.");
+    }
+}
+
+void TileMap::load()
+{
+    /* Load the store into this map. */
     // Load the header data.
-    chunkExtent = ChunkExtent::fromMapLengths(mapSnapshot.xLengthChunks,
-                                              mapSnapshot.yLengthChunks,
-                                              mapSnapshot.zLengthChunks);
+    chunkExtent = ChunkExtent::fromMapLengths(chunkStore.getXLengthChunks(),
+                                              chunkStore.getYLengthChunks(),
+                                              chunkStore.getZLengthChunks());
     tileExtent = TileExtent{chunkExtent};
 
     // If the map is too big, exit.
@@ -108,13 +299,44 @@ void TileMap::load(TileMapSnapshot& mapSnapshot)
     //       will be used below.
     collisionLocator.setGridSize(tileExtent);
 
-    // Load all of the snapshot's chunks into our map.
-    for (auto& [chunkPosition, chunkSnapshot] : mapSnapshot.chunks) {
-        loadChunk(chunkSnapshot,
-                  {chunkPosition.x, chunkPosition.y, chunkPosition.z});
+    // Track the store's chunks so we can load them when they're needed.
+    // Note: We can't iterate the store's index after this, since the writer
+    //       thread may modify it.
+    unloadedChunks.reserve(chunkStore.getRecordLocations().size());
+    for (const auto& [chunkPosition, recordLocation] :
+         chunkStore.getRecordLocations()) {
+        unloadedChunks.insert(chunkPosition);
     }
 }
 
+void TileMap::faultInChunk(const ChunkPosition& chunkPosition)
+{
+    ZoneScoped;
+
+    faultInSnapshot = {};
+    if (!chunkStore.readChunk(chunkPosition, faultInSnapshot)) {
+        LOG_FATAL("Failed to read chunk (%d, %d, %d).", chunkPosition.x,
+                  chunkPosition.y, chunkPosition.z);
+    }
+
+    loadChunk(faultInSnapshot, chunkPosition);
+    unloadedChunks.erase(chunkPosition);
+    chunkFaultInCount++;
+}
+
+void TileMap::evictChunk(const ChunkPosition& chunkPosition)
+{
+    // Drop the chunk's collision, then the chunk itself.
+    collisionLocator.removeChunk(chunkPosition);
+    chunks.erase(chunkPosition);
+    chunkLastUsedTicks.erase(chunkPosition);
+
+    // The chunk's latest state is in the store, load it from there if it's
+    // needed again.
+    unloadedChunks.insert(chunkPosition);
+    chunkEvictionCount++;
+}
+
 void TileMap::saveChunkToSnapshot(const Chunk& chunk,
                                   ChunkSnapshot& chunkSnapshot)
 {
@@ -131,7 +353,7 @@ void TileMap::saveChunkToSnapshot(const Chunk& chunk,
         // Add all of this tile's layers.
         for (const TileLayer& layer : tile.getAllLayers()) {
             std::size_t paletteIndex{chunkSnapshot.getPaletteIndex(
-                layer.type, layer.graphicSet.get().stringID,
+                layer.type, layer.getGraphicSet(graphicData).stringID,
                 layer.graphicValue)};
             chunkSnapshot.tileLayers[tileLayersIndex]
                 = static_cast<Uint8>(paletteIndex);
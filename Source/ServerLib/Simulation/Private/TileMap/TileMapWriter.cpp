@@ -0,0 +1,157 @@
+#include "TileMapWriter.h"
+#include "Timer.h"
+#include "Log.h"
+#include "tracy/Tracy.hpp"
+
+namespace AM
+{
+namespace Server
+{
+
+TileMapWriter::TileMapWriter(ChunkStore& inChunkStore)
+: chunkStore{inChunkStore}
+, writeThreadObj{}
+, exitRequested{false}
+, writeMutex{}
+, writeCondVar{}
+, pendingRequest{}
+, writeIsActive{false}
+, failedRequest{}
+, writeFailed{false}
+{
+    // Start the writer thread.
+    writeThreadObj = std::thread(&TileMapWriter::processWrites, this);
+}
+
+TileMapWriter::~TileMapWriter()
+{
+    // Note: The writer thread will finish any pending request before exiting.
+    {
+        std::unique_lock lock{writeMutex};
+        exitRequested = true;
+    }
+    writeCondVar.notify_one();
+    writeThreadObj.join();
+}
+
+void TileMapWriter::write(WriteRequest&& writeRequest)
+{
+    {
+        std::unique_lock lock{writeMutex};
+        if (!pendingRequest) {
+            pendingRequest.emplace(std::move(writeRequest));
+        }
+        else {
+            // A request is already waiting. Merge this one into it, letting
+            // our newer chunk snapshots replace any older ones.
+            pendingRequest->version = writeRequest.version;
+            pendingRequest->xLengthChunks = writeRequest.xLengthChunks;
+            pendingRequest->yLengthChunks = writeRequest.yLengthChunks;
+            pendingRequest->zLengthChunks = writeRequest.zLengthChunks;
+            for (auto& [chunkPosition, chunkSnapshot] : writeRequest.chunks) {
+                pendingRequest->chunks.insert_or_assign(
+                    chunkPosition, std::move(chunkSnapshot));
+            }
+        }
+    }
+    writeCondVar.notify_one();
+}
+
+bool TileMapWriter::writeIsInProgress()
+{
+    std::unique_lock lock{writeMutex};
+    return (pendingRequest.has_value() || writeIsActive);
+}
+
+bool TileMapWriter::lastWriteFailed()
+{
+    return writeFailed;
+}
+
+void TileMapWriter::processWrites()
+{
+    while (true) {
+        // Wait until we're signaled by write() or the destructor.
+        std::optional<WriteRequest> writeRequest{};
+        {
+            std::unique_lock lock{writeMutex};
+            writeCondVar.wait(lock, [this] {
+                return (pendingRequest.has_value() || exitRequested);
+            });
+
+            // If there's nothing left to write and we're exiting, end the
+            // thread.
+            if (!pendingRequest) {
+                // If the last write failed, give its chunks one last try.
+                if (writeFailed) {
+                    retryFailedRequest();
+                    if (writeFailed) {
+                        LOG_ERROR("Failed to save %zu map chunks before "
+                                  "exiting. Their changes were lost.",
+                                  failedRequest.chunks.size());
+                    }
+                }
+                return;
+            }
+
+            writeRequest.swap(pendingRequest);
+            writeIsActive = true;
+        }
+
+        performWrite(*writeRequest);
+
+        // Release our references to the chunk snapshots before signaling
+        // that we're done.
+        writeRequest.reset();
+        writeIsActive = false;
+    }
+}
+
+void TileMapWriter::performWrite(WriteRequest& writeRequest)
+{
+    ZoneScoped;
+    Timer timer{};
+
+    // If the last write failed, retry its chunks (unless they've since been
+    // replaced by newer snapshots).
+    for (auto& [chunkPosition, chunkSnapshot] : failedRequest.chunks) {
+        writeRequest.chunks.try_emplace(chunkPosition,
+                                        std::move(chunkSnapshot));
+    }
+    failedRequest.chunks.clear();
+
+    // Append the changed chunks to the store.
+    chunkStore.setMapInfo(writeRequest.version, writeRequest.xLengthChunks,
+                          writeRequest.yLengthChunks,
+                          writeRequest.zLengthChunks);
+    if (!chunkStore.save(writeRequest.chunks)) {
+        LOG_ERROR("Failed to save %zu map chunks. Will retry on the next "
+                  "save.",
+                  writeRequest.chunks.size());
+        failedRequest = std::move(writeRequest);
+        writeFailed = true;
+        return;
+    }
+    writeFailed = false;
+
+    double timeTaken{timer.getTime()};
+    LOG_INFO("Saved %zu map chunks in %.6fs (background). Store size: %llu "
+             "bytes, %llu live.",
+             writeRequest.chunks.size(), timeTaken,
+             static_cast<unsigned long long>(chunkStore.getDataFileSize()),
+             static_cast<unsigned long long>(chunkStore.getLiveDataSize()));
+}
+
+void TileMapWriter::retryFailedRequest()
+{
+    // Note: performWrite() will add the failed chunks to this request.
+    WriteRequest retryRequest{};
+    retryRequest.version = failedRequest.version;
+    retryRequest.xLengthChunks = failedRequest.xLengthChunks;
+    retryRequest.yLengthChunks = failedRequest.yLengthChunks;
+    retryRequest.zLengthChunks = failedRequest.zLengthChunks;
+    performWrite(retryRequest);
+}
+
+} // End namespace Server
+} // End namespace AM
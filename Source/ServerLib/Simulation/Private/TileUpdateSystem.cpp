@@ -48,6 +48,40 @@ struct InRangeExtentGetter {
     }
 };
 
+/** Returns the tile extent that contains any entities that may be affected
+    by a given tile update.
+    Note: We include the directly surrounding tiles in every direction, to
+          catch entities that were leaning against a changed wall, standing
+          on a changed tile, or standing on something at the tile's top. */
+struct AffectedExtentGetter {
+    TileMap& tileMap;
+
+    TileExtent operator()(const TileExtentClearLayers& tileUpdate)
+    {
+        return expand(tileUpdate.tileExtent);
+    }
+
+    // TileAddLayer, TileRemoveLayer, TileClearLayers
+    template<typename T>
+    TileExtent operator()(const T& tileUpdate)
+    {
+        const TilePosition& tilePosition{tileUpdate.tilePosition};
+        return expand(
+            {tilePosition.x, tilePosition.y, tilePosition.z, 1, 1, 1});
+    }
+
+    TileExtent expand(TileExtent tileExtent)
+    {
+        tileExtent.x -= 1;
+        tileExtent.y -= 1;
+        tileExtent.z -= 1;
+        tileExtent.xLength += 2;
+        tileExtent.yLength += 2;
+        tileExtent.zLength += 2;
+        return tileExtent.intersectWith(tileMap.getTileExtent());
+    }
+};
+
 /** Sends the given tile update to the currently set client netID. */
 struct UpdateSender {
     Network& network;
@@ -103,6 +137,22 @@ void TileUpdateSystem::updateTiles()
     world.tileMap.setAutoRebuildCollision(true);
 }
 
+void TileUpdateSystem::wakeEntitiesNearUpdates()
+{
+    ZoneScoped;
+
+    // Sleeping entities aren't moved, so they won't notice when the tiles
+    // around them change. Wake any that might be affected.
+    AffectedExtentGetter extentGetter{world.tileMap};
+    for (const auto& updateVariant : world.tileMap.getTileUpdateHistory()) {
+        TileExtent affectedExtent{std::visit(extentGetter, updateVariant)};
+        for (entt::entity entity :
+             world.entityLocator.getEntities(affectedExtent)) {
+            world.movementActivityTracker.wake(entity);
+        }
+    }
+}
+
 void TileUpdateSystem::sendTileUpdates()
 {
     auto clientView = world.registry.view<ClientSimData>();
@@ -146,6 +196,11 @@ void TileUpdateSystem::addTileLayer(const TileAddLayer& addLayerRequest)
         return;
     }
 
+    // Make sure the affected chunks are loaded (including the neighbors,
+    // since walls may modify adjacent tiles).
+    world.tileMap.loadExtentIfNecessary(
+        InRangeExtentGetter{world.tileMap}(addLayerRequest));
+
     if (addLayerRequest.layerType == TileLayer::Type::Terrain) {
         world.tileMap.addTerrain(
             addLayerRequest.tilePosition, addLayerRequest.graphicSetID,
@@ -180,6 +235,10 @@ void TileUpdateSystem::remTileLayer(const TileRemoveLayer& remLayerRequest)
         return;
     }
 
+    // Make sure the affected chunks are loaded.
+    world.tileMap.loadExtentIfNecessary(
+        InRangeExtentGetter{world.tileMap}(remLayerRequest));
+
     if (remLayerRequest.layerType == TileLayer::Type::Terrain) {
         world.tileMap.remTerrain(remLayerRequest.tilePosition);
     }
@@ -214,6 +273,10 @@ void TileUpdateSystem::clearTileLayers(
         return;
     }
 
+    // Make sure the affected chunks are loaded.
+    world.tileMap.loadExtentIfNecessary(
+        InRangeExtentGetter{world.tileMap}(clearLayersRequest));
+
     world.tileMap.clearTileLayers(clearLayersRequest.tilePosition,
                                   clearLayersRequest.layerTypesToClear);
 }
@@ -228,6 +291,10 @@ void TileUpdateSystem::clearExtentLayers(
         return;
     }
 
+    // Make sure the affected chunks are loaded.
+    world.tileMap.loadExtentIfNecessary(
+        InRangeExtentGetter{world.tileMap}(clearExtentLayersRequest));
+
     world.tileMap.clearExtentLayers(clearExtentLayersRequest.tileExtent,
                                     clearExtentLayersRequest.layerTypesToClear);
 }
@@ -0,0 +1,151 @@
+#include "TimingWheel.h"
+#include "tracy/Tracy.hpp"
+#include <utility>
+
+namespace AM
+{
+namespace Server
+{
+TimingWheel::TimingWheel(Uint32 inCurrentTick)
+: currentTick{inCurrentTick}
+, nextTimerID{1}
+, levels{}
+, callbacks{}
+, firingSlot{}
+{
+}
+
+TimerID TimingWheel::schedule(Uint32 targetTick, TimerCallback callback)
+{
+    // If the target tick has already been reached, fire on the next tick.
+    // Note: We compare the signed difference so that this keeps working if
+    //       the tick number wraps around.
+    if (static_cast<Sint32>(targetTick - currentTick) <= 0) {
+        targetTick = currentTick + 1;
+    }
+
+    TimerID timerID{nextTimerID++};
+    if (nextTimerID == 0) {
+        nextTimerID = 1;
+    }
+
+    callbacks.emplace(timerID, std::move(callback));
+    insert({timerID, targetTick});
+
+    return timerID;
+}
+
+TimerID TimingWheel::scheduleAfter(Uint32 delayTicks, TimerCallback callback)
+{
+    return schedule((currentTick + delayTicks), std::move(callback));
+}
+
+void TimingWheel::cancel(TimerID timerID)
+{
+    // Note: The timer's slot entry is left in place, and will be skipped
+    //       when its slot is reached.
+    callbacks.erase(timerID);
+}
+
+bool TimingWheel::isScheduled(TimerID timerID) const
+{
+    return callbacks.contains(timerID);
+}
+
+void TimingWheel::advance(Uint32 targetTick)
+{
+    ZoneScoped;
+
+    while (static_cast<Sint32>(targetTick - currentTick) > 0) {
+        processNextTick();
+    }
+
+    TracyPlot("TimingWheelTimers", static_cast<int64_t>(callbacks.size()));
+}
+
+Uint32 TimingWheel::getCurrentTick() const
+{
+    return currentTick;
+}
+
+std::size_t TimingWheel::getTimerCount() const
+{
+    return callbacks.size();
+}
+
+void TimingWheel::insert(const TimerEntry& entry)
+{
+    // Find the lowest level that can hold this timer's delay.
+    Uint32 delay{entry.expirationTick - currentTick};
+    unsigned int levelIndex{0};
+    while ((levelIndex < (LEVEL_COUNT - 1))
+           && (delay >= (Uint32{1} << ((levelIndex + 1) * SLOT_BITS)))) {
+        levelIndex++;
+    }
+
+    unsigned int slotIndex{getSlotIndex(entry.expirationTick, levelIndex)};
+    levels[levelIndex][slotIndex].push_back(entry);
+}
+
+void TimingWheel::processNextTick()
+{
+    currentTick++;
+
+    // If level 0 just wrapped around, cascade the next slot of each upper
+    // level that also wrapped, starting from the highest. Each cascaded
+    // timer moves down to the level that matches its remaining delay.
+    unsigned int levelsToCascade{0};
+    while ((levelsToCascade < (LEVEL_COUNT - 1))
+           && (getSlotIndex(currentTick, levelsToCascade) == 0)) {
+        levelsToCascade++;
+    }
+    for (unsigned int levelIndex{levelsToCascade}; levelIndex > 0;
+         --levelIndex) {
+        cascade(levelIndex);
+    }
+
+    // Fire this tick's timers.
+    // Note: We swap the slot out first, since callbacks may schedule more
+    //       timers.
+    Slot& slot{levels[0][getSlotIndex(currentTick, 0)]};
+    if (slot.empty()) {
+        return;
+    }
+    std::swap(firingSlot, slot);
+
+    for (const TimerEntry& entry : firingSlot) {
+        // If this timer was cancelled, skip it.
+        auto callbackIt{callbacks.find(entry.timerID)};
+        if (callbackIt == callbacks.end()) {
+            continue;
+        }
+
+        TimerCallback callback{std::move(callbackIt->second)};
+        callbacks.erase(callbackIt);
+        callback();
+    }
+
+    firingSlot.clear();
+}
+
+void TimingWheel::cascade(unsigned int levelIndex)
+{
+    Slot& slot{levels[levelIndex][getSlotIndex(currentTick, levelIndex)]};
+    Slot cascadingSlot{};
+    std::swap(cascadingSlot, slot);
+
+    for (const TimerEntry& entry : cascadingSlot) {
+        // Drop the entries of cancelled timers while we're here.
+        if (callbacks.contains(entry.timerID)) {
+            insert(entry);
+        }
+    }
+}
+
+unsigned int TimingWheel::getSlotIndex(Uint32 tick, unsigned int levelIndex)
+{
+    return (tick >> (levelIndex * SLOT_BITS)) & (SLOT_COUNT - 1);
+}
+
+} // namespace Server
+} // namespace AM
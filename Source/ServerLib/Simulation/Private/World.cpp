@@ -37,6 +37,7 @@ World::World(const SimulationContext& inSimContext)
 , entityLocator{registry}
 , collisionLocator{}
 , tileMap{inSimContext.graphicData, collisionLocator}
+, movementActivityTracker{registry}
 , entityStoredValueIDMap{}
 , globalStoredValueMap{}
 , inventoryHelper{*this, inSimContext.network, inSimContext.itemData}
@@ -227,8 +228,8 @@ std::string World::runEntityInitScript(entt::entity entity,
 {
     // Run the given script on the given entity.
     entityInitLua.selfEntity = entity;
-    auto result{entityInitLua.luaState.script(initScript.script,
-                                              &sol::script_pass_on_error)};
+    auto result{entityInitLua.scriptCache.run(entityInitLua.luaState,
+                                              initScript.script)};
 
     // If the init script ran successfully, save it.
     std::string returnString{""};
@@ -249,8 +250,7 @@ std::string World::runItemInitScript(Item& item, std::string_view initScript)
 {
     // Run the given script on the given item.
     itemInitLua.selfItem = &item;
-    auto result{
-        itemInitLua.luaState.script(initScript, &sol::script_pass_on_error)};
+    auto result{itemInitLua.scriptCache.run(itemInitLua.luaState, initScript)};
 
     // If the init script failed, return the error.
     std::string returnString{""};
@@ -411,9 +411,10 @@ void World::onEntityDestroyed(entt::entity entity)
     entityLocator.removeEntity(entity);
     collisionLocator.removeEntity(entity);
 
-    // If the entity is in the database, delete it (does nothing if it isn't).
-    // Note: This is to delete non-client entities, since they get persisted.
-    database->deleteEntityData(entity);
+    // Note: SaveSystem's PersistedEntityTracker records destroyed non-client
+    //       entities, and SaveSystem deletes them from the database during
+    //       its next save. This doesn't depend on the entity's ID staying
+    //       unused until then.
 }
 
 } // namespace Server
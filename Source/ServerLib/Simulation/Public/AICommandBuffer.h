@@ -0,0 +1,91 @@
+#pragma once
+
+#include "CastHelper.h"
+#include "Input.h"
+#include "Position.h"
+#include "entt/entity/entity.hpp"
+#include <string>
+#include <string_view>
+#include <variant>
+#include <vector>
+
+namespace AM
+{
+namespace Server
+{
+class World;
+
+/**
+ * Records the world mutations that an AI wants to make, so they can be
+ * applied later on the sim thread.
+ *
+ * Used by parallel AI (see ParallelAILogic in AILogic.h): AI logic runs on
+ * worker threads with read-only world access, and records its changes here.
+ * After every AI has ran, AISystem applies each buffer in a fixed order.
+ */
+class AICommandBuffer
+{
+public:
+    struct SetInputCommand {
+        entt::entity entity{entt::null};
+        Input::StateArr inputStates{};
+    };
+
+    struct SpawnEntityCommand {
+        Position position{};
+        std::string initScript{};
+    };
+
+    using Command
+        = std::variant<SetInputCommand,
+                       CastHelper::CastEntityInteractionParams,
+                       CastHelper::CastSpellParams, SpawnEntityCommand>;
+
+    /**
+     * Sets the given entity's input states.
+     */
+    void setInput(entt::entity entity, const Input::StateArr& inputStates);
+
+    /**
+     * Casts an entity interaction. See CastHelper::castEntityInteraction().
+     */
+    void castEntityInteraction(
+        const CastHelper::CastEntityInteractionParams& params);
+
+    /**
+     * Casts a spell. See CastHelper::castSpell().
+     */
+    void castSpell(const CastHelper::CastSpellParams& params);
+
+    /**
+     * Creates a new entity at the given position and, if initScript is
+     * non-empty, runs it on the entity.
+     */
+    void spawnEntity(const Position& position, std::string_view initScript);
+
+    /**
+     * Applies every recorded command to the world, in the order that they
+     * were recorded, then clears this buffer.
+     *
+     * Commands that are no longer valid (e.g. their entity was destroyed by
+     * an earlier command) are skipped.
+     */
+    void apply(World& world);
+
+    /**
+     * Clears this buffer without applying it.
+     */
+    void clear();
+
+    /**
+     * Returns the commands that have been recorded, in order.
+     */
+    const std::vector<Command>& getCommands() const;
+
+private:
+    /** The commands that have been recorded, in order. */
+    std::vector<Command> commands;
+};
+
+} // namespace Server
+} // namespace AM
@@ -7,6 +7,7 @@ namespace AM
 namespace Server
 {
 class World;
+class AICommandBuffer;
 
 /**
  * Interface class for entity AI logic.
@@ -22,10 +23,36 @@ public:
      * If the given entity doesn't possess any of the necessary components,
      * prints a warning and returns early.
      *
+     * Note: Changes to the entity's Input or Movement must go through
+     *       world.registry.patch() (or replace()). Otherwise, a sleeping
+     *       entity won't be woken and the change will be ignored. If you
+     *       must modify them some other way, call
+     *       world.movementActivityTracker.wake() afterwards.
+     *
      * @param entity The entity that this AI is controlling.
      */
     virtual void tick(World& world, entt::entity entity) = 0;
 };
 
+/**
+ * An AI type that can also run in parallel with other AI.
+ *
+ * If Config::AI_PARALLEL_TICK is true, AISystem calls tickParallel() instead
+ * of tick() for these types, from worker threads. tickParallel() must only
+ * read from the world, using the thread-safe queries (const registry access,
+ * EntityLocator's overloads that take an output vector, and
+ * CollisionLocator's batch raycasts). Any mutations must be recorded in the
+ * given command buffer, which AISystem applies after every AI has ran.
+ *
+ * tickParallel() may modify the AI component itself, since each component is
+ * only ever ticked by one thread at a time.
+ */
+template<typename AIType>
+concept ParallelAILogic = requires(AIType aiLogic, const World& world,
+                                   entt::entity entity,
+                                   AICommandBuffer& commandBuffer) {
+    aiLogic.tickParallel(world, entity, commandBuffer);
+};
+
 } // namespace Server
 } // namespace AM
@@ -1,28 +1,118 @@
 #pragma once
 
+#include "AIWorkerPool.h"
+#include "Timer.h"
+#include "entt/fwd.hpp"
+#include <SDL3/SDL_stdinc.h>
+#include <limits>
+#include <vector>
+
 namespace AM
 {
 namespace Server
 {
 struct SimulationContext;
+class Simulation;
 class World;
 
 /**
  * Handles AI processing.
+ *
+ * AI is scheduled by level of detail: each AI entity gets a tick interval
+ * based on its distance to the nearest client (found using the clients' AOI
+ * lists). Nearby AI runs every tick, AI in a client's AOI runs at a reduced
+ * rate, and AI that's out of every client's AOI runs rarely or sleeps until a
+ * client approaches.
+ *
+ * Entities with the same interval are spread across that interval's ticks by
+ * entity ID, so load is even from tick to tick.
+ *
+ * If Config::AI_PARALLEL_TICK is true, AI types that satisfy ParallelAILogic
+ * are ticked on an AIWorkerPool. After every chunk has ran, the chunks'
+ * command buffers are applied in chunk order, so the result doesn't depend on
+ * which thread ran which chunk.
  */
 class AISystem
 {
 public:
     AISystem(const SimulationContext& inSimContext);
 
+    ~AISystem();
+
     /**
-     * Calls tick() on all AI components.
+     * Calls tick() on all AI components that are due this tick.
      */
     void processAITick();
 
 private:
+    /** Per-AI-type run statistics, for finding expensive AI. */
+    struct AITypeStats {
+        /** The number of times this type's tick() has been called. */
+        std::size_t runCount{0};
+
+        /** The total time spent in this type's tick(), in seconds. */
+        double totalTime{0};
+    };
+
+    /**
+     * Fills nearestClientDistancesSquared using the clients' AOI lists.
+     */
+    void updateClientDistances();
+
+    /**
+     * Returns the number of ticks between each run of the given entity's AI.
+     * If 0, the AI is asleep.
+     */
+    Uint32 getTickInterval(entt::entity entity) const;
+
+    /**
+     * Returns true if the given entity's AI should run this tick.
+     */
+    bool isDue(entt::entity entity, Uint32 currentTick) const;
+
+    /**
+     * Ticks every due AI of the given type in parallel, then applies their
+     * command buffers.
+     *
+     * @return The number of AI that were ticked.
+     */
+    template<typename AIType>
+    std::size_t tickParallel(Uint32 currentTick);
+
+    /**
+     * Logs each AI type's run statistics, then resets them.
+     */
+    void logStats();
+
+    /** Used to get the current tick. */
+    Simulation& simulation;
+
     /** Used to get AI components to process. */
     World& world;
+
+    /** The squared distance from each entity to the nearest client entity
+        that has it in its AOI, indexed by entity index.
+        Entities that aren't in any client's AOI hold FAR_DISTANCE. */
+    std::vector<float> nearestClientDistancesSquared;
+
+    static constexpr float FAR_DISTANCE{std::numeric_limits<float>::max()};
+
+    /** Run statistics for each type in ProjectAITypes. */
+    std::vector<AITypeStats> aiTypeStats;
+
+    /** Used to know when to log aiTypeStats. */
+    Timer statsLogTimer;
+
+    //-------------------------------------------------------------------------
+    // Parallel AI
+    //-------------------------------------------------------------------------
+    /** The AI entities that are due this tick, for the type that's currently
+        being ticked in parallel. */
+    std::vector<entt::entity> dueEntities;
+
+    /** Used to tick parallel AI. Has no workers if Config::AI_PARALLEL_TICK
+        is false. */
+    AIWorkerPool workerPool;
 };
 
 } // End namespace Server
@@ -0,0 +1,98 @@
+#pragma once
+
+#include "AICommandBuffer.h"
+#include "entt/fwd.hpp"
+#include <atomic>
+#include <barrier>
+#include <functional>
+#include <span>
+#include <thread>
+#include <vector>
+
+namespace AM
+{
+namespace Server
+{
+/**
+ * Runs parallel AI on a pool of worker threads.
+ *
+ * Each run's entities are split into fixed-size chunks, each with its own
+ * AICommandBuffer. The workers and the calling thread take chunks until there
+ * are none left. The caller then applies the buffers in chunk order, so the
+ * result doesn't depend on which thread ran which chunk.
+ *
+ * The workers sleep on a barrier between runs.
+ */
+class AIWorkerPool
+{
+public:
+    /**
+     * @param workerCount The number of worker threads to start. If 0, every
+     *                    chunk runs on the calling thread.
+     * @param inChunkSize The max number of entities in each chunk.
+     */
+    AIWorkerPool(std::size_t workerCount, std::size_t inChunkSize);
+
+    ~AIWorkerPool();
+
+    /**
+     * Calls tickFunction on each of the given entities, spread across the
+     * workers and the calling thread. Returns once every entity has been
+     * ticked.
+     *
+     * Any commands left in the buffers from the last run are cleared.
+     *
+     * @param tickFunction Must be safe to call concurrently. Should record
+     *                     any world changes in the given command buffer.
+     * @return Each chunk's command buffer, in chunk order.
+     */
+    std::span<AICommandBuffer>
+        run(std::span<const entt::entity> inEntities,
+            const std::function<void(entt::entity, AICommandBuffer&)>&
+                inTickFunction);
+
+private:
+    /**
+     * Runs chunks until there are none left.
+     * Called by the calling thread and each worker.
+     */
+    void runChunks();
+
+    /**
+     * The loop that each worker thread runs.
+     */
+    void workerLoop();
+
+    /** The max number of entities in each chunk. */
+    std::size_t chunkSize;
+
+    /** The current run's entities. */
+    std::span<const entt::entity> entities;
+
+    /** The current run's tick function. */
+    const std::function<void(entt::entity, AICommandBuffer&)>* tickFunction;
+
+    /** A command buffer for each chunk. Grows to fit the largest run. */
+    std::vector<AICommandBuffer> commandBuffers;
+
+    /** The number of chunks in the current run. */
+    std::size_t chunkCount;
+
+    /** The index of the next chunk to run. */
+    std::atomic<std::size_t> nextChunkIndex;
+
+    /** If true, the workers should exit. */
+    std::atomic<bool> exitRequested;
+
+    /** Used to start each run, and to tell workers to exit. */
+    std::barrier<> startBarrier;
+
+    /** Used to wait for each run to finish. */
+    std::barrier<> finishBarrier;
+
+    /** The worker threads. */
+    std::vector<std::jthread> workers;
+};
+
+} // End namespace Server
+} // End namespace AM
@@ -10,9 +10,11 @@
 #include "EnttObserver.h"
 #include "QueuedEvents.h"
 #include "EventSorter.h"
+#include "TimingWheel.h"
 #include "entt/fwd.hpp"
 #include <unordered_map>
 #include <functional>
+#include <vector>
 
 namespace AM
 {
@@ -42,8 +44,12 @@ public:
     void sendCastCooldownInits();
 
     /**
-     * Processes cast requests, updates ongoing casts, cancels casts as
-     * necessary, and passes completed casts to registered handlers.
+     * Processes cast requests, starts new casts, and cancels casts as
+     * necessary.
+     *
+     * Ongoing casts are completed by their finish timer, when the sim's
+     * timing wheel reaches their end tick. Completed casts are passed to
+     * their registered handlers.
      */
     void processCasts();
 
@@ -53,16 +59,39 @@ private:
      */
     void processCastRequests();
 
+    /**
+     * Records a cast request that was too late or too early to be sorted, in
+     * its client's ClientSimData.
+     */
+    void trackUnsortedRequest(NetworkID clientID,
+                              SorterBase::ValidityResult validity);
+
     /**
      * Processes the given cast request.
      */
     void processCastRequest(const CastRequest& castRequest);
 
     /**
-     * Updates any ongoing casts, canceling or completing them as necessary.
+     * Cancels any ongoing casts whose caster has moved, and starts any new
+     * casts.
+     *
+     * Note: Casts are completed by their finish timer, see onCastTimerFired().
      */
     void updateCasts();
 
+    /**
+     * If the given entity is casting, tracks it so its cast can be cancelled
+     * in updateCasts().
+     */
+    void onPositionUpdated(entt::registry& registry, entt::entity entity);
+
+    /**
+     * Finishes the given entity's cast if it's still valid, else cancels it.
+     *
+     * Called by the timing wheel when a cast's end tick is reached.
+     */
+    void onCastTimerFired(entt::entity casterEntity, Uint32 endTick);
+
     /**
      * Sends a CastStarted message and sets any entity state related to the
      * cast being started.
@@ -107,6 +136,8 @@ private:
     Simulation& simulation;
     /** Used to access entity data and castHelper. */
     World& world;
+    /** Used to schedule cast completions. */
+    TimingWheel& timingWheel;
     /** Used to send CastFailed and CastStarted messages. */
     Network& network;
     const ItemData& itemData;
@@ -116,6 +147,16 @@ private:
         initial cast cooldown state to a newly-logged-on player. */
     EnttObserver playerCastCooldownObserver;
 
+    /** Observes CastState creation so we can start new casts. */
+    EnttObserver newCastObserver;
+
+    /** Entities that moved while casting, since the last updateCasts(). */
+    std::vector<entt::entity> movedCasters;
+
+    /** Scratch vector, used to start casts without iterating the observer
+        while CastState is being modified. */
+    std::vector<entt::entity> castsToStart;
+
     EventQueue<CastRequest> castRequestQueue;
     EventSorter<CastRequest> castRequestSorter;
 };
@@ -0,0 +1,61 @@
+#pragma once
+
+#include "ChunkPosition.h"
+#include "Timer.h"
+#include <unordered_set>
+
+namespace AM
+{
+namespace Server
+{
+struct SimulationContext;
+class Simulation;
+class World;
+
+/**
+ * Manages which tile map chunks are kept in memory.
+ *
+ * TileMap only loads chunks from disk when they're first needed. Entities
+ * need the chunks around them to be loaded so that they collide with the
+ * map, so each tick we load any missing chunks within LOAD_RADIUS of an
+ * entity.
+ *
+ * Periodically, we evict chunks that haven't been used in a while, or that
+ * are pushing us over the memory budget. Configure through
+ * Config::CHUNK_EVICTION_IDLE_S and Config::CHUNK_MEMORY_BUDGET.
+ *
+ * Note: Entities can't move more than a chunk per tick, so loading the
+ *       surrounding chunks keeps us ahead of them. Teleports may leave an
+ *       entity in an unloaded chunk for a single tick.
+ */
+class ChunkResidencySystem
+{
+public:
+    ChunkResidencySystem(const SimulationContext& inSimContext);
+
+    /**
+     * Loads any unloaded chunks that are near an entity. If it's time,
+     * evicts any idle chunks.
+     */
+    void updateResidency();
+
+private:
+    /** The radius, in chunks, around each entity's chunk to keep loaded.
+        Matches the range that clients request chunks in. */
+    static constexpr int LOAD_RADIUS{1};
+
+    /** Used to get the current tick. */
+    Simulation& simulation;
+    /** Used for accessing entity positions and the tile map. */
+    World& world;
+
+    /** Tracks when we should next check for chunks to evict. */
+    Timer evictionTimer;
+
+    /** The chunk columns that contain an entity. Used during
+        updateResidency(). */
+    std::unordered_set<ChunkPosition> occupiedColumns;
+};
+
+} // End namespace Server
+} // End namespace AM
@@ -15,6 +15,7 @@ struct ChunkWireSnapshot;
 namespace Server
 {
 struct SimulationContext;
+class Simulation;
 class World;
 class Network;
 
@@ -53,6 +54,8 @@ private:
     void addChunkToMessage(const ChunkPosition& chunkPosition,
                            ChunkUpdate& chunkUpdate);
 
+    /** Used for getting the frame arena. */
+    Simulation& simulation;
     /** Used for fetching entity, component, and map data. */
     World& world;
     /** Used for receiving chunk requests and sending chunks to clients. */
@@ -3,6 +3,7 @@
 #include "ComponentUpdate.h"
 #include "EnttObserver.h"
 #include <unordered_map>
+#include <memory_resource>
 
 namespace AM
 {
@@ -32,6 +33,14 @@ public:
     void sendUpdates();
 
 private:
+    /** Maps entityID -> a ComponentUpdate message containing that entity's
+        data. We iterate the observers to detect changes, so this map lets us
+        iteratively build the update messages component-by-component.
+        Note: These maps and their messages are allocated from the frame
+              arena, so they must not outlive the current tick. */
+    using ComponentUpdateMap
+        = std::pmr::unordered_map<entt::entity, ComponentUpdate>;
+
     void sendSelfUpdates();
 
     void sendInRangeUpdates();
@@ -41,14 +50,24 @@ private:
      * componentUpdateMap.
      */
     template <typename ComponentTypeList>
-    void addConstructDestroyComponents(auto& constructObservers,
+    void addConstructDestroyComponents(ComponentUpdateMap& componentUpdateMap,
+                                       auto& constructObservers,
                                        auto& destroyObservers);
 
     /**
-     * Adds updated components from the given list to * componentUpdateMap.
+     * Adds updated components from the given list to componentUpdateMap.
      */
     template <typename ComponentTypeList>
-    void addUpdateComponents(auto& updateObservers);
+    void addUpdateComponents(ComponentUpdateMap& componentUpdateMap,
+                             auto& updateObservers);
+
+    /**
+     * Returns the given entity's message in componentUpdateMap, adding it if
+     * necessary. Added messages use the map's memory resource.
+     */
+    static ComponentUpdate&
+        getComponentUpdate(ComponentUpdateMap& componentUpdateMap,
+                           entt::entity entity);
 
     /** Used to get the current tick. */
     Simulation& simulation;
@@ -61,13 +80,6 @@ private:
 
     // Note: Check the top of the cpp file for file-local types and variables.
     //       We keep some templated code there to reduce compile times.
-
-    // Note: To optimize, we could store indices into a vector<ComponentUpdate>.
-    //       Then we could re-use the vectors instead of re-allocating.
-    /** Maps entityID -> a ComponentUpdate message containing that entity's
-        data. We iterate the observers to detect changes, so this map lets us
-        iteratively build the update messages component-by-component. */
-    std::unordered_map<entt::entity, ComponentUpdate> componentUpdateMap;
 };
 
 } // namespace Server
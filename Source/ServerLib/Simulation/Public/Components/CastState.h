@@ -2,6 +2,7 @@
 
 #include "CastableID.h"
 #include "CastInfo.h"
+#include "TimingWheel.h"
 #include <SDL3/SDL_stdinc.h>
 
 namespace AM
@@ -25,6 +26,10 @@ struct CastState {
     /** The tick that this cast will finish on. If 0, this cast hasn't been
         processed for the first time yet. */
     Uint32 endTick{};
+
+    /** The timer that will finish this cast. If 0, this cast is either
+        unstarted or instant. */
+    TimerID finishTimerID{};
 };
 
 } // namespace Server
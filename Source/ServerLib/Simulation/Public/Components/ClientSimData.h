@@ -2,6 +2,7 @@
 
 #include "NetworkDefs.h"
 #include "entt/fwd.hpp"
+#include <SDL3/SDL_stdinc.h>
 #include <vector>
 
 namespace AM
@@ -25,6 +26,15 @@ struct ClientSimData {
 
     /** Tracks the entities that are in range of this client's entity. */
     std::vector<entt::entity> entitiesInAOI{};
+
+    /** The number of tick-synchronized messages (inputs, casts) that this
+        client sent for a tick that we had already processed. If this keeps
+        rising, the client isn't running far enough ahead of us. */
+    Uint32 tooLowMessageCount{0};
+
+    /** The number of tick-synchronized messages that this client sent for a
+        tick that was too far ahead for us to buffer. */
+    Uint32 tooHighMessageCount{0};
 };
 
 } // namespace Server
@@ -34,8 +34,8 @@ struct Dialogue {
     struct Choice {
         /** If non-empty, contains a condition script that must be ran against
             the player entity to check if they may access this choice.
-            Condition scripts will have "r =" prepended to them before running,
-            and must evaluate to a boolean value. */
+            Condition scripts will have "return " prepended to them before
+            running, and must evaluate to a boolean value. */
         std::string conditionScript{};
 
         /** The text that will be displayed for this choice. */
@@ -2,6 +2,8 @@
 
 #include "ItemID.h"
 #include "IconID.h"
+#include "PersistedComponentDefs.h"
+#include "Timer.h"
 #include "SQLiteCpp/SQLiteCpp.h"
 #include "entt/fwd.hpp"
 #include <SDL3/SDL_stdinc.h>
@@ -11,6 +13,7 @@
 #include <mutex>
 #include <condition_variable>
 #include <atomic>
+#include <functional>
 #include <span>
 #include <string_view>
 
@@ -26,9 +29,14 @@ class World;
  * We use the database to persist item definitions, non-client entity data,
  * and tile map data as blobs.
  *
- * To avoid blocking the main loop, we first copy all of our data into an
- * in-memory database. Then, we use a separate thread to backup the in-memory
- * database to a file. See SaveSystem.h for more info.
+ * To avoid blocking the main loop, all writes happen on a separate thread.
+ * Depending on Config::DATABASE_MODE, we either write into an in-memory
+ * database and then use that same thread to back it up to a file, or
+ * write directly to the file in WAL mode. See SaveSystem.h for more info.
+ *
+ * Note: After construction, only the backup thread may use the writable
+ *       database. The write functions below should only be called from a
+ *       writer passed to writeAndBackup().
  *
  * Note: Client entity data is persisted in the account database, not here.
  */
@@ -53,9 +61,19 @@ public:
 
     /**
      * Backs up our in-memory database to the file database.
+     * In WalFile mode, checkpoints the WAL instead.
      */
     void backupToFile();
 
+    /**
+     * On the backup thread: Calls the given writer inside a transaction, then
+     * backs up our in-memory database to the file database (or checkpoints
+     * the WAL, in WalFile mode).
+     *
+     * @pre A backup must not be in progress (see backupIsInProgress()).
+     */
+    void writeAndBackup(std::function<void(Database&)> writer);
+
     /**
      * @return true if a backup is currently being performed, else false.
      */
@@ -86,6 +104,20 @@ public:
      */
     void deleteEntityData(entt::entity entity);
 
+    /**
+     * Deletes every entity table entry.
+     * Used when migrating to the columnar format.
+     */
+    void deleteAllEntityData();
+
+    /**
+     * @return true if the entity table has any entries, else false.
+     *
+     * Note: Reads from the file-backed database, so this should only be
+     *       used while loading.
+     */
+    bool hasEntityData();
+
     /**
      * Calls the given callback on each entity data entry.
      *
@@ -118,6 +150,65 @@ public:
         iterateEntitiesQuery->reset();
     }
 
+    //-------------------------------------------------------------------------
+    // Component Columns
+    //-------------------------------------------------------------------------
+    /**
+     * Adds or overwrites a component column table entry.
+     *
+     * @param serializedColumn Every entity's instance of the component.
+     *
+     * See the columnar format comment in PersistedComponentDefs.h for format
+     * info.
+     */
+    void saveComponentColumn(PersistedComponentSet componentSet, Uint16 typeID,
+                             Uint16 version,
+                             std::span<const Uint8> serializedColumn);
+
+    /**
+     * Deletes every component column table entry.
+     * Used when migrating to the row format.
+     */
+    void deleteAllComponentColumns();
+
+    /**
+     * @return true if the component column table has any entries, else false.
+     *
+     * Note: Reads from the file-backed database, so this should only be
+     *       used while loading.
+     */
+    bool hasComponentColumnData();
+
+    /**
+     * Calls the given callback on each component column entry.
+     *
+     * @param callback A callback of form void(PersistedComponentSet, Uint16,
+     *                 Uint16, std::span<const Uint8>) that expects the
+     *                 column's set, type ID, version, and serialized column.
+     */
+    template<typename Func>
+    void iterateComponentColumns(Func callback)
+    {
+        while (iterateComponentColumnsQuery->executeStep()) {
+            SQLite::Column setColumn{
+                iterateComponentColumnsQuery->getColumn(0)};
+            SQLite::Column typeIDColumn{
+                iterateComponentColumnsQuery->getColumn(1)};
+            SQLite::Column versionColumn{
+                iterateComponentColumnsQuery->getColumn(2)};
+            SQLite::Column dataColumn{
+                iterateComponentColumnsQuery->getColumn(3)};
+            callback(
+                static_cast<PersistedComponentSet>(setColumn.getInt()),
+                static_cast<Uint16>(typeIDColumn.getInt()),
+                static_cast<Uint16>(versionColumn.getInt()),
+                std::span<const Uint8>{
+                    static_cast<const Uint8*>(dataColumn.getBlob()),
+                    static_cast<std::size_t>(dataColumn.getBytes())});
+        }
+        iterateComponentColumnsQuery->reset();
+    }
+
     //-------------------------------------------------------------------------
     // Items
     //-------------------------------------------------------------------------
@@ -230,19 +321,39 @@ protected:
      */
     void checkDataVersions();
 
+    /**
+     * Sets the pragmas that we use for file-backed databases in WalFile mode.
+     */
+    void configureWalConnection(SQLite::Database& connection);
+
+    /**
+     * Backs up the in-memory database to the file database, a few pages at a
+     * time.
+     */
+    void backupInSteps();
+
+    /**
+     * Moves any committed transactions from the WAL into World.db.
+     */
+    void checkpointWal();
+
     /**
      * Thread function.
-     * Waits for backupToFile() to flag that a backup should begin.
+     * Waits for backupToFile() or writeAndBackup() to flag that a backup
+     * should begin.
      *
-     * Backs up the in-memory database to the file database.
+     * Performs any pending write, then backs up the in-memory database to the
+     * file database.
      */
     void performBackup();
 
-    /** In-memory database. Used to gather our data so we can safely work
-        with it in another thread. */
+    /** The database that we write to. In InMemory mode, this is an in-memory
+        database that gathers our data so we can safely back it up in another
+        thread. In WalFile mode, this is World.db. */
     SQLite::Database database;
 
-    /** File-backed database. Used to persist our data to a file. */
+    /** File-backed database. Used to load our data, and in InMemory mode, to
+        persist it to a file. */
     SQLite::Database backupDatabase;
 
     /** If valid, this is the current ongoing transaction. */
@@ -260,10 +371,20 @@ protected:
     //       but it needs to be atomic to return it from backupIsInProgress().
     std::atomic<bool> backupRequested;
 
+    /** If set, this will be called inside a transaction before the next
+        backup. Guarded by backupMutex. */
+    std::function<void(Database&)> pendingWriter;
+
+    /** Tracks how long it's been since the current backup was requested.
+        Guarded by backupMutex. */
+    Timer requestTimer;
+
     // Pre-built queries
     std::unique_ptr<SQLite::Statement> insertEntityQuery;
     std::unique_ptr<SQLite::Statement> deleteEntityQuery;
     std::unique_ptr<SQLite::Statement> iterateEntitiesQuery;
+    std::unique_ptr<SQLite::Statement> insertComponentColumnQuery;
+    std::unique_ptr<SQLite::Statement> iterateComponentColumnsQuery;
     std::unique_ptr<SQLite::Statement> insertItemQuery;
     std::unique_ptr<SQLite::Statement> deleteItemQuery;
     std::unique_ptr<SQLite::Statement> iterateItemsQuery;
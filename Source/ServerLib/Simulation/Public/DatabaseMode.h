@@ -0,0 +1,22 @@
+#pragma once
+
+namespace AM
+{
+namespace Server
+{
+
+/**
+ * The ways that the world database can be run.
+ */
+enum class DatabaseMode {
+    /** Write to an in-memory database, then periodically back it up to
+        World.db. Writes are cheap, but anything since the last backup is
+        lost in a crash, and each backup copies the whole database. */
+    InMemory,
+    /** Write directly to World.db in WAL mode. Each save is durable as soon
+        as it's committed, and only the changed pages get written. */
+    WalFile
+};
+
+} // namespace Server
+} // namespace AM
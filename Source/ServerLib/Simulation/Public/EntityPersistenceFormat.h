@@ -0,0 +1,23 @@
+#pragma once
+
+namespace AM
+{
+namespace Server
+{
+
+/**
+ * The layouts that non-client entities can be persisted in.
+ */
+enum class EntityPersistenceFormat {
+    /** One row per entity, holding an ordered list of its component
+        records. Saves only write the entities that changed. */
+    Rows,
+    /** One blob per component type, holding every entity's instance of that
+        component. Saves rewrite the whole column of each component type
+        that changed, but save and load are straight passes over each
+        component storage. */
+    Columnar
+};
+
+} // namespace Server
+} // namespace AM
@@ -2,9 +2,10 @@
 
 #include "NetworkDefs.h"
 #include <SDL3/SDL_stdinc.h>
-#include <array>
-#include <queue>
+#include <utility>
+#include <vector>
 #include "Log.h"
+#include "AMAssert.h"
 
 namespace AM
 {
@@ -41,6 +42,10 @@ public:
  * if we're on tick 39 and we receive a message with tickNum = 42 from client 1,
  * and another with tickNum = 40 from client 2.
  *
+ * Events are stored in a ring of vectors, one per tick in the window. Each
+ * vector is cleared (not freed) when we advance past its tick, so once the
+ * vectors have grown to fit the usual load, sorting doesn't allocate.
+ *
  * Not thread safe, use an EventQueue first to move events across threads.
  */
 template<typename T>
@@ -48,58 +53,81 @@ class EventSorter : public SorterBase
 {
 public:
     /**
-     * The max valid positive difference between an incoming tickNum and our
-     * currentTick that we'll accept. If 10, the valid range is [currentTick,
-     * currentTick + 10). Effectively, how far into the future we'll buffer
-     * messages for.
+     * @param inWindowSize The max valid positive difference between an
+     *                     incoming tickNum and our currentTick that we'll
+     *                     accept. If 10, the valid range is [currentTick,
+     *                     currentTick + 10). Effectively, how far into the
+     *                     future we'll buffer events for.
+     * @param reservedEventsPerTick How many events to reserve space for in
+     *                              each tick's vector.
      */
-    static constexpr Sint64 BUFFER_SIZE = 10;
-
-    EventSorter()
-    : currentTick(0)
+    EventSorter(std::size_t inWindowSize, std::size_t reservedEventsPerTick)
+    : windowSize{inWindowSize}
+    , eventBuffer(windowSize)
+    , currentTick{0}
+    , tooLowCount{0}
+    , tooHighCount{0}
     {
+        AM_ASSERT(inWindowSize > 0, "Event sorter window must be non-zero.");
+
+        for (std::vector<T>& events : eventBuffer) {
+            events.reserve(reservedEventsPerTick);
+        }
     }
 
     /**
-     * Returns a pointer to the queue holding events for the current tick.
+     * Returns the events for the current tick, in the order that they were
+     * pushed.
+     *
+     * The events will be cleared when advance() is called.
      */
-    std::queue<T>& getCurrentQueue()
+    std::vector<T>& getCurrentEvents()
     {
-        return queueBuffer[currentTick % BUFFER_SIZE];
+        return eventBuffer[currentTick % windowSize];
     }
 
     /**
-     * Advances this sorter to the next tick.
+     * Clears the current tick's events and advances this sorter to the next
+     * tick.
      */
     void advance()
     {
-        // Advance the state.
+        eventBuffer[currentTick % windowSize].clear();
         currentTick++;
     }
 
     /**
-     * If tickNum is valid, buffers the message.
+     * If tickNum is valid, moves the event into the buffer. Otherwise, leaves
+     * the event untouched (so the caller can still use it) and counts it as
+     * too low or too high.
      *
-     * @return True if tickNum was valid and the message was pushed, else false.
+     * @return The validity of tickNum. The event was only moved if Valid.
      */
-    ValidityResult push(const T& event, Uint32 tickNum)
+    ValidityResult push(T&& event, Uint32 tickNum)
     {
         // Check validity of the event's tick.
-        ValidityResult validity = isTickValid(tickNum);
+        ValidityResult validity{isTickValid(tickNum)};
 
         // If tickNum is valid, push the event.
         if (validity == ValidityResult::Valid) {
-            queueBuffer[tickNum % BUFFER_SIZE].push(std::move(event));
+            eventBuffer[tickNum % windowSize].push_back(std::move(event));
+        }
+        else if (validity == ValidityResult::TooLow) {
+            tooLowCount++;
+        }
+        else {
+            tooHighCount++;
         }
 
         return validity;
     }
 
     /** Helper for checking if a tick number is within the bounds. */
-    ValidityResult isTickValid(Uint32 tickNum)
+    ValidityResult isTickValid(Uint32 tickNum) const
     {
         // Check if tickNum is within our lower and upper bounds.
-        Uint32 upperBound = (currentTick + BUFFER_SIZE - 1);
+        Uint32 upperBound{
+            static_cast<Uint32>(currentTick + windowSize - 1)};
         if (tickNum < currentTick) {
             return ValidityResult::TooLow;
         }
@@ -118,20 +146,41 @@ public:
      *       Simulation's currentTick instead. This is just to see where the
      *       sorter is at.
      */
-    Uint32 getCurrentTick() { return currentTick; }
+    Uint32 getCurrentTick() const { return currentTick; }
+
+    /**
+     * Returns the total number of events that were pushed with a tick that
+     * we had already passed.
+     */
+    std::size_t getTooLowCount() const { return tooLowCount; }
+
+    /**
+     * Returns the total number of events that were pushed with a tick that
+     * was beyond the end of the window.
+     */
+    std::size_t getTooHighCount() const { return tooHighCount; }
 
 private:
+    /** How many ticks into the future we'll buffer events for. */
+    std::size_t windowSize;
+
     /**
-     * Holds the queues used for sorting and storing events.
+     * Holds the events for each tick in the window.
      *
-     * Holds events at an index equal to their tick number % BUFFER_SIZE.
+     * Holds events at an index equal to their tick number % windowSize.
      */
-    std::array<std::queue<T>, BUFFER_SIZE> queueBuffer;
+    std::vector<std::vector<T>> eventBuffer;
 
     /**
      * The current tick that we've advanced to.
      */
     Uint32 currentTick;
+
+    /** The number of events that were pushed too late to be buffered. */
+    std::size_t tooLowCount;
+
+    /** The number of events that were pushed too early to be buffered. */
+    std::size_t tooHighCount;
 };
 
 } // namespace Server
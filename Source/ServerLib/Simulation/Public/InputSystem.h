@@ -37,8 +37,10 @@ private:
      * a flag so the NetworkUpdateSystem knows that a drop occurred.
      *
      * @param clientID  The ID of the client that we had to drop a message from.
+     * @param validity  Why the message was dropped.
      */
-    void handleDroppedMessage(NetworkID clientID);
+    void handleDroppedMessage(NetworkID clientID,
+                              SorterBase::ValidityResult validity);
 
     /** Used to get the current tick. */
     Simulation& simulation;
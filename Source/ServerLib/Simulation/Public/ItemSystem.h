@@ -34,6 +34,9 @@ public:
     /**
      * Processes the "Use On" item interactions (combine items, use item on
      * entity).
+     *
+     * Also resumes any entity item handler scripts that are waiting on a
+     * later tick.
      */
     void processUseItemInteractions();
 
@@ -99,7 +102,8 @@ private:
                            Item& item);
 
     /**
-     * Runs the given item handler script on the given target entity.
+     * Starts running the given item handler script on the given target
+     * entity. The script may yield and finish on a later tick.
      *
      * If the script fails, an appropriate error message will be sent.
      *
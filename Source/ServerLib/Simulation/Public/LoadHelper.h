@@ -1,5 +1,6 @@
 #pragma once
 
+#include "PersistedComponentDefs.h"
 #include "entt/fwd.hpp"
 #include <SDL3/SDL_stdinc.h>
 #include <span>
@@ -12,6 +13,8 @@ namespace Server
 class World;
 class Simulation;
 class ItemData;
+struct StagedEntity;
+struct EntityLoadBatch;
 
 /**
  * Helper class for loading persisted world state.
@@ -23,9 +26,27 @@ public:
 
     /**
      * Loads saved non-client entities and adds them to the registry.
+     *
+     * Loading is pipelined: a reader thread pulls rows from the database in
+     * batches, a pool of worker threads parses, deserializes, and migrates
+     * them, and the calling thread adds them to the registry in the order
+     * that they were read.
+     *
+     * If Config::ENTITY_PERSISTENCE_FORMAT is Columnar, loads each component
+     * column instead (see loadColumnarEntities()).
+     *
+     * If the configured format has no saved data but the other format does,
+     * loads from the other format and sets entityFormatNeedsMigration.
      */
     void loadNonClientEntities();
 
+    /**
+     * @return true if the last loadNonClientEntities() call loaded from the
+     *         format that isn't configured, so the entities need to be
+     *         re-saved in the configured format.
+     */
+    bool getEntityFormatNeedsMigration() const;
+
     /**
      * Loads saved item definitions.
      */
@@ -43,9 +64,76 @@ private:
         std::span<const Uint8> payload;
     };
 
-    void loadEntity(entt::entity entity,
-                    std::span<const Uint8> serializedEngineComponents,
-                    std::span<const Uint8> serializedProjectComponents);
+    struct SerializedColumn {
+        PersistedComponentSet componentSet;
+        Uint16 typeID;
+        Uint16 version;
+        std::vector<Uint8> data;
+    };
+
+    /**
+     * (Row format) Loads each entity's row, using a reader thread and a pool
+     * of worker threads (see loadNonClientEntities()).
+     */
+    void loadRowEntities();
+
+    /**
+     * (Columnar format) Creates each entity from the Position column, then
+     * bulk-adds each other component column to its storage.
+     */
+    void loadColumnarEntities();
+
+    /**
+     * Returns the column in columns with the given set and type ID, or
+     * nullptr if there isn't one.
+     */
+    static const SerializedColumn*
+        findColumn(const std::vector<SerializedColumn>& columns,
+                   PersistedComponentSet componentSet, Uint16 typeID);
+
+    /**
+     * Adds each column in columns that belongs to ComponentList to the
+     * registry (except for Position).
+     */
+    template<typename ComponentList>
+    void addColumns(const std::vector<SerializedColumn>& columns);
+
+    /**
+     * Deserializes each record in column as Entry::Component, migrating them
+     * if necessary.
+     *
+     * @param entitiesMustExist If true, records for entities that aren't in
+     *                          the registry are skipped.
+     */
+    template<typename Entry>
+    void deserializeColumn(
+        const SerializedColumn& column, bool entitiesMustExist,
+        std::vector<entt::entity>& entities,
+        std::vector<typename Entry::Component>& components) const;
+
+    /**
+     * Parses, deserializes, and migrates each entity in the given batch,
+     * filling in its stagedEntities.
+     *
+     * Note: This runs on a worker thread, so it must not touch the registry.
+     */
+    void stageBatch(EntityLoadBatch& batch) const;
+
+    /**
+     * Parses, deserializes, and migrates the given entity's components into
+     * stagedEntity.
+     *
+     * @return true if the entity can be loaded, else false.
+     */
+    bool stageEntity(entt::entity entity,
+                     std::span<const Uint8> serializedEngineComponents,
+                     std::span<const Uint8> serializedProjectComponents,
+                     StagedEntity& stagedEntity) const;
+
+    /**
+     * Adds the given staged entity and its components to the registry.
+     */
+    void addStagedEntity(StagedEntity& stagedEntity);
 
     /**
      * Parses the serializedComponents buffer, building up a list of each 
@@ -57,18 +145,23 @@ private:
         const char* componentSetName) const;
 
     /**
-     * Loads all valid engine components in serializedComponents onto entity.
+     * Adds each engine component in stagedEntity to its entity.
      */
-    void loadEngineComponents(
-        entt::entity entity,
-        const std::vector<SerializedComponent>& serializedComponents);
+    void addEngineComponents(entt::entity entity,
+                             StagedEntity& stagedEntity);
 
     /**
-     * Loads all valid project components in serializedComponents onto entity.
+     * Adds the given engine component to entity, along with any components
+     * that it implies.
      */
-    void loadProjectComponents(
-        entt::entity entity,
-        const std::vector<SerializedComponent>& serializedComponents);
+    template<typename Component>
+    void addEngineComponent(entt::entity entity, const Component& component);
+
+    /**
+     * Adds each project component in stagedEntity to its entity.
+     */
+    void addProjectComponents(entt::entity entity,
+                              StagedEntity& stagedEntity);
 
     /**
      * For any components in serializedComponents that exist in ComponentList, 
@@ -80,13 +173,13 @@ private:
      * skipped.
      *
      * @param componentCallback A function of the form 
-     * void(const auto& component) that expects the deserialized component.
+     * void(auto&& component) that expects the deserialized component.
      */
     template<typename ComponentList, typename ComponentCallback>
     void loadComponents(
         entt::entity entity,
         const std::vector<SerializedComponent>& serializedComponents,
-        ComponentCallback&& componentCallback);
+        ComponentCallback&& componentCallback) const;
 
     /**
      * Deserializes serializedComponent as Entry::Component.
@@ -101,7 +194,7 @@ private:
     template<typename Entry>
     bool deserializeComponent(entt::entity entity,
                               const SerializedComponent& serializedComponent,
-                              typename Entry::Component& component);
+                              typename Entry::Component& component) const;
 
     /**
      * Initializes components with lazy-updated timers.
@@ -111,6 +204,10 @@ private:
     World& world;
     Simulation& simulation;
     ItemData& itemData;
+
+    /** If true, the loaded entities came from the format that isn't
+        configured. */
+    bool entityFormatNeedsMigration;
 };
 
 } // namespace Server
@@ -1,5 +1,6 @@
 #pragma once
 
+#include "LuaScriptCache.h"
 #include "sol/sol.hpp"
 #include "entt/fwd.hpp"
 
@@ -12,7 +13,9 @@ namespace Server
  *
  * Condition scripts are much more limited than other dialogue scripts. They
  * only have access to getters, and will always be made into the form:
- * "r = (given script)" where r must hold a boolean type after evaluation.
+ * "return (given script)" where the returned value must be a boolean. The
+ * closing paren goes on its own line, so a trailing comment in the script
+ * can't hide it.
  *
  * Contains additional members that are set by the script runner to pass
  * relevant data to the environment's bound functions.
@@ -25,6 +28,10 @@ struct DialogueChoiceConditionLua {
           "GLOBAL": A constant used to identify the global value store. */
     sol::state luaState{};
 
+    /** Compiled condition scripts, so we don't recompile them on every run.
+        Must be declared after luaState, so it's destroyed first. */
+    LuaScriptCache scriptCache{"return (", "\n)"};
+
     /** The network ID of the client that is controlling the dialogue. */
     NetworkID clientID{0};
 };
@@ -2,6 +2,7 @@
 
 #include "DialogueEvent.h"
 #include "NetworkID.h"
+#include "LuaScriptCache.h"
 #include "sol/sol.hpp"
 #include "entt/fwd.hpp"
 
@@ -25,6 +26,10 @@ struct DialogueLua {
           "GLOBAL": A constant used to identify the global value store. */
     sol::state luaState{};
 
+    /** Compiled scripts, so we don't recompile them on every run.
+        Must be declared after luaState, so it's destroyed first. */
+    LuaScriptCache scriptCache{};
+
     /** The network ID of the client that is controlling the dialogue. */
     NetworkID clientID{0};
 
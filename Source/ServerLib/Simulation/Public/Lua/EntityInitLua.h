@@ -1,5 +1,6 @@
 #pragma once
 
+#include "LuaScriptCache.h"
 #include "sol/sol.hpp"
 #include "entt/fwd.hpp"
 
@@ -17,6 +18,10 @@ struct EntityInitLua {
     /** Lua environment for entity init script processing. */
     sol::state luaState{};
 
+    /** Compiled scripts, so we don't recompile them on every run.
+        Must be declared after luaState, so it's destroyed first. */
+    LuaScriptCache scriptCache{};
+
     /** The entity that the init script is being ran on. */
     entt::entity selfEntity{};
 };
@@ -1,6 +1,8 @@
 #pragma once
 
 #include "NetworkID.h"
+#include "LuaScriptCache.h"
+#include "LuaCoroutineScheduler.h"
 #include "sol/sol.hpp"
 
 namespace AM
@@ -26,6 +28,15 @@ struct EntityItemHandlerLua {
           "GLOBAL": A constant used to identify the global value store. */
     sol::state luaState{};
 
+    /** Compiled scripts, so we don't recompile them on every run.
+        Must be declared after luaState, so it's destroyed first. */
+    LuaScriptCache scriptCache{};
+
+    /** Runs handler scripts as coroutines, so they can wait(ticks) and be
+        spread across multiple ticks.
+        Must be declared after scriptCache, so it's destroyed first. */
+    LuaCoroutineScheduler scheduler{luaState, scriptCache};
+
     /** The network ID of the client that used the item. */
     NetworkID clientID{0};
 
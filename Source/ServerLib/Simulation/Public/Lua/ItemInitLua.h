@@ -1,5 +1,6 @@
 #pragma once
 
+#include "LuaScriptCache.h"
 #include "sol/sol.hpp"
 #include "entt/fwd.hpp"
 
@@ -20,6 +21,10 @@ struct ItemInitLua {
     /** Lua environment for item init script processing. */
     sol::state luaState{};
 
+    /** Compiled scripts, so we don't recompile them on every run.
+        Must be declared after luaState, so it's destroyed first. */
+    LuaScriptCache scriptCache{};
+
     /** The item that the init script is being ran on.
         Will always be non-nullptr while a script is running. */
     Item* selfItem{};
@@ -0,0 +1,152 @@
+#pragma once
+
+#include "LuaScriptBudget.h"
+#include "LuaScriptCache.h"
+#include "TimingWheel.h"
+#include "sol/sol.hpp"
+#include <SDL3/SDL_stdinc.h>
+#include <functional>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace AM
+{
+namespace Server
+{
+/**
+ * Runs scripts as coroutines, so they can be spread across multiple ticks.
+ *
+ * A script may yield by calling wait(ticks), or by running past its time
+ * slice (Config::LUA_SCRIPT_TIME_BUDGET_S). Yielded scripts are queued, and
+ * resumed by resumeScripts() on a later tick. Scripts that wait for more than
+ * a tick are parked in a timing wheel until they're due, so waiting scripts
+ * don't cost anything per-tick.
+ *
+ * The total time spent running scripts each tick, including newly started
+ * ones, is capped by Config::LUA_COROUTINE_TICK_BUDGET_S. Any scripts that
+ * don't fit in the current tick wait for the next one.
+ *
+ * Since yielded scripts are resumed later, any context that they rely on
+ * (globals, members of the Lua environment struct) must be restored before
+ * each resume. Callers provide a function for this when starting a script.
+ */
+class LuaCoroutineScheduler
+{
+public:
+    /** Restores the context that a script expects before it's resumed.
+        Returns false if the context is no longer valid (e.g. its entity was
+        destroyed), in which case the script is cancelled. */
+    using RestoreContextFunction = std::function<bool()>;
+
+    /** Reports an error that a script raised. */
+    using ReportErrorFunction = std::function<void(std::string_view)>;
+
+    LuaCoroutineScheduler(sol::state& inLuaState,
+                          LuaScriptCache& inScriptCache);
+
+    /**
+     * Starts running the given script as a coroutine.
+     *
+     * If there's time left in this tick's budget, the script starts running
+     * immediately. Otherwise, it's queued for the next tick.
+     *
+     * @param restoreContext Called before the script starts and before each
+     *                       resume.
+     * @param reportError Called if the script fails to compile, raises an
+     *                    error, or exceeds its instruction budget.
+     */
+    void start(std::string_view script, RestoreContextFunction restoreContext,
+               ReportErrorFunction reportError);
+
+    /**
+     * Resumes any queued scripts that are due, until they've all ran or this
+     * tick's budget is used up. Should be called once per tick.
+     */
+    void resumeScripts();
+
+    /**
+     * Returns the number of scripts that are waiting to be resumed, including
+     * ones that aren't due yet.
+     */
+    std::size_t getQueueDepth() const;
+
+private:
+    struct ScriptTask {
+        /** The script's cache entry. Used to start the coroutine and record
+            timing statistics.
+            Note: This is shared with the cache, so it stays valid if the
+                  cache drops the script while we're running it. */
+        std::shared_ptr<LuaScriptCache::CachedScript> cachedScript{};
+
+        /** The Lua thread that the coroutine runs on. */
+        sol::thread thread{};
+
+        /** The running script. */
+        sol::coroutine coroutine{};
+
+        /** The script's budget. Its instruction count carries across
+            resumes. */
+        LuaScriptBudget budget{};
+
+        /** The number of ticks to wait before resuming this script. Set when
+            it yields. */
+        Uint32 ticksUntilResume{0};
+
+        RestoreContextFunction restoreContext{};
+
+        ReportErrorFunction reportError{};
+    };
+
+    /**
+     * Restores the given task's context and runs it until it yields, finishes,
+     * or errors.
+     *
+     * @return true if the task yielded and should stay queued, else false.
+     */
+    bool resume(ScriptTask& task);
+
+    /**
+     * Queues the given yielded task to be resumed after its
+     * ticksUntilResume.
+     */
+    void requeue(ScriptTask&& task);
+
+    /**
+     * Returns how much time is left in this tick's script budget, in
+     * seconds.
+     */
+    double getRemainingTickTime() const;
+
+    /** The Lua environment that scripts are ran in. */
+    sol::state& luaState;
+
+    /** Used to get compiled scripts. */
+    LuaScriptCache& scriptCache;
+
+    /** Scripts that have yielded and are due to be resumed. */
+    std::vector<ScriptTask> queuedTasks;
+
+    /** Scripts that are waiting for more than 1 tick, by wait ID. */
+    std::unordered_map<Uint32, ScriptTask> waitingTasks;
+
+    /** The ID to give the next waiting script. */
+    Uint32 nextWaitID;
+
+    /** Moves waiting scripts to queuedTasks when they're due.
+        Advanced once per resumeScripts(). */
+    TimingWheel waitWheel;
+
+    /** The scripts that are being resumed this tick.
+        Scripts are moved here while resuming, so that scripts that are
+        started at the same time don't invalidate our iteration. */
+    std::vector<ScriptTask> resumingTasks;
+
+    /** The time spent running scripts this tick, in seconds. */
+    double tickTimeUsed;
+};
+
+} // namespace Server
+} // namespace AM
@@ -0,0 +1,65 @@
+#pragma once
+
+#include "Timer.h"
+#include "sol/sol.hpp"
+#include <cstddef>
+
+namespace AM
+{
+namespace Server
+{
+/**
+ * Tracks a script's usage of its instruction and time budgets.
+ *
+ * The instruction budget (Config::LUA_SCRIPT_INSTRUCTION_BUDGET) covers the
+ * script's whole lifetime, including every resume if it's a coroutine. The
+ * time limit only covers the current run or resume.
+ */
+struct LuaScriptBudget {
+    /** Used to time the current run or resume. */
+    Timer timer{};
+
+    /** Roughly how many instructions the script has executed. */
+    std::size_t instructionCount{0};
+
+    /** How long the current run or resume may take, in seconds. */
+    double timeLimitS{0};
+
+    /** If true, running out of time yields the script instead of stopping it
+        with an error. Only valid when the script is running as a
+        coroutine. */
+    bool yieldWhenOutOfTime{false};
+};
+
+/**
+ * Enforces the given budget on the given Lua thread until this object is
+ * destroyed.
+ *
+ * Installs a LUA_MASKCOUNT hook that checks the budget every
+ * Config::LUA_SCRIPT_BUDGET_CHECK_INTERVAL instructions. On destruction,
+ * restores whatever hook was installed before (scripts may run other scripts
+ * through bound functions).
+ */
+class LuaScriptBudgetScope
+{
+public:
+    LuaScriptBudgetScope(lua_State* inLuaThread, LuaScriptBudget& budget);
+
+    ~LuaScriptBudgetScope();
+
+    LuaScriptBudgetScope(const LuaScriptBudgetScope&) = delete;
+    LuaScriptBudgetScope& operator=(const LuaScriptBudgetScope&) = delete;
+
+private:
+    /** The thread that we installed the hook on. */
+    lua_State* luaThread;
+
+    /** The hook state that we replaced, so it can be restored. */
+    lua_Hook previousHook;
+    int previousMask;
+    int previousCount;
+    LuaScriptBudget* previousBudget;
+};
+
+} // namespace Server
+} // namespace AM
@@ -0,0 +1,145 @@
+#pragma once
+
+#include "sol/sol.hpp"
+#include <list>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+namespace AM
+{
+namespace Server
+{
+/**
+ * Caches compiled Lua scripts, so that scripts which are ran repeatedly (e.g.
+ * an NPC's init script, or a dialogue choice's action script) only get parsed
+ * and compiled once.
+ *
+ * Scripts are keyed by a hash of their content. Since an edited script has
+ * different content, it simply gets compiled into a new entry. When the cache
+ * grows past Config::LUA_SCRIPT_CACHE_MAX_ENTRIES, the least recently used
+ * entry is dropped.
+ *
+ * Each script run is limited by Config::LUA_SCRIPT_INSTRUCTION_BUDGET and
+ * Config::LUA_SCRIPT_TIME_BUDGET_S (see LuaScriptBudget). If a script exceeds
+ * either budget, it's stopped and returns an error, so a runaway script (e.g.
+ * "while true do end") can't stall the sim.
+ *
+ * Each cached script also tracks how long its runs take. Runs longer than
+ * Config::LUA_SCRIPT_SLOW_RUN_S are logged, to help find slow scripts.
+ *
+ * Each cache must only be used with a single Lua state, and must be destroyed
+ * before that state.
+ */
+class LuaScriptCache
+{
+public:
+    struct CachedScript {
+        /** The script's source, used to resolve hash collisions. */
+        std::string source{};
+
+        /** The compiled script. */
+        sol::protected_function function{};
+
+        /** The number of times this script has been ran. */
+        std::size_t runCount{0};
+
+        /** The total time spent running this script, in seconds. */
+        double totalRunTime{0};
+
+        /** The longest that a single run of this script has taken, in
+            seconds. */
+        double maxRunTime{0};
+    };
+
+    /**
+     * @param inSourcePrefix A string to prepend to each script's source before
+     *                       compiling it (e.g. "return (").
+     * @param inSourceSuffix A string to append to each script's source before
+     *                       compiling it (e.g. ")").
+     */
+    LuaScriptCache(std::string_view inSourcePrefix = "",
+                   std::string_view inSourceSuffix = "");
+
+    /**
+     * Runs the given script in the given state, compiling it first if it
+     * isn't already cached.
+     *
+     * If the script exceeds its instruction or time budget, it's stopped and
+     * the returned result holds an error describing which budget was hit.
+     *
+     * Scripts that fail to compile aren't cached. Instead, the error is
+     * returned the same way that sol::state::script() would return it.
+     */
+    sol::protected_function_result run(sol::state& luaState,
+                                       std::string_view script);
+
+    /**
+     * Returns the cached entry for the given script, compiling it first if
+     * it isn't already cached.
+     *
+     * Used to run scripts in other ways, e.g. as a coroutine. The returned
+     * entry stays valid even if the cache later drops it. If the script
+     * fails to compile, returns nullptr and sets errorString.
+     */
+    std::shared_ptr<CachedScript> getScript(sol::state& luaState,
+                                            std::string_view script,
+                                            std::string& errorString);
+
+    /**
+     * Adds the given run time to the given script's statistics, logging it if
+     * it was slow.
+     *
+     * run() does this automatically. Callers of getScript() may call this
+     * to track their own runs.
+     */
+    void recordRunTime(CachedScript& cachedScript, double runTime);
+
+    /**
+     * Drops every cached script.
+     */
+    void clear();
+
+private:
+    struct CacheEntry {
+        /** The cached script. Shared, so that callers of getScript() can
+            keep using it after it's dropped from the cache. */
+        std::shared_ptr<CachedScript> script{};
+
+        /** This entry's position in lruOrder. */
+        std::list<std::size_t>::iterator lruIt{};
+    };
+
+    /**
+     * Returns the cached entry for the given script, compiling it first if
+     * necessary.
+     *
+     * @param errorString If the script fails to compile, set to the error.
+     * @return The script's entry, or nullptr if it failed to compile.
+     */
+    CacheEntry* findOrCompile(sol::state& luaState, std::string_view script,
+                              std::string& errorString);
+
+    /** A string to prepend to each script's source before compiling it. */
+    std::string sourcePrefix;
+
+    /** A string to append to each script's source before compiling it. */
+    std::string sourceSuffix;
+
+    /** Compiled scripts, keyed by a hash of their source. */
+    std::unordered_map<std::size_t, CacheEntry> cachedScripts;
+
+    /** The hash of each cached script, ordered from most to least recently
+        used. */
+    std::list<std::size_t> lruOrder;
+
+    /** Used to build each prefixed source string. */
+    std::string workString;
+
+    /** Used to hold compilation errors that run() doesn't need. */
+    std::string workError;
+};
+
+} // namespace Server
+} // namespace AM
@@ -11,6 +11,9 @@ class World;
 
 /**
  * Moves entities.
+ *
+ * Only entities that may actually move (those with inputs, or that are
+ * airborne) are processed. See MovementActivityTracker.h.
  */
 class MovementSystem
 {
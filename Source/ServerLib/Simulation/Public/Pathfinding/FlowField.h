@@ -0,0 +1,85 @@
+#pragma once
+
+#include "TilePosition.h"
+#include "TileExtent.h"
+#include "ChunkExtent.h"
+#include "Vector3.h"
+#include <SDL3/SDL_stdinc.h>
+#include <vector>
+
+namespace AM
+{
+namespace Server
+{
+class NavGraph;
+
+/**
+ * A field of directions that lead to a single goal tile, covering a region of
+ * chunks around it.
+ *
+ * Built in 3 passes:
+ *   1. Cost field: each tile's walkability and edges, copied from the
+ *      region's nav chunks.
+ *   2. Integration field: the cost of the shortest path from each tile to
+ *      the goal (Dijkstra's, starting from the goal).
+ *   3. Direction field: for each tile, the direction of the neighbor with
+ *      the lowest integration cost.
+ *
+ * Once built, any number of agents that share the goal can look up their
+ * direction in constant time, instead of each running their own search.
+ */
+class FlowField
+{
+public:
+    /**
+     * Builds a field that leads to the given goal.
+     *
+     * @param chunkExtent The chunks to cover. Any of them that don't have a
+     *                    nav chunk in navGraph are treated as impassable.
+     */
+    FlowField(const TilePosition& inGoalTile, const ChunkExtent& inChunkExtent,
+              const NavGraph& navGraph);
+
+    /**
+     * Returns true if the given point is within this field's region.
+     */
+    bool contains(const Vector3& position) const;
+
+    /**
+     * Returns the normalized direction to move in, from the given point.
+     *
+     * If the point is outside of this field's region, is on the goal tile,
+     * or can't reach the goal, returns a zero vector.
+     */
+    Vector3 getDirection(const Vector3& position) const;
+
+    const TilePosition& getGoalTile() const;
+
+    const ChunkExtent& getChunkExtent() const;
+
+private:
+    /** A direction value, used for tiles that have no direction. */
+    static constexpr Uint8 NO_DIRECTION{8};
+
+    /**
+     * Returns the index of the given tile within directions, or -1 if it's
+     * outside of this field's region.
+     */
+    int getTileIndex(const TilePosition& tilePosition) const;
+
+    /** The tile that this field leads to. */
+    TilePosition goalTile;
+
+    /** The chunks that this field covers. */
+    ChunkExtent chunkExtent;
+
+    /** The tiles that this field covers. */
+    TileExtent tileExtent;
+
+    /** Each tile's direction, as an index into DIRECTION_VECTORS (or
+        NO_DIRECTION). Row-major. */
+    std::vector<Uint8> directions;
+};
+
+} // namespace Server
+} // namespace AM
@@ -0,0 +1,135 @@
+#pragma once
+
+#include "NavGraph.h"
+#include <functional>
+#include <queue>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace AM
+{
+namespace Server
+{
+/**
+ * Finds paths through a NavGraph using HPA* (hierarchical A*).
+ *
+ * First, A* is ran over the abstract graph: each chunk's portals, connected
+ * by their cached intra-chunk distances and by the steps that cross between
+ * chunks. The resulting portal-to-portal path is then refined into tiles by
+ * running A* within each chunk that it passes through.
+ *
+ * Owned and used by a single pathfinding worker. Holds scratch data that's
+ * reused between searches.
+ */
+class HierarchicalPathfinder
+{
+public:
+    enum class Status {
+        /** A path was found. */
+        Found,
+        /** There's no path, or the search gave up. */
+        NotFound,
+        /** The search couldn't finish because some nav chunks haven't been
+            built. Build them and try again. */
+        NeedsChunks
+    };
+
+    HierarchicalPathfinder(NavGraph& inNavGraph);
+
+    /**
+     * Finds a path between the given tiles, which must be on the same Z
+     * level.
+     *
+     * @param mapChunkExtent The map's extent. Chunks outside of it are
+     *                       treated as impassable.
+     * @param outPath If Found is returned, filled with the path's tiles, from
+     *                startTile to goalTile inclusive.
+     * @param outMissingChunks If NeedsChunks is returned, filled with the
+     *                         chunks that need to be built.
+     */
+    Status findPath(const TilePosition& startTile,
+                    const TilePosition& goalTile,
+                    const ChunkExtent& mapChunkExtent,
+                    std::vector<TilePosition>& outPath,
+                    std::vector<ChunkPosition>& outMissingChunks);
+
+private:
+    /**
+     * A node in the abstract graph. Every node is a portal tile, except for
+     * the start and goal nodes.
+     */
+    struct Node {
+        TilePosition tilePosition{};
+        float cost{};
+        int parentIndex{-1};
+        bool isClosed{false};
+    };
+
+    /** The abstract search's open list, ordered by lowest estimated total
+        cost. Each element is a (cost, node index) pair. */
+    using OpenList = std::priority_queue<std::pair<float, int>,
+                                         std::vector<std::pair<float, int>>,
+                                         std::greater<std::pair<float, int>>>;
+
+    /**
+     * Pushes the given node's abstract neighbors into the open list.
+     */
+    void expandNode(int nodeIndex);
+
+    /**
+     * If the given cost is an improvement, updates the tile's node and pushes
+     * it into the open list.
+     */
+    void relaxNode(const TilePosition& tilePosition, float cost,
+                   int parentIndex);
+
+    /**
+     * Returns the given chunk's cluster, or nullptr if it's outside of the
+     * map or isn't ready (in which case, the chunks it needs are added to
+     * missingChunks).
+     */
+    const NavCluster* getCluster(const ChunkPosition& chunkPosition);
+
+    /**
+     * Refines the abstract path that ends at the given node into tiles.
+     *
+     * @return true if successful, else false.
+     */
+    bool refinePath(int goalNodeIndex, std::vector<TilePosition>& outPath);
+
+    /** The graph that we're searching. */
+    NavGraph& navGraph;
+
+    //-------------------------------------------------------------------------
+    // Per-search state
+    //-------------------------------------------------------------------------
+    TilePosition goalTile;
+    ChunkPosition goalChunkPosition;
+    ChunkExtent mapChunkExtent;
+
+    /** The abstract graph nodes that we've reached. The start node is at
+        index 0. */
+    std::vector<Node> nodes;
+
+    /** Maps tile positions -> their index in nodes. */
+    std::unordered_map<TilePosition, int> nodeIndices;
+
+    OpenList openList;
+
+    /** The clusters that we've used. Null if the cluster wasn't available. */
+    std::unordered_map<ChunkPosition, std::shared_ptr<const NavCluster>>
+        clusterCache;
+
+    /** The chunks that clusters couldn't be built for. */
+    std::vector<ChunkPosition> missingChunks;
+
+    /** The distance from the start tile to each tile in its chunk. */
+    NavGraph::ChunkTileArray<float> startDistances;
+
+    /** The distance from the goal tile to each tile in its chunk. */
+    NavGraph::ChunkTileArray<float> goalDistances;
+};
+
+} // namespace Server
+} // namespace AM
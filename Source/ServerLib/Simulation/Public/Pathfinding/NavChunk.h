@@ -0,0 +1,62 @@
+#pragma once
+
+#include "ChunkPosition.h"
+#include "TilePosition.h"
+#include "SharedConfig.h"
+#include <SDL3/SDL_stdinc.h>
+#include <array>
+
+namespace AM
+{
+namespace Server
+{
+/**
+ * An immutable snapshot of a single chunk's walkability, used for
+ * pathfinding.
+ *
+ * Each tile tracks whether it can be stood on, and whether an agent can move
+ * from it to its +x and +y neighbors. Edges to the -x and -y neighbors are
+ * stored by those neighbors (which may be in another chunk).
+ *
+ * Built on the sim thread from the collision locator (see PathfindingSystem),
+ * then shared read-only with the pathfinding workers.
+ */
+struct NavChunk {
+    enum Flag : Uint8 {
+        /** An agent can stand on this tile. */
+        Walkable = 1 << 0,
+        /** An agent can move from this tile to the tile at x + 1. */
+        PassablePositiveX = 1 << 1,
+        /** An agent can move from this tile to the tile at y + 1. */
+        PassablePositiveY = 1 << 2,
+    };
+
+    /** The chunk that this snapshot was built from. */
+    ChunkPosition position{};
+
+    /** Each tile's flags, in row-major order. */
+    std::array<Uint8, SharedConfig::CHUNK_TILE_COUNT> tileFlags{};
+
+    /**
+     * Returns the flags of the tile at the given chunk-relative coordinates.
+     */
+    Uint8 getFlags(int localX, int localY) const
+    {
+        return tileFlags[(localY * SharedConfig::CHUNK_WIDTH) + localX];
+    }
+
+    /**
+     * Returns the index within tileFlags of the given tile, which must be
+     * within this chunk.
+     */
+    int getTileIndex(const TilePosition& tilePosition) const
+    {
+        TilePosition origin{position};
+        int chunkWidth{static_cast<int>(SharedConfig::CHUNK_WIDTH)};
+        return ((tilePosition.y - origin.y) * chunkWidth)
+               + (tilePosition.x - origin.x);
+    }
+};
+
+} // namespace Server
+} // namespace AM
@@ -0,0 +1,59 @@
+#pragma once
+
+#include "NavChunk.h"
+#include "TilePosition.h"
+#include <memory>
+#include <vector>
+
+namespace AM
+{
+namespace Server
+{
+/**
+ * The abstract graph data for a single chunk, used for hierarchical
+ * pathfinding.
+ *
+ * Each portal is a tile on one of this chunk's borders that an agent can
+ * step across, into a linked tile in the neighboring chunk. A portal is
+ * placed at the middle of each contiguous run of crossable border tiles.
+ *
+ * Derived from this chunk's NavChunk and the NavChunks of its -x and -y
+ * neighbors (which own the edges that cross into this chunk). If any of those
+ * are rebuilt, this cluster is stale and must be rebuilt.
+ */
+struct NavCluster {
+    struct Portal {
+        /** The tile within this chunk. */
+        TilePosition tilePosition{};
+
+        /** The tile in the neighboring chunk that this portal crosses to. */
+        TilePosition linkedTilePosition{};
+    };
+
+    /** The nav chunks that this cluster was derived from. Used to tell if
+        this cluster is stale. May be null if the neighbor is outside of the
+        map. */
+    std::shared_ptr<const NavChunk> navChunk{};
+    std::shared_ptr<const NavChunk> negativeXNavChunk{};
+    std::shared_ptr<const NavChunk> negativeYNavChunk{};
+
+    /** This chunk's portals, on all 4 sides. */
+    std::vector<Portal> portals{};
+
+    /** The shortest path cost between each pair of portals, when staying
+        within this chunk. Row-major, portals.size() squared. Unreachable
+        pairs are infinity. */
+    std::vector<float> distances{};
+
+    /**
+     * Returns the cost of moving between the given portals, staying within
+     * this chunk.
+     */
+    float getDistance(std::size_t fromIndex, std::size_t toIndex) const
+    {
+        return distances[(fromIndex * portals.size()) + toIndex];
+    }
+};
+
+} // namespace Server
+} // namespace AM
@@ -0,0 +1,126 @@
+#pragma once
+
+#include "NavChunk.h"
+#include "NavCluster.h"
+#include "ChunkExtent.h"
+#include <array>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace AM
+{
+namespace Server
+{
+/**
+ * Holds the pathfinding data for the tile map: a NavChunk per built chunk,
+ * and a lazily-built NavCluster per chunk.
+ *
+ * Nav chunks are only added or removed by the sim thread (see
+ * PathfindingSystem). Everything else is safe to call from the pathfinding
+ * workers.
+ *
+ * Note: Paths are searched on a single Z level. Each chunk is 1 tile tall, so
+ *       each nav chunk is also a single Z level.
+ */
+class NavGraph
+{
+public:
+    /** An array with an element per tile in a chunk, in row-major order. */
+    template<typename T>
+    using ChunkTileArray = std::array<T, SharedConfig::CHUNK_TILE_COUNT>;
+
+    /**
+     * Returns the nav chunk at the given position, or nullptr if it hasn't
+     * been built.
+     */
+    std::shared_ptr<const NavChunk>
+        getNavChunk(const ChunkPosition& chunkPosition) const;
+
+    /**
+     * Adds the given nav chunk, replacing any existing one at its position.
+     * Sim thread only.
+     */
+    void setNavChunk(std::shared_ptr<const NavChunk> navChunk);
+
+    /**
+     * Removes the nav chunk at the given position, along with any clusters
+     * that were derived from it. Sim thread only.
+     */
+    void eraseNavChunk(const ChunkPosition& chunkPosition);
+
+    /**
+     * Returns the cluster for the given chunk, building it if it's missing or
+     * stale.
+     *
+     * @param mapChunkExtent The map's extent. Chunks outside of it are
+     *                       treated as impassable.
+     * @param missingChunks If null is returned because a nav chunk that the
+     *                      cluster depends on hasn't been built, its position
+     *                      is pushed into this vector.
+     * @return The cluster, or nullptr if the chunk is outside of the map or
+     *         isn't ready.
+     */
+    std::shared_ptr<const NavCluster>
+        getCluster(const ChunkPosition& chunkPosition,
+                   const ChunkExtent& mapChunkExtent,
+                   std::vector<ChunkPosition>& missingChunks);
+
+    /**
+     * Returns the chunk that contains the given tile.
+     *
+     * Note: ChunkPosition(TilePosition) truncates, which puts negative tiles
+     *       in the wrong chunk. This floors instead.
+     */
+    static ChunkPosition toChunkPosition(const TilePosition& tilePosition);
+
+    /**
+     * Fills outDistances with the cost of the shortest path from the given
+     * tile to each tile in the chunk, staying within the chunk. Unreachable
+     * tiles are infinity.
+     */
+    static void findDistances(const NavChunk& navChunk,
+                              const TilePosition& startTile,
+                              ChunkTileArray<float>& outDistances);
+
+    /**
+     * Finds the shortest path between the given tiles, staying within the
+     * chunk.
+     *
+     * @param outPath If a path is found, the tiles after startTile (up to and
+     *                including goalTile) are pushed into this vector.
+     * @return true if a path was found, else false.
+     */
+    static bool findLocalPath(const NavChunk& navChunk,
+                              const TilePosition& startTile,
+                              const TilePosition& goalTile,
+                              std::vector<TilePosition>& outPath);
+
+private:
+    /**
+     * Builds a cluster from the given nav chunks.
+     */
+    static std::shared_ptr<const NavCluster> buildCluster(
+        std::shared_ptr<const NavChunk> navChunk,
+        std::shared_ptr<const NavChunk> negativeXNavChunk,
+        std::shared_ptr<const NavChunk> negativeYNavChunk);
+
+    /** Guards navChunks. */
+    mutable std::shared_mutex navChunksMutex;
+
+    /** The built nav chunks. */
+    std::unordered_map<ChunkPosition, std::shared_ptr<const NavChunk>>
+        navChunks;
+
+    /** Guards clusters. */
+    std::mutex clustersMutex;
+
+    /** The built clusters. May be stale, see NavCluster. */
+    std::unordered_map<ChunkPosition, std::shared_ptr<const NavCluster>>
+        clusters;
+};
+
+} // namespace Server
+} // namespace AM
@@ -0,0 +1,38 @@
+#pragma once
+
+#include "Vector3.h"
+#include <SDL3/SDL_stdinc.h>
+#include <vector>
+
+namespace AM
+{
+namespace Server
+{
+/** Identifies a path request made through PathfindingSystem. */
+using PathRequestID = Uint32;
+
+/**
+ * The result of a path request.
+ */
+struct PathResult {
+    enum class Status {
+        /** A path was found. */
+        Found,
+        /** There's no path between the given points, or the search gave up
+            (see Config::PATHFINDING_MAX_ABSTRACT_EXPANSIONS). */
+        NotFound
+    };
+
+    /** The request that this result is for. */
+    PathRequestID requestID{0};
+
+    Status status{Status::NotFound};
+
+    /** If status == Found, the points to move through, in order. Each point
+        is centered on a tile in the X and Y axis, at the tile's lowest Z.
+        The first point is the start tile's, the last is the goal tile's. */
+    std::vector<Vector3> waypoints{};
+};
+
+} // namespace Server
+} // namespace AM
@@ -0,0 +1,255 @@
+#pragma once
+
+#include "NavGraph.h"
+#include "HierarchicalPathfinder.h"
+#include "FlowField.h"
+#include "PathResult.h"
+#include "TileExtent.h"
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <stop_token>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace AM
+{
+struct Vector3;
+struct BoundingBox;
+
+namespace Server
+{
+struct SimulationContext;
+class World;
+
+/**
+ * Finds paths across the tile map, for NPCs and other server-driven movement.
+ *
+ * Path searches use HPA* (see HierarchicalPathfinder) and run on a pool of
+ * worker threads, so a large number of NPCs can request paths without
+ * stalling the sim. Results are delivered back on the sim thread, through
+ * the callback that was given to requestPath().
+ *
+ * The workers can't touch the collision locator, so the sim thread builds
+ * an immutable NavChunk snapshot of each chunk before any search needs it.
+ * Chunks are built on demand, with a per-tick budget. When tiles change,
+ * the affected nav chunks are thrown out and rebuilt the next time that
+ * they're needed. Each chunk's portal graph (NavCluster) is derived from
+ * the nav chunks and cached by the workers.
+ *
+ * For crowds that share a goal (e.g. chasing the same player), flow fields
+ * can be used instead of individual paths. See getFlowField().
+ *
+ * Tiles are only walkable if something supports them (see hasSupport()).
+ *
+ * Note: Paths are searched on a single Z level, and only consider
+ *       TerrainWall and Object collision (entities are ignored, since they
+ *       move).
+ */
+class PathfindingSystem
+{
+public:
+    /** Called on the sim thread when a path request finishes. */
+    using PathCallback = std::function<void(const PathResult&)>;
+
+    PathfindingSystem(const SimulationContext& inSimContext);
+
+    /**
+     * Requests a path between the given points. The search will be ran on a
+     * worker thread, and the given callback will be called with the result
+     * during a later processPathRequests().
+     *
+     * @return The request's ID, which can be passed to cancelRequest().
+     */
+    PathRequestID requestPath(const Vector3& start, const Vector3& goal,
+                              PathCallback callback);
+
+    /**
+     * Cancels the given request. Its callback won't be called. Does nothing
+     * if the request has already finished.
+     */
+    void cancelRequest(PathRequestID requestID);
+
+    /**
+     * Returns a flow field that leads to the given goal. Agents can then
+     * sample their direction from it.
+     *
+     * Fields are cached per goal cell (Config::FLOW_FIELD_GOAL_CELL_WIDTH)
+     * and cover the chunks within Config::FLOW_FIELD_CHUNK_RADIUS of the
+     * goal. Agents that are outside of a field's region should request a
+     * path instead.
+     *
+     * If the field isn't built yet, it's queued and built by a later
+     * processPathRequests(), within that tick's budget.
+     *
+     * @return The field, or nullptr if it isn't built yet.
+     *
+     * Note: The returned pointer is valid until the next
+     *       invalidateChangedTiles() or processPathRequests().
+     */
+    const FlowField* getFlowField(const Vector3& goal);
+
+    /**
+     * Throws out the nav data for any tiles that were changed this tick, so
+     * that it'll be rebuilt.
+     *
+     * Must be called after this tick's tile updates, and before the tile
+     * update history is cleared.
+     */
+    void invalidateChangedTiles();
+
+    /**
+     * Calls the callbacks of any finished requests, builds the nav chunks
+     * that waiting requests need, and gives ready requests to the workers.
+     * Then, builds any queued flow fields with the remaining budget.
+     */
+    void processPathRequests();
+
+private:
+    /**
+     * A request that hasn't finished yet.
+     */
+    struct PendingRequest {
+        TilePosition startTile{};
+        TilePosition goalTile{};
+        PathCallback callback{};
+
+        /** The nav chunks that need to be built before this request can be
+            given to a worker. */
+        std::vector<ChunkPosition> chunksToBuild{};
+
+        /** How many times this request has been given to a worker. */
+        unsigned int attemptCount{0};
+    };
+
+    /**
+     * A flow field, along with how long it's been since it was used.
+     */
+    struct CachedFlowField {
+        /** The tile that this field leads to. */
+        TilePosition goalTile{};
+
+        /** The chunks that this field covers. */
+        ChunkExtent chunkExtent{};
+
+        /** The field. Empty until it's built. */
+        std::optional<FlowField> flowField{};
+
+        /** How many ticks it's been since this field was last requested. */
+        unsigned int idleTicks{0};
+    };
+
+    /**
+     * A search for a worker to run.
+     */
+    struct PathTask {
+        PathRequestID requestID{0};
+        TilePosition startTile{};
+        TilePosition goalTile{};
+        ChunkExtent mapChunkExtent{};
+    };
+
+    /**
+     * A worker's search result.
+     */
+    struct PathTaskResult {
+        PathRequestID requestID{0};
+        HierarchicalPathfinder::Status status{};
+        std::vector<TilePosition> path{};
+        std::vector<ChunkPosition> missingChunks{};
+    };
+
+    /**
+     * Calls the given request's callback with the given result and erases
+     * it.
+     */
+    void finishRequest(PathRequestID requestID, PathTaskResult& taskResult);
+
+    /**
+     * Builds queued flow fields (and the nav chunks that they cover), until
+     * either budget is used up.
+     *
+     * @param buildCount The number of nav chunks that have been built this
+     *                   tick. Incremented for each chunk that we build.
+     */
+    void buildQueuedFlowFields(unsigned int& buildCount);
+
+    /**
+     * Erases the nav chunks that are affected by a change to the given
+     * tiles.
+     */
+    void invalidateTileExtent(const TileExtent& tileExtent);
+
+    /**
+     * Builds a nav chunk from the current collision state and adds it to
+     * navGraph.
+     */
+    void buildNavChunk(const ChunkPosition& chunkPosition);
+
+    /**
+     * Returns true if the given tile has something for an agent to stand on:
+     * a floor or terrain in the tile, full-height terrain in the tile below,
+     * or the bottom of the map.
+     */
+    bool hasSupport(const TilePosition& tilePosition);
+
+    /**
+     * Returns true if an agent fits in the given volume without touching
+     * any terrain, walls, or objects.
+     */
+    bool isVolumeClear(const BoundingBox& volume);
+
+    /**
+     * Pulls tasks from taskQueue and runs them, until a stop is requested.
+     */
+    void workerLoop(std::stop_token stopToken);
+
+    World& world;
+
+    /** The nav chunks and clusters that we've built. */
+    NavGraph navGraph;
+
+    /** The flow fields that have been requested, by goal cell (see
+        Config::FLOW_FIELD_GOAL_CELL_WIDTH). */
+    std::unordered_map<TilePosition, CachedFlowField> flowFields;
+
+    /** The goal cells of the flow fields that are waiting to be built, in
+        the order that they were requested. */
+    std::deque<TilePosition> flowFieldBuildQueue;
+
+    /** The ID to give the next request. */
+    PathRequestID nextRequestID;
+
+    /** The requests that haven't finished yet. */
+    std::unordered_map<PathRequestID, PendingRequest> pendingRequests;
+
+    /** The requests that are waiting for nav chunks to be built, in the
+        order that they'll be serviced. */
+    std::deque<PathRequestID> chunkWaitQueue;
+
+    /** Guards taskQueue. */
+    std::mutex taskMutex;
+
+    /** Used to wake the workers when a task is added. */
+    std::condition_variable_any taskCondition;
+
+    /** The tasks that are waiting for a worker. */
+    std::deque<PathTask> taskQueue;
+
+    /** Guards taskResults. */
+    std::mutex resultMutex;
+
+    /** The results that the workers have finished. */
+    std::vector<PathTaskResult> taskResults;
+
+    /** The worker threads.
+        Note: Must be declared last, so that the workers are stopped before
+              anything that they use is destroyed. */
+    std::vector<std::jthread> workers;
+};
+
+} // namespace Server
+} // namespace AM
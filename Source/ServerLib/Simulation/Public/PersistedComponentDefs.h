@@ -28,5 +28,27 @@ inline constexpr std::size_t VERSION_OFFSET{2};
 inline constexpr std::size_t PAYLOAD_SIZE_OFFSET{4};
 inline constexpr std::size_t COMPONENT_HEADER_SIZE{8};
 
+/**
+ * The columnar format (see EntityPersistenceFormat.h) instead stores one
+ * blob per persisted component type, alongside the type's set, ID, and
+ * version. Each blob looks like:
+ *   [entityCount][entity][payloadSize][payload][entity][payloadSize]...
+ *
+ * The version in the column applies to every payload in it.
+ */
+inline constexpr std::size_t COLUMN_HEADER_SIZE{4};
+inline constexpr std::size_t COLUMN_RECORD_ENTITY_OFFSET{0};
+inline constexpr std::size_t COLUMN_RECORD_PAYLOAD_SIZE_OFFSET{4};
+inline constexpr std::size_t COLUMN_RECORD_HEADER_SIZE{8};
+
+/**
+ * The persisted component sets. Engine and project components use separate
+ * ID namespaces, so columns are keyed by set and ID.
+ */
+enum class PersistedComponentSet : Uint8 {
+    Engine,
+    Project
+};
+
 } // namespace Server
 } // namespace AM
@@ -0,0 +1,31 @@
+#pragma once
+
+#include "EnginePersistedComponentTypes.h"
+#include "ProjectPersistedComponentTypes.h"
+#include "boost/mp11/algorithm.hpp"
+#include "boost/mp11/list.hpp"
+#include <optional>
+#include <tuple>
+
+namespace AM
+{
+namespace Server
+{
+
+/** Every component type that gets persisted. */
+using PersistedComponentTypes
+    = boost::mp11::mp_append<EnginePersistedComponentTypes::ComponentTypes,
+                             ProjectPersistedComponentTypes::ComponentTypes>;
+
+/**
+ * A copy of each persisted component that an entity possesses.
+ *
+ * Used to move entity data between threads while saving and loading, since
+ * the registry may only be accessed from the sim thread.
+ */
+using PersistedComponentSnapshot = boost::mp11::mp_rename<
+    boost::mp11::mp_transform<std::optional, PersistedComponentTypes>,
+    std::tuple>;
+
+} // namespace Server
+} // namespace AM
@@ -0,0 +1,90 @@
+#pragma once
+
+#include "EnttObserver.h"
+#include "entt/fwd.hpp"
+#include <vector>
+
+namespace AM
+{
+namespace Server
+{
+/**
+ * Tracks which entities need to be saved to or deleted from the database.
+ *
+ * An entity is marked as changed when one of its persisted components (see
+ * PersistedComponentTypes) is constructed, updated, or removed. When an entity
+ * is destroyed, it's dropped from the changed set (so its ID can be safely
+ * reused) and, if it isn't a client entity, recorded as destroyed.
+ *
+ * Note: Persisted component changes that don't go through the registry's
+ *       patch()/replace() won't be observed. In those cases, call
+ *       markChanged() manually.
+ */
+class PersistedEntityTracker
+{
+public:
+    PersistedEntityTracker(entt::registry& inRegistry);
+
+    ~PersistedEntityTracker();
+
+    /**
+     * Marks the given entity as changed.
+     */
+    void markChanged(entt::entity entity);
+
+    /**
+     * Returns the entities that have changed since the last clear().
+     *
+     * Note: May include client entities. Never includes destroyed entities.
+     */
+    const EnttObserver& getChangedEntities() const;
+
+    /**
+     * Returns the non-client entities that have been destroyed since the
+     * last clear().
+     */
+    const std::vector<entt::entity>& getDestroyedEntities() const;
+
+    /**
+     * Forgets all changed and destroyed entities.
+     */
+    void clear();
+
+private:
+    /**
+     * Marks the given entity as changed.
+     */
+    void onComponentDestroyed(entt::entity entity);
+
+    /**
+     * Records that the given entity is a client entity.
+     */
+    void onClientSimDataDestroyed(entt::entity entity);
+
+    /**
+     * Removes the given entity from the changed set, and records it as
+     * destroyed if it isn't a client entity.
+     */
+    void onEntityDestroyed(entt::entity entity);
+
+    /** Used to disconnect our listeners. */
+    entt::registry& registry;
+
+    /** The entities that have changed since the last clear(). Entities are
+        added automatically when a persisted component is constructed or
+        updated. */
+    EnttObserver changedEntities;
+
+    /** The non-client entities that have been destroyed since the last
+        clear(). */
+    std::vector<entt::entity> destroyedEntities;
+
+    /** The last entity to have its ClientSimData removed.
+        Note: When an entity is destroyed, its components are removed before
+              its own destroy signal fires, so this is the only way to tell
+              if it was a client. */
+    entt::entity lastClientEntity;
+};
+
+} // namespace Server
+} // namespace AM
@@ -2,7 +2,7 @@
 
 #include "ItemID.h"
 #include "Timer.h"
-#include "BinaryBuffer.h"
+#include "PersistedEntityTracker.h"
 #include <vector>
 
 namespace AM
@@ -13,25 +13,51 @@ struct SimulationContext;
 class Simulation;
 class World;
 class ItemData;
+struct SaveBatch;
 
 /**
  * Periodically saves the world's data:
- *   Tile map data is saved to TileMap.bin.
- *   Non-client entity data is saved to the database.
- *   Item data is saved to the database.
+ *   Changed tile map chunks are saved to the map's chunk store.
+ *   Changed non-client entity data is saved to the database.
+ *   Changed item data is saved to the database.
+ *
+ * Entity changes and destruction are tracked by PersistedEntityTracker. Code
+ * that modifies a persisted component in-place must call registry.patch() so
+ * that the change gets saved.
+ *
+ * To keep saves from stalling the sim, the sim thread only captures copies
+ * of the changed data. The copies are then serialized and written to the
+ * database on the database's backup thread, before it backs up to file. We
+ * don't start a new save until the last one has been backed up.
  */
 class SaveSystem
 {
 public:
     SaveSystem(const SimulationContext& inSimContext);
 
+    ~SaveSystem();
+
     /**
-     * If data is due for saving, saves it.
+     * If data is due for saving and the last save has finished, saves it.
      *
      * Configure through Config::SAVE_PERIOD.
      */
     void saveIfNecessary();
 
+    /**
+     * Forgets any entity changes that have been observed since the last save.
+     * Used after loading, since the loaded entities are already saved.
+     */
+    void clearChangedEntities();
+
+    /**
+     * Marks every non-client entity as changed, and deletes the other
+     * entity persistence format's data on the next save.
+     * Used after loading entities that were saved in the format that isn't
+     * configured (see LoadHelper::getEntityFormatNeedsMigration()).
+     */
+    void migrateEntityPersistenceFormat();
+
 private:
     /**
      * Adds the given item to updatedItems.
@@ -39,20 +65,38 @@ private:
     void itemUpdated(ItemID itemID);
 
     /**
-     * Saves non-client entities to the in-memory database.
+     * Copies the data of any non-client entities that have changed since the
+     * last save into the given batch, and records any that were destroyed.
+     *
+     * If Config::ENTITY_PERSISTENCE_FORMAT is Columnar, instead captures
+     * the columns of each component type that changed.
      */
-    void saveNonClientEntities();
+    void captureNonClientEntities(SaveBatch& saveBatch);
 
     /**
-     * Saves items to the in-memory database.
+     * (Columnar format) Copies each changed column of non-client entity
+     * components into the given batch.
      */
-    void saveItems();
+    void captureComponentColumns(SaveBatch& saveBatch);
 
     /**
-     * Saves World::storedValueIDMap and World::globalStoredValueMap to the
-     * in-memory database.
+     * (Columnar format) Marks Component's column as changed, if entity isn't
+     * a client entity.
      */
-    void saveStoredValues();
+    template<typename Component>
+    void onColumnChanged(entt::registry& registry, entt::entity entity);
+
+    /**
+     * Copies any items that have changed since the last save into the given
+     * batch.
+     */
+    void captureItems(SaveBatch& saveBatch);
+
+    /**
+     * Copies World::storedValueIDMap and World::globalStoredValueMap into the
+     * given batch.
+     */
+    void captureStoredValues(SaveBatch& saveBatch);
 
     Simulation& simulation;
     World& world;
@@ -62,12 +106,23 @@ private:
         Used to know which items need to be saved. */
     std::vector<ItemID> updatedItems;
 
+    /** Tracks changed and destroyed non-client entities.
+        Used to know which entities need to be saved or deleted. */
+    PersistedEntityTracker persistedEntityTracker;
+
+    /** (Columnar format) If true, the component type at the same index in
+        PersistedComponentTypes has changed since the last save. */
+    std::vector<bool> changedColumns;
+
+    /** If true, the next save will delete the entity data that's stored in
+        the format that isn't configured. */
+    bool deleteOldEntityFormat;
+
     /** Used to track how much time has passed since the last save. */
     Timer saveTimer;
 
-    /** Scratch buffers used while serializing data. */
-    BinaryBuffer workBuffer1;
-    BinaryBuffer workBuffer2;
+    /** Used to measure how long the sim thread spends on each save. */
+    Timer captureTimer;
 };
 
 } // namespace Server
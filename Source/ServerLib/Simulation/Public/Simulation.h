@@ -5,9 +5,11 @@
 #include "ClientConnectionSystem.h"
 #include "NceLifetimeSystem.h"
 #include "ComponentChangeSystem.h"
+#include "ChunkResidencySystem.h"
 #include "TileUpdateSystem.h"
 #include "InputSystem.h"
 #include "MovementSystem.h"
+#include "PathfindingSystem.h"
 #include "AISystem.h"
 #include "CastSystem.h"
 #include "ItemSystem.h"
@@ -19,6 +21,8 @@
 #include "ChunkStreamingSystem.h"
 #include "ScriptDataSystem.h"
 #include "SaveSystem.h"
+#include "TimingWheel.h"
+#include "FrameArena.h"
 #include <SDL3/SDL_stdinc.h>
 #include <atomic>
 #include <memory>
@@ -54,6 +58,11 @@ public:
     /** An unreasonable amount of time for the sim tick to be late by. */
     static constexpr double SIM_DELAYED_TIME_S{.001};
 
+    /** The initial size of frameArena's buffer, in bytes. If a tick needs
+        more than this, the arena will fall back to the heap for the rest of
+        that tick. */
+    static constexpr std::size_t FRAME_ARENA_SIZE{4 * 1024 * 1024};
+
     Simulation(const SimulationContext& inSimContext);
 
     ~Simulation();
@@ -72,11 +81,33 @@ public:
     DialogueLua& getDialogueLua();
     DialogueChoiceConditionLua& getDialogueChoiceConditionLua();
 
+    /**
+     * Returns a reference to the simulation's pathfinding system, for making
+     * path requests.
+     */
+    PathfindingSystem& getPathfindingSystem();
+
+    /**
+     * Returns a reference to the simulation's timing wheel, for scheduling
+     * callbacks on future ticks.
+     *
+     * Due timers are fired once per tick, after casts are processed.
+     */
+    TimingWheel& getTimingWheel();
+
     /**
      * Returns the simulation's current tick number.
      */
     Uint32 getCurrentTick() const;
 
+    /**
+     * Returns the arena used for this tick's temporary allocations.
+     * Everything allocated from it is freed at the end of the tick, so it
+     * must only be used for data that won't outlive the current tick (e.g.
+     * outgoing message structs, which get serialized immediately).
+     */
+    FrameArena& getFrameArena();
+
     /**
      * Updates accumulatedTime. If greater than the tick timestep, processes
      * the next sim iteration.
@@ -110,12 +141,21 @@ private:
     /** Lua environment for dialogue choice condition script processing. */
     std::unique_ptr<DialogueChoiceConditionLua> dialogueChoiceConditionLua;
 
+    /** Per-tick scratch memory. Reset at the end of each tick.
+        Note: Must be declared before the systems, since they may use it. */
+    FrameArena frameArena;
+
     /** The world's state. */
     World world;
 
     /** The tick number that we're currently on. */
     std::atomic<Uint32> currentTick;
 
+    /** Fires scheduled callbacks (cast completions, the project's delayed
+        events, etc) when their tick is reached.
+        Note: Must be declared before the systems, since they may use it. */
+    TimingWheel timingWheel;
+
     /** The engine's Lua bindings. */
     EngineLuaBindings engineLuaBindings;
 
@@ -130,9 +170,11 @@ private:
     ClientConnectionSystem clientConnectionSystem;
     NceLifetimeSystem nceLifetimeSystem;
     ComponentChangeSystem componentChangeSystem;
+    ChunkResidencySystem chunkResidencySystem;
     TileUpdateSystem tileUpdateSystem;
     InputSystem inputSystem;
     MovementSystem movementSystem;
+    PathfindingSystem pathfindingSystem;
     AISystem aiSystem;
     CastSystem castSystem;
     ItemSystem itemSystem;
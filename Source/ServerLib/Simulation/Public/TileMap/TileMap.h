@@ -1,6 +1,9 @@
 #pragma once
 
 #include "TileMapBase.h"
+#include "ChunkStore.h"
+#include "TileMapWriter.h"
+#include <string>
 
 namespace AM
 {
@@ -17,45 +20,194 @@ class GraphicData;
  * Owns and manages the world's tile map state.
  * Tiles are conceptually organized into 16x16 chunks.
  *
- * Persisted tile map data is loaded from TileMap.bin.
+ * Persisted tile map data is loaded from a chunk store (TileMap.index and
+ * TileMap.<generation>.chunks, see ChunkStore.h). If the store doesn't exist
+ * but an old-format TileMap.bin does, it'll be converted on startup.
  *
- * Note: This class expects a TileMap.bin file to be present in the same
+ * On startup, we only load the store's index. Each chunk is read from the
+ * (memory-mapped) data file the first time it's needed, so startup time
+ * doesn't depend on the size of the map. Chunks must be loaded through
+ * loadChunkIfNecessary()/loadExtentIfNecessary() before being read or
+ * modified. ChunkResidencySystem keeps the chunks around each entity loaded.
+ *
+ * Chunks that haven't been used in a while can be evicted through
+ * evictChunks(), freeing their memory and collision data. Evicted chunks are
+ * loaded again from the store the next time they're needed.
+ *
+ * Saving only snapshots the chunks that changed since the last save. The
+ * snapshots are then appended to the store by a background thread (see
+ * TileMapWriter), so saving never blocks on disk I/O.
+ *
+ * Note: This class expects the map files to be present in the same
  *       directory as the application executable.
  */
 class TileMap : public TileMapBase
 {
 public:
     /**
-     * Attempts to parse TileMap.bin and construct the tile map.
+     * Attempts to load the chunk store and construct the tile map.
      *
-     * Errors if TileMap.bin doesn't exist or it fails to parse.
+     * Errors if the map files don't exist or they fail to parse.
      */
     TileMap(const GraphicData& inGraphicData,
             CollisionLocator& inCollisionLocator);
 
     /**
-     * Attempts to save the current tile map state to TileMap.bin.
+     * Overload that loads the chunk store at the given path, instead of the
+     * one next to the executable. Used by tests.
+     *
+     * @param chunkStorePath  The path to the store's files, without
+     *                        extension (see ChunkStore()).
+     */
+    TileMap(const GraphicData& inGraphicData,
+            CollisionLocator& inCollisionLocator,
+            const std::string& chunkStorePath);
+
+    /**
+     * Saves any unsaved changes, waiting for the write to finish.
      */
     ~TileMap();
 
     /**
-     * Saves the map to a file with the given name, placed in the same
-     * directory as the program binary.
+     * Saves any chunks that changed since the last save. If the last save
+     * failed to write, its chunks are retried.
+     *
+     * The chunks are snapshotted immediately, but written asynchronously, so
+     * this never blocks on disk I/O.
+     */
+    void save();
+
+    /**
+     * @return true if a save is queued or currently being written, else
+     *         false.
+     */
+    bool saveIsInProgress();
+
+    /**
+     * If the given chunk hasn't been loaded from the chunk store yet, loads
+     * it. Either way, marks it as used on the current tick.
+     */
+    void loadChunkIfNecessary(const ChunkPosition& chunkPosition);
+
+    /**
+     * Loads any chunks within the given extent that haven't been loaded from
+     * the chunk store yet, and marks each chunk as used on the current tick.
+     */
+    void loadExtentIfNecessary(const ChunkExtent& extent);
+
+    /**
+     * Sets the tick that chunk uses will be recorded on.
+     */
+    void setCurrentTick(Uint32 inCurrentTick);
+
+    /**
+     * Evicts chunks that haven't been used in at least maxIdleTicks. If the
+     * loaded chunks use more than memoryBudget bytes, evicts the least
+     * recently used chunks until they fit. Chunks that were used on the
+     * current tick are never evicted.
+     *
+     * Chunks with unsaved changes can't be evicted until they're written
+     * back. If any are found, a save is started and they'll be evicted by a
+     * later call. Similarly, nothing is evicted while a save is in progress,
+     * or while a failed save is being retried.
      *
-     * @param fileName  The file name to save to, with no path prepended.
+     * @return The number of chunks that were evicted.
+     */
+    std::size_t evictChunks(Uint32 maxIdleTicks, std::size_t memoryBudget);
+
+    /**
+     * Returns the number of chunks in the chunk store that haven't been
+     * loaded yet.
+     */
+    std::size_t getUnloadedChunkCount() const;
+
+    /**
+     * Returns the number of chunks that have been loaded on demand (faulted
+     * in) since startup.
+     */
+    std::size_t getChunkFaultInCount() const;
+
+    /**
+     * Returns the number of chunks that have been evicted since startup.
      */
-    void save(const std::string& fileName);
+    std::size_t getChunkEvictionCount() const;
+
+    /**
+     * Returns the number of chunks that are currently loaded.
+     */
+    std::size_t getResidentChunkCount() const;
+
+    /**
+     * Returns the number of bytes used by the loaded chunks, as of the last
+     * call to evictChunks().
+     */
+    std::size_t getResidentChunkMemory() const;
 
 private:
     /**
-     * Loads the given snapshot's data into this map.
+     * Converts the given old-format TileMap.bin into our chunk store.
+     */
+    void convertLegacyMap(const std::string& mapPath);
+
+    /**
+     * Loads the chunk store's header data into this map, and marks each of
+     * its chunks as unloaded.
+     */
+    void load();
+
+    /**
+     * Reads the given chunk from the chunk store and loads it into this map.
+     */
+    void faultInChunk(const ChunkPosition& chunkPosition);
+
+    /**
+     * Removes the given chunk and its collision from this map, and marks it
+     * as unloaded.
+     *
+     * @pre The chunk must exist, and its latest state must be in the chunk
+     *      store.
      */
-    void load(TileMapSnapshot& mapSnapshot);
+    void evictChunk(const ChunkPosition& chunkPosition);
 
     /**
      * Copies the given chunk's data into the given snapshot.
      */
     void saveChunkToSnapshot(const Chunk& chunk, ChunkSnapshot& chunkSnapshot);
+
+    /** The on-disk map. After we're done loading, only tileMapWriter's
+        thread writes to it, and we only read chunks from it. */
+    ChunkStore chunkStore;
+
+    /** The chunks that are in the chunk store, but haven't been loaded into
+        this map yet. */
+    std::unordered_set<ChunkPosition> unloadedChunks;
+
+    /** Scratch snapshot used while faulting in chunks. */
+    ChunkSnapshot faultInSnapshot;
+
+    /** The number of chunks that have been faulted in since startup. */
+    std::size_t chunkFaultInCount;
+
+    /** The tick that chunk uses are recorded on. */
+    Uint32 currentTick;
+
+    /** The tick that each loaded chunk was last used on. Chunks that have
+        been created since the last evictChunks() call may be missing. */
+    std::unordered_map<ChunkPosition, Uint32> chunkLastUsedTicks;
+
+    /** The chunks that may be evicted, as (last used tick, position). Used
+        during evictChunks(). */
+    std::vector<std::pair<Uint32, ChunkPosition>> evictionCandidates;
+
+    /** The number of chunks that have been evicted since startup. */
+    std::size_t chunkEvictionCount;
+
+    /** The number of bytes used by the loaded chunks, as of the last call to
+        evictChunks(). */
+    std::size_t residentChunkMemory;
+
+    /** Writes our saves to disk on a separate thread. */
+    TileMapWriter tileMapWriter;
 };
 
 } // End namespace Server
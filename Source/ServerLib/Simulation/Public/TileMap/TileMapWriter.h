@@ -0,0 +1,127 @@
+#pragma once
+
+#include "ChunkStore.h"
+#include <SDL3/SDL_stdinc.h>
+#include <optional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+
+namespace AM
+{
+namespace Server
+{
+
+/**
+ * Writes tile map saves to disk on a background thread.
+ *
+ * When saving, TileMap snapshots the chunks that changed and hands them to
+ * us. We then serialize them and append them to the chunk store, without
+ * ever blocking the sim thread on disk I/O.
+ *
+ * See ChunkStore for how writes are kept crash-safe.
+ */
+class TileMapWriter
+{
+public:
+    /**
+     * A request to write a map's changes to disk.
+     */
+    struct WriteRequest {
+        /** The map format version. */
+        Uint16 version{0};
+
+        /** The map's lengths, in chunks. */
+        Uint16 xLengthChunks{0};
+        Uint16 yLengthChunks{0};
+        Uint16 zLengthChunks{0};
+
+        /** The chunks that changed since the last request. */
+        ChunkStore::ChunkUpdateMap chunks{};
+    };
+
+    /**
+     * @param inChunkStore  The store to write to. After construction, only
+     *                      our thread may write to it. Other threads may
+     *                      still read chunks from it.
+     */
+    TileMapWriter(ChunkStore& inChunkStore);
+
+    /**
+     * Finishes any pending write, then stops the writer thread.
+     *
+     * If the last write failed, its chunks are retried once more before
+     * stopping.
+     */
+    ~TileMapWriter();
+
+    /**
+     * Queues the given changes to be written to disk.
+     *
+     * If a previously queued write hasn't started yet, this one is merged
+     * into it. If a write is currently underway, this one will start after
+     * it finishes.
+     *
+     * If the last write failed, its chunks are retried along with this one.
+     * A request with no chunks can be used to only retry them.
+     */
+    void write(WriteRequest&& writeRequest);
+
+    /**
+     * @return true if a write is queued or currently being performed, else
+     *         false.
+     */
+    bool writeIsInProgress();
+
+    /**
+     * @return true if the last write failed and its chunks are waiting to be
+     *         retried by the next write, else false.
+     */
+    bool lastWriteFailed();
+
+private:
+    /**
+     * Thread function.
+     * Waits for write() to queue a request, then performs it.
+     */
+    void processWrites();
+
+    /**
+     * Writes the given request to the chunk store.
+     */
+    void performWrite(WriteRequest& writeRequest);
+
+    /**
+     * Performs a write that only contains the failed request's chunks.
+     */
+    void retryFailedRequest();
+
+    /** The store that we write to. */
+    ChunkStore& chunkStore;
+
+    /** Calls processWrites(). */
+    std::thread writeThreadObj;
+    /** Turn true to signal that the writer thread should end. */
+    std::atomic<bool> exitRequested;
+
+    /** Used for signaling the writer thread. */
+    std::mutex writeMutex;
+    std::condition_variable writeCondVar;
+
+    /** The next request to perform. Guarded by writeMutex. */
+    std::optional<WriteRequest> pendingRequest;
+
+    /** true while the writer thread is performing a request. */
+    std::atomic<bool> writeIsActive;
+
+    /** The last request, if it failed to write. Only touched by the writer
+        thread. */
+    WriteRequest failedRequest;
+
+    /** true if failedRequest holds chunks that still need to be written. */
+    std::atomic<bool> writeFailed;
+};
+
+} // End namespace Server
+} // End namespace AM
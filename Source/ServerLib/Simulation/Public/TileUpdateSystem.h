@@ -31,6 +31,16 @@ public:
      */
     void updateTiles();
 
+    /**
+     * Wakes any sleeping entities that are near a tile that was changed this
+     * tick, so that they'll react to the new floor or collision (e.g. fall
+     * through a removed floor).
+     *
+     * Must be called after this tick's tile updates, and before the tile
+     * update history is cleared.
+     */
+    void wakeEntitiesNearUpdates();
+
     /**
      * Sends any dirty tile state to all nearby clients.
      */
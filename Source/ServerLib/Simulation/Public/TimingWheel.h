@@ -0,0 +1,155 @@
+#pragma once
+
+#include <SDL3/SDL_stdinc.h>
+#include <array>
+#include <functional>
+#include <unordered_map>
+#include <vector>
+
+namespace AM
+{
+namespace Server
+{
+/** Identifies a timer that was scheduled through a TimingWheel.
+    0 is never used, so it can be used as a null value. */
+using TimerID = Uint32;
+
+/**
+ * Calls scheduled callbacks when the sim reaches a given tick.
+ *
+ * Timers are stored in a hierarchical timing wheel: 4 levels of 256 slots,
+ * where each level's slots cover 256x as many ticks as the level below it.
+ * Timers that are close to expiring live in level 0, which has 1 slot per
+ * tick. Timers that are further out live in the upper levels, and are moved
+ * ("cascaded") down a level each time the lower levels wrap around.
+ *
+ * This means that scheduling and cancelling are O(1), and advancing a tick
+ * only touches the timers that are due (plus an occasional cascade), no
+ * matter how many timers are waiting.
+ *
+ * Used for cast completions, delayed script resumes, and by the project for
+ * its own delayed sim events (see Simulation::getTimingWheel()).
+ */
+class TimingWheel
+{
+public:
+    /** Called when a timer expires. */
+    using TimerCallback = std::function<void()>;
+
+    /**
+     * @param inCurrentTick The tick that the wheel starts at. Timers will
+     *                      fire on the ticks after it.
+     */
+    TimingWheel(Uint32 inCurrentTick = 0);
+
+    /**
+     * Schedules the given callback to be called when the wheel advances to
+     * the given tick.
+     *
+     * If the given tick has already been reached, the callback will be
+     * called on the next tick.
+     *
+     * @return The timer's ID, which can be passed to cancel().
+     */
+    TimerID schedule(Uint32 targetTick, TimerCallback callback);
+
+    /**
+     * Schedules the given callback to be called the given number of ticks
+     * from now. A delay of 0 is treated as 1.
+     */
+    TimerID scheduleAfter(Uint32 delayTicks, TimerCallback callback);
+
+    /**
+     * Cancels the given timer. Its callback won't be called. Does nothing if
+     * the timer has already fired or been cancelled.
+     */
+    void cancel(TimerID timerID);
+
+    /**
+     * Returns true if the given timer is waiting to fire.
+     */
+    bool isScheduled(TimerID timerID) const;
+
+    /**
+     * Advances the wheel to the given tick, calling the callbacks of any
+     * timers that expire along the way (in tick order).
+     *
+     * Callbacks may schedule or cancel other timers.
+     */
+    void advance(Uint32 targetTick);
+
+    /**
+     * Returns the last tick that the wheel advanced to.
+     */
+    Uint32 getCurrentTick() const;
+
+    /**
+     * Returns the number of timers that are waiting to fire.
+     */
+    std::size_t getTimerCount() const;
+
+private:
+    /** The number of bits of the expiration tick that each level covers. */
+    static constexpr unsigned int SLOT_BITS{8};
+
+    /** The number of slots in each level. */
+    static constexpr unsigned int SLOT_COUNT{1 << SLOT_BITS};
+
+    /** The number of levels. Enough to cover any Uint32 delay. */
+    static constexpr unsigned int LEVEL_COUNT{32 / SLOT_BITS};
+
+    /**
+     * A timer's entry in a slot.
+     * The callback is kept in callbacks, so that cancelling a timer frees it
+     * immediately. Entries for cancelled timers are skipped when their slot
+     * is reached.
+     */
+    struct TimerEntry {
+        TimerID timerID{0};
+        Uint32 expirationTick{0};
+    };
+
+    using Slot = std::vector<TimerEntry>;
+    using Level = std::array<Slot, SLOT_COUNT>;
+
+    /**
+     * Adds the given entry to the slot that matches its expiration tick.
+     */
+    void insert(const TimerEntry& entry);
+
+    /**
+     * Processes the tick after currentTick: cascades any upper level slots
+     * that are due, then fires the timers in the current level 0 slot.
+     */
+    void processNextTick();
+
+    /**
+     * Moves the timers in the given level's current slot down to the lower
+     * levels.
+     */
+    void cascade(unsigned int levelIndex);
+
+    /**
+     * Returns the index of the given tick's slot, within the given level.
+     */
+    static unsigned int getSlotIndex(Uint32 tick, unsigned int levelIndex);
+
+    /** The last tick that we advanced to. */
+    Uint32 currentTick;
+
+    /** The ID to give the next timer. */
+    TimerID nextTimerID;
+
+    /** The wheel's levels. Level 0 has 1 tick per slot. */
+    std::array<Level, LEVEL_COUNT> levels;
+
+    /** The callbacks of each timer that's waiting to fire. */
+    std::unordered_map<TimerID, TimerCallback> callbacks;
+
+    /** The slot that's being fired. Kept as a member so its allocation can
+        be reused. */
+    Slot firingSlot;
+};
+
+} // namespace Server
+} // namespace AM
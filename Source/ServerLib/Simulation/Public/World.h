@@ -4,6 +4,7 @@
 #include "NetworkID.h"
 #include "EntityLocator.h"
 #include "CollisionLocator.h"
+#include "MovementActivityTracker.h"
 #include "EntityStoredValueID.h"
 #include "EntityStoredValueIDMap.h"
 #include "GlobalStoredValueMap.h"
@@ -75,6 +76,11 @@ public:
     /** The tile map that makes up the world. */
     TileMap tileMap;
 
+    /** Tracks which movement-enabled entities are awake and need to be
+        moved. Lives here (instead of in MovementSystem) so that other
+        systems can wake entities when they change the world around them. */
+    MovementActivityTracker movementActivityTracker;
+
     /** Maps entity stored value string IDs -> their associated numeric ID. */
     EntityStoredValueIDMap entityStoredValueIDMap;
 
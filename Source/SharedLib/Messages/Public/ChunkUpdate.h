@@ -3,6 +3,7 @@
 #include "EngineMessageType.h"
 #include "ChunkWireSnapshot.h"
 #include <vector>
+#include <memory_resource>
 
 namespace AM
 {
@@ -22,8 +23,9 @@ public:
        the map can have in the Z direction. */
     static constexpr std::size_t MAX_CHUNKS{9 * 20};
 
-    /** The chunks that the client should load. */
-    std::vector<ChunkWireSnapshot> chunks;
+    /** The chunks that the client should load.
+        Note: The server allocates this from its per-tick frame arena. */
+    std::pmr::vector<ChunkWireSnapshot> chunks;
 };
 
 template<typename S>
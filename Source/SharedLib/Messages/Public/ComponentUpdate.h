@@ -6,6 +6,8 @@
 #include "entt/entity/entity.hpp"
 #include "bitsery/ext/std_variant.h"
 #include "boost/mp11/algorithm.hpp"
+#include <vector>
+#include <memory_resource>
 
 namespace AM
 {
@@ -26,11 +28,11 @@ struct ComponentUpdate {
 
     /** The entity's constructed or updated components (we treat them the
         same). */
-    std::vector<ReplicatedComponent> updatedComponents{};
+    std::pmr::vector<ReplicatedComponent> updatedComponents{};
 
     /** The indices (from ReplicatedComponentTypes) of any of the entity's
         components that were destroyed. */
-    std::vector<Uint8> destroyedComponents{};
+    std::pmr::vector<Uint8> destroyedComponents{};
 };
 
 template<typename S>
@@ -10,6 +10,7 @@
 #include "boost/mp11/algorithm.hpp"
 #include <SDL3/SDL_stdinc.h>
 #include <vector>
+#include <memory_resource>
 
 namespace AM
 {
@@ -39,12 +40,14 @@ struct EntityInit {
         Position position{};
 
         /** This entity's optional client-relevant components. */
-        std::vector<ReplicatedComponent> components{};
+        std::pmr::vector<ReplicatedComponent> components{};
     };
 
     /** The component state of all entities that entered this client's AOI on
-        this tick. */
-    std::vector<EntityData> entityData{};
+        this tick.
+        Note: The server allocates this (and each entry's components) from its
+              per-tick frame arena. */
+    std::pmr::vector<EntityData> entityData{};
 };
 
 template<typename S>
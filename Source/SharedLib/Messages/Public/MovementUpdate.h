@@ -5,6 +5,7 @@
 #include "SharedConfig.h"
 #include <SDL3/SDL_stdinc.h>
 #include <vector>
+#include <memory_resource>
 
 namespace AM
 {
@@ -25,8 +26,9 @@ struct MovementUpdate {
     /** The tick that this update corresponds to. */
     Uint32 tickNum{0};
 
-    /** The new state of all relevant entities that updated on this tick. */
-    std::vector<MovementState> movementStates{};
+    /** The new state of all relevant entities that updated on this tick.
+        Note: The server allocates this from its per-tick frame arena. */
+    std::pmr::vector<MovementState> movementStates{};
 };
 
 template<typename S>
@@ -1,6 +1,7 @@
 #include "CollisionLocator.h"
 #include "SharedConfig.h"
 #include "Tile.h"
+#include "GraphicDataBase.h"
 #include "Cylinder.h"
 #include "BoundingBox.h"
 #include "Collision.h"
@@ -12,17 +13,79 @@
 #include "AMAssert.h"
 #include <cmath>
 #include <algorithm>
+#include <tuple>
 
 namespace AM
 {
-CollisionLocator::CollisionLocator()
+namespace
+{
+/**
+ * Merges the given volumes along the Merge axis, wherever they touch or
+ * overlap and have matching layers, Z bounds, and Other axis bounds.
+ *
+ * MergeVolume is CollisionLocator::TileMergeVolume.
+ */
+template<float Vector3::*Merge, float Vector3::*Other, typename MergeVolume>
+void mergeAlongAxis(std::vector<MergeVolume>& volumes)
+{
+    auto getMergeKey = [](const MergeVolume& volume) {
+        const BoundingBox& box{volume.collisionInfo.collisionVolume};
+        return std::tie(volume.collisionInfo.collisionLayers, box.min.z,
+                        box.max.z, box.min.*Other, box.max.*Other);
+    };
+
+    // Sort the volumes so that mergeable volumes are next to each other,
+    // ordered along the merge axis.
+    std::ranges::sort(volumes, [&](const MergeVolume& a,
+                                   const MergeVolume& b) {
+        return std::tuple_cat(
+                   getMergeKey(a),
+                   std::tie(a.collisionInfo.collisionVolume.min.*Merge))
+               < std::tuple_cat(
+                   getMergeKey(b),
+                   std::tie(b.collisionInfo.collisionVolume.min.*Merge));
+    });
+
+    // Extend each volume to absorb any following volumes that it touches.
+    std::size_t mergedCount{0};
+    for (const MergeVolume& volume : volumes) {
+        if (mergedCount > 0) {
+            MergeVolume& lastVolume{volumes[mergedCount - 1]};
+            BoundingBox& lastBox{lastVolume.collisionInfo.collisionVolume};
+            const BoundingBox& box{volume.collisionInfo.collisionVolume};
+            if ((getMergeKey(lastVolume) == getMergeKey(volume))
+                && (box.min.*Merge <= lastBox.max.*Merge)) {
+                lastBox.max.*Merge
+                    = std::max(lastBox.max.*Merge, box.max.*Merge);
+                lastVolume.sourceTileExtent
+                    = lastVolume.sourceTileExtent.unionWith(
+                        volume.sourceTileExtent);
+                continue;
+            }
+        }
+
+        volumes[mergedCount] = volume;
+        mergedCount++;
+    }
+
+    volumes.resize(mergedCount);
+}
+} // namespace
+
+CollisionLocator::CollisionLocator(bool inMergeTileCollisionVolumes)
 : gridCellExtent{}
 , collisionVolumes{}
 , freeCollisionVolumesIndices{}
 , collisionGrid{}
 , entityMap{}
 , tileMap{}
-, terrainGrid{}
+, mergeTileCollisionVolumes{inMergeTileCollisionVolumes}
+, unmergedTileVolumes{}
+, mergedChunkMap{}
+, dirtyMergeTiles{}
+, mergeVector{}
+, remergeExtents{}
+, terrainGrid{EMPTY_TERRAIN}
 , terrainCollisionVolumes{}
 , indexVector{}
 , collisionReturnVector{}
@@ -38,12 +101,17 @@ void CollisionLocator::setGridSize(const TileExtent& mapTileExtent)
         = CellExtent(mapTileExtent, SharedConfig::COLLISION_LOCATOR_CELL_WIDTH,
                      SharedConfig::COLLISION_LOCATOR_CELL_HEIGHT);
 
-    // Resize the grid to fit the map.
-    collisionGrid.resize(gridCellExtent.size());
-    terrainGrid.resize(gridTileExtent.size());
-
-    // Init the terrain grid as empty.
-    std::ranges::fill(terrainGrid, EMPTY_TERRAIN);
+    // Resize the grids to fit the map. Blocks will be allocated as collision
+    // is added to them.
+    // Note: Unallocated terrain blocks are treated as EMPTY_TERRAIN.
+    collisionGrid.setExtent(gridCellExtent);
+    terrainGrid.setExtent(gridTileExtent);
+
+    LOG_INFO("CollisionLocator grids: %zu bytes reserved (dense equivalent: "
+             "%zu bytes).",
+             getGridMemoryUsage(),
+             collisionGrid.getDenseMemoryUsage()
+                 + terrainGrid.getDenseMemoryUsage());
 }
 
 bool CollisionLocator::updateEntity(entt::entity entity,
@@ -112,28 +180,34 @@ bool CollisionLocator::updateEntity(entt::entity entity,
 }
 
 void CollisionLocator::updateTile(const TilePosition& tilePosition,
-                                  const Tile& tile)
+                                  const Tile& tile,
+                                  const GraphicDataBase& graphicData)
 {
-    // If we're already tracking this tile, clear its old collision data.
-    auto tileIt{tileMap.find(tilePosition)};
-    if (tileIt != tileMap.end()) {
+    // If we're merging, clear the tile's old unmerged volumes and mark it
+    // as needing to be re-merged.
+    if (mergeTileCollisionVolumes) {
+        unmergedTileVolumes.erase(tilePosition);
+        dirtyMergeTiles.emplace_back(tilePosition);
+
+        if (Terrain::Value* terrainValue{terrainGrid.find(tilePosition)}) {
+            *terrainValue = EMPTY_TERRAIN;
+        }
+    }
+    // Else if we're already tracking this tile, clear its old collision data.
+    else if (auto tileIt{tileMap.find(tilePosition)};
+             tileIt != tileMap.end()) {
         // For each layer that was in the tile.
         // Note: Terrain layers will never be present in this loop, since
         //       they aren't added to collisionVolumes or tileMap.
         for (Uint16 volumeIndex : tileIt->second) {
-            CollisionInfo& volumeInfo{collisionVolumes[volumeIndex]};
-
-            // Clear it from the grid.
-            CellExtent cellExtent(volumeInfo.collisionVolume, CELL_WORLD_WIDTH,
-                                  CELL_WORLD_HEIGHT);
-            clearCollisionVolumeFromCells(volumeIndex, cellExtent);
-
-            // Mark its index as now being free.
-            freeCollisionVolumesIndices.push_back(volumeIndex);
+            // Clear it from the grid and mark its index as now being free.
+            removeStaticCollisionVolume(volumeIndex);
         }
 
         // Clear this tile's position in terrainGrid.
-        terrainGrid[linearizeTileIndex(tilePosition)] = EMPTY_TERRAIN;
+        if (Terrain::Value* terrainValue{terrainGrid.find(tilePosition)}) {
+            *terrainValue = EMPTY_TERRAIN;
+        }
 
         // If the tile has no layers: erase it from the map, clear its terrain,
         // and return early.
@@ -145,7 +219,164 @@ void CollisionLocator::updateTile(const TilePosition& tilePosition,
 
     // Add the tile to tileMap, and add all of its collidable layers to
     // collisionGrid and terrainGrid.
-    addTileCollisionVolumes(tilePosition, tile);
+    addTileCollisionVolumes(tilePosition, tile, graphicData);
+}
+
+void CollisionLocator::mergeDirtyTileCollisionVolumes()
+{
+    // Sort the queue by chunk and de-duplicate it.
+    std::ranges::sort(dirtyMergeTiles, [](const TilePosition& a,
+                                          const TilePosition& b) {
+        return std::tuple{ChunkPosition{a}, a}
+               < std::tuple{ChunkPosition{b}, b};
+    });
+    auto lastIt{std::unique(dirtyMergeTiles.begin(), dirtyMergeTiles.end())};
+
+    // Re-merge each chunk's dirty tiles.
+    auto chunkBeginIt{dirtyMergeTiles.begin()};
+    while (chunkBeginIt != lastIt) {
+        ChunkPosition chunkPosition{*chunkBeginIt};
+        auto chunkEndIt{std::find_if(
+            chunkBeginIt, lastIt, [&](const TilePosition& tilePosition) {
+                return ChunkPosition{tilePosition} != chunkPosition;
+            })};
+
+        remergeChunkTiles(chunkPosition, {chunkBeginIt, chunkEndIt});
+        chunkBeginIt = chunkEndIt;
+    }
+
+    dirtyMergeTiles.clear();
+}
+
+void CollisionLocator::remergeChunkTiles(
+    const ChunkPosition& chunkPosition,
+    std::span<const TilePosition> dirtyTiles)
+{
+    TileExtent chunkTileExtent{ChunkExtent{chunkPosition.x, chunkPosition.y,
+                                           chunkPosition.z, 1, 1, 1}};
+
+    // Start with each dirty tile and its neighbors, so that the dirty tile's
+    // volumes can merge with the volumes around them.
+    remergeExtents.clear();
+    for (const TilePosition& tilePosition : dirtyTiles) {
+        TileExtent neighborExtent{tilePosition.x - 1, tilePosition.y - 1,
+                                  tilePosition.z,     3,
+                                  3,                  1};
+        remergeExtents.push_back(neighborExtent.intersectWith(chunkTileExtent));
+    }
+
+    // Remove any merged volumes that were built from tiles in the extents.
+    // Each removed volume's tiles must also be re-merged, which may overlap
+    // more merged volumes, so we add its extent and keep going until no more
+    // volumes are found.
+    std::vector<MergedVolume>& mergedVolumes{mergedChunkMap[chunkPosition]};
+    auto overlapsRemergeExtents = [&](const TileExtent& extent) {
+        return std::ranges::any_of(
+            remergeExtents, [&](const TileExtent& remergeExtent) {
+                return !(remergeExtent.intersectWith(extent).isEmpty());
+            });
+    };
+    bool removedVolume{true};
+    while (removedVolume) {
+        removedVolume = false;
+        for (std::size_t i{0}; i < mergedVolumes.size();) {
+            MergedVolume& mergedVolume{mergedVolumes[i]};
+            if (!overlapsRemergeExtents(mergedVolume.sourceTileExtent)) {
+                ++i;
+                continue;
+            }
+
+            removeStaticCollisionVolume(mergedVolume.volumeIndex);
+            remergeExtents.push_back(mergedVolume.sourceTileExtent);
+            mergedVolume = mergedVolumes.back();
+            mergedVolumes.pop_back();
+            removedVolume = true;
+        }
+    }
+
+    // Gather the unmerged volumes of each tile that we're re-merging.
+    mergeVector.clear();
+    for (int y{chunkTileExtent.y}; y <= chunkTileExtent.yMax(); ++y) {
+        for (int x{chunkTileExtent.x}; x <= chunkTileExtent.xMax(); ++x) {
+            TileExtent tileExtent{x, y, chunkTileExtent.z, 1, 1, 1};
+            if (!overlapsRemergeExtents(tileExtent)) {
+                continue;
+            }
+
+            auto tileIt{unmergedTileVolumes.find(tileExtent.min())};
+            if (tileIt != unmergedTileVolumes.end()) {
+                for (const CollisionInfo& collisionInfo : tileIt->second) {
+                    mergeVector.emplace_back(collisionInfo, tileExtent);
+                }
+            }
+        }
+    }
+
+    // Merge the volumes and add the results to the grid.
+    mergeVolumes(mergeVector);
+    for (const TileMergeVolume& mergeVolume : mergeVector) {
+        const CollisionInfo& collisionInfo{mergeVolume.collisionInfo};
+        mergedVolumes.emplace_back(
+            addStaticCollisionVolume(collisionInfo.collisionVolume,
+                                     collisionInfo.collisionLayers),
+            mergeVolume.sourceTileExtent);
+    }
+
+    if (mergedVolumes.empty()) {
+        mergedChunkMap.erase(chunkPosition);
+    }
+}
+
+void CollisionLocator::removeChunk(const ChunkPosition& chunkPosition)
+{
+    TileExtent chunkTileExtent{ChunkExtent{chunkPosition.x, chunkPosition.y,
+                                           chunkPosition.z, 1, 1, 1}};
+    chunkTileExtent = chunkTileExtent.intersectWith(gridTileExtent);
+    if (chunkTileExtent.isEmpty()) {
+        return;
+    }
+
+    // Clear each tile's collision data and terrain.
+    for (int z{chunkTileExtent.z}; z <= chunkTileExtent.zMax(); ++z) {
+        for (int y{chunkTileExtent.y}; y <= chunkTileExtent.yMax(); ++y) {
+            for (int x{chunkTileExtent.x}; x <= chunkTileExtent.xMax(); ++x) {
+                TilePosition tilePosition{x, y, z};
+                if (mergeTileCollisionVolumes) {
+                    unmergedTileVolumes.erase(tilePosition);
+                }
+                else if (auto tileIt{tileMap.find(tilePosition)};
+                         tileIt != tileMap.end()) {
+                    for (Uint16 volumeIndex : tileIt->second) {
+                        removeStaticCollisionVolume(volumeIndex);
+                    }
+                    tileMap.erase(tileIt);
+                }
+
+                if (Terrain::Value* terrainValue{
+                        terrainGrid.find(tilePosition)}) {
+                    *terrainValue = EMPTY_TERRAIN;
+                }
+            }
+        }
+    }
+
+    // If we're merging, clear the chunk's merged volumes.
+    if (auto chunkIt{mergedChunkMap.find(chunkPosition)};
+        chunkIt != mergedChunkMap.end()) {
+        for (const MergedVolume& mergedVolume : chunkIt->second) {
+            removeStaticCollisionVolume(mergedVolume.volumeIndex);
+        }
+        mergedChunkMap.erase(chunkIt);
+    }
+
+    // Free any grid blocks that are now empty.
+    // Note: Cell blocks may be shared with neighboring chunks along the Z
+    //       axis, in which case they'll stay allocated.
+    terrainGrid.releaseEmptyBlocks(chunkTileExtent);
+    collisionGrid.releaseEmptyBlocks(
+        CellExtent(chunkTileExtent, SharedConfig::COLLISION_LOCATOR_CELL_WIDTH,
+                   SharedConfig::COLLISION_LOCATOR_CELL_HEIGHT)
+            .intersectWith(gridCellExtent));
 }
 
 void CollisionLocator::removeEntity(entt::entity entity)
@@ -205,6 +436,41 @@ std::vector<CollisionLocator::RaycastHitInfo>&
     return raycastReturnVector;
 }
 
+void CollisionLocator::raycastAnyBatch(std::span<const BatchRaycastRay> rays,
+                                       std::span<BatchRaycastHit> results) const
+{
+    AM_ASSERT(results.size() >= rays.size(),
+              "Results span must be at least as large as rays span.");
+
+    for (std::size_t i{0}; i < rays.size(); ++i) {
+        const BatchRaycastRay& ray{rays[i]};
+        results[i] = {};
+
+        RaycastStrategyBatch strategy(*this, true, results[i]);
+        raycastInternal<RaycastStrategyBatch>(
+            strategy, {ray.start, ray.end, ray.collisionMask,
+                       ray.entitiesToExclude, ray.ignoreInsideHits});
+    }
+}
+
+void CollisionLocator::raycastFirstBatch(
+    std::span<const BatchRaycastRay> rays,
+    std::span<BatchRaycastHit> results) const
+{
+    AM_ASSERT(results.size() >= rays.size(),
+              "Results span must be at least as large as rays span.");
+
+    for (std::size_t i{0}; i < rays.size(); ++i) {
+        const BatchRaycastRay& ray{rays[i]};
+        results[i] = {};
+
+        RaycastStrategyBatch strategy(*this, false, results[i]);
+        raycastInternal<RaycastStrategyBatch>(
+            strategy, {ray.start, ray.end, ray.collisionMask,
+                       ray.entitiesToExclude, ray.ignoreInsideHits});
+    }
+}
+
 std::vector<const CollisionLocator::CollisionInfo*>&
     CollisionLocator::getCollisions(const Cylinder& cylinder,
                                     CollisionLayerBitSet collisionMask)
@@ -314,6 +580,11 @@ std::vector<const CollisionLocator::CollisionInfo*>&
     return getCollisionsBroad(TileExtent(chunkExtent), collisionMask);
 }
 
+std::size_t CollisionLocator::getGridMemoryUsage() const
+{
+    return collisionGrid.getMemoryUsage() + terrainGrid.getMemoryUsage();
+}
+
 void CollisionLocator::addCollisionVolumeToCells(Uint16 volumeIndex,
                                                  const CellExtent& cellExtent)
 {
@@ -323,8 +594,7 @@ void CollisionLocator::addCollisionVolumeToCells(Uint16 volumeIndex,
         for (int y{cellExtent.y}; y <= cellExtent.yMax(); ++y) {
             for (int x{cellExtent.x}; x <= cellExtent.xMax(); ++x) {
                 // Add the volume's index to this cell's vector.
-                std::size_t linearizedIndex{linearizeCellIndex({x, y, z})};
-                std::vector<Uint16>& cell{collisionGrid[linearizedIndex]};
+                std::vector<Uint16>& cell{collisionGrid.getOrCreate({x, y, z})};
 
                 cell.push_back(volumeIndex);
             }
@@ -340,29 +610,37 @@ void CollisionLocator::clearCollisionVolumeFromCells(
         for (int y{clearExtent.y}; y <= clearExtent.yMax(); ++y) {
             for (int x{clearExtent.x}; x <= clearExtent.xMax(); ++x) {
                 // Find and erase the volume's index from this cell.
-                std::size_t linearizedIndex{linearizeCellIndex({x, y, z})};
-                std::vector<Uint16>& cell{collisionGrid[linearizedIndex]};
+                std::vector<Uint16>* cell{collisionGrid.find({x, y, z})};
+                if (!cell) {
+                    continue;
+                }
 
-                auto indexIt{std::find(cell.begin(), cell.end(), volumeIndex)};
-                if (indexIt != cell.end()) {
-                    cell.erase(indexIt);
+                auto indexIt{
+                    std::find(cell->begin(), cell->end(), volumeIndex)};
+                if (indexIt != cell->end()) {
+                    cell->erase(indexIt);
                 }
             }
         }
     }
 }
 
-void CollisionLocator::addTileCollisionVolumes(const TilePosition& tilePosition,
-                                               const Tile& tile)
+void CollisionLocator::addTileCollisionVolumes(
+    const TilePosition& tilePosition, const Tile& tile,
+    const GraphicDataBase& graphicData)
 {
-    // Add the tile to the map, or clear it if already present.
-    std::vector<Uint16>& tileLayerCollisionIndices{tileMap[tilePosition]};
-    tileLayerCollisionIndices.clear();
+    // If we aren't merging, add the tile to the map, or clear it if already
+    // present.
+    std::vector<Uint16>* tileLayerCollisionIndices{nullptr};
+    if (!mergeTileCollisionVolumes) {
+        tileLayerCollisionIndices = &(tileMap[tilePosition]);
+        tileLayerCollisionIndices->clear();
+    }
 
     // Add all of this tile's collidable layers to the grid.
     float terrainHeight{0};
     for (const TileLayer& layer : tile.getAllLayers()) {
-        GraphicRef graphic{layer.getGraphic()};
+        GraphicRef graphic{layer.getGraphic(graphicData)};
 
         // Note: Tile layers are sorted, so they will always appear in this
         //       order (if present).
@@ -370,7 +648,7 @@ void CollisionLocator::addTileCollisionVolumes(const TilePosition& tilePosition,
         BoundingBox collisionVolume{};
         CollisionLayerType::Value layerType{};
         if (layer.type == TileLayer::Type::Terrain) {
-            terrainGrid[linearizeTileIndex(tilePosition)]
+            terrainGrid.getOrCreate(tilePosition)
                 = static_cast<Terrain::Value>(layer.graphicValue);
 
             // Generate a temporary collision volume so we can get a height
@@ -404,41 +682,80 @@ void CollisionLocator::addTileCollisionVolumes(const TilePosition& tilePosition,
             }
         }
 
-        // If we have a free volume vector index, use it.
-        Uint16 volumeIndex{};
-        if (!(freeCollisionVolumesIndices.empty())) {
-            volumeIndex = freeCollisionVolumesIndices.back();
-            freeCollisionVolumesIndices.pop_back();
-
-            collisionVolumes[volumeIndex].collisionVolume = collisionVolume;
-            collisionVolumes[volumeIndex].collisionLayers = layerType;
-        }
-        else {
-            // No free indices, add the volume to the back.
-            collisionVolumes.emplace_back(collisionVolume, layerType);
-            volumeIndex = static_cast<Uint16>(collisionVolumes.size() - 1);
+        // If we're merging, hold onto the volume until the chunk is merged.
+        if (mergeTileCollisionVolumes) {
+            if (graphic.getCollisionEnabled()) {
+                unmergedTileVolumes[tilePosition].emplace_back(collisionVolume,
+                                                               layerType);
+            }
+            continue;
         }
 
-        // Convert the volume to a cell extent and make sure each length is
-        // non-zero (it's fine for the volume to be a plane, but if the cell
-        // extent has any zero lengths, this layer won't be added to any cells).
-        CellExtent cellExtent(collisionVolume, CELL_WORLD_WIDTH,
-                              CELL_WORLD_HEIGHT);
-        cellExtent.xLength = std::max(cellExtent.xLength, 1);
-        cellExtent.yLength = std::max(cellExtent.yLength, 1);
-        cellExtent.zLength = std::max(cellExtent.zLength, 1);
+        // Add this layer's collision volume to the grid, and its index to the
+        // map.
+        tileLayerCollisionIndices->push_back(
+            addStaticCollisionVolume(collisionVolume, layerType));
+    }
+}
 
-        // Add this layer's collision volume to the grid.
-        addCollisionVolumeToCells(volumeIndex, cellExtent);
+Uint16 CollisionLocator::addStaticCollisionVolume(
+    const BoundingBox& collisionVolume, CollisionLayerBitSet collisionLayers)
+{
+    // If we have a free volume vector index, use it.
+    Uint16 volumeIndex{};
+    if (!(freeCollisionVolumesIndices.empty())) {
+        volumeIndex = freeCollisionVolumesIndices.back();
+        freeCollisionVolumesIndices.pop_back();
 
-        // Add this layer's index to the map.
-        tileLayerCollisionIndices.push_back(volumeIndex);
+        collisionVolumes[volumeIndex].collisionVolume = collisionVolume;
+        collisionVolumes[volumeIndex].collisionLayers = collisionLayers;
+        collisionVolumes[volumeIndex].entity = entt::null;
+    }
+    else {
+        // No free indices, add the volume to the back.
+        collisionVolumes.emplace_back(collisionVolume, collisionLayers);
+        volumeIndex = static_cast<Uint16>(collisionVolumes.size() - 1);
     }
+
+    addCollisionVolumeToCells(volumeIndex,
+                              getStaticVolumeCellExtent(collisionVolume));
+
+    return volumeIndex;
+}
+
+void CollisionLocator::removeStaticCollisionVolume(Uint16 volumeIndex)
+{
+    const BoundingBox& collisionVolume{
+        collisionVolumes[volumeIndex].collisionVolume};
+    clearCollisionVolumeFromCells(volumeIndex,
+                                  getStaticVolumeCellExtent(collisionVolume));
+    freeCollisionVolumesIndices.push_back(volumeIndex);
+}
+
+CellExtent CollisionLocator::getStaticVolumeCellExtent(
+    const BoundingBox& collisionVolume)
+{
+    // Convert the volume to a cell extent and make sure each length is
+    // non-zero (it's fine for the volume to be a plane, but if the cell
+    // extent has any zero lengths, this volume won't be added to any cells).
+    CellExtent cellExtent(collisionVolume, CELL_WORLD_WIDTH, CELL_WORLD_HEIGHT);
+    cellExtent.xLength = std::max(cellExtent.xLength, 1);
+    cellExtent.yLength = std::max(cellExtent.yLength, 1);
+    cellExtent.zLength = std::max(cellExtent.zLength, 1);
+
+    return cellExtent;
+}
+
+void CollisionLocator::mergeVolumes(std::vector<TileMergeVolume>& volumes)
+{
+    // Merge into rows along X, then merge matching rows along Y.
+    mergeAlongAxis<&Vector3::x, &Vector3::y>(volumes);
+    mergeAlongAxis<&Vector3::y, &Vector3::x>(volumes);
 }
 
 template<typename RaycastStrategy>
 void CollisionLocator::raycastInternal(RaycastStrategy& strategy,
-                                       const RaycastParams& params)
+                                       const RaycastParams& params) const
 {
     // DDA Algorithm Ref: https://lodev.org/cgtutor/raycasting.html
     //                    https://www.youtube.com/watch?v=NbSee-XM7WA
@@ -565,8 +882,7 @@ std::vector<const CollisionLocator::CollisionInfo*>&
         for (int y{tileExtent.y}; y <= tileExtent.yMax(); ++y) {
             for (int x{tileExtent.x}; x <= tileExtent.xMax(); ++x) {
                 TilePosition tilePosition{x, y, z};
-                std::size_t linearizedIndex{linearizeTileIndex(tilePosition)};
-                Terrain::Value terrainValue{terrainGrid[linearizedIndex]};
+                Terrain::Value terrainValue{terrainGrid.get(tilePosition)};
                 if (terrainValue == EMPTY_TERRAIN) {
                     continue;
                 }
@@ -591,8 +907,7 @@ std::vector<const CollisionLocator::CollisionInfo*>&
     for (int z{cellExtent.z}; z <= cellExtent.zMax(); ++z) {
         for (int y{cellExtent.y}; y <= cellExtent.yMax(); ++y) {
             for (int x{cellExtent.x}; x <= cellExtent.xMax(); ++x) {
-                std::size_t linearizedIndex{linearizeCellIndex({x, y, z})};
-                std::vector<Uint16>& cell{collisionGrid[linearizedIndex]};
+                const std::vector<Uint16>& cell{collisionGrid.get({x, y, z})};
                 indexVector.insert(indexVector.end(), cell.begin(), cell.end());
             }
         }
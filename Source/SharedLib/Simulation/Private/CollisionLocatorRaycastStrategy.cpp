@@ -1,4 +1,12 @@
 #include "CollisionLocatorRaycastStrategy.h"
+#include <algorithm>
+#include <bit>
+
+// If SSE is available, use it to test volume packets.
+#if defined(__SSE__) || defined(_M_X64) || defined(_M_AMD64)
+#include <xmmintrin.h>
+#define AM_RAYCAST_USE_SSE
+#endif
 
 namespace AM
 {
@@ -31,14 +39,14 @@ void CollisionLocator::RaycastStrategyIntersectAny::intersectObjectsInCell(
             CellExtent{cellPosition.x, cellPosition.y, cellPosition.z, 1, 1, 1},
             SharedConfig::COLLISION_LOCATOR_CELL_WIDTH,
             SharedConfig::COLLISION_LOCATOR_CELL_HEIGHT};
+        cellTileExtent
+            = cellTileExtent.intersectWith(collisionLocator.gridTileExtent);
         for (int z{cellTileExtent.z}; z <= cellTileExtent.zMax(); ++z) {
             for (int y{cellTileExtent.y}; y <= cellTileExtent.yMax(); ++y) {
                 for (int x{cellTileExtent.x}; x <= cellTileExtent.xMax(); ++x) {
                     TilePosition tilePosition{x, y, z};
-                    std::size_t linearizedIndex{
-                        collisionLocator.linearizeTileIndex(tilePosition)};
                     Terrain::Value terrainValue{
-                        collisionLocator.terrainGrid[linearizedIndex]};
+                        collisionLocator.terrainGrid.get(tilePosition)};
                     if (terrainValue == EMPTY_TERRAIN) {
                         continue;
                     }
@@ -65,9 +73,8 @@ void CollisionLocator::RaycastStrategyIntersectAny::intersectObjectsInCell(
     }
 
     // If the line intersects any of this cell's objects, return true.
-    std::size_t linearizedIndex{
-        collisionLocator.linearizeCellIndex(cellPosition)};
-    std::vector<Uint16>& cell{collisionLocator.collisionGrid[linearizedIndex]};
+    const std::vector<Uint16>& cell{
+        collisionLocator.collisionGrid.get(cellPosition)};
     for (Uint16 collisionVolumeIndex : cell) {
         const CollisionInfo& collisionInfo{
             collisionLocator.collisionVolumes[collisionVolumeIndex]};
@@ -136,14 +143,14 @@ void CollisionLocator::RaycastStrategyIntersectFirst::intersectObjectsInCell(
             CellExtent{cellPosition.x, cellPosition.y, cellPosition.z, 1, 1, 1},
             SharedConfig::COLLISION_LOCATOR_CELL_WIDTH,
             SharedConfig::COLLISION_LOCATOR_CELL_HEIGHT};
+        cellTileExtent
+            = cellTileExtent.intersectWith(collisionLocator.gridTileExtent);
         for (int z{cellTileExtent.z}; z <= cellTileExtent.zMax(); ++z) {
             for (int y{cellTileExtent.y}; y <= cellTileExtent.yMax(); ++y) {
                 for (int x{cellTileExtent.x}; x <= cellTileExtent.xMax(); ++x) {
                     TilePosition tilePosition{x, y, z};
-                    std::size_t linearizedIndex{
-                        collisionLocator.linearizeTileIndex(tilePosition)};
                     Terrain::Value terrainValue{
-                        collisionLocator.terrainGrid[linearizedIndex]};
+                        collisionLocator.terrainGrid.get(tilePosition)};
                     if (terrainValue == EMPTY_TERRAIN) {
                         continue;
                     }
@@ -182,9 +189,8 @@ void CollisionLocator::RaycastStrategyIntersectFirst::intersectObjectsInCell(
     }
 
     // If the line intersects any of this cell's objects, track it.
-    std::size_t linearizedIndex{
-        collisionLocator.linearizeCellIndex(cellPosition)};
-    std::vector<Uint16>& cell{collisionLocator.collisionGrid[linearizedIndex]};
+    const std::vector<Uint16>& cell{
+        collisionLocator.collisionGrid.get(cellPosition)};
     for (Uint16 collisionVolumeIndex : cell) {
         const CollisionInfo& collisionInfo{
             collisionLocator.collisionVolumes[collisionVolumeIndex]};
@@ -255,14 +261,14 @@ void CollisionLocator::RaycastStrategyIntersectAll::intersectObjectsInCell(
             CellExtent{cellPosition.x, cellPosition.y, cellPosition.z, 1, 1, 1},
             SharedConfig::COLLISION_LOCATOR_CELL_WIDTH,
             SharedConfig::COLLISION_LOCATOR_CELL_HEIGHT};
+        cellTileExtent
+            = cellTileExtent.intersectWith(collisionLocator.gridTileExtent);
         for (int z{cellTileExtent.z}; z <= cellTileExtent.zMax(); ++z) {
             for (int y{cellTileExtent.y}; y <= cellTileExtent.yMax(); ++y) {
                 for (int x{cellTileExtent.x}; x <= cellTileExtent.xMax(); ++x) {
                     TilePosition tilePosition{x, y, z};
-                    std::size_t linearizedIndex{
-                        collisionLocator.linearizeTileIndex(tilePosition)};
                     Terrain::Value terrainValue{
-                        collisionLocator.terrainGrid[linearizedIndex]};
+                        collisionLocator.terrainGrid.get(tilePosition)};
                     if (terrainValue == EMPTY_TERRAIN) {
                         continue;
                     }
@@ -297,9 +303,8 @@ void CollisionLocator::RaycastStrategyIntersectAll::intersectObjectsInCell(
     }
 
     // If the line intersects any of this cell's objects, track it.
-    std::size_t linearizedIndex{
-        collisionLocator.linearizeCellIndex(cellPosition)};
-    std::vector<Uint16>& cell{collisionLocator.collisionGrid[linearizedIndex]};
+    const std::vector<Uint16>& cell{
+        collisionLocator.collisionGrid.get(cellPosition)};
     for (Uint16 collisionVolumeIndex : cell) {
         const CollisionInfo& collisionInfo{
             collisionLocator.collisionVolumes[collisionVolumeIndex]};
@@ -336,4 +341,227 @@ void CollisionLocator::RaycastStrategyIntersectAll::intersectObjectsInCell(
     }
 }
 
+CollisionLocator::RaycastStrategyBatch::RaycastStrategyBatch(
+    const CollisionLocator& inCollisionLocator, bool inStopAtAnyHit,
+    BatchRaycastHit& inHit)
+: collisionLocator{inCollisionLocator}
+, stopAtAnyHit{inStopAtAnyHit}
+, hit{inHit}
+, packet{}
+{
+}
+
+bool CollisionLocator::RaycastStrategyBatch::isDone() const
+{
+    return hit.didHit;
+}
+
+void CollisionLocator::RaycastStrategyBatch::intersectObjectsInCell(
+    const Vector3& start, const Vector3& inverseRayDirection,
+    const CellPosition& cellPosition, CollisionLayerBitSet collisionMask,
+    std::span<entt::entity> entitiesToExclude, bool ignoreInsideHits)
+{
+    // Rays may start or end outside of the map. Skip any cells that are
+    // outside of the grid.
+    if (!(collisionLocator.gridCellExtent.contains(cellPosition))) {
+        return;
+    }
+
+    // Gather any of this cell's terrain.
+    // Note: We ignore modelBounds and collisionEnabled on terrain, all
+    //       terrain gets generated collision.
+    if (CollisionLayerType::TerrainWall & collisionMask) {
+        TileExtent cellTileExtent{
+            CellExtent{cellPosition.x, cellPosition.y, cellPosition.z, 1, 1, 1},
+            SharedConfig::COLLISION_LOCATOR_CELL_WIDTH,
+            SharedConfig::COLLISION_LOCATOR_CELL_HEIGHT};
+        cellTileExtent
+            = cellTileExtent.intersectWith(collisionLocator.gridTileExtent);
+        for (int z{cellTileExtent.z}; z <= cellTileExtent.zMax(); ++z) {
+            for (int y{cellTileExtent.y}; y <= cellTileExtent.yMax(); ++y) {
+                for (int x{cellTileExtent.x}; x <= cellTileExtent.xMax(); ++x) {
+                    TilePosition tilePosition{x, y, z};
+                    Terrain::Value terrainValue{
+                        collisionLocator.terrainGrid.get(tilePosition)};
+                    if (terrainValue == EMPTY_TERRAIN) {
+                        continue;
+                    }
+
+                    // Check for inside hits.
+                    BoundingBox collisionVolume{
+                        Terrain::calcWorldBounds(tilePosition, terrainValue)};
+                    if (ignoreInsideHits && collisionVolume.contains(start)) {
+                        continue;
+                    }
+
+                    pushVolume(collisionVolume, nullptr, start,
+                               inverseRayDirection);
+                }
+            }
+        }
+    }
+
+    // Gather any of this cell's objects.
+    const std::vector<Uint16>& cell{
+        collisionLocator.collisionGrid.get(cellPosition)};
+    for (Uint16 collisionVolumeIndex : cell) {
+        const CollisionInfo& collisionInfo{
+            collisionLocator.collisionVolumes[collisionVolumeIndex]};
+
+        // Check for masking.
+        bool isInMask{
+            static_cast<bool>(collisionInfo.collisionLayers & collisionMask)};
+        if (!isInMask) {
+            continue;
+        }
+
+        // Check for exclusion.
+        if ((collisionInfo.entity != entt::null)
+            && (std::ranges::contains(entitiesToExclude,
+                                      collisionInfo.entity))) {
+            continue;
+        }
+
+        // Check for inside hits.
+        const BoundingBox& collisionVolume{collisionInfo.collisionVolume};
+        if (ignoreInsideHits && collisionVolume.contains(start)) {
+            continue;
+        }
+
+        pushVolume(collisionVolume, &collisionInfo, start,
+                   inverseRayDirection);
+    }
+
+    // Test any leftover volumes.
+    flushPacket(start, inverseRayDirection);
+}
+
+void CollisionLocator::RaycastStrategyBatch::pushVolume(
+    const BoundingBox& collisionVolume, const CollisionInfo* collisionInfo,
+    const Vector3& start, const Vector3& inverseRayDirection)
+{
+    // If we're only looking for any hit and already found one, skip the work.
+    if (stopAtAnyHit && hit.didHit) {
+        return;
+    }
+
+    std::size_t index{packet.count};
+    packet.minX[index] = collisionVolume.min.x;
+    packet.minY[index] = collisionVolume.min.y;
+    packet.minZ[index] = collisionVolume.min.z;
+    packet.maxX[index] = collisionVolume.max.x;
+    packet.maxY[index] = collisionVolume.max.y;
+    packet.maxZ[index] = collisionVolume.max.z;
+    packet.collisionInfos[index] = collisionInfo;
+    packet.count++;
+
+    if (packet.count == PACKET_WIDTH) {
+        flushPacket(start, inverseRayDirection);
+    }
+}
+
+void CollisionLocator::RaycastStrategyBatch::flushPacket(
+    const Vector3& start, const Vector3& inverseRayDirection)
+{
+    if (packet.count == 0) {
+        return;
+    }
+
+    // Run the slab test on every volume in the packet.
+    // Note: This matches BoundingBox::intersects(), bounded to [0, 1]. Since
+    //       we want to bound to t==1, it's important for inverseRayDirection
+    //       to not be normalized.
+    // Note: The SSE min/max operands are ordered so that NaN handling
+    //       matches std::min/std::max.
+    alignas(16) std::array<float, PACKET_WIDTH> tMins{};
+    unsigned int hitMask{0};
+#ifdef AM_RAYCAST_USE_SSE
+    const __m128 startX{_mm_set1_ps(start.x)};
+    const __m128 startY{_mm_set1_ps(start.y)};
+    const __m128 startZ{_mm_set1_ps(start.z)};
+    const __m128 inverseX{_mm_set1_ps(inverseRayDirection.x)};
+    const __m128 inverseY{_mm_set1_ps(inverseRayDirection.y)};
+    const __m128 inverseZ{_mm_set1_ps(inverseRayDirection.z)};
+
+    __m128 t0X{_mm_mul_ps(_mm_sub_ps(_mm_load_ps(packet.minX.data()), startX),
+                          inverseX)};
+    __m128 t0Y{_mm_mul_ps(_mm_sub_ps(_mm_load_ps(packet.minY.data()), startY),
+                          inverseY)};
+    __m128 t0Z{_mm_mul_ps(_mm_sub_ps(_mm_load_ps(packet.minZ.data()), startZ),
+                          inverseZ)};
+    __m128 t1X{_mm_mul_ps(_mm_sub_ps(_mm_load_ps(packet.maxX.data()), startX),
+                          inverseX)};
+    __m128 t1Y{_mm_mul_ps(_mm_sub_ps(_mm_load_ps(packet.maxY.data()), startY),
+                          inverseY)};
+    __m128 t1Z{_mm_mul_ps(_mm_sub_ps(_mm_load_ps(packet.maxZ.data()), startZ),
+                          inverseZ)};
+
+    // std::min(a, b) == _mm_min_ps(b, a), std::max(a, b) == _mm_max_ps(b, a)
+    __m128 tEnterX{_mm_min_ps(t1X, t0X)};
+    __m128 tEnterY{_mm_min_ps(t1Y, t0Y)};
+    __m128 tEnterZ{_mm_min_ps(t1Z, t0Z)};
+    __m128 tExitX{_mm_max_ps(t0X, t1X)};
+    __m128 tExitY{_mm_max_ps(t0Y, t1Y)};
+    __m128 tExitZ{_mm_max_ps(t0Z, t1Z)};
+
+    __m128 tMin{_mm_max_ps(_mm_max_ps(tEnterZ, _mm_max_ps(tEnterY, tEnterX)),
+                           _mm_setzero_ps())};
+    __m128 tMax{_mm_min_ps(_mm_min_ps(tExitZ, _mm_min_ps(tExitY, tExitX)),
+                           _mm_set1_ps(1.f))};
+
+    _mm_store_ps(tMins.data(), tMin);
+    hitMask = static_cast<unsigned int>(
+        _mm_movemask_ps(_mm_cmpge_ps(tMax, tMin)));
+#else
+    for (std::size_t i{0}; i < PACKET_WIDTH; ++i) {
+        float t0X{(packet.minX[i] - start.x) * inverseRayDirection.x};
+        float t0Y{(packet.minY[i] - start.y) * inverseRayDirection.y};
+        float t0Z{(packet.minZ[i] - start.z) * inverseRayDirection.z};
+        float t1X{(packet.maxX[i] - start.x) * inverseRayDirection.x};
+        float t1Y{(packet.maxY[i] - start.y) * inverseRayDirection.y};
+        float t1Z{(packet.maxZ[i] - start.z) * inverseRayDirection.z};
+
+        float tMin{std::max(
+            0.f, std::max(std::max(std::min(t0X, t1X), std::min(t0Y, t1Y)),
+                          std::min(t0Z, t1Z)))};
+        float tMax{std::min(
+            1.f, std::min(std::min(std::max(t1X, t0X), std::max(t1Y, t0Y)),
+                          std::max(t1Z, t0Z)))};
+
+        tMins[i] = tMin;
+        if (tMax >= tMin) {
+            hitMask |= (1u << i);
+        }
+    }
+#endif
+
+    // Ignore any unused lanes.
+    hitMask &= ((1u << packet.count) - 1);
+
+    // Record the earliest hit.
+    while (hitMask != 0) {
+        int index{std::countr_zero(hitMask)};
+        hitMask &= (hitMask - 1);
+
+        if (tMins[index] < hit.hitT) {
+            hit.didHit = true;
+            hit.hitT = tMins[index];
+            if (const CollisionInfo* collisionInfo{
+                    packet.collisionInfos[index]}) {
+                hit.collisionInfo = *collisionInfo;
+            }
+            else {
+                hit.collisionInfo
+                    = {BoundingBox{{packet.minX[index], packet.minY[index],
+                                    packet.minZ[index]},
+                                   {packet.maxX[index], packet.maxY[index],
+                                    packet.maxZ[index]}},
+                       CollisionLayerType::TerrainWall};
+            }
+        }
+    }
+
+    packet.count = 0;
+}
+
 } // End namespace AM
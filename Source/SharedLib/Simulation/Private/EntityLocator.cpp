@@ -30,8 +30,13 @@ void EntityLocator::setGridSize(const TileExtent& mapTileExtent)
         = CellExtent(mapTileExtent, SharedConfig::ENTITY_LOCATOR_CELL_WIDTH,
                      SharedConfig::ENTITY_LOCATOR_CELL_HEIGHT);
 
-    // Resize the grid to fit the map.
-    entityGrid.resize(linearizeCellIndex(gridCellExtent.max()) + 1);
+    // Resize the grid to fit the map. Cell blocks will be allocated as
+    // entities enter them.
+    entityGrid.setExtent(gridCellExtent);
+
+    LOG_INFO("EntityLocator grid: %zu bytes reserved (dense equivalent: %zu "
+             "bytes).",
+             entityGrid.getMemoryUsage(), entityGrid.getDenseMemoryUsage());
 }
 
 bool EntityLocator::updateEntity(entt::entity entity, const Position& position)
@@ -60,8 +65,7 @@ bool EntityLocator::updateEntity(entt::entity entity, const Position& position)
     }
 
     // Add the entity to the cell.
-    std::size_t linearizedIndex{linearizeCellIndex(cellPosition)};
-    std::vector<entt::entity>& cell{entityGrid[linearizedIndex]};
+    std::vector<entt::entity>& cell{entityGrid.getOrCreate(cellPosition)};
 
     cell.push_back(entity);
 
@@ -91,34 +95,14 @@ void EntityLocator::removeEntity(entt::entity entity)
 
 std::vector<entt::entity>& EntityLocator::getEntities(const Cylinder& cylinder)
 {
-    AM_ASSERT(cylinder.radius >= 0, "Cylinder can't have negative radius.");
-    AM_ASSERT(cylinder.halfHeight >= 0,
-              "Cylinder can't have negative half height.");
-
-    // Perform a broad phase.
-    getEntitiesBroad(cylinder);
-
-    // Erase any entities whose position isn't within the cylinder.
-    std::erase_if(returnVector, [this, &cylinder](entt::entity entity) {
-        const Position& position{registry.get<Position>(entity)};
-        return !(cylinder.intersects(position));
-    });
-
+    getEntities(cylinder, returnVector);
     return returnVector;
 }
 
 std::vector<entt::entity>&
     EntityLocator::getEntities(const TileExtent& tileExtent)
 {
-    // Perform a broad phase.
-    getEntitiesBroad(tileExtent);
-
-    // Erase any entities that don't actually intersect the extent.
-    std::erase_if(returnVector, [this, &tileExtent](entt::entity entity) {
-        const Position& position{registry.get<Position>(entity)};
-        return !(tileExtent.contains(position));
-    });
-
+    getEntities(tileExtent, returnVector);
     return returnVector;
 }
 
@@ -134,34 +118,7 @@ std::vector<entt::entity>&
 std::vector<entt::entity>&
     EntityLocator::getEntitiesBroad(const Cylinder& cylinder)
 {
-    // Clear the return vector.
-    returnVector.clear();
-
-    // Calc the cell extent that is intersected by the cylinder.
-    CellExtent cylinderCellExtent(cylinder, CELL_WORLD_WIDTH,
-                                  CELL_WORLD_HEIGHT);
-
-    // Clip the extent to the grid's bounds.
-    cylinderCellExtent = cylinderCellExtent.intersectWith(gridCellExtent);
-
-    // Add the entities in every intersected cell to the return vector.
-    for (int z{cylinderCellExtent.z}; z <= cylinderCellExtent.zMax(); ++z) {
-        for (int y{cylinderCellExtent.y}; y <= cylinderCellExtent.yMax(); ++y) {
-            for (int x{cylinderCellExtent.x}; x <= cylinderCellExtent.xMax();
-                 ++x) {
-                // Add the entities in this cell to the return vector.
-                std::size_t linearizedIndex{linearizeCellIndex({x, y, z})};
-                std::vector<entt::entity>& entityVec{
-                    entityGrid[linearizedIndex]};
-                returnVector.insert(returnVector.end(), entityVec.begin(),
-                                    entityVec.end());
-            }
-        }
-    }
-
-    // Note: We don't need to de-duplicate since an entity's Position will only
-    //       ever be in one cell at a time.
-
+    getEntitiesBroad(cylinder, returnVector);
     return returnVector;
 }
 
@@ -175,8 +132,75 @@ std::vector<entt::entity>&
 std::vector<entt::entity>&
     EntityLocator::getEntitiesBroad(const TileExtent& tileExtent)
 {
-    // Clear the return vector.
-    returnVector.clear();
+    getEntitiesBroad(tileExtent, returnVector);
+    return returnVector;
+}
+
+std::vector<entt::entity>&
+    EntityLocator::getEntitiesBroad(const ChunkExtent& chunkExtent)
+{
+    // Convert to TileExtent.
+    TileExtent tileExtent{chunkExtent};
+
+    return getEntitiesBroad(tileExtent);
+}
+
+void EntityLocator::getEntities(const Cylinder& cylinder,
+                                std::vector<entt::entity>& outEntities) const
+{
+    AM_ASSERT(cylinder.radius >= 0, "Cylinder can't have negative radius.");
+    AM_ASSERT(cylinder.halfHeight >= 0,
+              "Cylinder can't have negative half height.");
+
+    // Perform a broad phase.
+    getEntitiesBroad(cylinder, outEntities);
+
+    // Erase any entities whose position isn't within the cylinder.
+    // Note: We use a const registry so that get() can't modify it.
+    const entt::registry& constRegistry{registry};
+    std::erase_if(outEntities, [&](entt::entity entity) {
+        const Position& position{constRegistry.get<Position>(entity)};
+        return !(cylinder.intersects(position));
+    });
+}
+
+void EntityLocator::getEntities(const TileExtent& tileExtent,
+                                std::vector<entt::entity>& outEntities) const
+{
+    // Perform a broad phase.
+    getEntitiesBroad(tileExtent, outEntities);
+
+    // Erase any entities that don't actually intersect the extent.
+    // Note: We use a const registry so that get() can't modify it.
+    const entt::registry& constRegistry{registry};
+    std::erase_if(outEntities, [&](entt::entity entity) {
+        const Position& position{constRegistry.get<Position>(entity)};
+        return !(tileExtent.contains(position));
+    });
+}
+
+void EntityLocator::getEntitiesBroad(
+    const Cylinder& cylinder, std::vector<entt::entity>& outEntities) const
+{
+    // Clear the output vector.
+    outEntities.clear();
+
+    // Calc the cell extent that is intersected by the cylinder.
+    CellExtent cylinderCellExtent(cylinder, CELL_WORLD_WIDTH,
+                                  CELL_WORLD_HEIGHT);
+
+    // Clip the extent to the grid's bounds.
+    cylinderCellExtent = cylinderCellExtent.intersectWith(gridCellExtent);
+
+    // Add the entities in every intersected cell to the output vector.
+    addCellEntities(cylinderCellExtent, outEntities);
+}
+
+void EntityLocator::getEntitiesBroad(
+    const TileExtent& tileExtent, std::vector<entt::entity>& outEntities) const
+{
+    // Clear the output vector.
+    outEntities.clear();
 
     // Calc the cell extent that is intersected by the tile extent.
     CellExtent tileCellExtent(tileExtent,
@@ -186,45 +210,41 @@ std::vector<entt::entity>&
     // Clip the extent to the grid's bounds.
     tileCellExtent = tileCellExtent.intersectWith(gridCellExtent);
 
-    // Add the entities in every intersected cell to the return vector.
-    for (int z{tileCellExtent.z}; z <= tileCellExtent.zMax(); ++z) {
-        for (int y{tileCellExtent.y}; y <= tileCellExtent.yMax(); ++y) {
-            for (int x{tileCellExtent.x}; x <= tileCellExtent.xMax(); ++x) {
-                // Add the entities in this cell to the return vector.
-                std::size_t linearizedIndex{linearizeCellIndex({x, y, z})};
-                std::vector<entt::entity>& entityVec{
-                    entityGrid[linearizedIndex]};
-                returnVector.insert(returnVector.end(), entityVec.begin(),
-                                    entityVec.end());
+    // Add the entities in every intersected cell to the output vector.
+    addCellEntities(tileCellExtent, outEntities);
+}
+
+void EntityLocator::addCellEntities(
+    const CellExtent& cellExtent, std::vector<entt::entity>& outEntities) const
+{
+    for (int z{cellExtent.z}; z <= cellExtent.zMax(); ++z) {
+        for (int y{cellExtent.y}; y <= cellExtent.yMax(); ++y) {
+            for (int x{cellExtent.x}; x <= cellExtent.xMax(); ++x) {
+                // Add the entities in this cell to the output vector.
+                const std::vector<entt::entity>& entityVec{
+                    entityGrid.get({x, y, z})};
+                outEntities.insert(outEntities.end(), entityVec.begin(),
+                                   entityVec.end());
             }
         }
     }
 
     // Note: We don't need to de-duplicate since an entity's Position will only
     //       ever be in one cell at a time.
-
-    return returnVector;
-}
-
-std::vector<entt::entity>&
-    EntityLocator::getEntitiesBroad(const ChunkExtent& chunkExtent)
-{
-    // Convert to TileExtent.
-    TileExtent tileExtent{chunkExtent};
-
-    return getEntitiesBroad(tileExtent);
 }
 
 void EntityLocator::clearEntityFromCell(entt::entity entity,
                                         const CellPosition& clearPosition)
 {
     // Find and erase the entity from the cell.
-    std::size_t linearizedIndex{linearizeCellIndex(clearPosition)};
-    std::vector<entt::entity>& cell{entityGrid[linearizedIndex]};
+    std::vector<entt::entity>* cell{entityGrid.find(clearPosition)};
+    if (!cell) {
+        return;
+    }
 
-    auto entityIt{std::find(cell.begin(), cell.end(), entity)};
-    if (entityIt != cell.end()) {
-        cell.erase(entityIt);
+    auto entityIt{std::find(cell->begin(), cell->end(), entity)};
+    if (entityIt != cell->end()) {
+        cell->erase(entityIt);
     }
 }
 
@@ -0,0 +1,72 @@
+#include "MovementActivityTracker.h"
+#include "Input.h"
+#include "Movement.h"
+#include "Position.h"
+#include "PreviousPosition.h"
+#include "Collision.h"
+#include "entt/entity/registry.hpp"
+
+namespace AM
+{
+MovementActivityTracker::MovementActivityTracker(entt::registry& inRegistry)
+: registry{inRegistry}
+, activeEntities{}
+, entitiesToSleep{}
+, activeEntityCount{0}
+, sleepingEntityCount{0}
+{
+    // Wake entities when they become movement-enabled, or when their movement
+    // state is changed.
+    // Note: We also observe Collision since it may be the last movement group
+    //       component to be added to a new entity.
+    activeEntities.bind(registry);
+    activeEntities.on_construct<Input>()
+        .on_update<Input>()
+        .on_construct<Movement>()
+        .on_update<Movement>()
+        .on_construct<Collision>();
+
+    // When an entity is destroyed, remove it from the active set (so its ID
+    // can be safely reused).
+    registry.on_destroy<entt::entity>()
+        .connect<&MovementActivityTracker::onEntityDestroyed>(this);
+}
+
+MovementActivityTracker::~MovementActivityTracker()
+{
+    registry.on_destroy<entt::entity>()
+        .disconnect<&MovementActivityTracker::onEntityDestroyed>(this);
+}
+
+void MovementActivityTracker::wake(entt::entity entity)
+{
+    if (!(activeEntities.contains(entity))) {
+        activeEntities.push(entity);
+    }
+}
+
+bool MovementActivityTracker::canSleep(const Input& input,
+                                       const Movement& movement,
+                                       const Position& position,
+                                       const PreviousPosition& previousPosition)
+{
+    return (input.inputStates.none() && !(movement.isAirborne)
+            && (position == previousPosition));
+}
+
+std::size_t MovementActivityTracker::getActiveEntityCount() const
+{
+    return activeEntityCount;
+}
+
+std::size_t MovementActivityTracker::getSleepingEntityCount() const
+{
+    return sleepingEntityCount;
+}
+
+void MovementActivityTracker::onEntityDestroyed(entt::entity entity)
+{
+    activeEntities.remove(entity);
+}
+
+} // End namespace AM
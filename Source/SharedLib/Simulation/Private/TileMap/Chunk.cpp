@@ -1,11 +1,22 @@
 #include "Chunk.h"
 #include "Morton.h"
 #include "AMAssert.h"
+#include <algorithm>
 #include <cstdint>
 
 namespace AM
 {
 
+Chunk::Chunk()
+: tiles{}
+, layerPool{}
+, abandonedLayerSlots{0}
+{
+    for (Tile& tile : tiles) {
+        tile.chunk = this;
+    }
+}
+
 Tile& Chunk::getTile(Uint16 tileOffsetX, Uint16 tileOffsetY)
 {
     AM_ASSERT(tileOffsetX < tiles.size(), "Invalid tile offset.");
@@ -20,6 +31,69 @@ const Tile& Chunk::getTile(Uint16 tileOffsetX, Uint16 tileOffsetY) const
     return tiles[mortonEncode(tileOffsetX, tileOffsetY)];
 }
 
+std::size_t Chunk::getMemoryUsage() const
+{
+    return sizeof(Chunk) + (layerPool.capacity() * sizeof(TileLayer));
+}
+
+void Chunk::growTileLayers(Tile& tile)
+{
+    std::size_t newCapacity{INITIAL_TILE_LAYER_CAPACITY};
+    if (tile.layerCapacity > 0) {
+        newCapacity = std::min(tile.layerCapacity * std::size_t{2},
+                               std::size_t{UINT8_MAX});
+    }
+
+    // If the tile's slots are at the end of the pool, grow them in place.
+    if ((tile.layerCapacity > 0)
+        && ((tile.layerOffset + tile.layerCapacity) == layerPool.size())) {
+        layerPool.resize(tile.layerOffset + newCapacity);
+        tile.layerCapacity = static_cast<Uint8>(newCapacity);
+        return;
+    }
+
+    // If too much of the pool has been abandoned, compact it before we add
+    // more.
+    if ((abandonedLayerSlots > 0)
+        && (abandonedLayerSlots >= (layerPool.size() / 2))) {
+        compactLayerPool();
+    }
+
+    // Move the tile's layers to new slots at the end of the pool.
+    std::size_t newOffset{layerPool.size()};
+    layerPool.resize(newOffset + newCapacity);
+    std::copy_n(layerPool.begin() + tile.layerOffset, tile.layerCount,
+                layerPool.begin() + newOffset);
+
+    abandonedLayerSlots += tile.layerCapacity;
+    tile.layerOffset = static_cast<Uint32>(newOffset);
+    tile.layerCapacity = static_cast<Uint8>(newCapacity);
+}
+
+void Chunk::compactLayerPool()
+{
+    // Copy each tile's layers into a new, tightly packed pool.
+    // Note: Tiles that have no layers give up their slots.
+    std::vector<TileLayer> newLayerPool{};
+    newLayerPool.reserve(layerPool.size() - abandonedLayerSlots);
+    for (Tile& tile : tiles) {
+        if (tile.layerCount == 0) {
+            tile.layerOffset = 0;
+            tile.layerCapacity = 0;
+            continue;
+        }
+
+        std::size_t newOffset{newLayerPool.size()};
+        auto layersBegin{layerPool.begin() + tile.layerOffset};
+        newLayerPool.insert(newLayerPool.end(), layersBegin,
+                            layersBegin + tile.layerCapacity);
+        tile.layerOffset = static_cast<Uint32>(newOffset);
+    }
+
+    layerPool = std::move(newLayerPool);
+    abandonedLayerSlots = 0;
+}
+
 Uint32 Chunk::mortonEncode(Uint16 x, Uint16 y) const
 {
     // If x and y fit in our lookup table, use it. Otherwise, calculate it
@@ -0,0 +1,423 @@
+#include "ChunkStore.h"
+#include "TileMapSnapshot.h"
+#include "Serialize.h"
+#include "Deserialize.h"
+#include "FileTools.h"
+#include "ByteTools.h"
+#include "Log.h"
+#include <filesystem>
+#include <cstdio>
+
+namespace AM
+{
+namespace
+{
+/**
+ * The persistable form of the store's index.
+ */
+struct ChunkStoreIndex {
+    struct Entry {
+        ChunkPosition chunkPosition{};
+        Uint64 offset{0};
+        Uint32 payloadSize{0};
+    };
+
+    Uint16 storeVersion{0};
+    Uint16 mapVersion{0};
+    Uint16 xLengthChunks{0};
+    Uint16 yLengthChunks{0};
+    Uint16 zLengthChunks{0};
+    Uint32 generation{0};
+    Uint64 dataFileSize{0};
+    std::vector<Entry> entries{};
+};
+
+template<typename S>
+void serialize(S& serializer, ChunkStoreIndex::Entry& entry)
+{
+    serializer.object(entry.chunkPosition);
+    serializer.value8b(entry.offset);
+    serializer.value4b(entry.payloadSize);
+}
+
+template<typename S>
+void serialize(S& serializer, ChunkStoreIndex& index)
+{
+    serializer.value2b(index.storeVersion);
+    serializer.value2b(index.mapVersion);
+    serializer.value2b(index.xLengthChunks);
+    serializer.value2b(index.yLengthChunks);
+    serializer.value2b(index.zLengthChunks);
+    serializer.value4b(index.generation);
+    serializer.value8b(index.dataFileSize);
+    serializer.container(index.entries, TileMapSnapshot::MAX_CHUNKS);
+}
+
+/** Record header field offsets. */
+constexpr std::size_t X_OFFSET{0};
+constexpr std::size_t Y_OFFSET{4};
+constexpr std::size_t Z_OFFSET{8};
+constexpr std::size_t PAYLOAD_SIZE_OFFSET{12};
+} // namespace
+
+ChunkStore::ChunkStore(const std::string& inBasePath)
+: basePath{inBasePath}
+, mapVersion{0}
+, xLengthChunks{0}
+, yLengthChunks{0}
+, zLengthChunks{0}
+, generation{0}
+, dataFileSize{0}
+, liveDataSize{0}
+, recordLocations{}
+, recordBuffer{}
+, dataFileMapping{}
+, mappedGeneration{0}
+, storeMutex{}
+{
+}
+
+bool ChunkStore::exists() const
+{
+    return std::filesystem::exists(basePath + ".index");
+}
+
+bool ChunkStore::open()
+{
+    std::string indexPath{basePath + ".index"};
+    ChunkStoreIndex index{};
+    if (!Deserialize::fromFile(indexPath, index)) {
+        LOG_ERROR("Failed to load chunk store index: %s", indexPath.c_str());
+        return false;
+    }
+    else if (index.storeVersion != STORE_FORMAT_VERSION) {
+        LOG_ERROR("Chunk store version doesn't match. Expected: %u, got: %u",
+                  STORE_FORMAT_VERSION, index.storeVersion);
+        return false;
+    }
+
+    std::scoped_lock lock{storeMutex};
+    mapVersion = index.mapVersion;
+    xLengthChunks = index.xLengthChunks;
+    yLengthChunks = index.yLengthChunks;
+    zLengthChunks = index.zLengthChunks;
+    generation = index.generation;
+    dataFileSize = index.dataFileSize;
+
+    recordLocations.clear();
+    liveDataSize = 0;
+    for (const ChunkStoreIndex::Entry& entry : index.entries) {
+        recordLocations.emplace(
+            entry.chunkPosition,
+            RecordLocation{entry.offset, entry.payloadSize});
+        liveDataSize += (RECORD_HEADER_SIZE + entry.payloadSize);
+    }
+
+    return true;
+}
+
+bool ChunkStore::readChunk(const ChunkPosition& chunkPosition,
+                           ChunkSnapshot& chunkSnapshot)
+{
+    std::scoped_lock lock{storeMutex};
+
+    auto locationIt{recordLocations.find(chunkPosition)};
+    if (locationIt == recordLocations.end()) {
+        return false;
+    }
+    const RecordLocation& location{locationIt->second};
+
+    // If the data file isn't mapped, compaction replaced it, or a save
+    // appended this record after we mapped it, (re-)map it.
+    const std::size_t recordEnd{static_cast<std::size_t>(
+        location.offset + RECORD_HEADER_SIZE + location.payloadSize)};
+    if (!dataFileMapping.isOpen() || (mappedGeneration != generation)
+        || (recordEnd > dataFileMapping.size())) {
+        // Note: We only map the valid part of the file, since anything past
+        //       dataFileSize may be truncated by the next save.
+        if (!dataFileMapping.open(getDataFilePath(generation),
+                                  static_cast<std::size_t>(dataFileSize))) {
+            return false;
+        }
+        mappedGeneration = generation;
+    }
+    if (recordEnd > dataFileMapping.size()) {
+        LOG_ERROR("Chunk record at offset %llu is past the end of the data "
+                  "file.",
+                  static_cast<unsigned long long>(location.offset));
+        return false;
+    }
+
+    // Make sure the header matches what the index expects.
+    const Uint8* header{dataFileMapping.data() + location.offset};
+    if ((static_cast<int>(ByteTools::read32(header + X_OFFSET))
+         != chunkPosition.x)
+        || (static_cast<int>(ByteTools::read32(header + Y_OFFSET))
+            != chunkPosition.y)
+        || (static_cast<int>(ByteTools::read32(header + Z_OFFSET))
+            != chunkPosition.z)
+        || (ByteTools::read32(header + PAYLOAD_SIZE_OFFSET)
+            != location.payloadSize)) {
+        LOG_ERROR("Chunk record header doesn't match the index.");
+        return false;
+    }
+
+    // Deserialize the record straight out of the mapping.
+    return Deserialize::fromBuffer(header, location.payloadSize,
+                                   chunkSnapshot, RECORD_HEADER_SIZE);
+}
+
+bool ChunkStore::save(ChunkUpdateMap& chunkUpdates)
+{
+    // Serialize all of the updated chunks into records.
+    recordBuffer.clear();
+    std::vector<std::pair<ChunkPosition, std::optional<RecordLocation>>>
+        newLocations{};
+    newLocations.reserve(chunkUpdates.size());
+    for (auto& [chunkPosition, chunkSnapshot] : chunkUpdates) {
+        if (!chunkSnapshot) {
+            // The chunk was removed.
+            newLocations.emplace_back(chunkPosition, std::nullopt);
+            continue;
+        }
+
+        std::optional<RecordLocation> location{
+            appendRecord(chunkPosition, *chunkSnapshot, dataFileSize)};
+        if (!location) {
+            return false;
+        }
+        newLocations.emplace_back(chunkPosition, *location);
+    }
+
+    // Append the records to the data file.
+    // Note: This also truncates anything left over from a failed save. It
+    //       never cuts into the mapped part of the file, since we only map up
+    //       to dataFileSize.
+    if (!recordBuffer.empty()
+        && !FileTools::truncateAndAppend(getDataFilePath(generation),
+                                         dataFileSize, recordBuffer)) {
+        return false;
+    }
+
+    // Point the index at the new records.
+    std::unique_lock lock{storeMutex};
+    dataFileSize += recordBuffer.size();
+    for (const auto& [chunkPosition, location] : newLocations) {
+        auto oldLocationIt{recordLocations.find(chunkPosition)};
+        if (oldLocationIt != recordLocations.end()) {
+            liveDataSize
+                -= (RECORD_HEADER_SIZE + oldLocationIt->second.payloadSize);
+            recordLocations.erase(oldLocationIt);
+        }
+
+        if (location) {
+            recordLocations.emplace(chunkPosition, *location);
+            liveDataSize += (RECORD_HEADER_SIZE + location->payloadSize);
+        }
+    }
+
+    lock.unlock();
+
+    // Note: If this fails, the on-disk index still points at the old records.
+    //       Our in-memory state is still valid, so the next save will fix it.
+    return writeIndex();
+}
+
+bool ChunkStore::compact()
+{
+    // Read every live chunk.
+    ChunkUpdateMap chunks{};
+    chunks.reserve(recordLocations.size());
+    for (const auto& [chunkPosition, location] : recordLocations) {
+        ChunkSnapshot& chunkSnapshot{chunks[chunkPosition].emplace()};
+        if (!readChunk(chunkPosition, chunkSnapshot)) {
+            return false;
+        }
+    }
+
+    // Write them into a fresh data file.
+    return writeNewGeneration(chunks);
+}
+
+bool ChunkStore::importSnapshot(const TileMapSnapshot& mapSnapshot)
+{
+    setMapInfo(mapSnapshot.version, mapSnapshot.xLengthChunks,
+               mapSnapshot.yLengthChunks, mapSnapshot.zLengthChunks);
+
+    ChunkUpdateMap chunks{};
+    chunks.reserve(mapSnapshot.chunks.size());
+    for (const auto& [chunkPosition, chunkSnapshot] : mapSnapshot.chunks) {
+        chunks.emplace(chunkPosition, chunkSnapshot);
+    }
+
+    return writeNewGeneration(chunks);
+}
+
+void ChunkStore::setMapInfo(Uint16 inMapVersion, Uint16 inXLengthChunks,
+                            Uint16 inYLengthChunks, Uint16 inZLengthChunks)
+{
+    mapVersion = inMapVersion;
+    xLengthChunks = inXLengthChunks;
+    yLengthChunks = inYLengthChunks;
+    zLengthChunks = inZLengthChunks;
+}
+
+Uint16 ChunkStore::getMapVersion() const
+{
+    return mapVersion;
+}
+
+Uint16 ChunkStore::getXLengthChunks() const
+{
+    return xLengthChunks;
+}
+
+Uint16 ChunkStore::getYLengthChunks() const
+{
+    return yLengthChunks;
+}
+
+Uint16 ChunkStore::getZLengthChunks() const
+{
+    return zLengthChunks;
+}
+
+const std::unordered_map<ChunkPosition, ChunkStore::RecordLocation>&
+    ChunkStore::getRecordLocations() const
+{
+    return recordLocations;
+}
+
+Uint64 ChunkStore::getDataFileSize() const
+{
+    return dataFileSize;
+}
+
+Uint64 ChunkStore::getLiveDataSize() const
+{
+    return liveDataSize;
+}
+
+std::string ChunkStore::getDataFilePath(Uint32 dataGeneration) const
+{
+    return basePath + "." + std::to_string(dataGeneration) + ".chunks";
+}
+
+std::optional<ChunkStore::RecordLocation>
+    ChunkStore::appendRecord(const ChunkPosition& chunkPosition,
+                             ChunkSnapshot& chunkSnapshot, Uint64 fileOffset)
+{
+    std::size_t payloadSize{Serialize::measureSize(chunkSnapshot)};
+    const std::size_t recordOffset{recordBuffer.size()};
+    recordBuffer.resize(recordOffset + RECORD_HEADER_SIZE + payloadSize);
+
+    // Write the header.
+    Uint8* header{recordBuffer.data() + recordOffset};
+    ByteTools::write32(static_cast<Uint32>(chunkPosition.x),
+                       header + X_OFFSET);
+    ByteTools::write32(static_cast<Uint32>(chunkPosition.y),
+                       header + Y_OFFSET);
+    ByteTools::write32(static_cast<Uint32>(chunkPosition.z),
+                       header + Z_OFFSET);
+    ByteTools::write32(static_cast<Uint32>(payloadSize),
+                       header + PAYLOAD_SIZE_OFFSET);
+
+    // Write the payload.
+    std::size_t bytesWritten{Serialize::toBuffer(
+        recordBuffer.data(), recordBuffer.size(), chunkSnapshot,
+        (recordOffset + RECORD_HEADER_SIZE))};
+    if (bytesWritten != payloadSize) {
+        LOG_ERROR("Failed to serialize chunk: measured %zu bytes, but "
+                  "serialization wrote %zu.",
+                  payloadSize, bytesWritten);
+        return std::nullopt;
+    }
+
+    return RecordLocation{(fileOffset + recordOffset),
+                          static_cast<Uint32>(payloadSize)};
+}
+
+bool ChunkStore::writeIndex()
+{
+    ChunkStoreIndex index{};
+    index.storeVersion = STORE_FORMAT_VERSION;
+    index.mapVersion = mapVersion;
+    index.xLengthChunks = xLengthChunks;
+    index.yLengthChunks = yLengthChunks;
+    index.zLengthChunks = zLengthChunks;
+    index.generation = generation;
+    index.dataFileSize = dataFileSize;
+    index.entries.reserve(recordLocations.size());
+    for (const auto& [chunkPosition, location] : recordLocations) {
+        index.entries.emplace_back(chunkPosition, location.offset,
+                                   location.payloadSize);
+    }
+
+    recordBuffer.resize(Serialize::measureSize(index));
+    Serialize::toBuffer(recordBuffer.data(), recordBuffer.size(), index);
+
+    return FileTools::writeAtomically(basePath + ".index", recordBuffer);
+}
+
+bool ChunkStore::writeNewGeneration(ChunkUpdateMap& chunks)
+{
+    // Serialize all of the chunks into records.
+    recordBuffer.clear();
+    std::unordered_map<ChunkPosition, RecordLocation> newRecordLocations{};
+    newRecordLocations.reserve(chunks.size());
+    for (auto& [chunkPosition, chunkSnapshot] : chunks) {
+        if (!chunkSnapshot) {
+            continue;
+        }
+
+        std::optional<RecordLocation> location{
+            appendRecord(chunkPosition, *chunkSnapshot, 0)};
+        if (!location) {
+            return false;
+        }
+        newRecordLocations.emplace(chunkPosition, *location);
+    }
+
+    // Write them to the new generation's data file.
+    const Uint32 oldGeneration{generation};
+    const Uint32 newGeneration{generation + 1};
+    std::string newDataFilePath{getDataFilePath(newGeneration)};
+    if (!FileTools::truncateAndAppend(newDataFilePath, 0, recordBuffer)) {
+        std::remove(newDataFilePath.c_str());
+        return false;
+    }
+
+    // Point the index at the new data file.
+    // Note: writeIndex() reuses recordBuffer, so grab its size first.
+    const Uint64 newDataFileSize{recordBuffer.size()};
+    const Uint64 oldDataFileSize{dataFileSize};
+    const Uint64 oldLiveDataSize{liveDataSize};
+    {
+        std::scoped_lock lock{storeMutex};
+        std::swap(recordLocations, newRecordLocations);
+        generation = newGeneration;
+        dataFileSize = newDataFileSize;
+        liveDataSize = newDataFileSize;
+    }
+    if (!writeIndex()) {
+        // Failed to write the index, go back to the old data file.
+        std::scoped_lock lock{storeMutex};
+        std::swap(recordLocations, newRecordLocations);
+        generation = oldGeneration;
+        dataFileSize = oldDataFileSize;
+        liveDataSize = oldLiveDataSize;
+        std::remove(newDataFilePath.c_str());
+        return false;
+    }
+
+    // The new index is in place, the old data file is no longer needed.
+    {
+        std::scoped_lock lock{storeMutex};
+        dataFileMapping.close();
+    }
+    std::remove(getDataFilePath(oldGeneration).c_str());
+
+    return true;
+}
+
+} // End namespace AM
@@ -1,27 +1,65 @@
 #include "Tile.h"
+#include "Chunk.h"
 #include "GraphicSets.h"
 #include "SharedConfig.h"
+#include "Log.h"
 #include <algorithm>
 
 namespace AM
 {
+namespace
+{
+/** Used to compare layers by type in binary searches. */
+TileLayer::Type getLayerType(const TileLayer& layer)
+{
+    return layer.type;
+}
+TileLayer::Type getLayerType(TileLayer::Type layerType)
+{
+    return layerType;
+}
+} // namespace
+
+template<typename Predicate>
+std::size_t Tile::eraseLayersIf(Predicate predicate)
+{
+    std::span<TileLayer> layers{getAllLayers()};
+    auto newEnd{std::remove_if(layers.begin(), layers.end(), predicate)};
+
+    std::size_t numErased{
+        static_cast<std::size_t>(std::distance(newEnd, layers.end()))};
+    layerCount -= static_cast<Uint8>(numErased);
+
+    return numErased;
+}
 
 void Tile::addLayer(const TileOffset& tileOffset, TileLayer::Type layerType,
-                    const GraphicSet& graphicSet, Uint8 graphicValue)
+                    Uint16 graphicSetID, Uint8 graphicValue)
 {
-    if (layers.size() == UINT8_MAX) {
+    if (layerCount == UINT8_MAX) {
         LOG_INFO("Failed to add layer: limit reached.");
         return;
     }
 
-    // Insert the new layer, being careful to keep the vector sorted.
-    TileLayer newLayer{tileOffset, layerType, graphicValue, graphicSet};
-    layers.insert(
-        std::lower_bound(layers.begin(), layers.end(), newLayer,
+    // If we're out of room, reserve more space in the chunk's pool.
+    // Note: This may move our layers, so we need to do it before getting any
+    //       pointers.
+    if (layerCount == layerCapacity) {
+        chunk->growTileLayers(*this);
+    }
+
+    // Insert the new layer, being careful to keep the layers sorted.
+    TileLayer newLayer{tileOffset, layerType, graphicValue, graphicSetID};
+    TileLayer* begin{chunk->layerPool.data() + layerOffset};
+    TileLayer* end{begin + layerCount};
+    TileLayer* insertPosition{
+        std::lower_bound(begin, end, newLayer,
                          [](const TileLayer& layer, const TileLayer& newLayer) {
                              return layer.type < newLayer.type;
-                         }),
-        newLayer);
+                         })};
+    std::move_backward(insertPosition, end, end + 1);
+    *insertPosition = newLayer;
+    layerCount++;
 }
 
 std::size_t Tile::removeLayers(const TileOffset& tileOffset,
@@ -29,174 +67,99 @@ std::size_t Tile::removeLayers(const TileOffset& tileOffset,
                                Uint8 graphicValue)
 {
     // Erase any layers with a matching type, graphic index, and graphic set.
-    std::size_t numErased{0};
-    for (auto it{layers.begin()}; it != layers.end();) {
-        TileLayer& layer{*it};
-
-        // If this layer matches, erase it.
-        if ((layer.tileOffset == tileOffset) && (layer.type == layerType)
-            && (layer.graphicValue == graphicValue)
-            && (layer.graphicSet.get().numericID == graphicSetID)) {
-            it = layers.erase(it);
-            numErased++;
-        }
-        // If we've reached a type past the desired one, stop looking.
-        else if (layer.type == (layerType + 1)) {
-            break;
-        }
-        else {
-            it++;
-        }
-    }
-
-    return numErased;
+    return eraseLayersIf([&](const TileLayer& layer) {
+        return (layer.tileOffset == tileOffset) && (layer.type == layerType)
+               && (layer.graphicValue == graphicValue)
+               && (layer.graphicSetID == graphicSetID);
+    });
 }
 
 std::size_t Tile::removeLayers(TileLayer::Type layerType, Uint16 graphicSetID,
                                Uint8 graphicValue)
 {
     // Erase any layers with a matching type, graphic index, and graphic set.
-    std::size_t numErased{0};
-    for (auto it{layers.begin()}; it != layers.end();) {
-        TileLayer& layer{*it};
-
-        // If this layer matches, erase it.
-        if ((layer.type == layerType) && (layer.graphicValue == graphicValue)
-            && (layer.graphicSet.get().numericID == graphicSetID)) {
-            it = layers.erase(it);
-            numErased++;
-        }
-        // If we've reached a type past the desired one, stop looking.
-        else if (layer.type == (layerType + 1)) {
-            break;
-        }
-        else {
-            it++;
-        }
-    }
-
-    return numErased;
+    return eraseLayersIf([&](const TileLayer& layer) {
+        return (layer.type == layerType) && (layer.graphicValue == graphicValue)
+               && (layer.graphicSetID == graphicSetID);
+    });
 }
 
 std::size_t Tile::removeLayers(TileLayer::Type layerType, Uint8 graphicValue)
 {
     // Erase any layers with a matching type and graphic index.
-    std::size_t numErased{0};
-    for (auto it{layers.begin()}; it != layers.end();) {
-        TileLayer& layer{*it};
-
-        // If this layer matches, erase it.
-        if ((layer.type == layerType) && (layer.graphicValue == graphicValue)) {
-            it = layers.erase(it);
-            numErased++;
-        }
-        // If we've reached a type past the desired one, stop looking.
-        else if (layer.type == (layerType + 1)) {
-            break;
-        }
-        else {
-            it++;
-        }
-    }
-
-    return numErased;
+    return eraseLayersIf([&](const TileLayer& layer) {
+        return (layer.type == layerType)
+               && (layer.graphicValue == graphicValue);
+    });
 }
 
 std::size_t Tile::clearLayers(
     const std::array<bool, TileLayer::Type::Count>& layerTypesToClear)
 {
     // Erase any layers with a matching type.
-    std::size_t numErased{std::erase_if(layers, [&](const TileLayer& layer) {
+    return eraseLayersIf([&](const TileLayer& layer) {
         return layerTypesToClear[layer.type];
-    })};
-
-    return numErased;
+    });
 }
 
 std::size_t Tile::clear()
 {
-    std::size_t layerCount{layers.size()};
+    std::size_t clearedCount{layerCount};
 
-    layers.clear();
+    // Note: We keep our reserved space in the chunk's pool, in case we get
+    //       new layers later.
+    layerCount = 0;
 
-    return layerCount;
+    return clearedCount;
 }
 
 std::span<TileLayer> Tile::getLayers(TileLayer::Type layerType)
 {
-    auto begin{layers.end()};
-    auto end{layers.end()};
-    for (auto it{layers.begin()}; it != layers.end(); ++it) {
-        if (it->type == layerType) {
-            // If this is the first match, set our iterators.
-            if (begin == layers.end()) {
-                begin = it;
-                end = it + 1;
-            }
-            else {
-                // Found another match, move our end iterator forward.
-                end = it + 1;
-            }
-        }
-        else if (it->type == (layerType + 1)) {
-            // Reached a type past the one we were looking for, stop looking.
-            break;
-        }
-    }
+    // Layers are sorted by type, so we can just search for the matching range.
+    std::span<TileLayer> layers{getAllLayers()};
+    auto [begin, end] = std::equal_range(
+        layers.begin(), layers.end(), layerType,
+        [](const auto& lhs, const auto& rhs) {
+            return getLayerType(lhs) < getLayerType(rhs);
+        });
 
-    // If we found any matches, return them.
-    if (begin != layers.end()) {
-        return {begin, end};
-    }
-    else {
-        return {};
-    }
+    return {begin, end};
 }
 
 std::span<const TileLayer> Tile::getLayers(TileLayer::Type layerType) const
 {
-    auto begin{layers.end()};
-    auto end{layers.end()};
-    for (auto it{layers.begin()}; it != layers.end(); ++it) {
-        if (it->type == layerType) {
-            // If this is the first match, set our iterators.
-            if (begin == layers.end()) {
-                begin = it;
-                end = it + 1;
-            }
-            else {
-                // Found another match, move our end iterator forward.
-                end = it + 1;
-            }
-        }
-        else if (it->type == (layerType + 1)) {
-            // Reached a type past the one we were looking for, stop looking.
-            break;
-        }
-    }
+    std::span<const TileLayer> layers{getAllLayers()};
+    auto [begin, end] = std::equal_range(
+        layers.begin(), layers.end(), layerType,
+        [](const auto& lhs, const auto& rhs) {
+            return getLayerType(lhs) < getLayerType(rhs);
+        });
 
-    // If we found any matches, return them.
-    if (begin != layers.end()) {
-        return {begin, end};
-    }
-    else {
-        return {};
-    }
+    return {begin, end};
 }
 
-std::vector<TileLayer>& Tile::getAllLayers()
+std::span<TileLayer> Tile::getAllLayers()
 {
-    return layers;
+    // Note: We check the count so that we never touch chunk when it's empty.
+    if (layerCount == 0) {
+        return {};
+    }
+
+    return {chunk->layerPool.data() + layerOffset, layerCount};
 }
 
-const std::vector<TileLayer>& Tile::getAllLayers() const
+std::span<const TileLayer> Tile::getAllLayers() const
 {
-    return layers;
+    if (layerCount == 0) {
+        return {};
+    }
+
+    return {chunk->layerPool.data() + layerOffset, layerCount};
 }
 
 TileLayer* Tile::findLayer(TileLayer::Type layerType, Uint8 graphicValue)
 {
-    for (TileLayer& layer : layers) {
+    for (TileLayer& layer : getAllLayers()) {
         if ((layer.type == layerType) && (layer.graphicValue == graphicValue)) {
             return &layer;
         }
@@ -212,7 +175,7 @@ TileLayer* Tile::findLayer(TileLayer::Type layerType, Uint8 graphicValue)
 const TileLayer* Tile::findLayer(TileLayer::Type layerType,
                                  Uint8 graphicValue) const
 {
-    for (const TileLayer& layer : layers) {
+    for (const TileLayer& layer : getAllLayers()) {
         if ((layer.type == layerType) && (layer.graphicValue == graphicValue)) {
             return &layer;
         }
@@ -227,7 +190,7 @@ const TileLayer* Tile::findLayer(TileLayer::Type layerType,
 
 TileLayer* Tile::findLayer(TileLayer::Type layerType)
 {
-    for (TileLayer& layer : layers) {
+    for (TileLayer& layer : getAllLayers()) {
         if (layer.type == layerType) {
             return &layer;
         }
@@ -242,7 +205,7 @@ TileLayer* Tile::findLayer(TileLayer::Type layerType)
 
 const TileLayer* Tile::findLayer(TileLayer::Type layerType) const
 {
-    for (const TileLayer& layer : layers) {
+    for (const TileLayer& layer : getAllLayers()) {
         if (layer.type == layerType) {
             return &layer;
         }
@@ -257,7 +220,7 @@ const TileLayer* Tile::findLayer(TileLayer::Type layerType) const
 
 bool Tile::isEmpty() const
 {
-    return layers.empty();
+    return (layerCount == 0);
 }
 
 } // End namespace AM
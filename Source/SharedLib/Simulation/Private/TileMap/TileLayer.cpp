@@ -1,13 +1,32 @@
 #include "TileLayer.h"
 #include "GraphicSets.h"
+#include "GraphicDataBase.h"
 #include "AMAssert.h"
 
 namespace AM
 {
 
-GraphicRef TileLayer::getGraphic() const
+const GraphicSet&
+    TileLayer::getGraphicSet(const GraphicDataBase& graphicData) const
 {
-    return getGraphic(type, graphicSet, graphicValue);
+    if (type == Type::Terrain) {
+        return graphicData.getTerrainGraphicSet(graphicSetID);
+    }
+    else if (type == Type::Floor) {
+        return graphicData.getFloorGraphicSet(graphicSetID);
+    }
+    else if (type == Type::Wall) {
+        return graphicData.getWallGraphicSet(graphicSetID);
+    }
+    else {
+        // Type::Object
+        return graphicData.getObjectGraphicSet(graphicSetID);
+    }
+}
+
+GraphicRef TileLayer::getGraphic(const GraphicDataBase& graphicData) const
+{
+    return getGraphic(type, getGraphicSet(graphicData), graphicValue);
 }
 
 GraphicRef TileLayer::getGraphic(Type type, const GraphicSet& graphicSet,
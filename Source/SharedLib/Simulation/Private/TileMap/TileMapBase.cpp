@@ -12,6 +12,7 @@
 #include "Morton.h"
 #include "SharedConfig.h"
 #include "Timer.h"
+#include "VariantTools.h"
 #include "Log.h"
 #include "AMAssert.h"
 
@@ -34,6 +35,8 @@ TileMapBase::TileMapBase(const GraphicDataBase& inGraphicData,
 , dirtyCollisionQueue{}
 , trackTileUpdates{inTrackTileUpdates}
 , tileUpdateHistory{}
+, dirtyChunks{}
+, dirtyChunksHistoryIndex{0}
 {
 }
 
@@ -378,21 +381,33 @@ bool TileMapBase::clearExtentLayers(
 {
     // Clear the given layers from each tile in the given extent.
     bool layerWasCleared{false};
-    for (int z{extent.z}; z <= extent.zMax(); ++z) {
-        for (int y{extent.y}; y <= extent.yMax(); ++y) {
-            for (int x{extent.x}; x <= extent.xMax(); ++x) {
-                TilePosition tilePosition{x, y, z};
-                Tile* clearedTile{
-                    clearTileLayersInternal(tilePosition, layerTypesToClear)};
-                if (clearedTile) {
-                    layerWasCleared = true;
-
-                    // A layer was cleared. Rebuild the affected tile's
-                    // collision.
-                    rebuildTileCollision(*clearedTile, tilePosition);
-                }
+    std::vector<ChunkPosition> emptiedChunks{};
+    forEachChunk(
+        *this, extent,
+        [&](const ChunkPosition& chunkPosition, Chunk& chunk,
+            const TileExtent& chunkTileExtent) {
+            forEachTileInChunk(
+                chunk, chunkPosition, chunkTileExtent,
+                [&](const TilePosition& tilePosition, Tile& tile) {
+                    if (clearTileLayersInternal(chunk, tile, layerTypesToClear)
+                        > 0) {
+                        layerWasCleared = true;
+
+                        // A layer was cleared. Rebuild the affected tile's
+                        // collision.
+                        rebuildTileCollision(tile, tilePosition);
+                    }
+                });
+
+            // Note: We can't erase the chunk while we're visiting it.
+            if (chunk.tileLayerCount == 0) {
+                emptiedChunks.push_back(chunkPosition);
             }
-        }
+        });
+
+    // Erase any chunks that are now completely empty.
+    for (const ChunkPosition& chunkPosition : emptiedChunks) {
+        chunks.erase(chunkPosition);
     }
 
     // If we're tracking tile updates, add this one to the history.
@@ -417,6 +432,8 @@ void TileMapBase::clear()
     tileExtent = {};
     chunks.clear();
     tileUpdateHistory.clear();
+    dirtyChunks.clear();
+    dirtyChunksHistoryIndex = 0;
 }
 
 const Chunk* TileMapBase::getChunk(const ChunkPosition& chunkPosition) const
@@ -488,10 +505,13 @@ void TileMapBase::rebuildDirtyTileCollision()
     // Rebuild the collision of any dirty tiles.
     for (auto it{dirtyCollisionQueue.begin()}; it != lastIt; ++it) {
         if (auto tileResult{getTile(*it)}) {
-            collisionLocator.updateTile(*it, tileResult->tile);
+            collisionLocator.updateTile(*it, tileResult->tile, graphicData);
         }
     }
 
+    // If tile collision merging is enabled, merge the affected chunks.
+    collisionLocator.mergeDirtyTileCollisionVolumes();
+
     dirtyCollisionQueue.clear();
 }
 
@@ -503,7 +523,23 @@ const std::vector<TileMapBase::TileUpdateVariant>&
 
 void TileMapBase::clearTileUpdateHistory()
 {
+    collectDirtyChunks();
     tileUpdateHistory.clear();
+    dirtyChunksHistoryIndex = 0;
+}
+
+const std::unordered_set<ChunkPosition>& TileMapBase::getDirtyChunks()
+{
+    collectDirtyChunks();
+    return dirtyChunks;
+}
+
+void TileMapBase::clearDirtyChunks()
+{
+    // Skip any history that hasn't been collected yet, since it's now
+    // considered clean.
+    dirtyChunks.clear();
+    dirtyChunksHistoryIndex = tileUpdateHistory.size();
 }
 
 void TileMapBase::loadChunk(const ChunkSnapshot& chunkSnapshot,
@@ -573,7 +609,7 @@ Chunk* TileMapBase::getOrCreateChunk(const ChunkPosition& chunkPosition)
     }
     else if (chunkResult.error() == ChunkError::NotFound) {
         // Chunk doesn't exist, create it.
-        auto chunkIt{chunks.emplace(chunkPosition, Chunk{}).first};
+        auto chunkIt{chunks.try_emplace(chunkPosition).first};
         return &(chunkIt->second);
     }
     else if (chunkResult.error() == ChunkError::InvalidPosition) {
@@ -596,7 +632,7 @@ TileMapBase::ChunkTilePtrPair
     }
     else if (chunkResult.error() == ChunkError::NotFound) {
         // Chunk doesn't exist, create it.
-        auto chunkIt{chunks.emplace(chunkPosition, Chunk{}).first};
+        auto chunkIt{chunks.try_emplace(chunkPosition).first};
         chunk = &(chunkIt->second);
     }
     else if (chunkResult.error() == ChunkError::InvalidPosition) {
@@ -639,18 +675,19 @@ void TileMapBase::addTileLayer(Chunk& chunk, Tile& tile,
     if (layerType == TileLayer::Type::Terrain) {
         // If there's an existing terrain, replace it.
         if (TileLayer * terrain{tile.findLayer(TileLayer::Type::Terrain)}) {
-            terrain->graphicSet = graphicSet;
+            terrain->graphicSetID = graphicSet.numericID;
             terrain->graphicValue = graphicValue;
         }
         else {
             // No existing terrain, add one.
-            tile.addLayer(tileOffset, TileLayer::Type::Terrain, graphicSet,
-                          graphicValue);
+            tile.addLayer(tileOffset, TileLayer::Type::Terrain,
+                          graphicSet.numericID, graphicValue);
             layerWasAdded = true;
         }
     }
     else {
-        tile.addLayer(tileOffset, layerType, graphicSet, graphicValue);
+        tile.addLayer(tileOffset, layerType, graphicSet.numericID,
+                      graphicValue);
         layerWasAdded = true;
     }
 
@@ -665,7 +702,8 @@ void TileMapBase::rebuildTileCollision(Tile& tile,
 {
     // If auto rebuild is enabled, rebuild the affected tile's collision.
     if (autoRebuildCollision) {
-        collisionLocator.updateTile(tilePosition, tile);
+        collisionLocator.updateTile(tilePosition, tile, graphicData);
+        collisionLocator.mergeDirtyTileCollisionVolumes();
     }
     else {
         // Not enabled. Queue the affected tile to have its collision rebuilt.
@@ -694,7 +732,7 @@ void TileMapBase::addNorthWall(const TilePosition& tilePosition,
         for (TileLayer& layer : tile->getLayers(TileLayer::Type::Wall)) {
             if ((layer.graphicValue == Wall::Type::North)
                 || (layer.graphicValue == Wall::Type::NorthWestGapFill)) {
-                layer.graphicSet = graphicSet;
+                layer.graphicSetID = graphicSet.numericID;
                 layer.graphicValue = Wall::Type::North;
                 replacedWall = true;
                 break;
@@ -737,17 +775,19 @@ void TileMapBase::addNorthWall(const TilePosition& tilePosition,
         addTileLayer(*eastChunk, *eastTile, {}, TileLayer::Type::Wall,
                      graphicSet, Wall::Type::NorthWestGapFill);
         rebuildTileCollision(*eastTile, eastPos);
+        markNeighborChunkDirty(eastPos);
     }
     else if (TileLayer
              * eastNorthWestGapFill{eastTile->findLayer(
                  TileLayer::Type::Wall, Wall::Type::NorthWestGapFill)}) {
         // The East tile has a NW gap fill. If its graphic set no longer
         // matches either surrounding wall, make it match the new wall.
-        int gapFillID{eastNorthWestGapFill->graphicSet.get().numericID};
+        int gapFillID{eastNorthWestGapFill->graphicSetID};
         int newNorthID{graphicSet.numericID};
-        int westID{northeastWestWall->graphicSet.get().numericID};
+        int westID{northeastWestWall->graphicSetID};
         if ((gapFillID != newNorthID) && (gapFillID != westID)) {
-            eastNorthWestGapFill->graphicSet = graphicSet;
+            eastNorthWestGapFill->graphicSetID = graphicSet.numericID;
+            markNeighborChunkDirty(eastPos);
         }
         rebuildTileCollision(*eastTile, eastPos);
     }
@@ -765,7 +805,7 @@ void TileMapBase::addWestWall(const TilePosition& tilePosition,
     // If there's an existing West wall, replace it.
     if (TileLayer
         * westWall{tile->findLayer(TileLayer::Type::Wall, Wall::Type::West)}) {
-        westWall->graphicSet = graphicSet;
+        westWall->graphicSetID = graphicSet.numericID;
     }
     else {
         // No existing West wall, add one.
@@ -816,20 +856,21 @@ void TileMapBase::addWestWall(const TilePosition& tilePosition,
         // The South tile has no walls. Add a NorthWestGapFill.
         addTileLayer(*southChunk, *southTile, {}, TileLayer::Type::Wall,
                      graphicSet, Wall::Type::NorthWestGapFill);
+        markNeighborChunkDirty(southPos);
     }
     else if (TileLayer
              * southNorthWestGapFill{southTile->findLayer(
                  TileLayer::Type::Wall, Wall::Type::NorthWestGapFill)}) {
         // The South tile has a NW gap fill. If its graphic set no longer
         // matches either surrounding wall, make it match the new wall.
-        int gapFillID{southNorthWestGapFill->graphicSet.get().numericID};
+        int gapFillID{southNorthWestGapFill->graphicSetID};
         int newWestID{graphicSet.numericID};
-        int northID{
-            southwestNorthWall
-                ? southwestNorthWall->graphicSet.get().numericID
-                : southwestNorthEastGapFill->graphicSet.get().numericID};
+        int northID{southwestNorthWall
+                        ? southwestNorthWall->graphicSetID
+                        : southwestNorthEastGapFill->graphicSetID};
         if ((gapFillID != newWestID) && (gapFillID != northID)) {
-            southNorthWestGapFill->graphicSet = graphicSet;
+            southNorthWestGapFill->graphicSetID = graphicSet.numericID;
+            markNeighborChunkDirty(southPos);
         }
     }
     rebuildTileCollision(*southTile, southPos);
@@ -997,7 +1038,8 @@ bool TileMapBase::remNorthWall(const TilePosition& tilePosition)
             if (remTileLayers(
                     eastChunk, eastTile, ChunkPosition{eastTilePosition},
                     TileLayer::Type::Wall, Wall::Type::NorthWestGapFill)) {
-                rebuildTileCollision(eastTile, tilePosition);
+                rebuildTileCollision(eastTile, eastTilePosition);
+                markNeighborChunkDirty(eastTilePosition);
             }
         }
     }
@@ -1038,7 +1080,8 @@ bool TileMapBase::remWestWall(const TilePosition& tilePosition)
             if (remTileLayers(
                     southChunk, southTile, ChunkPosition{southTilePosition},
                     TileLayer::Type::Wall, Wall::Type::NorthWestGapFill)) {
-                rebuildTileCollision(southTile, tilePosition);
+                rebuildTileCollision(southTile, southTilePosition);
+                markNeighborChunkDirty(southTilePosition);
             }
         }
 
@@ -1063,33 +1106,41 @@ Tile* TileMapBase::clearTileLayersInternal(
         return nullptr;
     }
 
+    // If we cleared any layers, check if the chunk is now empty.
+    if (clearTileLayersInternal(*chunk, *tile, layerTypesToClear) > 0) {
+        // If the chunk is now completely empty, erase it.
+        if (chunk->tileLayerCount == 0) {
+            chunks.erase(ChunkPosition{tilePosition});
+        }
+
+        return tile;
+    }
+
+    return nullptr;
+}
+
+std::size_t TileMapBase::clearTileLayersInternal(
+    Chunk& chunk, Tile& tile,
+    const std::array<bool, TileLayer::Type::Count>& layerTypesToClear)
+{
     // If we're being asked to clear every layer, clear the whole tile.
     std::size_t numRemoved{0};
     if (layerTypesToClear[TileLayer::Type::Terrain]
         && layerTypesToClear[TileLayer::Type::Floor]
         && layerTypesToClear[TileLayer::Type::Wall]
         && layerTypesToClear[TileLayer::Type::Object]) {
-        numRemoved = tile->clear();
+        numRemoved = tile.clear();
     }
     else {
-        numRemoved = tile->clearLayers(layerTypesToClear);
+        numRemoved = tile.clearLayers(layerTypesToClear);
     }
 
-    // If we cleared any layers, decrement the chunk's layer count.
-    if (numRemoved > 0) {
-        AM_ASSERT(chunk->tileLayerCount >= numRemoved,
-                  "tileLayerCount was not properly maintained.");
-        chunk->tileLayerCount -= static_cast<Uint16>(numRemoved);
-
-        // If the chunk is now completely empty, erase it.
-        if (chunk->tileLayerCount == 0) {
-            chunks.erase(ChunkPosition{tilePosition});
-        }
+    // Decrement the chunk's layer count.
+    AM_ASSERT(chunk.tileLayerCount >= numRemoved,
+              "tileLayerCount was not properly maintained.");
+    chunk.tileLayerCount -= static_cast<Uint16>(numRemoved);
 
-        return tile;
-    }
-
-    return nullptr;
+    return numRemoved;
 }
 
 std::array<bool, TileLayer::Type::Count> TileMapBase::toBoolArray(
@@ -1118,6 +1169,11 @@ void TileMapBase::loadChunkInternal(const T& chunkSnapshot,
         return;
     }
 
+    // Defer collision rebuilding until the whole chunk is loaded, so that
+    // CollisionLocator only needs to merge the chunk's collision once.
+    bool wasAutoRebuilding{autoRebuildCollision};
+    autoRebuildCollision = false;
+
     // Iterate each of the tiles in the chunk snapshot.
     std::size_t currentTileLayerStartIndex{0};
     std::size_t currentTileIndex{0};
@@ -1191,6 +1247,51 @@ void TileMapBase::loadChunkInternal(const T& chunkSnapshot,
         currentTileLayerStartIndex += tileLayerCount;
         currentTileIndex++;
     }
+
+    // If auto rebuild was enabled, rebuild the chunk's collision.
+    setAutoRebuildCollision(wasAutoRebuilding);
+}
+
+void TileMapBase::markNeighborChunkDirty(const TilePosition& tilePosition)
+{
+    // Note: Like the rest of the dirty chunk set, this is only maintained if
+    //       we're tracking tile updates.
+    if (trackTileUpdates) {
+        dirtyChunks.emplace(tilePosition);
+    }
+}
+
+void TileMapBase::collectDirtyChunks()
+{
+    auto visitor{VariantTools::Overload(
+        [&](const TileExtentClearLayers& update) {
+            // Note: We don't check if the chunks exist, since the update may
+            //       have emptied and erased them.
+            TileExtent clippedExtent{
+                update.tileExtent.intersectWith(tileExtent)};
+            if (clippedExtent.isEmpty()) {
+                return;
+            }
+
+            ChunkPosition minChunk{TilePosition{clippedExtent.min()}};
+            ChunkPosition maxChunk{TilePosition{clippedExtent.max()}};
+            for (int z{minChunk.z}; z <= maxChunk.z; ++z) {
+                for (int y{minChunk.y}; y <= maxChunk.y; ++y) {
+                    for (int x{minChunk.x}; x <= maxChunk.x; ++x) {
+                        dirtyChunks.emplace(x, y, z);
+                    }
+                }
+            }
+        },
+        [&](const auto& update) {
+            dirtyChunks.emplace(update.tilePosition);
+        })};
+
+    for (std::size_t i{dirtyChunksHistoryIndex}; i < tileUpdateHistory.size();
+         ++i) {
+        std::visit(visitor, tileUpdateHistory[i]);
+    }
+    dirtyChunksHistoryIndex = tileUpdateHistory.size();
 }
 
 } // End namespace AM
@@ -6,17 +6,22 @@
 #include "TilePosition.h"
 #include "TileExtent.h"
 #include "ChunkExtent.h"
+#include "ChunkPosition.h"
 #include "Terrain.h"
+#include "SparseGrid.h"
 #include "SharedConfig.h"
 #include "entt/fwd.hpp"
 #include "entt/entity/entity.hpp"
 #include <vector>
 #include <span>
 #include <optional>
+#include <algorithm>
+#include <limits>
 
 namespace AM
 {
 class Tile;
+class GraphicDataBase;
 struct Cylinder;
 struct BoundingBox;
 
@@ -34,6 +39,13 @@ struct BoundingBox;
  * Internally, collision volumes are organized into "cells", each of which has
  * a size corresponding to SharedConfig::COLLISION_LOCATOR_CELL_WIDTH. These
  * values can be tweaked to affect performance.
+ *
+ * Cells and terrain are stored sparsely, in chunk-sized blocks that are only
+ * allocated once something with collision is added to them. See SparseGrid.h.
+ *
+ * If tile collision merging is enabled, the wall and object collision volumes
+ * in each chunk are greedily merged into larger boxes. See
+ * mergeDirtyTileCollisionVolumes().
  */
 class CollisionLocator
 {
@@ -52,7 +64,13 @@ public:
         entt::entity entity{entt::null};
     };
 
-    CollisionLocator();
+    /**
+     * @param inMergeTileCollisionVolumes If true, wall and object collision
+     *                                    volumes will be merged. See
+     *                                    mergeDirtyTileCollisionVolumes().
+     */
+    CollisionLocator(bool inMergeTileCollisionVolumes
+                     = SharedConfig::MERGE_TILE_COLLISION_VOLUMES);
 
     /**
      * Sets this locator's internal grid size to match the given extent.
@@ -78,8 +96,39 @@ public:
      *
      * @param tilePosition The tile's position.
      * @param tile The tile to add.
+     * @param graphicData Used to look up the tile's graphic sets.
      */
-    void updateTile(const TilePosition& tilePosition, const Tile& tile);
+    void updateTile(const TilePosition& tilePosition, const Tile& tile,
+                    const GraphicDataBase& graphicData);
+
+    /**
+     * If tile collision merging is enabled, re-merges the tile collision
+     * volumes around any tiles that have been updated since the last call.
+     * Until this is called, those tiles' wall and object collision won't be
+     * present in this locator.
+     *
+     * Merging combines adjacent volumes that have matching collision layers
+     * and Z bounds, without ever adding any space that wasn't covered by the
+     * original volumes.
+     *
+     * Only the merged volumes that touch an updated tile (or its neighbors)
+     * are re-merged, so a single tile edit doesn't re-merge its whole chunk.
+     * Because of this, repeated edits may leave a chunk with a few more
+     * volumes than a fresh merge would produce.
+     *
+     * TileMapBase calls this whenever it rebuilds tile collision, so you
+     * normally don't need to call it manually.
+     */
+    void mergeDirtyTileCollisionVolumes();
+
+    /**
+     * Removes all tile collision within the given chunk, and frees any grid
+     * storage that the chunk no longer needs.
+     *
+     * Used when a chunk is evicted from the tile map. If the chunk is loaded
+     * again, its tiles must be re-added through updateTile().
+     */
+    void removeChunk(const ChunkPosition& chunkPosition);
 
     /**
      * Removes the given entity from this locator, if present.
@@ -131,6 +180,59 @@ public:
      */
     std::vector<RaycastHitInfo>& raycastAll(const RaycastParams& params);
 
+    /**
+     * A single ray within a batched raycast.
+     * Unlike RaycastParams, this owns its points, so it can be stored in
+     * containers.
+     */
+    struct BatchRaycastRay {
+        Vector3 start{};
+        Vector3 end{};
+        CollisionLayerBitSet collisionMask{};
+        std::span<entt::entity> entitiesToExclude{};
+        bool ignoreInsideHits{true};
+    };
+
+    /**
+     * The result of a single ray within a batched raycast.
+     */
+    struct BatchRaycastHit {
+        /** If true, the ray hit something and the fields below are valid. */
+        bool didHit{false};
+
+        /** The t value (along the ray) at which the object was hit. */
+        float hitT{std::numeric_limits<float>::infinity()};
+
+        /** A copy of the hit object's collision info. Since this is a copy,
+            it stays valid after the locator is modified. */
+        CollisionInfo collisionInfo{};
+    };
+
+    /**
+     * For each of the given rays, checks if it intersects any collision
+     * volume. If so, the matching element in results will have didHit ==
+     * true and will describe one of the hit objects.
+     *
+     * This doesn't use any of the locator's shared scratch or return
+     * vectors, so it's safe to call concurrently from multiple threads, as
+     * long as nothing is modifying the locator at the same time.
+     *
+     * @param results Caller-owned storage. Must be at least as large as rays.
+     *                Each element will be overwritten.
+     */
+    void raycastAnyBatch(std::span<const BatchRaycastRay> rays,
+                         std::span<BatchRaycastHit> results) const;
+
+    /**
+     * For each of the given rays, finds the first collision volume that it
+     * intersects. See raycastAnyBatch() for thread safety info.
+     *
+     * @param results Caller-owned storage. Must be at least as large as rays.
+     *                Each element will be overwritten.
+     */
+    void raycastFirstBatch(std::span<const BatchRaycastRay> rays,
+                           std::span<BatchRaycastHit> results) const;
+
     /**
      * Returns all collision volumes that intersect the given cylinder.
      *
@@ -206,12 +308,19 @@ public:
         getCollisionsBroad(const ChunkExtent& chunkExtent,
                            CollisionLayerBitSet collisionMask);
 
+    /**
+     * Returns the number of bytes used by this locator's collision and
+     * terrain grids (not including the contents of each collision cell).
+     */
+    std::size_t getGridMemoryUsage() const;
+
 private:
     /** Raycast strategies. Defined here so they have access to the locator's
         private members. */
     struct RaycastStrategyIntersectAny;
     struct RaycastStrategyIntersectFirst;
     struct RaycastStrategyIntersectAll;
+    struct RaycastStrategyBatch;
 
     /** The width of a grid cell in world units. */
     static constexpr float CELL_WORLD_WIDTH{
@@ -230,6 +339,18 @@ private:
     /** A value to use in terrainGrid to indicate that a tile has no terrain. */
     static constexpr Terrain::Value EMPTY_TERRAIN{SDL_MAX_UINT8};
 
+    /** The X and Y axis length of a collisionGrid block, in cells. Blocks are
+        sized to match a chunk, so that unpopulated chunks cost no cell
+        storage. */
+    static constexpr int BLOCK_CELL_WIDTH{std::max(
+        static_cast<int>(SharedConfig::CHUNK_WIDTH
+                         / SharedConfig::COLLISION_LOCATOR_CELL_WIDTH),
+        1)};
+
+    /** The X and Y axis length of a terrainGrid block, in tiles. */
+    static constexpr int BLOCK_TILE_WIDTH{
+        static_cast<int>(SharedConfig::CHUNK_WIDTH)};
+
     /**
      * Adds the given index to the collisionGrid cells within the given extent.
      */
@@ -246,13 +367,77 @@ private:
     /**
      * Adds the given tile's collision volumes to the collision and terrain
      * grids.
+     *
+     * If we're merging tile collision volumes, the tile's wall and object
+     * volumes are instead added to unmergedTileVolumes, to be added to the
+     * grid when the tile's chunk is merged.
      */
     void addTileCollisionVolumes(const TilePosition& tilePosition,
-                                 const Tile& tile);
+                                 const Tile& tile,
+                                 const GraphicDataBase& graphicData);
+
+    /**
+     * Adds the given non-entity collision volume to collisionVolumes and
+     * collisionGrid.
+     *
+     * @return The volume's index in collisionVolumes.
+     */
+    Uint16 addStaticCollisionVolume(const BoundingBox& collisionVolume,
+                                    CollisionLayerBitSet collisionLayers);
+
+    /**
+     * A tile collision volume that's being merged, along with the tiles that
+     * it was built from.
+     */
+    struct TileMergeVolume {
+        CollisionInfo collisionInfo{};
+
+        /** The extent of the tiles whose unmerged volumes were combined to
+            make this volume. */
+        TileExtent sourceTileExtent{};
+    };
+
+    /**
+     * A merged tile collision volume that's in the grid.
+     */
+    struct MergedVolume {
+        /** The volume's index in collisionVolumes. */
+        Uint16 volumeIndex{};
+
+        /** See TileMergeVolume::sourceTileExtent. */
+        TileExtent sourceTileExtent{};
+    };
+
+    /**
+     * Re-merges the volumes around the given dirty tiles, which must all be
+     * within the given chunk.
+     */
+    void remergeChunkTiles(const ChunkPosition& chunkPosition,
+                           std::span<const TilePosition> dirtyTiles);
+
+    /**
+     * Removes the given static (tile) collision volume from the grid and
+     * frees its index.
+     */
+    void removeStaticCollisionVolume(Uint16 volumeIndex);
+
+    /**
+     * Returns the cell extent that the given static volume is added to.
+     * Each length is clamped to at least 1, so that planes are still added
+     * to a cell.
+     */
+    static CellExtent
+        getStaticVolumeCellExtent(const BoundingBox& collisionVolume);
+
+    /**
+     * Greedily merges the given volumes into as few boxes as possible, first
+     * along the X axis, then along the Y axis.
+     */
+    static void mergeVolumes(std::vector<TileMergeVolume>& volumes);
 
     template<typename RaycastStrategy>
     void raycastInternal(RaycastStrategy& strategy,
-                         const RaycastParams& params);
+                         const RaycastParams& params) const;
 
     /**
      * Performs a broad phase to get all collision volumes in cells intersected
@@ -275,44 +460,6 @@ private:
                            const CellExtent& cellExtent,
                            CollisionLayerBitSet collisionMask);
 
-    /**
-     * Returns the index in the collisionGrid vector where the cell with the
-     * given coordinates can be found.
-     */
-    inline std::size_t
-        linearizeCellIndex(const CellPosition& cellPosition) const
-    {
-        // Translate the given position from actual-space to positive-space.
-        CellPosition positivePosition{cellPosition.x - gridCellExtent.x,
-                                      cellPosition.y - gridCellExtent.y,
-                                      cellPosition.z - gridCellExtent.z};
-
-        return static_cast<std::size_t>(
-            (gridCellExtent.xLength * gridCellExtent.yLength
-             * positivePosition.z)
-            + (gridCellExtent.xLength * positivePosition.y)
-            + positivePosition.x);
-    }
-
-    /**
-     * Returns the index in the terrainGrid vector where the tile with the
-     * given coordinates can be found.
-     */
-    inline std::size_t
-        linearizeTileIndex(const TilePosition& tilePosition) const
-    {
-        // Translate the given position from actual-space to positive-space.
-        TilePosition positivePosition{tilePosition.x - gridTileExtent.x,
-                                      tilePosition.y - gridTileExtent.y,
-                                      tilePosition.z - gridTileExtent.z};
-
-        return static_cast<std::size_t>(
-            (gridTileExtent.xLength * gridTileExtent.yLength
-             * positivePosition.z)
-            + (gridTileExtent.xLength * positivePosition.y)
-            + positivePosition.x);
-    }
-
     /** The grid's extent, with tiles as the unit. */
     TileExtent gridTileExtent;
 
@@ -326,25 +473,52 @@ private:
     /** Tracks which indices in collisionVolumes are free to use. */
     std::vector<Uint16> freeCollisionVolumesIndices;
 
-    /** The outer vector is a 3D grid stored in row-major order, holding the
-        grid's cells.
+    /** A sparse 3D grid holding the grid's cells.
         Each element in the grid is a vector of volumes--the volumes that
         currently intersect with that cell (represented by their index in
         collisionVolumes). */
-    std::vector<std::vector<Uint16>> collisionGrid;
+    SparseGrid<DiscreteImpl::CellTag, std::vector<Uint16>, BLOCK_CELL_WIDTH,
+               BLOCK_CELL_WIDTH, 1>
+        collisionGrid;
 
     /** A map of entities -> the index of their collision volumes in
         collisionVolumes. */
     std::unordered_map<entt::entity, Uint16> entityMap;
     /** A map of tiles -> the indices of their layer's collision volumes in
-        collisionVolumes. */
+        collisionVolumes.
+        Unused if we're merging tile collision volumes. */
     std::unordered_map<TilePosition, std::vector<Uint16>> tileMap;
 
-    /** A 3D grid where each element holds the terrain of the associated tile.
+    /** If true, wall and object collision volumes are merged before being
+        added to the grid. */
+    bool mergeTileCollisionVolumes;
+
+    /** If we're merging tile collision volumes, this holds each tile's
+        unmerged wall and object collision volumes. */
+    std::unordered_map<TilePosition, std::vector<CollisionInfo>>
+        unmergedTileVolumes;
+
+    /** A map of chunks -> their merged tile collision volumes. */
+    std::unordered_map<ChunkPosition, std::vector<MergedVolume>>
+        mergedChunkMap;
+
+    /** The tiles that have been updated since they were last merged. */
+    std::vector<TilePosition> dirtyMergeTiles;
+
+    /** A scratch vector used while merging a chunk's volumes. */
+    std::vector<TileMergeVolume> mergeVector;
+
+    /** A scratch vector holding the tile extents that are being re-merged. */
+    std::vector<TileExtent> remergeExtents;
+
+    /** A sparse 3D grid where each element holds the terrain of the
+        associated tile.
         Since terrain can be fully described by its 1B value, it's more
         efficient to store the value and construct the bounding box as needed
         instead of storing it in collisionGrid. */
-    std::vector<Terrain::Value> terrainGrid;
+    SparseGrid<DiscreteImpl::TileTag, Terrain::Value, BLOCK_TILE_WIDTH,
+               BLOCK_TILE_WIDTH, 1>
+        terrainGrid;
 
     /** Holds the collision info of any Terrain tile layers that were hit during
         the last query (so that the query result has somewhere to point to). */
@@ -1,6 +1,8 @@
 #pragma once
 
 #include "CollisionLocator.h"
+#include "BoundingBox.h"
+#include <array>
 
 namespace AM
 {
@@ -61,4 +63,77 @@ private:
     CollisionLocator& collisionLocator;
 };
 
+/**
+ * Used by the batched raycasts. Unlike the other strategies, this one only
+ * reads from the locator and writes its result into caller-owned storage, so
+ * it can be used from multiple threads at once.
+ *
+ * Candidate volumes are gathered into small packets and tested against the
+ * ray simultaneously (using SIMD, when available).
+ */
+struct CollisionLocator::RaycastStrategyBatch {
+    /**
+     * @param inStopAtAnyHit If true, the raycast will end as soon as anything
+     *                       is hit. If false, the earliest hit will be found.
+     * @param inHit Where to write the result.
+     */
+    RaycastStrategyBatch(const CollisionLocator& inCollisionLocator,
+                         bool inStopAtAnyHit, BatchRaycastHit& inHit);
+
+    bool isDone() const;
+
+    void intersectObjectsInCell(const Vector3& start,
+                                const Vector3& inverseRayDirection,
+                                const CellPosition& cellPosition,
+                                CollisionLayerBitSet collisionMask,
+                                std::span<entt::entity> entitiesToExclude,
+                                bool ignoreInsideHits);
+
+private:
+    /** The number of volumes that get tested at once. */
+    static constexpr std::size_t PACKET_WIDTH{4};
+
+    /**
+     * A group of volumes, stored in SoA layout so that they can be tested
+     * against a ray simultaneously.
+     */
+    struct VolumePacket {
+        alignas(16) std::array<float, PACKET_WIDTH> minX{};
+        alignas(16) std::array<float, PACKET_WIDTH> minY{};
+        alignas(16) std::array<float, PACKET_WIDTH> minZ{};
+        alignas(16) std::array<float, PACKET_WIDTH> maxX{};
+        alignas(16) std::array<float, PACKET_WIDTH> maxY{};
+        alignas(16) std::array<float, PACKET_WIDTH> maxZ{};
+
+        /** The info of each volume. If nullptr, the volume is terrain (which
+            has no persistent info). */
+        std::array<const CollisionInfo*, PACKET_WIDTH> collisionInfos{};
+
+        /** The number of volumes in this packet. */
+        std::size_t count{0};
+    };
+
+    /**
+     * Adds the given volume to the packet. If the packet becomes full, it
+     * gets flushed.
+     */
+    void pushVolume(const BoundingBox& collisionVolume,
+                    const CollisionInfo* collisionInfo, const Vector3& start,
+                    const Vector3& inverseRayDirection);
+
+    /**
+     * Tests all volumes in the packet against the ray, records any hits, and
+     * empties the packet.
+     */
+    void flushPacket(const Vector3& start, const Vector3& inverseRayDirection);
+
+    const CollisionLocator& collisionLocator;
+
+    bool stopAtAnyHit;
+
+    BatchRaycastHit& hit;
+
+    VolumePacket packet;
+};
+
 } // End namespace AM
@@ -4,9 +4,12 @@
 #include "CellPosition.h"
 #include "TileExtent.h"
 #include "ChunkExtent.h"
+#include "SparseGrid.h"
+#include "SharedConfig.h"
 #include "entt/fwd.hpp"
 #include <vector>
 #include <unordered_map>
+#include <algorithm>
 
 namespace AM
 {
@@ -30,6 +33,9 @@ struct BoundingBox;
  * Internally, entities are organized into "cells", each of which has a size
  * corresponding to SharedConfig::ENTITY_LOCATOR_CELL_WIDTH/HEIGHT. These values
  * can be tweaked to affect performance.
+ *
+ * Cells are stored sparsely, in chunk-sized blocks that are only allocated
+ * once an entity enters them. See SparseGrid.h.
  */
 class EntityLocator
 {
@@ -98,6 +104,23 @@ public:
      */
     std::vector<entt::entity>& getEntitiesBroad(const ChunkExtent& chunkExtent);
 
+    /**
+     * Thread-safe overloads of the above queries.
+     *
+     * These write their results into outEntities instead of this locator's
+     * shared return vector, so they're safe to call concurrently from
+     * multiple threads, as long as nothing is modifying the locator or the
+     * registry's Position storage at the same time.
+     */
+    void getEntities(const Cylinder& cylinder,
+                     std::vector<entt::entity>& outEntities) const;
+    void getEntities(const TileExtent& tileExtent,
+                     std::vector<entt::entity>& outEntities) const;
+    void getEntitiesBroad(const Cylinder& cylinder,
+                          std::vector<entt::entity>& outEntities) const;
+    void getEntitiesBroad(const TileExtent& tileExtent,
+                          std::vector<entt::entity>& outEntities) const;
+
 private:
     /** The width of a grid cell in world units. */
     static constexpr float CELL_WORLD_WIDTH{
@@ -109,6 +132,21 @@ private:
         SharedConfig::ENTITY_LOCATOR_CELL_HEIGHT
         * SharedConfig::TILE_WORLD_HEIGHT};
 
+    /** The X and Y axis length of a grid block, in cells. Blocks are sized
+        to match a chunk, so that unpopulated chunks cost no cell storage. */
+    static constexpr int BLOCK_CELL_WIDTH{std::max(
+        static_cast<int>(SharedConfig::CHUNK_WIDTH
+                         / SharedConfig::ENTITY_LOCATOR_CELL_WIDTH),
+        1)};
+
+    /**
+     * Adds the entities in every cell within the given extent to outEntities.
+     *
+     * @pre cellExtent must be pre-clipped to this locator's bounds.
+     */
+    void addCellEntities(const CellExtent& cellExtent,
+                         std::vector<entt::entity>& outEntities) const;
+
     /**
      * Removes the given entity from the given cell.
      *
@@ -118,36 +156,18 @@ private:
     void clearEntityFromCell(entt::entity entity,
                              const CellPosition& clearPosition);
 
-    /**
-     * Returns the index in the entityGrid vector where the cell with the given
-     * coordinates can be found.
-     */
-    inline std::size_t
-        linearizeCellIndex(const CellPosition& cellPosition) const
-    {
-        // Translate the given position from actual-space to positive-space.
-        CellPosition positivePosition{cellPosition.x - gridCellExtent.x,
-                                      cellPosition.y - gridCellExtent.y,
-                                      cellPosition.z - gridCellExtent.z};
-
-        return static_cast<std::size_t>(
-            (gridCellExtent.xLength * gridCellExtent.yLength
-             * positivePosition.z)
-            + (gridCellExtent.xLength * positivePosition.y)
-            + positivePosition.x);
-    }
-
     /** Used for fetching entity positions during narrow phases. */
     entt::registry& registry;
 
     /** The grid's extent, with cells as the unit. */
     CellExtent gridCellExtent;
 
-    /** The outer vector is a 3D grid stored in row-major order, holding the
-        grid's cells.
+    /** A sparse 3D grid holding the grid's cells.
         Each element in the grid is a vector of entities--the entities that
         currently intersect with that cell. */
-    std::vector<std::vector<entt::entity>> entityGrid;
+    SparseGrid<DiscreteImpl::CellTag, std::vector<entt::entity>,
+               BLOCK_CELL_WIDTH, BLOCK_CELL_WIDTH, 1>
+        entityGrid;
 
     /** A map of entity ID -> the cell that the entity is located in.
         Used to easily find the entity during removal. */
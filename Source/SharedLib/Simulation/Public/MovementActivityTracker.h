@@ -0,0 +1,115 @@
+#pragma once
+
+#include "EnttObserver.h"
+#include "entt/fwd.hpp"
+#include <vector>
+
+namespace AM
+{
+struct Input;
+struct Movement;
+struct Position;
+struct PreviousPosition;
+
+/**
+ * Partitions movement-enabled entities into "active" and "sleeping" sets, so
+ * that movement systems only need to process the entities that might move.
+ *
+ * An entity is woken when its Input or Movement is constructed or updated
+ * (e.g. when a client presses a key, or when an entity is teleported). It's
+ * put back to sleep once it has no inputs, isn't airborne, and didn't move
+ * during the last tick.
+ *
+ * Note: Input and Movement changes that don't go through the registry's
+ *       patch()/replace() won't be observed. In those cases, call wake()
+ *       manually.
+ */
+class MovementActivityTracker
+{
+public:
+    MovementActivityTracker(entt::registry& inRegistry);
+
+    ~MovementActivityTracker();
+
+    /**
+     * Wakes the given entity, so that it will be processed on the next call
+     * to forEachActive().
+     */
+    void wake(entt::entity entity);
+
+    /**
+     * Calls the given function on each active entity in the given movement
+     * group. Any entities that the function returns false for will be put to
+     * sleep.
+     *
+     * Also updates the active and sleeping entity counts.
+     *
+     * @param function A function with the signature bool(entt::entity). Must
+     *                 not wake any entities.
+     */
+    template<typename Group, typename Function>
+    void forEachActive(const Group& movementGroup, Function&& function)
+    {
+        entitiesToSleep.clear();
+        for (entt::entity entity : activeEntities) {
+            // If the entity was destroyed or is no longer movement-enabled,
+            // drop it.
+            if (!(movementGroup.contains(entity))) {
+                entitiesToSleep.push_back(entity);
+            }
+            else if (!function(entity)) {
+                entitiesToSleep.push_back(entity);
+            }
+        }
+
+        for (entt::entity entity : entitiesToSleep) {
+            activeEntities.remove(entity);
+        }
+
+        activeEntityCount = activeEntities.size();
+        sleepingEntityCount = movementGroup.size() - activeEntityCount;
+    }
+
+    /**
+     * Returns true if an entity with the given state is able to sleep (it has
+     * no inputs, isn't airborne, and didn't move during the last tick).
+     */
+    static bool canSleep(const Input& input, const Movement& movement,
+                         const Position& position,
+                         const PreviousPosition& previousPosition);
+
+    /**
+     * Returns the number of entities that were processed during the last
+     * call to forEachActive().
+     */
+    std::size_t getActiveEntityCount() const;
+
+    /**
+     * Returns the number of movement-enabled entities that were skipped
+     * during the last call to forEachActive().
+     */
+    std::size_t getSleepingEntityCount() const;
+
+private:
+    /**
+     * Removes the given entity from the active set.
+     */
+    void onEntityDestroyed(entt::entity entity);
+
+    /** Used to disconnect our destroy listener. */
+    entt::registry& registry;
+
+    /** The currently active entities. Entities are added automatically
+        when their Input or Movement is constructed or updated. */
+    EnttObserver activeEntities;
+
+    /** Scratch vector used to hold the entities that are going to sleep. */
+    std::vector<entt::entity> entitiesToSleep;
+
+    /** The number of active and sleeping entities, as of the last call to
+        forEachActive(). */
+    std::size_t activeEntityCount;
+    std::size_t sleepingEntityCount;
+};
+
+} // End namespace AM
@@ -0,0 +1,282 @@
+#pragma once
+
+#include "DiscreteExtent.h"
+#include "DiscretePosition.h"
+#include "AMAssert.h"
+#include <array>
+#include <vector>
+#include <memory>
+#include <algorithm>
+
+namespace AM
+{
+/**
+ * A sparse 3D grid of elements, used by our spatial partitioning locators.
+ *
+ * Elements are grouped into fixed-size blocks. The grid holds a dense table
+ * of block pointers, but a block is only allocated the first time one of its
+ * elements is written to. Since most of a large map is typically empty (e.g.
+ * ocean or sky), this saves a lot of memory compared to a fully dense grid.
+ *
+ * Reads of unallocated blocks return emptyValue, so queries never need to
+ * allocate.
+ *
+ * @tparam Tag The discrete unit that this grid uses (tiles, cells, etc).
+ * @tparam T The element type.
+ * @tparam BLOCK_X_LENGTH The X-axis length of a block, in elements.
+ * @tparam BLOCK_Y_LENGTH The Y-axis length of a block, in elements.
+ * @tparam BLOCK_Z_LENGTH The Z-axis length of a block, in elements.
+ */
+template<typename Tag, typename T, int BLOCK_X_LENGTH, int BLOCK_Y_LENGTH,
+         int BLOCK_Z_LENGTH>
+class SparseGrid
+{
+public:
+    static_assert((BLOCK_X_LENGTH > 0) && (BLOCK_Y_LENGTH > 0)
+                      && (BLOCK_Z_LENGTH > 0),
+                  "Block lengths must be positive.");
+
+    /** The number of elements in a single block. */
+    static constexpr std::size_t BLOCK_ELEMENT_COUNT{
+        static_cast<std::size_t>(BLOCK_X_LENGTH * BLOCK_Y_LENGTH
+                                 * BLOCK_Z_LENGTH)};
+
+    /**
+     * @param inEmptyValue The value that unallocated elements are considered
+     *                     to hold. Newly allocated blocks are filled with it.
+     */
+    explicit SparseGrid(const T& inEmptyValue = T{})
+    : gridExtent{}
+    , blockXCount{0}
+    , blockYCount{0}
+    , blockZCount{0}
+    , blocks{}
+    , emptyValue{inEmptyValue}
+    {
+    }
+
+    /**
+     * Sets this grid's extent, clearing all existing elements.
+     */
+    void setExtent(const DiscreteExtent<Tag>& newExtent)
+    {
+        gridExtent = newExtent;
+        blockXCount = ceilDiv(gridExtent.xLength, BLOCK_X_LENGTH);
+        blockYCount = ceilDiv(gridExtent.yLength, BLOCK_Y_LENGTH);
+        blockZCount = ceilDiv(gridExtent.zLength, BLOCK_Z_LENGTH);
+
+        blocks.clear();
+        blocks.resize(static_cast<std::size_t>(blockXCount * blockYCount
+                                               * blockZCount));
+    }
+
+    /**
+     * Returns this grid's extent.
+     */
+    const DiscreteExtent<Tag>& getExtent() const { return gridExtent; }
+
+    /**
+     * Returns the element at the given position. If its block hasn't been
+     * allocated, returns emptyValue.
+     *
+     * @pre position must be within this grid's extent.
+     */
+    const T& get(const DiscretePosition<Tag>& position) const
+    {
+        auto [blockIndex, elementIndex] = linearize(position);
+        if (const Block* block{blocks[blockIndex].get()}) {
+            return block->elements[elementIndex];
+        }
+
+        return emptyValue;
+    }
+
+    /**
+     * Returns a pointer to the element at the given position, or nullptr if
+     * its block hasn't been allocated.
+     *
+     * @pre position must be within this grid's extent.
+     */
+    T* find(const DiscretePosition<Tag>& position)
+    {
+        auto [blockIndex, elementIndex] = linearize(position);
+        if (Block* block{blocks[blockIndex].get()}) {
+            return &(block->elements[elementIndex]);
+        }
+
+        return nullptr;
+    }
+
+    /**
+     * Returns the element at the given position, allocating its block if
+     * necessary.
+     *
+     * @pre position must be within this grid's extent.
+     */
+    T& getOrCreate(const DiscretePosition<Tag>& position)
+    {
+        auto [blockIndex, elementIndex] = linearize(position);
+        std::unique_ptr<Block>& block{blocks[blockIndex]};
+        if (!block) {
+            block = std::make_unique<Block>();
+            block->elements.fill(emptyValue);
+        }
+
+        return block->elements[elementIndex];
+    }
+
+    /**
+     * Frees all allocated blocks, leaving the extent unchanged.
+     */
+    void clear()
+    {
+        for (std::unique_ptr<Block>& block : blocks) {
+            block.reset();
+        }
+    }
+
+    /**
+     * Frees any allocated blocks that intersect the given extent and only
+     * hold emptyValue.
+     *
+     * @pre extent must be within this grid's extent.
+     */
+    void releaseEmptyBlocks(const DiscreteExtent<Tag>& extent)
+    {
+        if (extent.isEmpty()) {
+            return;
+        }
+
+        // Find the range of blocks that the extent intersects.
+        int minBlockX{(extent.x - gridExtent.x) / BLOCK_X_LENGTH};
+        int minBlockY{(extent.y - gridExtent.y) / BLOCK_Y_LENGTH};
+        int minBlockZ{(extent.z - gridExtent.z) / BLOCK_Z_LENGTH};
+        int maxBlockX{(extent.xMax() - gridExtent.x) / BLOCK_X_LENGTH};
+        int maxBlockY{(extent.yMax() - gridExtent.y) / BLOCK_Y_LENGTH};
+        int maxBlockZ{(extent.zMax() - gridExtent.z) / BLOCK_Z_LENGTH};
+
+        for (int blockZ{minBlockZ}; blockZ <= maxBlockZ; ++blockZ) {
+            for (int blockY{minBlockY}; blockY <= maxBlockY; ++blockY) {
+                for (int blockX{minBlockX}; blockX <= maxBlockX; ++blockX) {
+                    std::unique_ptr<Block>& block{
+                        blocks[static_cast<std::size_t>(
+                            (blockXCount * blockYCount * blockZ)
+                            + (blockXCount * blockY) + blockX)]};
+                    if (block
+                        && std::all_of(block->elements.begin(),
+                                       block->elements.end(),
+                                       [this](const T& element) {
+                                           return (element == emptyValue);
+                                       })) {
+                        block.reset();
+                    }
+                }
+            }
+        }
+    }
+
+    /**
+     * Returns the number of blocks that are currently allocated.
+     */
+    std::size_t getAllocatedBlockCount() const
+    {
+        std::size_t count{0};
+        for (const std::unique_ptr<Block>& block : blocks) {
+            if (block) {
+                count++;
+            }
+        }
+
+        return count;
+    }
+
+    /**
+     * Returns the number of bytes used by the block table and the allocated
+     * blocks.
+     * Note: This doesn't include any heap memory that's owned by the
+     *       elements themselves (e.g. if T is a vector).
+     */
+    std::size_t getMemoryUsage() const
+    {
+        return (blocks.capacity() * sizeof(std::unique_ptr<Block>))
+               + (getAllocatedBlockCount() * sizeof(Block));
+    }
+
+    /**
+     * Returns the number of bytes that a fully dense grid with this grid's
+     * extent would use.
+     */
+    std::size_t getDenseMemoryUsage() const
+    {
+        return (gridExtent.size() * sizeof(T));
+    }
+
+private:
+    struct Block {
+        /** The elements in this block, stored in row-major order. */
+        std::array<T, BLOCK_ELEMENT_COUNT> elements;
+    };
+
+    struct LinearIndex {
+        /** The index in blocks where the element's block can be found. */
+        std::size_t blockIndex{};
+
+        /** The index in the block's elements array where the element can be
+            found. */
+        std::size_t elementIndex{};
+    };
+
+    static constexpr int ceilDiv(int numerator, int denominator)
+    {
+        return ((numerator + denominator - 1) / denominator);
+    }
+
+    /**
+     * Returns the indices where the element with the given coordinates can be
+     * found.
+     */
+    inline LinearIndex linearize(const DiscretePosition<Tag>& position) const
+    {
+        AM_ASSERT(gridExtent.contains(position),
+                  "Tried to access position outside of grid.");
+
+        // Translate the given position from actual-space to positive-space.
+        int positiveX{position.x - gridExtent.x};
+        int positiveY{position.y - gridExtent.y};
+        int positiveZ{position.z - gridExtent.z};
+
+        // Split the position into a block position and an offset within the
+        // block.
+        int blockX{positiveX / BLOCK_X_LENGTH};
+        int blockY{positiveY / BLOCK_Y_LENGTH};
+        int blockZ{positiveZ / BLOCK_Z_LENGTH};
+        int offsetX{positiveX % BLOCK_X_LENGTH};
+        int offsetY{positiveY % BLOCK_Y_LENGTH};
+        int offsetZ{positiveZ % BLOCK_Z_LENGTH};
+
+        return {static_cast<std::size_t>(
+                    (blockXCount * blockYCount * blockZ)
+                    + (blockXCount * blockY) + blockX),
+                static_cast<std::size_t>(
+                    (BLOCK_X_LENGTH * BLOCK_Y_LENGTH * offsetZ)
+                    + (BLOCK_X_LENGTH * offsetY) + offsetX)};
+    }
+
+    /** The grid's extent. */
+    DiscreteExtent<Tag> gridExtent;
+
+    /** The number of blocks along each axis. */
+    int blockXCount;
+    int blockYCount;
+    int blockZCount;
+
+    /** A 3D grid of blocks stored in row-major order. Unallocated blocks are
+        nullptr. */
+    std::vector<std::unique_ptr<Block>> blocks;
+
+    /** The value that elements in unallocated blocks are considered to
+        hold. */
+    T emptyValue;
+};
+
+} // End namespace AM
@@ -4,6 +4,7 @@
 #include "SharedConfig.h"
 #include <SDL3/SDL_stdinc.h>
 #include <array>
+#include <vector>
 
 namespace AM
 {
@@ -20,6 +21,17 @@ struct Sprite;
 class Chunk
 {
 public:
+    /** The number of layer slots that a tile reserves in layerPool when it
+        gets its first layer. Most tiles only have a terrain and maybe a
+        floor or wall, so this lets them avoid ever being relocated. */
+    static constexpr Uint8 INITIAL_TILE_LAYER_CAPACITY{2};
+
+    Chunk();
+
+    // Our tiles hold pointers to this chunk, so it can't be copied or moved.
+    Chunk(const Chunk&) = delete;
+    Chunk& operator=(const Chunk&) = delete;
+
     /** The number of tiles in the tiles array that are non-empty.
         Used to tell when this chunk is empty and can be deleted. */
     Uint16 tileLayerCount{0};
@@ -34,13 +46,40 @@ public:
     Tile& getTile(Uint16 tileOffsetX, Uint16 tileOffsetY);
     const Tile& getTile(Uint16 tileOffsetX, Uint16 tileOffsetY) const;
 
+    /**
+     * Returns the number of bytes used by this chunk, including its layer
+     * pool.
+     */
+    std::size_t getMemoryUsage() const;
+
 private:
+    friend class Tile;
+
+    /**
+     * Reserves more slots in layerPool for the given tile, moving its layers
+     * to the end of the pool if they can't be grown in place.
+     */
+    void growTileLayers(Tile& tile);
+
+    /**
+     * Rebuilds layerPool without any abandoned slots.
+     */
+    void compactLayerPool();
+
     /**
      * Returns a morton code for the given x and y.
      * We use morton codes to lay out our tiles in a more cache-friendly way
      * since we're likely to be accessing neighbors at the same time.
      */
     Uint32 mortonEncode(Uint16 x, Uint16 y) const;
+
+    /** The layers of all tiles in this chunk. Each tile owns a contiguous
+        range of slots, described by its layerOffset and layerCapacity. */
+    std::vector<TileLayer> layerPool;
+
+    /** The number of slots in layerPool that were abandoned when a tile's
+        layers were moved. When this gets too high, we compact the pool. */
+    std::size_t abandonedLayerSlots;
 };
 
 } // End namespace AM
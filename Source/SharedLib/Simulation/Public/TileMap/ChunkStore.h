@@ -0,0 +1,224 @@
+#pragma once
+
+#include "ChunkPosition.h"
+#include "ChunkSnapshot.h"
+#include "BinaryBuffer.h"
+#include "MappedFile.h"
+#include <SDL3/SDL_stdinc.h>
+#include <unordered_map>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace AM
+{
+struct TileMapSnapshot;
+
+/**
+ * A chunk-addressed on-disk tile map format. Lets us save only the chunks
+ * that changed, instead of re-writing the whole map.
+ *
+ * The store consists of two files:
+ *   <base>.<generation>.chunks: An append-only log of chunk records. Each
+ *     record is a RECORD_HEADER_SIZE header (chunk x, y, z, payload size)
+ *     followed by a serialized ChunkSnapshot. A chunk may have many records,
+ *     only the latest one is live.
+ *   <base>.index: The map's header data, the current generation, and the
+ *     location of each chunk's live record.
+ *
+ * Saving appends records for the changed chunks, syncs the data file, then
+ * atomically replaces the index. If we crash partway through, the old index
+ * still points at valid records, and the unreferenced tail of the data file
+ * is truncated by the next save.
+ *
+ * Since old records are left in place, the data file grows over time. Use
+ * compact() (or "MapTool compact") to rewrite it with only the live records.
+ * Compaction writes to a new generation's data file, so the old file stays
+ * valid until the new index is in place.
+ *
+ * Records are read through a memory mapping of the data file, so reading a
+ * chunk only touches that chunk's pages. This lets the server open a map of
+ * any size in roughly constant time, then fault chunks in as they're needed.
+ *
+ * Thread safety: One thread may write (save(), compact(), importSnapshot(),
+ * setMapInfo()) while another reads chunks (readChunk()). Writers only hold
+ * storeMutex while updating the index, never while doing disk I/O.
+ */
+class ChunkStore
+{
+public:
+    /** The version of the store's file format. */
+    static constexpr Uint16 STORE_FORMAT_VERSION{1};
+
+    /** The size of each record's header in the data file. */
+    static constexpr std::size_t RECORD_HEADER_SIZE{16};
+
+    /** Chunk updates to save. A nullopt snapshot means the chunk was
+        removed. */
+    using ChunkUpdateMap
+        = std::unordered_map<ChunkPosition, std::optional<ChunkSnapshot>>;
+
+    /** The location of a chunk's live record within the data file. */
+    struct RecordLocation {
+        /** The offset of the record's header. */
+        Uint64 offset{0};
+
+        /** The size of the record's payload. */
+        Uint32 payloadSize{0};
+    };
+
+    /**
+     * @param inBasePath  The path to the store's files, without extension
+     *                    (e.g. "<BASE_PATH>/TileMap").
+     */
+    ChunkStore(const std::string& inBasePath);
+
+    /**
+     * @return true if the store's index file exists, else false.
+     */
+    bool exists() const;
+
+    /**
+     * Loads the store's index.
+     *
+     * @return true if the index was loaded, else false.
+     */
+    bool open();
+
+    /**
+     * Reads the live record of the given chunk into chunkSnapshot.
+     *
+     * Note: Safe to call while another thread is saving.
+     *
+     * @return true if the chunk was read, else false.
+     */
+    bool readChunk(const ChunkPosition& chunkPosition,
+                   ChunkSnapshot& chunkSnapshot);
+
+    /**
+     * Appends the given chunk updates to the data file, then updates the
+     * index.
+     *
+     * Note: chunkUpdates is non-const because serialization requires it. It
+     *       isn't modified.
+     *
+     * @return true if the save succeeded, else false. If false, the on-disk
+     *         store still holds its previous state.
+     */
+    bool save(ChunkUpdateMap& chunkUpdates);
+
+    /**
+     * Rewrites the data file so that it only contains live records.
+     *
+     * @return true if compaction succeeded, else false.
+     */
+    bool compact();
+
+    /**
+     * Replaces the store's contents with the given map snapshot.
+     * Used to convert maps from the old single-file TileMap.bin format.
+     *
+     * @return true if the import succeeded, else false.
+     */
+    bool importSnapshot(const TileMapSnapshot& mapSnapshot);
+
+    /**
+     * Sets the map header data that will be written by the next save.
+     */
+    void setMapInfo(Uint16 inMapVersion, Uint16 inXLengthChunks,
+                    Uint16 inYLengthChunks, Uint16 inZLengthChunks);
+
+    Uint16 getMapVersion() const;
+    Uint16 getXLengthChunks() const;
+    Uint16 getYLengthChunks() const;
+    Uint16 getZLengthChunks() const;
+
+    /**
+     * Returns the location of every chunk's live record.
+     *
+     * Note: Not safe to call while another thread is saving.
+     */
+    const std::unordered_map<ChunkPosition, RecordLocation>&
+        getRecordLocations() const;
+
+    /**
+     * Returns the size of the data file, in bytes.
+     */
+    Uint64 getDataFileSize() const;
+
+    /**
+     * Returns the number of bytes in the data file that belong to live
+     * records. The rest is garbage that compact() would remove.
+     */
+    Uint64 getLiveDataSize() const;
+
+private:
+    /**
+     * Returns the path to the data file of the given generation.
+     */
+    std::string getDataFilePath(Uint32 dataGeneration) const;
+
+    /**
+     * Serializes the given snapshot as a record and appends it to
+     * recordBuffer.
+     *
+     * @param fileOffset  The offset in the data file that recordBuffer
+     *                    starts at.
+     * @return The location of the new record, or nullopt if serialization
+     *         failed.
+     */
+    std::optional<RecordLocation>
+        appendRecord(const ChunkPosition& chunkPosition,
+                     ChunkSnapshot& chunkSnapshot, Uint64 fileOffset);
+
+    /**
+     * Writes our index to disk, replacing the old one.
+     */
+    bool writeIndex();
+
+    /**
+     * Writes the given chunks into a new generation's data file, then points
+     * the index at it and deletes the old data file.
+     */
+    bool writeNewGeneration(ChunkUpdateMap& chunks);
+
+    /** The path to the store's files, without extension. */
+    std::string basePath;
+
+    /** The version of the map format (see TileMapBase::MAP_FORMAT_VERSION). */
+    Uint16 mapVersion;
+
+    /** The map's lengths, in chunks. */
+    Uint16 xLengthChunks;
+    Uint16 yLengthChunks;
+    Uint16 zLengthChunks;
+
+    /** The generation of the current data file. Incremented by compaction. */
+    Uint32 generation;
+
+    /** The size of the valid part of the data file. Anything after this is
+        left over from a failed save. */
+    Uint64 dataFileSize;
+
+    /** The number of bytes in the data file that belong to live records. */
+    Uint64 liveDataSize;
+
+    /** The location of each chunk's live record. */
+    std::unordered_map<ChunkPosition, RecordLocation> recordLocations;
+
+    /** Scratch buffer used while serializing records and the index. */
+    BinaryBuffer recordBuffer;
+
+    /** A read-only mapping of the data file. Only valid if mappedGeneration
+        matches generation. Remapped when a record lies past its end. */
+    MappedFile dataFileMapping;
+    Uint32 mappedGeneration;
+
+    /** Guards the index state (generation, dataFileSize, liveDataSize,
+        recordLocations) and dataFileMapping. Writers only need it while
+        modifying, since they're the only ones modifying. */
+    std::mutex storeMutex;
+};
+
+} // End namespace AM
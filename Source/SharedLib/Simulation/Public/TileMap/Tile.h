@@ -9,6 +9,7 @@
 namespace AM
 {
 struct Sprite;
+class Chunk;
 
 /**
  * A tile in the tile map.
@@ -24,6 +25,11 @@ struct Sprite;
  *   2 walls
  *   Any number of objects
  * All layers are optional and may not be present in a given tile.
+ *
+ * Note: To avoid a heap allocation per tile, a tile's layers are stored in
+ *       its chunk's layer pool. Because of this, tiles must live in a Chunk,
+ *       and adding a layer to any tile in a chunk may relocate the layers of
+ *       every tile in that chunk.
  */
 class Tile
 {
@@ -32,7 +38,7 @@ public:
      * Adds the given layer to this tile.
      */
     void addLayer(const TileOffset& tileOffset, TileLayer::Type layerType,
-                  const GraphicSet& graphicSet, Uint8 graphicValue);
+                  Uint16 graphicSetID, Uint8 graphicValue);
 
     /**
      * Removes any layers with a matching offset, type, graphic index, and
@@ -78,16 +84,18 @@ public:
     /**
      * @return This tile's layers of the given type, if it has any.
      * Note: This span will be invalidated if you add, remove, or clear any
-     *       of this tile's layers.
+     *       of this tile's layers, or add a layer to any other tile in the
+     *       same chunk.
      */
     std::span<TileLayer> getLayers(TileLayer::Type layerType);
     std::span<const TileLayer> getLayers(TileLayer::Type layerType) const;
 
     /**
      * @return All of this tile's layers.
+     * Note: This span has the same invalidation rules as getLayers().
      */
-    std::vector<TileLayer>& getAllLayers();
-    const std::vector<TileLayer>& getAllLayers() const;
+    std::span<TileLayer> getAllLayers();
+    std::span<const TileLayer> getAllLayers() const;
 
     /**
      * Returns a pointer to the first matching layer in this tile. If one isn't
@@ -103,11 +111,30 @@ public:
     bool isEmpty() const;
 
 private:
-    // TODO: Maybe eventually switch to an alternative vector type that
-    //       has a smaller footprint but only supports forward iterators.
-    /** The graphic layers that are on this tile, sorted by their
-        TileLayer::Type in increasing order. */
-    std::vector<TileLayer> layers{};
+    friend class Chunk;
+
+    /**
+     * Removes any layers that match the given predicate.
+     *
+     * @return The number of layers that were removed.
+     */
+    template<typename Predicate>
+    std::size_t eraseLayersIf(Predicate predicate);
+
+    /** The chunk that owns this tile. Set by the chunk. */
+    Chunk* chunk{nullptr};
+
+    /** The index in chunk's layer pool where this tile's layers start.
+        The graphic layers that are on this tile are stored contiguously,
+        sorted by their TileLayer::Type in increasing order. */
+    Uint32 layerOffset{0};
+
+    /** The number of layers that this tile has. */
+    Uint8 layerCount{0};
+
+    /** The number of slots that are reserved for this tile in chunk's layer
+        pool, starting at layerOffset. */
+    Uint8 layerCapacity{0};
 };
 
 } // End namespace AM
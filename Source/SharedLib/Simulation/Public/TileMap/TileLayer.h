@@ -2,6 +2,7 @@
 
 #include "GraphicRef.h"
 #include "TileOffset.h"
+#include <SDL3/SDL_stdinc.h>
 #include <span>
 #include <functional>
 
@@ -9,6 +10,7 @@ namespace AM
 {
 
 struct GraphicSet;
+class GraphicDataBase;
 
 /**
  * A single graphic layer of a tile.
@@ -41,22 +43,34 @@ struct TileLayer {
         graphicSet.graphics. For Terrain, this is a bit-packed value.
         For Terrain, cast this to Terrain::Value. For Walls, cast this to
         Wall::Type. For Floors and Objects, cast this to Rotation::Direction.
-        Note: It'd be more intuitive to put this after graphicSet, but alignment
-              would cause this struct to be larger if we did so. */
+        Note: It'd be more intuitive to put this after graphicSetID, but
+              alignment would cause this struct to be larger if we did so. */
     Uint8 graphicValue{0};
 
-    /** A polymorphic reference to this layer's graphic set.
+    /** The numeric ID of this layer's graphic set.
         Each layer type maps directly to a single graphic set type, e.g. Floor
-        layers -> FloorGraphicSet. */
-    std::reference_wrapper<const GraphicSet> graphicSet;
+        layers -> FloorGraphicSet, so this can be cast to FloorGraphicSetID,
+        etc. depending on type.
+        Note: We store the ID instead of a reference to keep this struct
+              small (8B), since large maps hold a lot of layers. */
+    Uint16 graphicSetID{0};
 
     /**
-     * Casts graphicSet to the appropriate type and returns
+     * Returns this layer's graphic set from the given graphic data.
+     */
+    const GraphicSet& getGraphicSet(const GraphicDataBase& graphicData) const;
+
+    /**
+     * Casts this layer's graphic set to the appropriate type and returns
      * graphicSet.graphics[graphicIndex].
      */
-    GraphicRef getGraphic() const;
+    GraphicRef getGraphic(const GraphicDataBase& graphicData) const;
     static GraphicRef getGraphic(Type type, const GraphicSet& graphicSet,
                                  Uint8 graphicValue);
 };
 
+// Large maps hold a lot of layers, so we enforce a size constraint.
+static_assert(sizeof(TileLayer) <= 8,
+              "TileLayer is too large. Please keep it <= 8B.");
+
 } // End namespace AM
@@ -19,6 +19,7 @@
 #include "AMAssert.h"
 #include <vector>
 #include <unordered_map>
+#include <unordered_set>
 #include <variant>
 #include <type_traits>
 #include <expected>
@@ -230,6 +231,24 @@ public:
     const Tile* getTile(const TilePosition& tilePosition) const;
     const Tile* cgetTile(const TilePosition& tilePosition) const;
 
+    /**
+     * Calls the given visitor for each tile within the given extent whose
+     * parent chunk exists.
+     *
+     * This is much cheaper than calling getTile() for each position in the
+     * extent, since each chunk is only looked up once and its tiles are
+     * visited directly. Because of this, tiles are visited chunk by chunk
+     * (see forEachTileInChunk() for the order within each chunk) instead of
+     * row by row across the whole extent.
+     *
+     * @param extent The extent to iterate. Any part of it that's outside of
+     *               the map is ignored.
+     * @param visitor A callable with the signature
+     *                void(const TilePosition&, const Tile&).
+     */
+    template<typename Visitor>
+    void forEachTile(const TileExtent& extent, Visitor&& visitor) const;
+
     /**
      * Returns the map extent, with chunks as the unit.
      */
@@ -253,6 +272,8 @@ public:
     /**
      * Rebuilds the collision of any tiles that have been updated since the
      * last time this was called (while autoRebuildCollision is disabled).
+     * If tile collision merging is enabled, the affected chunks are then
+     * re-merged (see CollisionLocator::mergeDirtyTileCollisionVolumes()).
      *
      * You normally don't need to call this manually, since it's called when
      * autoRebuildCollision is re-enabled.
@@ -270,9 +291,27 @@ public:
 
     /**
      * Clears the tile update history vector.
+     *
+     * Note: Before clearing, the history is folded into the dirty chunk set
+     *       (see getDirtyChunks()).
      */
     void clearTileUpdateHistory();
 
+    /**
+     * Returns the positions of every chunk that has been modified since the
+     * last time clearDirtyChunks() was called. Chunks that were modified
+     * until empty (and thus erased) are included.
+     *
+     * This is derived from the tile update history, so it's only populated
+     * if trackTileUpdates is true.
+     */
+    const std::unordered_set<ChunkPosition>& getDirtyChunks();
+
+    /**
+     * Clears the dirty chunk set.
+     */
+    void clearDirtyChunks();
+
     /**
      * Adds the tile layers from the given chunk snapshot to the map.
      */
@@ -439,6 +478,48 @@ protected:
         const TilePosition& tilePosition,
         const std::array<bool, TileLayer::Type::Count>& layerTypesToClear);
 
+    /**
+     * Clears the given layer types from the given tile and updates the
+     * chunk's layer count.
+     * Note: This doesn't erase the chunk if it becomes empty, the caller must
+     *       handle that.
+     * @return The number of layers that were cleared.
+     */
+    std::size_t clearTileLayersInternal(
+        Chunk& chunk, Tile& tile,
+        const std::array<bool, TileLayer::Type::Count>& layerTypesToClear);
+
+    /**
+     * Calls the given visitor for each existing chunk that intersects the
+     * given extent.
+     *
+     * @param self The map to iterate (used to support const and non-const).
+     * @param visitor A callable with the signature
+     *                void(const ChunkPosition&, Chunk&, const TileExtent&),
+     *                where the extent is the part of the given extent that's
+     *                within the chunk. If self is const, Chunk is const.
+     */
+    template<typename Self, typename Visitor>
+    static void forEachChunk(Self& self, const TileExtent& extent,
+                             Visitor&& visitor);
+
+    /**
+     * Calls the given visitor for each of the given chunk's tiles that are
+     * within the given extent. If the extent covers the whole chunk, tiles
+     * are visited in storage order. Otherwise, they're visited row by row.
+     *
+     * @param extent The extent to iterate. Must be within the chunk.
+     *
+     * @param visitor A callable with the signature
+     *                void(const TilePosition&, Tile&). If chunk is const,
+     *                Tile is const.
+     */
+    template<typename ChunkType, typename Visitor>
+    static void forEachTileInChunk(ChunkType& chunk,
+                                   const ChunkPosition& chunkPosition,
+                                   const TileExtent& extent,
+                                   Visitor&& visitor);
+
     /**
      * Adds the tile layers from the given chunk snapshot to the map.
      */
@@ -491,6 +572,110 @@ private:
         TileUpdateSystem uses this history to send updates to clients, then
         clears it. */
     std::vector<TileUpdateVariant> tileUpdateHistory;
+
+    /** The positions of all chunks that have been modified since the last
+        call to clearDirtyChunks(). */
+    std::unordered_set<ChunkPosition> dirtyChunks;
+
+    /** The number of entries at the front of tileUpdateHistory that have
+        already been folded into dirtyChunks. */
+    std::size_t dirtyChunksHistoryIndex;
+
+    /**
+     * Adds the chunks that were touched by any new entries in
+     * tileUpdateHistory to dirtyChunks.
+     */
+    void collectDirtyChunks();
+
+    /**
+     * Adds the chunk that contains the given tile to dirtyChunks.
+     *
+     * The tile update history only records the tile that each update
+     * targeted, so this must be called when an update also modifies a
+     * neighboring tile (e.g. a wall's gap fill), since that tile may be in
+     * another chunk.
+     */
+    void markNeighborChunkDirty(const TilePosition& tilePosition);
 };
 
+template<typename Visitor>
+void TileMapBase::forEachTile(const TileExtent& extent, Visitor&& visitor) const
+{
+    forEachChunk(*this, extent,
+                 [&](const ChunkPosition& chunkPosition, const Chunk& chunk,
+                     const TileExtent& chunkTileExtent) {
+                     forEachTileInChunk(chunk, chunkPosition, chunkTileExtent,
+                                        visitor);
+                 });
+}
+
+template<typename Self, typename Visitor>
+void TileMapBase::forEachChunk(Self& self, const TileExtent& extent,
+                               Visitor&& visitor)
+{
+    // Clip the extent to the map's bounds.
+    TileExtent clippedExtent{extent.intersectWith(self.tileExtent)};
+    if (clippedExtent.isEmpty()) {
+        return;
+    }
+
+    // Visit each chunk that intersects the extent.
+    // Note: Chunks are 1 tile tall, so chunk Z == tile Z.
+    const int CHUNK_WIDTH{static_cast<int>(SharedConfig::CHUNK_WIDTH)};
+    ChunkPosition minChunk{TilePosition{clippedExtent.min()}};
+    ChunkPosition maxChunk{TilePosition{clippedExtent.max()}};
+    for (int z{minChunk.z}; z <= maxChunk.z; ++z) {
+        for (int y{minChunk.y}; y <= maxChunk.y; ++y) {
+            for (int x{minChunk.x}; x <= maxChunk.x; ++x) {
+                ChunkPosition chunkPosition{x, y, z};
+                auto chunkIt{self.chunks.find(chunkPosition)};
+                if (chunkIt == self.chunks.end()) {
+                    continue;
+                }
+
+                TileExtent chunkTileExtent{x * CHUNK_WIDTH, y * CHUNK_WIDTH, z,
+                                           CHUNK_WIDTH, CHUNK_WIDTH, 1};
+                visitor(chunkPosition, chunkIt->second,
+                        chunkTileExtent.intersectWith(clippedExtent));
+            }
+        }
+    }
+}
+
+template<typename ChunkType, typename Visitor>
+void TileMapBase::forEachTileInChunk(ChunkType& chunk,
+                                     const ChunkPosition& chunkPosition,
+                                     const TileExtent& extent,
+                                     Visitor&& visitor)
+{
+    const int CHUNK_WIDTH{static_cast<int>(SharedConfig::CHUNK_WIDTH)};
+    const int originX{chunkPosition.x * CHUNK_WIDTH};
+    const int originY{chunkPosition.y * CHUNK_WIDTH};
+
+    // If the extent covers the whole chunk, walk the tiles in storage
+    // (morton) order.
+    if ((extent.xLength == CHUNK_WIDTH) && (extent.yLength == CHUNK_WIDTH)) {
+        for (std::size_t tileIndex{0};
+             tileIndex < SharedConfig::CHUNK_TILE_COUNT; ++tileIndex) {
+            Morton::Result2D xyOffsets{
+                Morton::decode16x16(static_cast<Uint8>(tileIndex))};
+            TilePosition tilePosition{originX + xyOffsets.x,
+                                      originY + xyOffsets.y, chunkPosition.z};
+            visitor(tilePosition, chunk.tiles[tileIndex]);
+        }
+        return;
+    }
+
+    // Otherwise, only visit the tiles within the extent.
+    for (int y{extent.y}; y <= extent.yMax(); ++y) {
+        for (int x{extent.x}; x <= extent.xMax(); ++x) {
+            Uint8 tileIndex{
+                Morton::encode16x16(static_cast<Uint8>(x - originX),
+                                    static_cast<Uint8>(y - originY))};
+            visitor(TilePosition{x, y, chunkPosition.z},
+                    chunk.tiles[tileIndex]);
+        }
+    }
+}
+
 } // End namespace AM
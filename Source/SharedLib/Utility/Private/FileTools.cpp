@@ -0,0 +1,163 @@
+#include "FileTools.h"
+#include "Log.h"
+#include <cstring>
+#include <cerrno>
+#include <climits>
+#include <algorithm>
+#include <cstdio>
+#if defined(_WIN32)
+#include <io.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace AM
+{
+namespace
+{
+#if defined(_WIN32)
+bool writeAndSync(const std::string& filePath, std::size_t fileSize,
+                  std::span<const Uint8> data)
+{
+    int fd{_open(filePath.c_str(), (_O_WRONLY | _O_CREAT | _O_BINARY),
+                 (_S_IREAD | _S_IWRITE))};
+    if (fd < 0) {
+        LOG_ERROR("Failed to open file: %s", filePath.c_str());
+        return false;
+    }
+
+    // Cut the file down to fileSize and move to the end.
+    if ((_chsize_s(fd, static_cast<__int64>(fileSize)) != 0)
+        || (_lseeki64(fd, static_cast<__int64>(fileSize), SEEK_SET) < 0)) {
+        LOG_ERROR("Failed to resize file: %s", filePath.c_str());
+        _close(fd);
+        return false;
+    }
+
+    std::size_t bytesWritten{0};
+    while (bytesWritten < data.size()) {
+        unsigned int chunkSize{static_cast<unsigned int>(
+            std::min(data.size() - bytesWritten, std::size_t{INT_MAX}))};
+        int result{_write(fd, data.data() + bytesWritten, chunkSize)};
+        if (result < 0) {
+            LOG_ERROR("Failed to write file: %s", filePath.c_str());
+            _close(fd);
+            return false;
+        }
+        bytesWritten += static_cast<std::size_t>(result);
+    }
+
+    bool syncSuccessful{_commit(fd) == 0};
+    _close(fd);
+    if (!syncSuccessful) {
+        LOG_ERROR("Failed to flush file to disk: %s", filePath.c_str());
+    }
+
+    return syncSuccessful;
+}
+
+bool replaceFile(const std::string& sourcePath, const std::string& destPath)
+{
+    return MoveFileExA(sourcePath.c_str(), destPath.c_str(),
+                       (MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH));
+}
+#else
+bool writeAndSync(const std::string& filePath, std::size_t fileSize,
+                  std::span<const Uint8> data)
+{
+    int fd{open(filePath.c_str(), (O_WRONLY | O_CREAT), 0644)};
+    if (fd < 0) {
+        LOG_ERROR("Failed to open file: %s (%s)", filePath.c_str(),
+                  std::strerror(errno));
+        return false;
+    }
+
+    // Cut the file down to fileSize and move to the end.
+    if ((ftruncate(fd, static_cast<off_t>(fileSize)) != 0)
+        || (lseek(fd, static_cast<off_t>(fileSize), SEEK_SET) < 0)) {
+        LOG_ERROR("Failed to resize file: %s (%s)", filePath.c_str(),
+                  std::strerror(errno));
+        close(fd);
+        return false;
+    }
+
+    std::size_t bytesWritten{0};
+    while (bytesWritten < data.size()) {
+        ssize_t result{write(fd, data.data() + bytesWritten,
+                             (data.size() - bytesWritten))};
+        if (result < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            LOG_ERROR("Failed to write file: %s (%s)", filePath.c_str(),
+                      std::strerror(errno));
+            close(fd);
+            return false;
+        }
+        bytesWritten += static_cast<std::size_t>(result);
+    }
+
+    bool syncSuccessful{fsync(fd) == 0};
+    close(fd);
+    if (!syncSuccessful) {
+        LOG_ERROR("Failed to flush file to disk: %s (%s)", filePath.c_str(),
+                  std::strerror(errno));
+    }
+
+    return syncSuccessful;
+}
+
+bool replaceFile(const std::string& sourcePath, const std::string& destPath)
+{
+    if (std::rename(sourcePath.c_str(), destPath.c_str()) != 0) {
+        return false;
+    }
+
+    // Sync the parent directory so the rename itself is durable.
+    std::size_t lastSlash{destPath.find_last_of('/')};
+    std::string directoryPath{
+        (lastSlash == std::string::npos) ? "."
+                                         : destPath.substr(0, lastSlash + 1)};
+    int directoryFD{open(directoryPath.c_str(), O_RDONLY)};
+    if (directoryFD >= 0) {
+        fsync(directoryFD);
+        close(directoryFD);
+    }
+
+    return true;
+}
+#endif
+} // namespace
+
+bool FileTools::writeAtomically(const std::string& filePath,
+                                std::span<const Uint8> data)
+{
+    // Write the data to a temporary file next to the destination.
+    std::string tempFilePath{filePath + ".tmp"};
+    if (!writeAndSync(tempFilePath, 0, data)) {
+        std::remove(tempFilePath.c_str());
+        return false;
+    }
+
+    // Swap the temporary file into place.
+    if (!replaceFile(tempFilePath, filePath)) {
+        LOG_ERROR("Failed to replace file: %s", filePath.c_str());
+        std::remove(tempFilePath.c_str());
+        return false;
+    }
+
+    return true;
+}
+
+bool FileTools::truncateAndAppend(const std::string& filePath,
+                                  std::size_t fileSize,
+                                  std::span<const Uint8> data)
+{
+    return writeAndSync(filePath, fileSize, data);
+}
+
+} // End namespace AM
@@ -0,0 +1,56 @@
+#include "FrameArena.h"
+
+namespace AM
+{
+FrameArena::FrameArena(std::size_t inCapacity)
+: buffer{std::make_unique<std::byte[]>(inCapacity)}
+, capacity{inCapacity}
+, resource{buffer.get(), capacity, std::pmr::get_default_resource()}
+, allocationCount{0}
+, allocatedBytes{0}
+{
+}
+
+void FrameArena::reset()
+{
+    // Note: After release(), the resource starts over at the beginning of
+    //       buffer and frees any memory that it got from the default resource.
+    resource.release();
+    allocationCount = 0;
+    allocatedBytes = 0;
+}
+
+std::size_t FrameArena::getAllocationCount() const
+{
+    return allocationCount;
+}
+
+std::size_t FrameArena::getAllocatedBytes() const
+{
+    return allocatedBytes;
+}
+
+std::size_t FrameArena::getCapacity() const
+{
+    return capacity;
+}
+
+void* FrameArena::do_allocate(std::size_t bytes, std::size_t alignment)
+{
+    allocationCount++;
+    allocatedBytes += bytes;
+    return resource.allocate(bytes, alignment);
+}
+
+void FrameArena::do_deallocate(void*, std::size_t, std::size_t)
+{
+    // Monotonic, memory is only reclaimed in reset().
+}
+
+bool FrameArena::do_is_equal(
+    const std::pmr::memory_resource& other) const noexcept
+{
+    return (this == &other);
+}
+
+} // End namespace AM
@@ -0,0 +1,143 @@
+#include "MappedFile.h"
+#include "Log.h"
+#include <cstring>
+#include <cerrno>
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#endif
+
+namespace AM
+{
+MappedFile::MappedFile()
+: mappedData{nullptr}
+, mappedSize{0}
+#if defined(_WIN32)
+, fileHandle{INVALID_HANDLE_VALUE}
+, mappingHandle{nullptr}
+#endif
+{
+}
+
+MappedFile::~MappedFile()
+{
+    close();
+}
+
+#if defined(_WIN32)
+bool MappedFile::open(const std::string& filePath, std::size_t mapSize)
+{
+    close();
+    if (mapSize == 0) {
+        LOG_ERROR("Can't map an empty range of file: %s", filePath.c_str());
+        return false;
+    }
+
+    // Note: We allow other handles to write and delete, since the file is
+    //       appended to and replaced while we have it mapped.
+    fileHandle = CreateFileA(
+        filePath.c_str(), GENERIC_READ,
+        (FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE), nullptr,
+        OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (fileHandle == INVALID_HANDLE_VALUE) {
+        LOG_ERROR("Failed to open file for mapping: %s", filePath.c_str());
+        return false;
+    }
+
+    const Uint64 size64{static_cast<Uint64>(mapSize)};
+    mappingHandle = CreateFileMappingA(
+        fileHandle, nullptr, PAGE_READONLY, static_cast<DWORD>(size64 >> 32),
+        static_cast<DWORD>(size64 & 0xFFFFFFFF), nullptr);
+    if (mappingHandle == nullptr) {
+        LOG_ERROR("Failed to create file mapping: %s", filePath.c_str());
+        close();
+        return false;
+    }
+
+    void* view{MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, mapSize)};
+    if (view == nullptr) {
+        LOG_ERROR("Failed to map view of file: %s", filePath.c_str());
+        close();
+        return false;
+    }
+
+    mappedData = static_cast<const Uint8*>(view);
+    mappedSize = mapSize;
+    return true;
+}
+
+void MappedFile::close()
+{
+    if (mappedData != nullptr) {
+        UnmapViewOfFile(mappedData);
+        mappedData = nullptr;
+        mappedSize = 0;
+    }
+    if (mappingHandle != nullptr) {
+        CloseHandle(mappingHandle);
+        mappingHandle = nullptr;
+    }
+    if (fileHandle != INVALID_HANDLE_VALUE) {
+        CloseHandle(fileHandle);
+        fileHandle = INVALID_HANDLE_VALUE;
+    }
+}
+#else
+bool MappedFile::open(const std::string& filePath, std::size_t mapSize)
+{
+    close();
+    if (mapSize == 0) {
+        LOG_ERROR("Can't map an empty range of file: %s", filePath.c_str());
+        return false;
+    }
+
+    int fd{::open(filePath.c_str(), O_RDONLY)};
+    if (fd < 0) {
+        LOG_ERROR("Failed to open file for mapping: %s (%s)",
+                  filePath.c_str(), std::strerror(errno));
+        return false;
+    }
+
+    // Note: The mapping stays valid after the descriptor is closed.
+    void* view{mmap(nullptr, mapSize, PROT_READ, MAP_SHARED, fd, 0)};
+    ::close(fd);
+    if (view == MAP_FAILED) {
+        LOG_ERROR("Failed to map file: %s (%s)", filePath.c_str(),
+                  std::strerror(errno));
+        return false;
+    }
+
+    mappedData = static_cast<const Uint8*>(view);
+    mappedSize = mapSize;
+    return true;
+}
+
+void MappedFile::close()
+{
+    if (mappedData != nullptr) {
+        munmap(const_cast<Uint8*>(mappedData), mappedSize);
+        mappedData = nullptr;
+        mappedSize = 0;
+    }
+}
+#endif
+
+bool MappedFile::isOpen() const
+{
+    return (mappedData != nullptr);
+}
+
+const Uint8* MappedFile::data() const
+{
+    return mappedData;
+}
+
+std::size_t MappedFile::size() const
+{
+    return mappedSize;
+}
+
+} // End namespace AM
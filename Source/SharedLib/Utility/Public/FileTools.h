@@ -0,0 +1,47 @@
+#pragma once
+
+#include <SDL3/SDL_stdinc.h>
+#include <span>
+#include <string>
+
+/**
+ * Static functions for working with files.
+ */
+namespace AM
+{
+class FileTools
+{
+public:
+    /**
+     * Writes the given data to the file at the given path, such that the file
+     * either fully contains the old data or fully contains the new data, even
+     * if we crash partway through.
+     *
+     * The data is written to "<filePath>.tmp", flushed to disk, then renamed
+     * over filePath.
+     *
+     * Note: This blocks until the data is on disk, so avoid calling it from
+     *       the main thread.
+     *
+     * @return true if the write succeeded, else false.
+     */
+    static bool writeAtomically(const std::string& filePath,
+                                std::span<const Uint8> data);
+
+    /**
+     * Truncates the file at the given path to fileSize bytes, appends the
+     * given data, then flushes the file to disk.
+     *
+     * If the file doesn't exist, it'll be created (fileSize must be 0).
+     *
+     * Note: This blocks until the data is on disk, so avoid calling it from
+     *       the main thread.
+     *
+     * @return true if the write succeeded, else false.
+     */
+    static bool truncateAndAppend(const std::string& filePath,
+                                  std::size_t fileSize,
+                                  std::span<const Uint8> data);
+};
+
+} // End namespace AM
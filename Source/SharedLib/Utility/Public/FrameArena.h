@@ -0,0 +1,80 @@
+#pragma once
+
+#include <memory_resource>
+#include <memory>
+#include <cstddef>
+
+namespace AM
+{
+/**
+ * A monotonic memory resource for transient, per-tick allocations (message
+ * structs, scratch containers, etc).
+ *
+ * Allocations are served by bumping a pointer through a preallocated buffer.
+ * Deallocation is a no-op. Instead, all memory is reclaimed at once when
+ * reset() is called (typically at the end of each tick). If the buffer runs
+ * out, additional memory is requested from the default resource until the
+ * next reset().
+ *
+ * Usage: Give this arena to a std::pmr container, e.g.
+ *   std::pmr::vector<int> ints{&frameArena};
+ *
+ * Note: Any containers that use this arena must be destroyed (or otherwise
+ *       no longer touched) before reset() is called.
+ */
+class FrameArena : public std::pmr::memory_resource
+{
+public:
+    /**
+     * @param inCapacity The size in bytes of the preallocated buffer.
+     */
+    explicit FrameArena(std::size_t inCapacity);
+
+    /**
+     * Releases all memory that was allocated since the last reset.
+     */
+    void reset();
+
+    /**
+     * Returns the number of allocations made since the last reset.
+     */
+    std::size_t getAllocationCount() const;
+
+    /**
+     * Returns the number of bytes allocated since the last reset.
+     */
+    std::size_t getAllocatedBytes() const;
+
+    /**
+     * Returns the size in bytes of the preallocated buffer. If
+     * getAllocatedBytes() goes past this, the arena had to fall back to the
+     * default resource.
+     */
+    std::size_t getCapacity() const;
+
+private:
+    void* do_allocate(std::size_t bytes, std::size_t alignment) override;
+
+    void do_deallocate(void* pointer, std::size_t bytes,
+                       std::size_t alignment) override;
+
+    bool do_is_equal(
+        const std::pmr::memory_resource& other) const noexcept override;
+
+    /** The preallocated buffer. */
+    std::unique_ptr<std::byte[]> buffer;
+
+    /** The size of buffer, in bytes. */
+    std::size_t capacity;
+
+    /** The resource that actually hands out memory from buffer. */
+    std::pmr::monotonic_buffer_resource resource;
+
+    /** The number of allocations made since the last reset. */
+    std::size_t allocationCount;
+
+    /** The number of bytes allocated since the last reset. */
+    std::size_t allocatedBytes;
+};
+
+} // End namespace AM
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <SDL3/SDL_stdinc.h>
+#include <string>
+
+namespace AM
+{
+/**
+ * A read-only memory mapping of a file.
+ *
+ * Mapping a file lets us read any part of it without a syscall. The OS only
+ * pages in the parts that we actually touch, so opening a large file is
+ * cheap.
+ */
+class MappedFile
+{
+public:
+    MappedFile();
+
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    /**
+     * Maps the first mapSize bytes of the file at the given path.
+     * If a file is already mapped, it'll be unmapped first.
+     *
+     * Note: The file must not be truncated below mapSize while it's mapped.
+     *
+     * @return true if the file was mapped, else false.
+     */
+    bool open(const std::string& filePath, std::size_t mapSize);
+
+    /**
+     * Unmaps the file, if one is mapped.
+     */
+    void close();
+
+    /**
+     * @return true if a file is currently mapped, else false.
+     */
+    bool isOpen() const;
+
+    /**
+     * Returns a pointer to the start of the mapped data.
+     */
+    const Uint8* data() const;
+
+    /**
+     * Returns the number of mapped bytes.
+     */
+    std::size_t size() const;
+
+private:
+    /** The start of the mapped data. nullptr if nothing is mapped. */
+    const Uint8* mappedData;
+
+    /** The number of mapped bytes. */
+    std::size_t mappedSize;
+
+#if defined(_WIN32)
+    /** The file and mapping handles. Windows needs these kept open for as
+        long as the view is mapped. */
+    void* fileHandle;
+    void* mappingHandle;
+#endif
+};
+
+} // End namespace AM
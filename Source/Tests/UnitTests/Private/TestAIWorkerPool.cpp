@@ -0,0 +1,239 @@
+#include "catch2/catch_all.hpp"
+#include "AIWorkerPool.h"
+#include "AICommandBuffer.h"
+#include "EntityLocator.h"
+#include "Position.h"
+#include "Input.h"
+#include "Cylinder.h"
+#include "TileExtent.h"
+#include "SharedConfig.h"
+#include "entt/entity/registry.hpp"
+#include <thread>
+#include <variant>
+#include <vector>
+
+using namespace AM;
+using namespace AM::Server;
+
+namespace
+{
+/** How far the test AI searches for entities. */
+constexpr float SEARCH_RADIUS{SharedConfig::TILE_WORLD_WIDTH * 2};
+
+/** The number of entities in each test world. */
+constexpr int ENTITY_COUNT{500};
+
+/**
+ * A registry of AI entities, and a locator that tracks them.
+ */
+struct TestAIWorld {
+    entt::registry registry{};
+    EntityLocator entityLocator{registry};
+
+    /**
+     * Places ENTITY_COUNT entities in rows, close enough that each one's
+     * search finds several others.
+     */
+    TestAIWorld()
+    {
+        entityLocator.setGridSize(TileExtent{0, 0, 0, 32, 32, 1});
+        for (int i{0}; i < ENTITY_COUNT; ++i) {
+            entt::entity entity{registry.create()};
+            const Position& position{registry.emplace<Position>(
+                entity, ((i % 25) * SharedConfig::TILE_WORLD_WIDTH) + 3.f,
+                ((i / 25) * SharedConfig::TILE_WORLD_WIDTH) + 3.f, 0.f)};
+            registry.emplace<Input>(entity);
+            entityLocator.updateEntity(entity, position);
+        }
+    }
+};
+
+/**
+ * A test AI type. Each tick, it presses an input on every entity around it.
+ * Neighboring AI press different inputs on the same entities, so the result
+ * depends on the order that their commands are applied in.
+ *
+ * Note: Real AI types take a const World&, but unit tests can't build one.
+ *       This type only uses the parts of the world that parallel AI shares.
+ */
+struct TestParallelAI {
+    /** The number of times this AI has been ticked. */
+    Uint32 tickCount{0};
+
+    void tickParallel(const TestAIWorld& world, entt::entity entity,
+                      AICommandBuffer& commandBuffer)
+    {
+        tickCount++;
+
+        // Find the entities around us.
+        std::vector<entt::entity> nearbyEntities{};
+        const Position& position{world.registry.get<Position>(entity)};
+        world.entityLocator.getEntities(
+            Cylinder{position, SEARCH_RADIUS, SEARCH_RADIUS}, nearbyEntities);
+
+        // Press an input on each of them.
+        Input::StateArr inputStates{};
+        inputStates.set(
+            (static_cast<std::size_t>(entt::to_entity(entity)) + tickCount)
+            % Input::Type::Count);
+        for (entt::entity nearbyEntity : nearbyEntities) {
+            commandBuffer.setInput(nearbyEntity, inputStates);
+        }
+    }
+};
+
+/**
+ * Applies the input commands in the given buffer to the given world, in
+ * order, the same way that AICommandBuffer::apply() does.
+ *
+ * Note: apply() takes a World, which unit tests can't build.
+ */
+void applyInputs(const AICommandBuffer& commandBuffer, TestAIWorld& world)
+{
+    for (const AICommandBuffer::Command& command :
+         commandBuffer.getCommands()) {
+        const auto& setInput{
+            std::get<AICommandBuffer::SetInputCommand>(command)};
+        world.registry.get<Input>(setInput.entity).inputStates
+            = setInput.inputStates;
+    }
+}
+
+/**
+ * Returns true if every entity in the given worlds has the same input
+ * states and AI tick count.
+ */
+bool worldsMatch(const TestAIWorld& worldA, const TestAIWorld& worldB)
+{
+    for (entt::entity entity : worldA.registry.view<Input>()) {
+        if ((worldA.registry.get<Input>(entity).inputStates
+             != worldB.registry.get<Input>(entity).inputStates)
+            || (worldA.registry.get<TestParallelAI>(entity).tickCount
+                != worldB.registry.get<TestParallelAI>(entity).tickCount)) {
+            return false;
+        }
+    }
+
+    return true;
+}
+} // namespace
+
+TEST_CASE("TestAIWorkerPool")
+{
+    SECTION("Parallel AI matches a serial run")
+    {
+        struct PoolConfig {
+            std::size_t workerCount{};
+            std::size_t chunkSize{};
+        };
+        for (PoolConfig config :
+             {PoolConfig{0, 16}, PoolConfig{3, 1}, PoolConfig{3, 16},
+              PoolConfig{3, 1000}, PoolConfig{8, 7}}) {
+            TestAIWorld serialWorld{};
+            TestAIWorld parallelWorld{};
+            for (TestAIWorld* world : {&serialWorld, &parallelWorld}) {
+                for (entt::entity entity : world->registry.view<Input>()) {
+                    world->registry.emplace<TestParallelAI>(entity);
+                }
+            }
+
+            AIWorkerPool workerPool{config.workerCount, config.chunkSize};
+            std::vector<entt::entity> entities{};
+            for (Uint32 tick{0}; tick < 5; ++tick) {
+                // Tick every AI on this thread, into a single buffer.
+                AICommandBuffer serialBuffer{};
+                auto serialView{serialWorld.registry.view<TestParallelAI>()};
+                for (auto [entity, aiLogic] : serialView.each()) {
+                    aiLogic.tickParallel(serialWorld, entity, serialBuffer);
+                }
+                applyInputs(serialBuffer, serialWorld);
+
+                // Tick every AI on the pool, then apply the buffers in
+                // chunk order.
+                auto parallelView{
+                    parallelWorld.registry.view<TestParallelAI>()};
+                entities.assign(parallelView.begin(), parallelView.end());
+                std::span<AICommandBuffer> commandBuffers{workerPool.run(
+                    entities,
+                    [&](entt::entity entity, AICommandBuffer& commandBuffer) {
+                        parallelView.get<TestParallelAI>(entity).tickParallel(
+                            parallelWorld, entity, commandBuffer);
+                    })};
+                CHECK(commandBuffers.size()
+                      == ((ENTITY_COUNT + config.chunkSize - 1)
+                          / config.chunkSize));
+                for (AICommandBuffer& commandBuffer : commandBuffers) {
+                    applyInputs(commandBuffer, parallelWorld);
+                }
+
+                CHECK(worldsMatch(serialWorld, parallelWorld));
+            }
+
+            // Every AI was ticked exactly once per run.
+            auto parallelView{parallelWorld.registry.view<TestParallelAI>()};
+            for (auto [entity, aiLogic] : parallelView.each()) {
+                CHECK(aiLogic.tickCount == 5);
+            }
+
+            // Empty runs don't need the workers.
+            CHECK(workerPool.run({}, [](entt::entity, AICommandBuffer&) {})
+                      .empty());
+        }
+    }
+
+    SECTION("Const locator queries can run on several threads")
+    {
+        TestAIWorld world{};
+
+        // Get the expected results, using the shared return vector.
+        std::vector<Cylinder> cylinders{};
+        std::vector<std::vector<entt::entity>> expectedEntities{};
+        std::vector<std::vector<entt::entity>> expectedBroadEntities{};
+        for (entt::entity entity : world.registry.view<Position>()) {
+            Cylinder& cylinder{cylinders.emplace_back(
+                world.registry.get<Position>(entity), SEARCH_RADIUS,
+                SEARCH_RADIUS)};
+            expectedEntities.push_back(
+                world.entityLocator.getEntities(cylinder));
+            expectedBroadEntities.push_back(
+                world.entityLocator.getEntitiesBroad(cylinder));
+        }
+        const TileExtent tileExtent{2, 2, 0, 10, 6, 1};
+        std::vector<entt::entity> expectedExtentEntities{
+            world.entityLocator.getEntities(tileExtent)};
+        REQUIRE(expectedExtentEntities.size() > 0);
+
+        // Run the same queries on several threads at once.
+        const EntityLocator& entityLocator{world.entityLocator};
+        std::vector<int> mismatchCounts(4, 0);
+        {
+            std::vector<std::jthread> threads{};
+            for (std::size_t threadIndex{0};
+                 threadIndex < mismatchCounts.size(); ++threadIndex) {
+                threads.emplace_back([&, threadIndex]() {
+                    std::vector<entt::entity> outEntities{};
+                    int& mismatchCount{mismatchCounts[threadIndex]};
+                    for (int pass{0}; pass < 20; ++pass) {
+                        for (std::size_t i{0}; i < cylinders.size(); ++i) {
+                            entityLocator.getEntities(cylinders[i],
+                                                      outEntities);
+                            mismatchCount
+                                += (outEntities != expectedEntities[i]);
+                            entityLocator.getEntitiesBroad(cylinders[i],
+                                                           outEntities);
+                            mismatchCount
+                                += (outEntities != expectedBroadEntities[i]);
+                        }
+                        entityLocator.getEntities(tileExtent, outEntities);
+                        mismatchCount
+                            += (outEntities != expectedExtentEntities);
+                    }
+                });
+            }
+        }
+
+        for (int mismatchCount : mismatchCounts) {
+            CHECK(mismatchCount == 0);
+        }
+    }
+}
@@ -0,0 +1,164 @@
+#include "catch2/catch_all.hpp"
+#include "CollisionLocator.h"
+#include "CollisionLayerType.h"
+#include "BoundingBox.h"
+#include "Vector3.h"
+#include "SharedConfig.h"
+#include <vector>
+
+using namespace AM;
+
+namespace
+{
+/**
+ * Returns a box that covers the given tile-space extent, with the given
+ * height in tiles.
+ */
+BoundingBox boxFromTiles(float x, float y, float width, float length,
+                         float height)
+{
+    const float TILE_WORLD_WIDTH{SharedConfig::TILE_WORLD_WIDTH};
+    const float TILE_WORLD_HEIGHT{SharedConfig::TILE_WORLD_HEIGHT};
+    return {{x * TILE_WORLD_WIDTH, y * TILE_WORLD_WIDTH, 0},
+            {(x + width) * TILE_WORLD_WIDTH, (y + length) * TILE_WORLD_WIDTH,
+             height * TILE_WORLD_HEIGHT}};
+}
+
+/**
+ * Returns a point at the given tile-space coordinates.
+ */
+Vector3 pointFromTiles(float x, float y, float z)
+{
+    return {x * SharedConfig::TILE_WORLD_WIDTH,
+            y * SharedConfig::TILE_WORLD_WIDTH,
+            z * SharedConfig::TILE_WORLD_HEIGHT};
+}
+} // namespace
+
+TEST_CASE("TestBatchRaycast")
+{
+    CollisionLocator collisionLocator{};
+    collisionLocator.setGridSize(TileExtent{0, 0, 0, 32, 32, 2});
+
+    // Add some entity volumes, on a couple of different layers.
+    std::vector<entt::entity> entities{};
+    for (Uint32 i{0}; i < 5; ++i) {
+        entities.push_back(static_cast<entt::entity>(i));
+    }
+    collisionLocator.updateEntity(entities[0], boxFromTiles(4, 4, 1, 1, 1),
+                                  CollisionLayerType::BlockCollision);
+    collisionLocator.updateEntity(entities[1], boxFromTiles(8, 4, 2, 1, 1),
+                                  CollisionLayerType::BlockCollision);
+    collisionLocator.updateEntity(entities[2], boxFromTiles(12, 4, 1, 3, 1),
+                                  CollisionLayerType::BlockLoS);
+    collisionLocator.updateEntity(
+        entities[3], boxFromTiles(4, 12, 1, 1, 1),
+        CollisionLayerType::BlockCollision | CollisionLayerType::BlockLoS);
+    // Crosses a cell boundary, so it's in multiple cells.
+    collisionLocator.updateEntity(entities[4], boxFromTiles(15, 15, 3, 3, 1),
+                                  CollisionLayerType::BlockCollision);
+
+    const CollisionLayerBitSet ALL_LAYERS{CollisionLayerType::BlockCollision
+                                          | CollisionLayerType::BlockLoS};
+
+    // A set of rays that cover hits, misses, masked-out layers, excluded
+    // entities, and rays that start inside a volume.
+    std::vector<CollisionLocator::BatchRaycastRay> rays{};
+    // Along y = 4.5, through entities 0, 1, and 2 (first hit: 0).
+    rays.push_back(
+        {pointFromTiles(0, 4.5f, 0.5f), pointFromTiles(20, 4.5f, 0.5f),
+         ALL_LAYERS});
+    // Same, but in reverse (first hit: 2).
+    rays.push_back(
+        {pointFromTiles(20, 4.5f, 0.5f), pointFromTiles(0, 4.5f, 0.5f),
+         ALL_LAYERS});
+    // Same, but only BlockLoS (skips 0 and 1).
+    rays.push_back(
+        {pointFromTiles(0, 4.5f, 0.5f), pointFromTiles(20, 4.5f, 0.5f),
+         CollisionLayerType::BlockLoS});
+    // Misses everything.
+    rays.push_back(
+        {pointFromTiles(0, 2, 0.5f), pointFromTiles(20, 2, 0.5f), ALL_LAYERS});
+    // Passes over the volumes.
+    rays.push_back(
+        {pointFromTiles(0, 4.5f, 1.5f), pointFromTiles(20, 4.5f, 1.5f),
+         ALL_LAYERS});
+    // Diagonal, crossing many cells, through entities 0 and 4 (first hit: 0).
+    rays.push_back(
+        {pointFromTiles(1, 2, 0.5f), pointFromTiles(30, 29, 0.5f), ALL_LAYERS});
+    // Starts inside entity 4.
+    rays.push_back(
+        {pointFromTiles(16, 16, 0.5f), pointFromTiles(16, 30, 0.5f),
+         ALL_LAYERS});
+    rays.push_back({pointFromTiles(16, 16, 0.5f),
+                    pointFromTiles(16, 30, 0.5f), ALL_LAYERS, {}, false});
+    // Vertical, into entity 3.
+    rays.push_back(
+        {pointFromTiles(4.5f, 12.5f, 1.5f), pointFromTiles(4.5f, 12.5f, 0),
+         ALL_LAYERS});
+    // Zero length.
+    rays.push_back(
+        {pointFromTiles(3, 3, 0), pointFromTiles(3, 3, 0), ALL_LAYERS});
+
+    SECTION("Batch results match the single-ray API")
+    {
+        std::vector<CollisionLocator::BatchRaycastHit> anyResults(
+            rays.size());
+        std::vector<CollisionLocator::BatchRaycastHit> firstResults(
+            rays.size());
+        collisionLocator.raycastAnyBatch(rays, anyResults);
+        collisionLocator.raycastFirstBatch(rays, firstResults);
+
+        for (std::size_t i{0}; i < rays.size(); ++i) {
+            INFO("Ray " << i);
+            const CollisionLocator::BatchRaycastRay& ray{rays[i]};
+            CollisionLocator::RaycastParams params{
+                ray.start, ray.end, ray.collisionMask, ray.entitiesToExclude,
+                ray.ignoreInsideHits};
+
+            bool singleAny{collisionLocator.raycastAny(params)};
+            CHECK(anyResults[i].didHit == singleAny);
+
+            std::optional<CollisionLocator::RaycastHitInfo> singleFirst{
+                collisionLocator.raycastFirst(params)};
+            REQUIRE(firstResults[i].didHit == singleFirst.has_value());
+            if (singleFirst) {
+                CHECK(firstResults[i].hitT == singleFirst->hitT);
+                CHECK(firstResults[i].collisionInfo.entity
+                      == singleFirst->collisionInfo->entity);
+            }
+        }
+
+        // Spot check that the rays hit what we expect, so the comparison
+        // above isn't trivially passing.
+        CHECK(firstResults[0].collisionInfo.entity == entities[0]);
+        CHECK(firstResults[1].collisionInfo.entity == entities[2]);
+        CHECK(firstResults[2].collisionInfo.entity == entities[2]);
+        CHECK(!(firstResults[3].didHit));
+        CHECK(!(firstResults[4].didHit));
+        CHECK(firstResults[5].collisionInfo.entity == entities[0]);
+        CHECK(firstResults[8].collisionInfo.entity == entities[3]);
+    }
+
+    SECTION("Excluded entities are skipped by both APIs")
+    {
+        std::vector<entt::entity> toExclude{entities[0]};
+        std::vector<CollisionLocator::BatchRaycastRay> excludeRays{
+            {pointFromTiles(0, 4.5f, 0.5f), pointFromTiles(20, 4.5f, 0.5f),
+             ALL_LAYERS, toExclude}};
+
+        std::vector<CollisionLocator::BatchRaycastHit> results(1);
+        collisionLocator.raycastFirstBatch(excludeRays, results);
+
+        CollisionLocator::RaycastParams params{
+            excludeRays[0].start, excludeRays[0].end, ALL_LAYERS, toExclude};
+        std::optional<CollisionLocator::RaycastHitInfo> singleFirst{
+            collisionLocator.raycastFirst(params)};
+
+        REQUIRE(results[0].didHit);
+        REQUIRE(singleFirst);
+        CHECK(results[0].collisionInfo.entity == entities[1]);
+        CHECK(singleFirst->collisionInfo->entity == entities[1]);
+        CHECK(results[0].hitT == singleFirst->hitT);
+    }
+}
@@ -0,0 +1,254 @@
+#include "catch2/catch_all.hpp"
+#include "TestMapStore.h"
+#include "TestTileMap.h"
+#include "TileMap.h"
+#include "GraphicData.h"
+#include "ChunkPosition.h"
+#include "Wall.h"
+#include "Rotation.h"
+#include <limits>
+
+using namespace AM;
+using namespace AM::Server;
+
+namespace
+{
+/** Passed to evictChunks() to disable one of its conditions. */
+constexpr Uint32 NO_IDLE_LIMIT{std::numeric_limits<Uint32>::max()};
+constexpr std::size_t NO_MEMORY_BUDGET{
+    std::numeric_limits<std::size_t>::max()};
+
+/**
+ * Builds a room whose walls cross from the map's first chunk into the chunk
+ * to its East, a row of blocks along the border, and a block in each of the
+ * other chunks. Then, saves the map and waits for the write to finish.
+ */
+void buildTestMap(TileMap& tileMap)
+{
+    const TileExtent& mapExtent{tileMap.getTileExtent()};
+    const int CHUNK_WIDTH{static_cast<int>(SharedConfig::CHUNK_WIDTH)};
+    auto at = [&](int x, int y) -> TilePosition {
+        return {mapExtent.x + x, mapExtent.y + y, 0};
+    };
+
+    for (int x{10}; x < 22; ++x) {
+        tileMap.addWall(at(x, 4), TestGraphicSets::WALL, Wall::Type::North);
+        tileMap.addWall(at(x, 12), TestGraphicSets::WALL, Wall::Type::North);
+    }
+    for (int y{4}; y < 12; ++y) {
+        tileMap.addWall(at(10, y), TestGraphicSets::WALL, Wall::Type::West);
+        tileMap.addWall(at(22, y), TestGraphicSets::WALL, Wall::Type::West);
+    }
+    for (int y{2}; y < 14; ++y) {
+        tileMap.addObject(at(CHUNK_WIDTH - 1, y), {}, TestGraphicSets::BLOCK,
+                          Rotation::Direction::South);
+        tileMap.addObject(at(CHUNK_WIDTH, y), {}, TestGraphicSets::BLOCK,
+                          Rotation::Direction::South);
+    }
+    tileMap.addObject(at(1, CHUNK_WIDTH + 1), {}, TestGraphicSets::BLOCK,
+                      Rotation::Direction::South);
+    tileMap.addObject(at(CHUNK_WIDTH + 1, CHUNK_WIDTH + 1), {},
+                      TestGraphicSets::BLOCK, Rotation::Direction::South);
+    tileMap.rebuildDirtyTileCollision();
+
+    tileMap.save();
+    waitWhile([&]() { return tileMap.saveIsInProgress(); });
+}
+} // namespace
+
+TEST_CASE("TestChunkEviction")
+{
+    TestMapStore mapStore{"AmalgamTestChunkEviction", 2, 2, 1};
+    GraphicData graphicData{getTestResourceData()};
+    CollisionLocator collisionLocator{};
+    TileMap tileMap{graphicData, collisionLocator, mapStore.getBasePath()};
+    buildTestMap(tileMap);
+
+    const TileExtent& mapExtent{tileMap.getTileExtent()};
+    const int CHUNK_WIDTH{static_cast<int>(SharedConfig::CHUNK_WIDTH)};
+    const float MID_HEIGHT{SharedConfig::TILE_WORLD_HEIGHT / 2.f};
+    const ChunkPosition firstChunk{
+        TilePosition{mapExtent.x, mapExtent.y, 0}};
+    const ChunkPosition eastChunk{firstChunk.x + 1, firstChunk.y, 0};
+    const ChunkPosition southChunk{firstChunk.x, firstChunk.y + 1, 0};
+    const ChunkPosition southEastChunk{firstChunk.x + 1, firstChunk.y + 1,
+                                       0};
+    const TileExtent firstExtent{
+        TileExtent{ChunkExtent{firstChunk.x, firstChunk.y, 0, 1, 1, 1}}};
+    const TileExtent eastExtent{firstExtent.x + CHUNK_WIDTH, firstExtent.y,
+                                0, CHUNK_WIDTH, CHUNK_WIDTH, 1};
+    REQUIRE(tileMap.getResidentChunkCount() == 4);
+
+    // Use every chunk on tick 1, then start each section on tick 10.
+    tileMap.setCurrentTick(1);
+    tileMap.loadExtentIfNecessary(tileMap.getChunkExtent());
+    tileMap.setCurrentTick(10);
+
+    SECTION("Idle chunks are evicted")
+    {
+        // Keep the East chunk in use.
+        tileMap.loadChunkIfNecessary(eastChunk);
+
+        // Not idle for long enough.
+        CHECK(tileMap.evictChunks(10, NO_MEMORY_BUDGET) == 0);
+        CHECK(tileMap.getResidentChunkCount() == 4);
+
+        // Chunks used on the current tick stay loaded.
+        CHECK(tileMap.evictChunks(9, NO_MEMORY_BUDGET) == 3);
+        CHECK(tileMap.getResidentChunkCount() == 1);
+        CHECK(tileMap.cgetChunk(eastChunk) != nullptr);
+        CHECK(tileMap.getUnloadedChunkCount() == 3);
+        CHECK(tileMap.getChunkEvictionCount() == 3);
+    }
+
+    SECTION("Least recently used chunks are evicted to fit the budget")
+    {
+        tileMap.setCurrentTick(11);
+        tileMap.loadChunkIfNecessary(southEastChunk);
+        tileMap.setCurrentTick(12);
+        tileMap.loadChunkIfNecessary(southChunk);
+        tileMap.setCurrentTick(13);
+        tileMap.loadChunkIfNecessary(eastChunk);
+
+        // Measure the chunks.
+        CHECK(tileMap.evictChunks(NO_IDLE_LIMIT, NO_MEMORY_BUDGET) == 0);
+        std::size_t residentMemory{tileMap.getResidentChunkMemory()};
+        REQUIRE(residentMemory > 0);
+
+        // Going just over budget evicts the least recently used chunk.
+        CHECK(tileMap.evictChunks(NO_IDLE_LIMIT, (residentMemory - 1)) == 1);
+        CHECK(tileMap.cgetChunk(firstChunk) == nullptr);
+        CHECK(tileMap.getResidentChunkMemory() <= (residentMemory - 1));
+
+        // Chunks used on the current tick stay loaded, even if we're over
+        // budget.
+        CHECK(tileMap.evictChunks(NO_IDLE_LIMIT, 0) == 2);
+        CHECK(tileMap.getResidentChunkCount() == 1);
+        CHECK(tileMap.cgetChunk(eastChunk) != nullptr);
+    }
+
+    SECTION("Chunks with unsaved changes are written back before eviction")
+    {
+        const TilePosition newTile{firstExtent.x + 2, firstExtent.y + 2, 0};
+        tileMap.addObject(newTile, {}, TestGraphicSets::BLOCK,
+                          Rotation::Direction::South);
+        REQUIRE(tileMap.getDirtyChunks().contains(firstChunk));
+
+        // The dirty chunk isn't evicted. Instead, a save is started.
+        std::size_t evictedCount{tileMap.evictChunks(1, NO_MEMORY_BUDGET)};
+        CHECK(evictedCount == 3);
+        CHECK(tileMap.cgetChunk(firstChunk) != nullptr);
+        CHECK(tileMap.getDirtyChunks().empty());
+
+        // Keep trying until the chunk is evicted.
+        // Note: The save may finish at any point, so we can't check exactly
+        //       when eviction resumes. Instead, we check that the chunk
+        //       wasn't evicted before its change reached the store.
+        tileMap.setCurrentTick(20);
+        while (tileMap.cgetChunk(firstChunk) != nullptr) {
+            tileMap.evictChunks(1, NO_MEMORY_BUDGET);
+        }
+
+        // When the chunk is loaded again, it has the change.
+        tileMap.loadChunkIfNecessary(firstChunk);
+        const Tile* tile{tileMap.cgetTile(newTile)};
+        REQUIRE(tile != nullptr);
+        CHECK(tile->getLayers(TileLayer::Type::Object).size() == 1);
+    }
+
+    SECTION("Evicting a chunk removes only its collision")
+    {
+        std::vector<bool> originalEastProbes{
+            probeTiles(collisionLocator, eastExtent, MID_HEIGHT)};
+
+        tileMap.loadChunkIfNecessary(eastChunk);
+        tileMap.loadChunkIfNecessary(southChunk);
+        tileMap.loadChunkIfNecessary(southEastChunk);
+        REQUIRE(tileMap.evictChunks(1, NO_MEMORY_BUDGET) == 1);
+        REQUIRE(tileMap.cgetChunk(firstChunk) == nullptr);
+
+        for (bool probeHit :
+             probeTiles(collisionLocator, firstExtent, MID_HEIGHT)) {
+            CHECK(!probeHit);
+        }
+        CHECK(probeTiles(collisionLocator, eastExtent, MID_HEIGHT)
+              == originalEastProbes);
+    }
+
+    SECTION("Reloading a chunk restores its collision")
+    {
+        std::vector<bool> originalProbes{
+            probeTiles(collisionLocator, mapExtent, MID_HEIGHT)};
+        std::size_t originalVolumeCount{
+            collisionLocator.getCollisions(mapExtent, TILE_COLLISION_LAYERS)
+                .size()};
+        REQUIRE(originalVolumeCount > 0);
+
+        // Evict and reload every chunk twice. Nothing should be left behind.
+        for (Uint32 tick : {20, 30}) {
+            tileMap.setCurrentTick(tick);
+            REQUIRE(tileMap.evictChunks(1, NO_MEMORY_BUDGET) == 4);
+            REQUIRE(tileMap.getResidentChunkCount() == 0);
+
+            tileMap.loadExtentIfNecessary(tileMap.getChunkExtent());
+            tileMap.rebuildDirtyTileCollision();
+            CHECK(probeTiles(collisionLocator, mapExtent, MID_HEIGHT)
+                  == originalProbes);
+            CHECK(collisionLocator
+                      .getCollisions(mapExtent, TILE_COLLISION_LAYERS)
+                      .size()
+                  == originalVolumeCount);
+        }
+        CHECK(tileMap.getChunkFaultInCount() == 8);
+    }
+}
+
+TEST_CASE("TestChunkEvictionFailedSave")
+{
+#ifndef NDEBUG
+    // Note: Failed writes call LOG_ERROR, which aborts in debug builds.
+    SKIP("Write failures can only be tested in release builds.");
+#endif
+
+    TestMapStore mapStore{"AmalgamTestChunkEvictionFailedSave", 2, 2, 1};
+    GraphicData graphicData{getTestResourceData()};
+    CollisionLocator collisionLocator{};
+    TileMap tileMap{graphicData, collisionLocator, mapStore.getBasePath()};
+    buildTestMap(tileMap);
+    auto waitForSave = [&]() {
+        waitWhile([&]() { return tileMap.saveIsInProgress(); });
+    };
+
+    // Fail to save an edit.
+    const TileExtent& mapExtent{tileMap.getTileExtent()};
+    const TilePosition newTile{mapExtent.x + 2, mapExtent.y + 2, 0};
+    const ChunkPosition editedChunk{newTile};
+    tileMap.addObject(newTile, {}, TestGraphicSets::BLOCK,
+                      Rotation::Direction::South);
+    mapStore.blockWrites();
+    tileMap.save();
+    waitForSave();
+
+    // Nothing is evicted while the store is missing our changes.
+    tileMap.setCurrentTick(1);
+    tileMap.loadExtentIfNecessary(tileMap.getChunkExtent());
+    tileMap.setCurrentTick(10);
+    CHECK(tileMap.evictChunks(1, 0) == 0);
+    waitForSave();
+    CHECK(tileMap.evictChunks(1, 0) == 0);
+    waitForSave();
+    CHECK(tileMap.getResidentChunkCount() == 4);
+
+    // Once writes work again, eviction retries the save without any further
+    // edits, then resumes.
+    mapStore.unblockWrites();
+    CHECK(tileMap.evictChunks(1, 0) == 0);
+    waitForSave();
+    CHECK(tileMap.evictChunks(1, 0) == 4);
+
+    // The edit survived eviction.
+    tileMap.loadChunkIfNecessary(editedChunk);
+    const Tile* tile{tileMap.cgetTile(newTile)};
+    REQUIRE(tile != nullptr);
+    CHECK(tile->getLayers(TileLayer::Type::Object).size() == 1);
+}
@@ -0,0 +1,123 @@
+#include "catch2/catch_all.hpp"
+#include "ChunkStore.h"
+#include "ChunkPosition.h"
+#include "ChunkSnapshot.h"
+#include <filesystem>
+#include <string>
+
+using namespace AM;
+
+namespace
+{
+/**
+ * Returns a chunk snapshot whose first tile holds a single terrain layer
+ * with the given graphic value, so we can tell snapshots apart.
+ */
+ChunkSnapshot makeChunkSnapshot(Uint8 graphicValue)
+{
+    ChunkSnapshot chunkSnapshot{};
+    chunkSnapshot.palette.push_back(
+        {"Ground", TileLayer::Type::Terrain, graphicValue});
+    chunkSnapshot.tileLayerCounts[0] = 1;
+    chunkSnapshot.tileLayers.push_back(0);
+    return chunkSnapshot;
+}
+
+/**
+ * Returns the graphic value of the given chunk's first layer.
+ */
+Uint8 readGraphicValue(ChunkStore& chunkStore,
+                       const ChunkPosition& chunkPosition)
+{
+    ChunkSnapshot chunkSnapshot{};
+    REQUIRE(chunkStore.readChunk(chunkPosition, chunkSnapshot));
+    REQUIRE(chunkSnapshot.palette.size() == 1);
+    REQUIRE(chunkSnapshot.tileLayers.size() == 1);
+    return chunkSnapshot.palette[0].graphicValue;
+}
+} // namespace
+
+TEST_CASE("TestChunkStore")
+{
+    // Give each run a fresh directory.
+    std::filesystem::path directory{std::filesystem::temp_directory_path()
+                                    / "AmalgamTestChunkStore"};
+    std::filesystem::remove_all(directory);
+    std::filesystem::create_directories(directory);
+    const std::string basePath{(directory / "TileMap").string()};
+
+    const ChunkPosition chunkA{0, 0, 0};
+    const ChunkPosition chunkB{1, 0, 0};
+    const ChunkPosition chunkC{0, 1, 0};
+
+    {
+        ChunkStore chunkStore{basePath};
+        CHECK(!(chunkStore.exists()));
+        chunkStore.setMapInfo(1, 2, 2, 1);
+
+        ChunkStore::ChunkUpdateMap chunkUpdates{};
+        chunkUpdates.emplace(chunkA, makeChunkSnapshot(1));
+        chunkUpdates.emplace(chunkB, makeChunkSnapshot(2));
+        chunkUpdates.emplace(chunkC, makeChunkSnapshot(3));
+        REQUIRE(chunkStore.save(chunkUpdates));
+        CHECK(chunkStore.getDataFileSize() == chunkStore.getLiveDataSize());
+
+        // Overwrite A twice and remove C, leaving garbage records behind.
+        for (Uint8 graphicValue : {4, 5}) {
+            chunkUpdates.clear();
+            chunkUpdates.emplace(chunkA, makeChunkSnapshot(graphicValue));
+            REQUIRE(chunkStore.save(chunkUpdates));
+        }
+        chunkUpdates.clear();
+        chunkUpdates.emplace(chunkC, std::nullopt);
+        REQUIRE(chunkStore.save(chunkUpdates));
+
+        CHECK(chunkStore.getDataFileSize() > chunkStore.getLiveDataSize());
+        CHECK(readGraphicValue(chunkStore, chunkA) == 5);
+    }
+
+    SECTION("Saved chunks round-trip through a reopened store")
+    {
+        ChunkStore chunkStore{basePath};
+        REQUIRE(chunkStore.exists());
+        REQUIRE(chunkStore.open());
+
+        CHECK(chunkStore.getMapVersion() == 1);
+        CHECK(chunkStore.getXLengthChunks() == 2);
+        CHECK(chunkStore.getYLengthChunks() == 2);
+        CHECK(chunkStore.getZLengthChunks() == 1);
+
+        CHECK(chunkStore.getRecordLocations().size() == 2);
+        CHECK(readGraphicValue(chunkStore, chunkA) == 5);
+        CHECK(readGraphicValue(chunkStore, chunkB) == 2);
+
+        ChunkSnapshot chunkSnapshot{};
+        CHECK(!(chunkStore.readChunk(chunkC, chunkSnapshot)));
+    }
+
+    SECTION("Compaction keeps only the latest record of each chunk")
+    {
+        ChunkStore chunkStore{basePath};
+        REQUIRE(chunkStore.open());
+        Uint64 oldDataFileSize{chunkStore.getDataFileSize()};
+
+        REQUIRE(chunkStore.compact());
+        CHECK(chunkStore.getDataFileSize() < oldDataFileSize);
+        CHECK(chunkStore.getDataFileSize() == chunkStore.getLiveDataSize());
+        CHECK(chunkStore.getRecordLocations().size() == 2);
+        CHECK(readGraphicValue(chunkStore, chunkA) == 5);
+        CHECK(readGraphicValue(chunkStore, chunkB) == 2);
+
+        // The compacted store should also survive a reopen.
+        ChunkStore reopenedStore{basePath};
+        REQUIRE(reopenedStore.open());
+        CHECK(reopenedStore.getDataFileSize()
+              == reopenedStore.getLiveDataSize());
+        CHECK(readGraphicValue(reopenedStore, chunkA) == 5);
+        CHECK(readGraphicValue(reopenedStore, chunkB) == 2);
+        ChunkSnapshot chunkSnapshot{};
+        CHECK(!(reopenedStore.readChunk(chunkC, chunkSnapshot)));
+    }
+
+    std::filesystem::remove_all(directory);
+}
@@ -0,0 +1,86 @@
+#include "catch2/catch_all.hpp"
+#include "EventSorter.h"
+#include <vector>
+
+using namespace AM;
+using namespace AM::Server;
+
+TEST_CASE("TestEventSorter")
+{
+    // Valid ticks are [currentTick, currentTick + 4).
+    EventSorter<int> eventSorter{4, 2};
+
+    SECTION("Ticks are classified against the window")
+    {
+        // Advance so there's a tick below the window.
+        eventSorter.advance();
+        eventSorter.advance();
+        REQUIRE(eventSorter.getCurrentTick() == 2);
+
+        CHECK(eventSorter.isTickValid(1) == SorterBase::ValidityResult::TooLow);
+        CHECK(eventSorter.isTickValid(2) == SorterBase::ValidityResult::Valid);
+        CHECK(eventSorter.isTickValid(5) == SorterBase::ValidityResult::Valid);
+        CHECK(eventSorter.isTickValid(6)
+              == SorterBase::ValidityResult::TooHigh);
+
+        // Invalid events are counted, but not buffered.
+        CHECK(eventSorter.push(0, 0) == SorterBase::ValidityResult::TooLow);
+        CHECK(eventSorter.push(0, 1) == SorterBase::ValidityResult::TooLow);
+        CHECK(eventSorter.push(0, 6) == SorterBase::ValidityResult::TooHigh);
+        CHECK(eventSorter.getTooLowCount() == 2);
+        CHECK(eventSorter.getTooHighCount() == 1);
+
+        // Nothing invalid made it into the buffer.
+        for (int i{0}; i < 4; ++i) {
+            CHECK(eventSorter.getCurrentEvents().empty());
+            eventSorter.advance();
+        }
+    }
+
+    SECTION("Events are returned on their tick, in push order")
+    {
+        eventSorter.push(30, 3);
+        eventSorter.push(10, 1);
+        eventSorter.push(0, 0);
+        eventSorter.push(11, 1);
+
+        CHECK(eventSorter.getCurrentEvents() == std::vector<int>{0});
+        eventSorter.advance();
+        CHECK(eventSorter.getCurrentEvents() == std::vector<int>{10, 11});
+        eventSorter.advance();
+        CHECK(eventSorter.getCurrentEvents().empty());
+        eventSorter.advance();
+        CHECK(eventSorter.getCurrentEvents() == std::vector<int>{30});
+    }
+
+    SECTION("The ring wraps around")
+    {
+        // Go around the ring a few times, filling the whole window each
+        // time. Each tick's slot is reused by the tick one window later.
+        for (Uint32 tick{0}; tick < 12; ++tick) {
+            REQUIRE(eventSorter.getCurrentTick() == tick);
+
+            // Push into the last tick of the window, which shares a slot
+            // with the tick before the current one.
+            Uint32 lastTick{tick + 3};
+            CHECK(eventSorter.push(static_cast<int>(lastTick), lastTick)
+                  == SorterBase::ValidityResult::Valid);
+            CHECK(eventSorter.push(static_cast<int>(lastTick + 1),
+                                   (lastTick + 1))
+                  == SorterBase::ValidityResult::TooHigh);
+
+            // The first window's ticks were never pushed to.
+            if (tick < 3) {
+                CHECK(eventSorter.getCurrentEvents().empty());
+            }
+            else {
+                CHECK(eventSorter.getCurrentEvents()
+                      == std::vector<int>{static_cast<int>(tick)});
+            }
+
+            eventSorter.advance();
+        }
+        CHECK(eventSorter.getTooLowCount() == 0);
+        CHECK(eventSorter.getTooHighCount() == 12);
+    }
+}
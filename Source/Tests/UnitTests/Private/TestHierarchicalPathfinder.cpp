@@ -0,0 +1,373 @@
+#include "catch2/catch_all.hpp"
+#include "HierarchicalPathfinder.h"
+#include "NavGraph.h"
+#include "ChunkExtent.h"
+#include "SharedConfig.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <limits>
+#include <memory>
+#include <queue>
+#include <utility>
+#include <vector>
+
+using namespace AM;
+using namespace AM::Server;
+
+namespace
+{
+const int CHUNK_WIDTH{static_cast<int>(SharedConfig::CHUNK_WIDTH)};
+const float DIAGONAL_COST{1.41421356f};
+
+/**
+ * A grid of walkable tiles on Z level 0, starting at the origin. Builds nav
+ * chunks from the grid, and runs a plain (non-hierarchical) A* over it to
+ * compare paths against.
+ */
+class TestNavMap
+{
+public:
+    TestNavMap(int inChunksX, int inChunksY)
+    : chunkExtent{0, 0, 0, inChunksX, inChunksY, 1}
+    , width{inChunksX * CHUNK_WIDTH}
+    , length{inChunksY * CHUNK_WIDTH}
+    , isBlocked(static_cast<std::size_t>(width * length), false)
+    {
+    }
+
+    void setBlocked(int x, int y, bool blocked)
+    {
+        isBlocked[(y * width) + x] = blocked;
+    }
+
+    bool isWalkable(int x, int y) const
+    {
+        return (x >= 0) && (y >= 0) && (x < width) && (y < length)
+               && !(isBlocked[(y * width) + x]);
+    }
+
+    /**
+     * Builds the given chunk's nav chunk the same way that PathfindingSystem
+     * does: an edge is passable if both of its tiles are walkable.
+     */
+    void buildNavChunk(NavGraph& navGraph,
+                       const ChunkPosition& chunkPosition) const
+    {
+        auto navChunk{std::make_shared<NavChunk>()};
+        navChunk->position = chunkPosition;
+        TilePosition origin{chunkPosition};
+        for (int y{0}; y < CHUNK_WIDTH; ++y) {
+            for (int x{0}; x < CHUNK_WIDTH; ++x) {
+                int tileX{origin.x + x};
+                int tileY{origin.y + y};
+                if (!isWalkable(tileX, tileY)) {
+                    continue;
+                }
+
+                Uint8 flags{NavChunk::Walkable};
+                if (isWalkable(tileX + 1, tileY)) {
+                    flags |= NavChunk::PassablePositiveX;
+                }
+                if (isWalkable(tileX, tileY + 1)) {
+                    flags |= NavChunk::PassablePositiveY;
+                }
+                navChunk->tileFlags[(y * CHUNK_WIDTH) + x] = flags;
+            }
+        }
+
+        navGraph.setNavChunk(std::move(navChunk));
+    }
+
+    void buildAllNavChunks(NavGraph& navGraph) const
+    {
+        for (int y{chunkExtent.y}; y <= chunkExtent.yMax(); ++y) {
+            for (int x{chunkExtent.x}; x <= chunkExtent.xMax(); ++x) {
+                buildNavChunk(navGraph, {x, y, 0});
+            }
+        }
+    }
+
+    /**
+     * Returns true if an agent can step from the given tile in the given
+     * direction. Diagonal steps can't cut corners.
+     */
+    bool canStep(int x, int y, int dx, int dy) const
+    {
+        if (!isWalkable(x, y) || !isWalkable(x + dx, y + dy)) {
+            return false;
+        }
+
+        return ((dx == 0) || (dy == 0))
+               || (isWalkable(x + dx, y) && isWalkable(x, y + dy));
+    }
+
+    /**
+     * Returns the cost of the given path, or -1 if it isn't a valid series of
+     * steps.
+     */
+    float getPathCost(const std::vector<TilePosition>& path) const
+    {
+        float cost{0};
+        for (std::size_t i{1}; i < path.size(); ++i) {
+            int dx{path[i].x - path[i - 1].x};
+            int dy{path[i].y - path[i - 1].y};
+            if ((std::abs(dx) > 1) || (std::abs(dy) > 1) || ((dx | dy) == 0)
+                || !canStep(path[i - 1].x, path[i - 1].y, dx, dy)) {
+                return -1;
+            }
+            cost += ((dx != 0) && (dy != 0)) ? DIAGONAL_COST : 1.f;
+        }
+
+        return cost;
+    }
+
+    /**
+     * Returns the cost of the shortest path between the given tiles, using
+     * plain A* over every tile. Returns infinity if there's no path.
+     */
+    float findShortestPathCost(const TilePosition& start,
+                               const TilePosition& goal) const
+    {
+        auto heuristic{[&](int x, int y) {
+            int dx{std::abs(goal.x - x)};
+            int dy{std::abs(goal.y - y)};
+            int diagonalSteps{std::min(dx, dy)};
+            return static_cast<float>(std::max(dx, dy) - diagonalSteps)
+                   + (static_cast<float>(diagonalSteps) * DIAGONAL_COST);
+        }};
+
+        const float INFINITE_COST{std::numeric_limits<float>::infinity()};
+        std::vector<float> costs(isBlocked.size(), INFINITE_COST);
+        using OpenEntry = std::pair<float, int>;
+        std::priority_queue<OpenEntry, std::vector<OpenEntry>,
+                            std::greater<OpenEntry>>
+            openList{};
+        costs[(start.y * width) + start.x] = 0;
+        openList.push({heuristic(start.x, start.y), (start.y * width)
+                                                        + start.x});
+        while (!(openList.empty())) {
+            auto [estimate, index]{openList.top()};
+            openList.pop();
+            int x{index % width};
+            int y{index / width};
+            if ((x == goal.x) && (y == goal.y)) {
+                return costs[index];
+            }
+            if (estimate > (costs[index] + heuristic(x, y))) {
+                continue;
+            }
+
+            for (int dy{-1}; dy <= 1; ++dy) {
+                for (int dx{-1}; dx <= 1; ++dx) {
+                    if (((dx | dy) == 0) || !canStep(x, y, dx, dy)) {
+                        continue;
+                    }
+
+                    int nextIndex{((y + dy) * width) + (x + dx)};
+                    float nextCost{costs[index]
+                                   + (((dx != 0) && (dy != 0))
+                                          ? DIAGONAL_COST
+                                          : 1.f)};
+                    if (nextCost < costs[nextIndex]) {
+                        costs[nextIndex] = nextCost;
+                        openList.push(
+                            {nextCost + heuristic(x + dx, y + dy),
+                             nextIndex});
+                    }
+                }
+            }
+        }
+
+        return INFINITE_COST;
+    }
+
+    const ChunkExtent chunkExtent;
+
+private:
+    int width;
+    int length;
+    std::vector<bool> isBlocked;
+};
+
+/**
+ * Checks that the given path goes from start to goal, and that its cost is
+ * close to the plain A* path's.
+ */
+void checkPath(const TestNavMap& navMap,
+               const std::vector<TilePosition>& path,
+               const TilePosition& start, const TilePosition& goal)
+{
+    REQUIRE(!(path.empty()));
+    CHECK(path.front() == start);
+    CHECK(path.back() == goal);
+
+    float pathCost{navMap.getPathCost(path)};
+    float shortestCost{navMap.findShortestPathCost(start, goal)};
+    REQUIRE(pathCost >= 0);
+    CHECK(pathCost >= (shortestCost - 0.01f));
+    // HPA* paths go through portals, so they aren't always optimal, but they
+    // should be close.
+    CHECK(pathCost <= (shortestCost * 1.25f));
+}
+} // namespace
+
+TEST_CASE("TestHierarchicalPathfinder")
+{
+    TestNavMap navMap{3, 3};
+    NavGraph navGraph{};
+    HierarchicalPathfinder pathfinder{navGraph};
+    std::vector<TilePosition> path{};
+    std::vector<ChunkPosition> missingChunks{};
+
+    // A wall along x == 20 (in the middle chunk column), with gaps at y == 4
+    // and y == 40.
+    for (int y{0}; y < (CHUNK_WIDTH * 3); ++y) {
+        if ((y != 4) && (y != 40)) {
+            navMap.setBlocked(20, y, true);
+        }
+    }
+
+    SECTION("Abstract graph")
+    {
+        navMap.buildAllNavChunks(navGraph);
+
+        // The middle chunk's -x border is fully open, so it has a single
+        // portal in the middle, linked to the -x neighbor.
+        std::shared_ptr<const NavCluster> cluster{navGraph.getCluster(
+            {1, 1, 0}, navMap.chunkExtent, missingChunks)};
+        REQUIRE(cluster);
+        CHECK(missingChunks.empty());
+        auto countPortals{[&](int linkedX) {
+            return std::count_if(
+                cluster->portals.begin(), cluster->portals.end(),
+                [&](const NavCluster::Portal& portal) {
+                    return (portal.linkedTilePosition.x == linkedX);
+                });
+        }};
+        CHECK(countPortals(CHUNK_WIDTH - 1) == 1);
+        CHECK(countPortals(CHUNK_WIDTH * 2) == 1);
+
+        // Each portal links to an adjacent tile in another chunk.
+        for (const NavCluster::Portal& portal : cluster->portals) {
+            CHECK(NavGraph::toChunkPosition(portal.tilePosition)
+                  == ChunkPosition{1, 1, 0});
+            CHECK(NavGraph::toChunkPosition(portal.linkedTilePosition)
+                  != ChunkPosition{1, 1, 0});
+            CHECK((std::abs(portal.tilePosition.x
+                            - portal.linkedTilePosition.x)
+                   + std::abs(portal.tilePosition.y
+                              - portal.linkedTilePosition.y))
+                  == 1);
+        }
+
+        // The wall cuts off the -x portal from the +x portal.
+        std::size_t portalCount{cluster->portals.size()};
+        REQUIRE(cluster->distances.size() == (portalCount * portalCount));
+        for (std::size_t from{0}; from < portalCount; ++from) {
+            for (std::size_t to{0}; to < portalCount; ++to) {
+                bool fromWest{cluster->portals[from].tilePosition.x < 20};
+                bool toWest{cluster->portals[to].tilePosition.x < 20};
+                CHECK(std::isinf(cluster->getDistance(from, to))
+                      == (fromWest != toWest));
+            }
+        }
+
+        // The cluster is reused until one of its nav chunks changes.
+        missingChunks.clear();
+        CHECK(navGraph.getCluster({1, 1, 0}, navMap.chunkExtent,
+                                  missingChunks)
+              == cluster);
+        navMap.buildNavChunk(navGraph, {0, 1, 0});
+        CHECK(navGraph.getCluster({1, 1, 0}, navMap.chunkExtent,
+                                  missingChunks)
+              != cluster);
+
+        // Clusters need their -x and -y neighbors.
+        navGraph.eraseNavChunk({1, 0, 0});
+        missingChunks.clear();
+        CHECK(!navGraph.getCluster({1, 1, 0}, navMap.chunkExtent,
+                                   missingChunks));
+        CHECK(missingChunks == std::vector<ChunkPosition>{{1, 0, 0}});
+    }
+
+    SECTION("Refined paths match plain A*")
+    {
+        navMap.buildAllNavChunks(navGraph);
+
+        // Within a single chunk.
+        TilePosition start{2, 2, 0};
+        TilePosition goal{13, 9, 0};
+        REQUIRE(pathfinder.findPath(start, goal, navMap.chunkExtent, path,
+                                    missingChunks)
+                == HierarchicalPathfinder::Status::Found);
+        checkPath(navMap, path, start, goal);
+
+        // Across chunks, through a gap in the wall.
+        start = {2, 30, 0};
+        goal = {45, 30, 0};
+        REQUIRE(pathfinder.findPath(start, goal, navMap.chunkExtent, path,
+                                    missingChunks)
+                == HierarchicalPathfinder::Status::Found);
+        checkPath(navMap, path, start, goal);
+
+        // Corner to corner.
+        start = {0, 0, 0};
+        goal = {47, 47, 0};
+        REQUIRE(pathfinder.findPath(start, goal, navMap.chunkExtent, path,
+                                    missingChunks)
+                == HierarchicalPathfinder::Status::Found);
+        checkPath(navMap, path, start, goal);
+
+        // Into a blocked tile.
+        CHECK(pathfinder.findPath(start, {20, 10, 0}, navMap.chunkExtent,
+                                  path, missingChunks)
+              == HierarchicalPathfinder::Status::NotFound);
+    }
+
+    SECTION("Paths are rebuilt after a tile edit")
+    {
+        navMap.buildAllNavChunks(navGraph);
+
+        TilePosition start{2, 6, 0};
+        TilePosition goal{45, 6, 0};
+        REQUIRE(pathfinder.findPath(start, goal, navMap.chunkExtent, path,
+                                    missingChunks)
+                == HierarchicalPathfinder::Status::Found);
+        checkPath(navMap, path, start, goal);
+        bool usedNearGap{std::find(path.begin(), path.end(),
+                                   TilePosition{20, 4, 0})
+                         != path.end()};
+        CHECK(usedNearGap);
+
+        // Close the near gap. Until the affected chunk is rebuilt, the
+        // search can't finish.
+        navMap.setBlocked(20, 4, true);
+        navGraph.eraseNavChunk({1, 0, 0});
+        CHECK(pathfinder.findPath(start, goal, navMap.chunkExtent, path,
+                                  missingChunks)
+              == HierarchicalPathfinder::Status::NeedsChunks);
+        CHECK(std::find(missingChunks.begin(), missingChunks.end(),
+                        ChunkPosition{1, 0, 0})
+              != missingChunks.end());
+
+        // Rebuild the chunk (and its -x neighbor, which owns the edges
+        // into it), and the path should go through the far gap.
+        missingChunks.clear();
+        navMap.buildNavChunk(navGraph, {1, 0, 0});
+        navMap.buildNavChunk(navGraph, {0, 0, 0});
+        REQUIRE(pathfinder.findPath(start, goal, navMap.chunkExtent, path,
+                                    missingChunks)
+                == HierarchicalPathfinder::Status::Found);
+        checkPath(navMap, path, start, goal);
+        CHECK(std::find(path.begin(), path.end(), TilePosition{20, 40, 0})
+              != path.end());
+
+        // Close the far gap too, and there's no path.
+        navMap.setBlocked(20, 40, true);
+        navMap.buildNavChunk(navGraph, {1, 2, 0});
+        CHECK(pathfinder.findPath(start, goal, navMap.chunkExtent, path,
+                                  missingChunks)
+              == HierarchicalPathfinder::Status::NotFound);
+    }
+}
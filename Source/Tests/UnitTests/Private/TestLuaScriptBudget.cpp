@@ -0,0 +1,46 @@
+#include "catch2/catch_all.hpp"
+#include "LuaScriptCache.h"
+#include "sol/sol.hpp"
+#include <string>
+
+using namespace AM;
+using namespace AM::Server;
+
+TEST_CASE("TestLuaScriptBudget")
+{
+    sol::state luaState{};
+    luaState.open_libraries(sol::lib::base);
+    LuaScriptCache scriptCache{};
+
+    SECTION("Scripts within their budget run normally")
+    {
+        auto result{scriptCache.run(
+            luaState, "local x = 0 for i = 1, 100 do x = x + i end return x")};
+        REQUIRE(result.valid());
+        CHECK(result.get<int>() == 5050);
+    }
+
+    SECTION("Runaway scripts are stopped")
+    {
+        auto result{scriptCache.run(luaState, "while true do end")};
+        REQUIRE(!(result.valid()));
+
+        sol::error err = result;
+        std::string errorString{err.what()};
+        CHECK(errorString.find("budget") != std::string::npos);
+    }
+
+    SECTION("Stopping a script leaves the state usable")
+    {
+        auto runawayResult{scriptCache.run(luaState, "while true do end")};
+        REQUIRE(!(runawayResult.valid()));
+
+        // The budget hook should have been removed.
+        CHECK(lua_gethook(luaState.lua_state()) == nullptr);
+
+        // The budget resets for each run.
+        auto result{scriptCache.run(luaState, "return 1 + 2")};
+        REQUIRE(result.valid());
+        CHECK(result.get<int>() == 3);
+    }
+}
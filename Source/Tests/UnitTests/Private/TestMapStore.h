@@ -0,0 +1,124 @@
+#pragma once
+
+#include "ChunkStore.h"
+#include "TileMapSnapshot.h"
+#include "catch2/catch_all.hpp"
+#include <SDL3/SDL_stdinc.h>
+#include <chrono>
+#include <filesystem>
+#include <functional>
+#include <string>
+#include <thread>
+
+namespace AM
+{
+/**
+ * Creates an empty chunk store in a fresh temporary directory, and deletes
+ * the directory when destroyed.
+ *
+ * Also lets tests make the store's writes fail, to exercise the server's
+ * retry logic.
+ */
+class TestMapStore
+{
+public:
+    TestMapStore(const std::string& directoryName, Uint16 xLengthChunks,
+                 Uint16 yLengthChunks, Uint16 zLengthChunks)
+    : directory{std::filesystem::temp_directory_path() / directoryName}
+    , basePath{(directory / "TileMap").string()}
+    {
+        std::filesystem::remove_all(directory);
+        std::filesystem::create_directories(directory);
+
+        TileMapSnapshot mapSnapshot{};
+        mapSnapshot.version = 1;
+        mapSnapshot.xLengthChunks = xLengthChunks;
+        mapSnapshot.yLengthChunks = yLengthChunks;
+        mapSnapshot.zLengthChunks = zLengthChunks;
+        ChunkStore chunkStore{basePath};
+        REQUIRE(chunkStore.importSnapshot(mapSnapshot));
+    }
+
+    ~TestMapStore() { std::filesystem::remove_all(directory); }
+
+    /**
+     * Returns the path to the store's files, without extension.
+     */
+    const std::string& getBasePath() const { return basePath; }
+
+    /**
+     * Makes writes to the store's data file fail, by moving the file aside
+     * and putting a directory in its place.
+     *
+     * Note: Readers that already mapped the file are unaffected.
+     */
+    void blockWrites()
+    {
+        dataFilePath = findDataFile();
+        std::filesystem::rename(dataFilePath, blockedFilePath());
+        std::filesystem::create_directory(dataFilePath);
+    }
+
+    /**
+     * Undoes blockWrites().
+     */
+    void unblockWrites()
+    {
+        std::filesystem::remove(dataFilePath);
+        std::filesystem::rename(blockedFilePath(), dataFilePath);
+    }
+
+    /**
+     * Returns true if the store on disk has a record for the given chunk.
+     */
+    bool hasChunk(const ChunkPosition& chunkPosition) const
+    {
+        ChunkStore chunkStore{basePath};
+        REQUIRE(chunkStore.open());
+        return chunkStore.getRecordLocations().contains(chunkPosition);
+    }
+
+private:
+    /**
+     * Returns the path to the current generation's data file.
+     */
+    std::filesystem::path findDataFile() const
+    {
+        for (const auto& entry :
+             std::filesystem::directory_iterator{directory}) {
+            if (entry.path().extension() == ".chunks") {
+                return entry.path();
+            }
+        }
+
+        FAIL("Chunk store has no data file.");
+        return {};
+    }
+
+    std::filesystem::path blockedFilePath() const
+    {
+        return directory / "Blocked.chunks.bak";
+    }
+
+    /** The directory that holds the store. */
+    std::filesystem::path directory;
+
+    /** The path to the store's files, without extension. */
+    std::string basePath;
+
+    /** The data file that blockWrites() moved aside. */
+    std::filesystem::path dataFilePath;
+};
+
+/**
+ * Blocks until the given condition returns false, e.g. until a save is no
+ * longer in progress.
+ */
+inline void waitWhile(const std::function<bool()>& condition)
+{
+    while (condition()) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+}
+
+} // End namespace AM
@@ -0,0 +1,80 @@
+#include "catch2/catch_all.hpp"
+#include "PersistedEntityTracker.h"
+#include "Position.h"
+#include "Name.h"
+#include "ClientSimData.h"
+#include "entt/entity/registry.hpp"
+#include <vector>
+
+using namespace AM;
+using namespace AM::Server;
+
+TEST_CASE("TestPersistedEntityTracker")
+{
+    entt::registry registry{};
+    PersistedEntityTracker tracker{registry};
+    const EnttObserver& changedEntities{tracker.getChangedEntities()};
+    const std::vector<entt::entity>& destroyedEntities{
+        tracker.getDestroyedEntities()};
+
+    entt::entity entity{registry.create()};
+    registry.emplace<Position>(entity);
+
+    SECTION("Persisted component changes mark the entity as changed")
+    {
+        CHECK(changedEntities.contains(entity));
+
+        tracker.clear();
+        registry.patch<Position>(entity, [](Position& position) {
+            position.x = 1.f;
+        });
+        CHECK(changedEntities.contains(entity));
+
+        registry.emplace<Name>(entity, "Test");
+        tracker.clear();
+        registry.remove<Name>(entity);
+        CHECK(changedEntities.contains(entity));
+        CHECK(changedEntities.size() == 1);
+        CHECK(destroyedEntities.empty());
+    }
+
+    SECTION("Destroyed entities are recorded, even if their ID is reused")
+    {
+        registry.destroy(entity);
+        CHECK(changedEntities.empty());
+        CHECK(destroyedEntities == std::vector<entt::entity>{entity});
+
+        // Spawn an entity on the recycled index before the next save.
+        entt::entity newEntity{registry.create()};
+        REQUIRE(entt::to_entity(newEntity) == entt::to_entity(entity));
+        REQUIRE(newEntity != entity);
+        registry.emplace<Position>(newEntity);
+        CHECK(changedEntities.contains(newEntity));
+        CHECK(changedEntities.size() == 1);
+
+        // Destroying the new entity also records it.
+        registry.destroy(newEntity);
+        CHECK(changedEntities.empty());
+        CHECK(destroyedEntities
+              == std::vector<entt::entity>{entity, newEntity});
+
+        tracker.clear();
+        CHECK(destroyedEntities.empty());
+    }
+
+    SECTION("Destroyed client entities aren't recorded")
+    {
+        entt::entity clientEntity{registry.create()};
+        registry.emplace<ClientSimData>(clientEntity);
+        registry.emplace<Position>(clientEntity);
+        CHECK(changedEntities.contains(clientEntity));
+
+        registry.destroy(clientEntity);
+        CHECK(!(changedEntities.contains(clientEntity)));
+        CHECK(destroyedEntities.empty());
+
+        // Non-client entities destroyed afterwards are still recorded.
+        registry.destroy(entity);
+        CHECK(destroyedEntities == std::vector<entt::entity>{entity});
+    }
+}
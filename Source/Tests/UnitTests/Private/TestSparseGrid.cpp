@@ -0,0 +1,123 @@
+#include "catch2/catch_all.hpp"
+#include "SparseGrid.h"
+#include "TileExtent.h"
+#include "TilePosition.h"
+
+using namespace AM;
+
+namespace
+{
+/** A grid with small blocks, so tests can easily cross block boundaries. */
+using TestGrid = SparseGrid<DiscreteImpl::TileTag, int, 4, 4, 1>;
+} // namespace
+
+TEST_CASE("TestSparseGrid")
+{
+    // A grid that straddles the origin, so half of it has negative
+    // coordinates.
+    TestGrid grid{-1};
+    TileExtent gridExtent{-8, -8, 0, 16, 16, 2};
+    grid.setExtent(gridExtent);
+
+    SECTION("Starts empty")
+    {
+        CHECK(grid.getAllocatedBlockCount() == 0);
+        CHECK(grid.get({-8, -8, 0}) == -1);
+        CHECK(grid.get({7, 7, 1}) == -1);
+        CHECK(grid.find({0, 0, 0}) == nullptr);
+    }
+
+    SECTION("Insert allocates only the touched block")
+    {
+        grid.getOrCreate({-5, -6, 0}) = 5;
+        CHECK(grid.getAllocatedBlockCount() == 1);
+        CHECK(grid.get({-5, -6, 0}) == 5);
+
+        // The rest of the block holds the empty value.
+        CHECK(grid.get({-8, -8, 0}) == -1);
+        REQUIRE(grid.find({-7, -7, 0}) != nullptr);
+        CHECK(*(grid.find({-7, -7, 0})) == -1);
+
+        // Neighboring blocks (including across the origin and on another Z
+        // level) are still unallocated.
+        CHECK(grid.find({-4, -6, 0}) == nullptr);
+        CHECK(grid.find({0, 0, 0}) == nullptr);
+        CHECK(grid.find({-5, -6, 1}) == nullptr);
+    }
+
+    SECTION("Insert at negative and positive coordinates")
+    {
+        grid.getOrCreate({-1, -1, 0}) = 1;
+        grid.getOrCreate({0, 0, 0}) = 2;
+        grid.getOrCreate({-8, 7, 1}) = 3;
+        grid.getOrCreate({7, -8, 1}) = 4;
+
+        CHECK(grid.get({-1, -1, 0}) == 1);
+        CHECK(grid.get({0, 0, 0}) == 2);
+        CHECK(grid.get({-8, 7, 1}) == 3);
+        CHECK(grid.get({7, -8, 1}) == 4);
+        CHECK(grid.getAllocatedBlockCount() == 4);
+
+        // Positions that map to the same offset in other blocks are
+        // unaffected.
+        CHECK(grid.get({3, 3, 0}) == -1);
+        CHECK(grid.get({-5, -5, 0}) == -1);
+    }
+
+    SECTION("Remove releases only empty blocks")
+    {
+        grid.getOrCreate({-3, -3, 0}) = 1;
+        grid.getOrCreate({2, 2, 0}) = 2;
+        REQUIRE(grid.getAllocatedBlockCount() == 2);
+
+        // Setting an element back to the empty value and releasing frees
+        // its block.
+        grid.getOrCreate({-3, -3, 0}) = -1;
+        grid.releaseEmptyBlocks(TileExtent{-4, -4, 0, 1, 1, 1});
+        CHECK(grid.getAllocatedBlockCount() == 1);
+        CHECK(grid.find({-3, -3, 0}) == nullptr);
+        CHECK(grid.get({-3, -3, 0}) == -1);
+
+        // Releasing over a non-empty block keeps it.
+        grid.releaseEmptyBlocks(gridExtent);
+        CHECK(grid.getAllocatedBlockCount() == 1);
+        CHECK(grid.get({2, 2, 0}) == 2);
+
+        grid.clear();
+        CHECK(grid.getAllocatedBlockCount() == 0);
+        CHECK(grid.get({2, 2, 0}) == -1);
+    }
+
+    SECTION("Query a region")
+    {
+        // Fill a region that crosses blocks on both sides of the origin.
+        TileExtent region{-6, -2, 0, 9, 5, 1};
+        for (int y{region.y}; y <= region.yMax(); ++y) {
+            for (int x{region.x}; x <= region.xMax(); ++x) {
+                grid.getOrCreate({x, y, 0}) = (x * 100) + y;
+            }
+        }
+
+        for (int y{gridExtent.y}; y <= gridExtent.yMax(); ++y) {
+            for (int x{gridExtent.x}; x <= gridExtent.xMax(); ++x) {
+                int expected{region.contains(TilePosition{x, y, 0})
+                                 ? ((x * 100) + y)
+                                 : -1};
+                CHECK(grid.get({x, y, 0}) == expected);
+                CHECK(grid.get({x, y, 1}) == -1);
+            }
+        }
+
+        // The region touches 3 blocks in X and 2 in Y.
+        CHECK(grid.getAllocatedBlockCount() == 6);
+        CHECK(grid.getMemoryUsage() < grid.getDenseMemoryUsage());
+    }
+
+    SECTION("Changing the extent clears the grid")
+    {
+        grid.getOrCreate({0, 0, 0}) = 1;
+        grid.setExtent(TileExtent{-20, -20, 0, 8, 8, 1});
+        CHECK(grid.getAllocatedBlockCount() == 0);
+        CHECK(grid.get({-20, -20, 0}) == -1);
+    }
+}
@@ -0,0 +1,155 @@
+#include "catch2/catch_all.hpp"
+#include "TestTileMap.h"
+#include "Wall.h"
+#include "Rotation.h"
+#include <functional>
+#include <optional>
+
+using namespace AM;
+
+namespace
+{
+/**
+ * Casts a grid of rays across the given extent, along X and along Y, and
+ * returns the t value of each one's first hit (or nullopt).
+ */
+std::vector<std::optional<float>>
+    castRays(CollisionLocator& collisionLocator, const TileExtent& extent,
+             float z)
+{
+    const float TILE_WORLD_WIDTH{SharedConfig::TILE_WORLD_WIDTH};
+    float minX{extent.x * TILE_WORLD_WIDTH};
+    float maxX{(extent.xMax() + 1) * TILE_WORLD_WIDTH};
+    float minY{extent.y * TILE_WORLD_WIDTH};
+    float maxY{(extent.yMax() + 1) * TILE_WORLD_WIDTH};
+
+    std::vector<std::optional<float>> hitTs{};
+    auto castRay = [&](const Vector3& start, const Vector3& end) {
+        CollisionLocator::RaycastParams params{start, end,
+                                               TILE_COLLISION_LAYERS};
+        if (auto hitInfo{collisionLocator.raycastFirst(params)}) {
+            hitTs.push_back(hitInfo->hitT);
+        }
+        else {
+            hitTs.push_back(std::nullopt);
+        }
+    };
+
+    // Offset the rays so they don't run exactly along a tile edge.
+    for (float y{minY + 5.f}; y < maxY; y += (TILE_WORLD_WIDTH / 2.f)) {
+        castRay({minX + 0.5f, y, z}, {maxX - 0.5f, y, z});
+        castRay({maxX - 0.5f, y, z}, {minX + 0.5f, y, z});
+    }
+    for (float x{minX + 5.f}; x < maxX; x += (TILE_WORLD_WIDTH / 2.f)) {
+        castRay({x, minY + 0.5f, z}, {x, maxY - 0.5f, z});
+        castRay({x, maxY - 0.5f, z}, {x, minY + 0.5f, z});
+    }
+
+    return hitTs;
+}
+} // namespace
+
+TEST_CASE("TestTileCollisionMerging")
+{
+    GraphicDataBase graphicData{getTestResourceData()};
+    CollisionLocator mergedLocator{true};
+    CollisionLocator unmergedLocator{false};
+    const ChunkExtent chunkExtent{ChunkExtent::fromMapLengths(2, 2, 1)};
+    TestTileMap mergedMap{graphicData, mergedLocator, chunkExtent};
+    TestTileMap unmergedMap{graphicData, unmergedLocator, chunkExtent};
+    const TileExtent& mapExtent{mergedMap.getTileExtent()};
+
+    // Returns the tile at the given offset from the map's origin.
+    auto at = [&](int x, int y) -> TilePosition {
+        return {mapExtent.x + x, mapExtent.y + y, 0};
+    };
+
+    // Applies the given edit to both maps and rebuilds their collision.
+    auto editBoth = [&](const std::function<void(TileMapBase&)>& edit) {
+        edit(mergedMap);
+        edit(unmergedMap);
+        mergedMap.rebuildDirtyTileCollision();
+        unmergedMap.rebuildDirtyTileCollision();
+    };
+
+    // Checks that both locators give the same results.
+    const float MID_HEIGHT{SharedConfig::TILE_WORLD_HEIGHT / 2.f};
+    auto checkMatches = [&]() {
+        CHECK(probeTiles(mergedLocator, mapExtent, MID_HEIGHT)
+              == probeTiles(unmergedLocator, mapExtent, MID_HEIGHT));
+        CHECK(castRays(mergedLocator, mapExtent, MID_HEIGHT)
+              == castRays(unmergedLocator, mapExtent, MID_HEIGHT));
+    };
+
+    // Build a room whose walls cross the chunk borders, a row of blocks
+    // that crosses a chunk border, and a few lone blocks.
+    editBoth([&](TileMapBase& tileMap) {
+        for (int x{4}; x < 28; ++x) {
+            tileMap.addWall(at(x, 4), TestGraphicSets::WALL,
+                            Wall::Type::North);
+            tileMap.addWall(at(x, 20), TestGraphicSets::WALL,
+                            Wall::Type::North);
+        }
+        for (int y{4}; y < 20; ++y) {
+            tileMap.addWall(at(4, y), TestGraphicSets::WALL,
+                            Wall::Type::West);
+            tileMap.addWall(at(28, y), TestGraphicSets::WALL,
+                            Wall::Type::West);
+        }
+        for (int x{10}; x < 22; ++x) {
+            tileMap.addObject(at(x, 26), {}, TestGraphicSets::BLOCK,
+                              Rotation::Direction::South);
+        }
+        tileMap.addObject(at(1, 1), {}, TestGraphicSets::BLOCK,
+                          Rotation::Direction::South);
+        tileMap.addObject(at(15, 15), {}, TestGraphicSets::BLOCK,
+                          Rotation::Direction::South);
+        tileMap.addObject(at(16, 15), {}, TestGraphicSets::BLOCK,
+                          Rotation::Direction::South);
+    });
+
+    SECTION("Merged and unmerged collision match")
+    {
+        checkMatches();
+
+        // Merging should have reduced the number of volumes.
+        std::size_t mergedCount{
+            mergedLocator.getCollisions(mapExtent, TILE_COLLISION_LAYERS)
+                .size()};
+        std::size_t unmergedCount{
+            unmergedLocator.getCollisions(mapExtent, TILE_COLLISION_LAYERS)
+                .size()};
+        CHECK(mergedCount < unmergedCount);
+    }
+
+    SECTION("Merged and unmerged collision match after edits")
+    {
+        // Knock holes in the walls and the row of blocks, then fill some
+        // of them back in.
+        editBoth([&](TileMapBase& tileMap) {
+            tileMap.remWall(at(15, 4), Wall::Type::North);
+            tileMap.remWall(at(16, 4), Wall::Type::North);
+            tileMap.remWall(at(4, 10), Wall::Type::West);
+            tileMap.remObject(at(16, 26), {}, TestGraphicSets::BLOCK,
+                              Rotation::Direction::South);
+        });
+        checkMatches();
+
+        editBoth([&](TileMapBase& tileMap) {
+            tileMap.addWall(at(16, 4), TestGraphicSets::WALL,
+                            Wall::Type::North);
+            tileMap.addObject(at(16, 26), {}, TestGraphicSets::BLOCK,
+                              Rotation::Direction::South);
+            tileMap.addObject(at(16, 27), {}, TestGraphicSets::BLOCK,
+                              Rotation::Direction::South);
+        });
+        checkMatches();
+
+        // Clear a whole chunk.
+        editBoth([&](TileMapBase& tileMap) {
+            tileMap.clearExtent(
+                TileExtent{mapExtent.x, mapExtent.y, 0, 16, 16, 1});
+        });
+        checkMatches();
+    }
+}
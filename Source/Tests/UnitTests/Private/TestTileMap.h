@@ -0,0 +1,149 @@
+#pragma once
+
+#include "TileMapBase.h"
+#include "GraphicDataBase.h"
+#include "CollisionLocator.h"
+#include "CollisionLayerType.h"
+#include "BoundingBox.h"
+#include "Vector3.h"
+#include "ChunkExtent.h"
+#include "TileExtent.h"
+#include "SharedConfig.h"
+#include "nlohmann/json.hpp"
+#include <array>
+#include <string>
+#include <vector>
+
+namespace AM
+{
+/**
+ * Exposes the map extent setters, so tests can build a map without loading
+ * TileMap.bin.
+ */
+class TestTileMap : public TileMapBase
+{
+public:
+    TestTileMap(const GraphicDataBase& inGraphicData,
+                CollisionLocator& inCollisionLocator,
+                const ChunkExtent& inChunkExtent,
+                bool inTrackTileUpdates = false)
+    : TileMapBase(inGraphicData, inCollisionLocator, inTrackTileUpdates)
+    {
+        chunkExtent = inChunkExtent;
+        tileExtent = TileExtent{chunkExtent};
+        collisionLocator.setGridSize(tileExtent);
+        setAutoRebuildCollision(false);
+    }
+};
+
+/**
+ * The graphic set IDs in the resource data from getTestResourceData().
+ */
+struct TestGraphicSets {
+    /** Flat ground. No collision (terrain collision comes from its value). */
+    static constexpr Uint16 GROUND{1};
+
+    /** A floor with no collision. */
+    static constexpr Uint16 FLOOR{1};
+
+    /** A set of thin, full-height walls with collision. */
+    static constexpr Uint16 WALL{1};
+
+    /** A full-tile, full-height block with collision, in every rotation. */
+    static constexpr Uint16 BLOCK{1};
+};
+
+/**
+ * Returns resource data with one graphic set of each tile layer type, as
+ * described by TestGraphicSets.
+ */
+inline nlohmann::json getTestResourceData()
+{
+    const int TILE_WIDTH{static_cast<int>(SharedConfig::TILE_WORLD_WIDTH)};
+    const int TILE_HEIGHT{static_cast<int>(SharedConfig::TILE_WORLD_HEIGHT)};
+    const int WALL_THICKNESS{2};
+
+    nlohmann::json json;
+    json["animations"] = nlohmann::json::object();
+    json["entities"] = nlohmann::json::object();
+
+    // Add a sprite for each graphic.
+    auto addSprite = [&](int numericID, const std::string& displayName,
+                         bool collisionEnabled, int minX, int maxX, int minY,
+                         int maxY) {
+        nlohmann::json& spriteJson{
+            json["spriteSheets"]["Test"]["sprites"][displayName]};
+        spriteJson["numericID"] = numericID;
+        spriteJson["displayName"] = displayName;
+        spriteJson["collisionEnabled"] = collisionEnabled;
+        spriteJson["modelBounds"] = {{"minX", minX}, {"maxX", maxX},
+                                     {"minY", minY}, {"maxY", maxY},
+                                     {"minZ", 0},    {"maxZ", TILE_HEIGHT}};
+    };
+    addSprite(1, "Ground", false, 0, TILE_WIDTH, 0, TILE_WIDTH);
+    addSprite(2, "Floor", false, 0, TILE_WIDTH, 0, TILE_WIDTH);
+    addSprite(3, "WestWall", true, 0, WALL_THICKNESS, 0, TILE_WIDTH);
+    addSprite(4, "NorthWall", true, 0, TILE_WIDTH, 0, WALL_THICKNESS);
+    addSprite(5, "NorthWestGapFill", true, 0, WALL_THICKNESS, 0,
+              WALL_THICKNESS);
+    addSprite(6, "NorthEastGapFill", true, WALL_THICKNESS, TILE_WIDTH, 0,
+              WALL_THICKNESS);
+    addSprite(7, "Block", true, 0, TILE_WIDTH, 0, TILE_WIDTH);
+
+    // Add the graphic sets.
+    // Note: Sprite graphic IDs match their sprite IDs.
+    json["terrain"]["Ground"] = {{"numericID", TestGraphicSets::GROUND},
+                                 {"displayName", "Ground"},
+                                 {"graphicIDs", {1, 1, 1, 1}}};
+    json["floors"]["Floor"]
+        = {{"numericID", TestGraphicSets::FLOOR},
+           {"displayName", "Floor"},
+           {"graphicIDs", {2, 2, 2, 2, 2, 2, 2, 2}}};
+    json["walls"]["Wall"] = {{"numericID", TestGraphicSets::WALL},
+                             {"displayName", "Wall"},
+                             {"graphicIDs", {3, 4, 5, 6}}};
+    json["objects"]["Block"]
+        = {{"numericID", TestGraphicSets::BLOCK},
+           {"displayName", "Block"},
+           {"graphicIDs", {7, 7, 7, 7, 7, 7, 7, 7}}};
+
+    return json;
+}
+
+/** The collision layers that tiles may add volumes to. */
+inline const CollisionLayerBitSet TILE_COLLISION_LAYERS{
+    CollisionLayerType::TerrainWall | CollisionLayerType::Object};
+
+/**
+ * Places a small probe box at a few spots in each tile, at the given Z
+ * height. Returns whether each probe intersected any tile volumes.
+ */
+inline std::vector<bool> probeTiles(CollisionLocator& collisionLocator,
+                                    const TileExtent& extent, float z)
+{
+    const float TILE_WORLD_WIDTH{SharedConfig::TILE_WORLD_WIDTH};
+    // Inside the walls, just outside of them, and in the middle of the tile.
+    const std::array<float, 3> offsets{1.f, 3.f, 16.f};
+
+    std::vector<bool> probeHits{};
+    for (int y{extent.y}; y <= extent.yMax(); ++y) {
+        for (int x{extent.x}; x <= extent.xMax(); ++x) {
+            for (float offsetY : offsets) {
+                for (float offsetX : offsets) {
+                    Vector3 center{(x * TILE_WORLD_WIDTH) + offsetX,
+                                   (y * TILE_WORLD_WIDTH) + offsetY, z};
+                    BoundingBox probe{center - Vector3{0.5f, 0.5f, 0.5f},
+                                      center + Vector3{0.5f, 0.5f, 0.5f}};
+                    probeHits.push_back(
+                        !(collisionLocator
+                              .getCollisions(probe, TILE_COLLISION_LAYERS)
+                              .empty()));
+                }
+            }
+        }
+    }
+
+    return probeHits;
+}
+
+} // End namespace AM
@@ -0,0 +1,80 @@
+#include "catch2/catch_all.hpp"
+#include "TestTileMap.h"
+#include "ChunkPosition.h"
+#include "Wall.h"
+#include "Rotation.h"
+
+using namespace AM;
+
+TEST_CASE("TestTileMapDirtyChunks")
+{
+    GraphicDataBase graphicData{getTestResourceData()};
+    CollisionLocator collisionLocator{};
+    TestTileMap tileMap{graphicData, collisionLocator,
+                        ChunkExtent::fromMapLengths(2, 2, 1), true};
+    const TileExtent& mapExtent{tileMap.getTileExtent()};
+    const int CHUNK_WIDTH{static_cast<int>(SharedConfig::CHUNK_WIDTH)};
+
+    // The last column and row of tiles in the map's first chunk.
+    const int lastX{mapExtent.x + CHUNK_WIDTH - 1};
+    const int lastY{mapExtent.y + CHUNK_WIDTH - 1};
+    const ChunkPosition firstChunk{TilePosition{mapExtent.x, mapExtent.y, 0}};
+
+    SECTION("Single tile updates dirty their chunk")
+    {
+        tileMap.addObject({mapExtent.x, mapExtent.y, 0}, {},
+                          TestGraphicSets::BLOCK, Rotation::Direction::South);
+        CHECK(tileMap.getDirtyChunks().size() == 1);
+        CHECK(tileMap.getDirtyChunks().contains(firstChunk));
+
+        tileMap.clearDirtyChunks();
+        CHECK(tileMap.getDirtyChunks().empty());
+    }
+
+    SECTION("Gap fills in a neighboring chunk dirty that chunk")
+    {
+        // Build a corner whose NW gap fill lands in the chunk to the East.
+        TilePosition eastTile{lastX + 1, lastY, 0};
+        tileMap.addWall({lastX + 1, lastY - 1, 0}, TestGraphicSets::WALL,
+                        Wall::Type::West);
+        tileMap.clearDirtyChunks();
+
+        tileMap.addWall({lastX, lastY, 0}, TestGraphicSets::WALL,
+                        Wall::Type::North);
+        const Tile* tile{tileMap.cgetTile(eastTile)};
+        REQUIRE(tile);
+        REQUIRE(tile->findLayer(TileLayer::Type::Wall,
+                                Wall::Type::NorthWestGapFill));
+        CHECK(tileMap.getDirtyChunks().contains(firstChunk));
+        CHECK(tileMap.getDirtyChunks().contains(ChunkPosition{eastTile}));
+
+        // Removing the wall removes the gap fill, which should also dirty
+        // the East chunk.
+        tileMap.clearDirtyChunks();
+        tileMap.remWall({lastX, lastY, 0}, Wall::Type::North);
+        tile = tileMap.cgetTile(eastTile);
+        REQUIRE(tile);
+        CHECK(!(tile->findLayer(TileLayer::Type::Wall,
+                                Wall::Type::NorthWestGapFill)));
+        CHECK(tileMap.getDirtyChunks().contains(firstChunk));
+        CHECK(tileMap.getDirtyChunks().contains(ChunkPosition{eastTile}));
+    }
+
+    SECTION("West wall gap fills in the chunk to the South")
+    {
+        // Build a corner whose NW gap fill lands in the chunk to the South.
+        TilePosition southTile{lastX, lastY + 1, 0};
+        tileMap.addWall({lastX - 1, lastY + 1, 0}, TestGraphicSets::WALL,
+                        Wall::Type::North);
+        tileMap.clearDirtyChunks();
+
+        tileMap.addWall({lastX, lastY, 0}, TestGraphicSets::WALL,
+                        Wall::Type::West);
+        const Tile* tile{tileMap.cgetTile(southTile)};
+        REQUIRE(tile);
+        REQUIRE(tile->findLayer(TileLayer::Type::Wall,
+                                Wall::Type::NorthWestGapFill));
+        CHECK(tileMap.getDirtyChunks().contains(firstChunk));
+        CHECK(tileMap.getDirtyChunks().contains(ChunkPosition{southTile}));
+    }
+}
@@ -0,0 +1,172 @@
+#include "catch2/catch_all.hpp"
+#include "TestTileMap.h"
+#include "ChunkPosition.h"
+#include "Terrain.h"
+#include <unordered_set>
+#include <vector>
+
+using namespace AM;
+
+namespace
+{
+/** Resource data with no graphics, so only the null sets exist. */
+nlohmann::json getEmptyResourceData()
+{
+    nlohmann::json json;
+    for (const char* category : {"spriteSheets", "animations", "terrain",
+                                 "floors", "walls", "objects", "entities"}) {
+        json[category] = nlohmann::json::object();
+    }
+    return json;
+}
+
+/** Returns the number of layers in each tile within the given extent, using
+    getTile(). */
+std::size_t countLayersByPosition(const TileMapBase& tileMap,
+                                  const TileExtent& extent)
+{
+    std::size_t layerCount{0};
+    for (int z{extent.z}; z <= extent.zMax(); ++z) {
+        for (int y{extent.y}; y <= extent.yMax(); ++y) {
+            for (int x{extent.x}; x <= extent.xMax(); ++x) {
+                if (const Tile* tile{tileMap.getTile({x, y, z})}) {
+                    layerCount += tile->getAllLayers().size();
+                }
+            }
+        }
+    }
+    return layerCount;
+}
+
+/** Returns the number of layers in each tile within the given extent, using
+    forEachTile(). */
+std::size_t countLayersByChunk(const TileMapBase& tileMap,
+                               const TileExtent& extent)
+{
+    std::size_t layerCount{0};
+    tileMap.forEachTile(extent, [&](const TilePosition&, const Tile& tile) {
+        layerCount += tile.getAllLayers().size();
+    });
+    return layerCount;
+}
+
+/**
+ * Fills every other row of tiles with flat terrain, in a checkerboard of
+ * chunks. The rest of the chunks are left empty (and so, don't exist).
+ */
+void fillCheckerboard(TileMapBase& tileMap)
+{
+    const Terrain::Value flatTerrain{
+        Terrain::toValue(Terrain::Height::Flat, Terrain::Height::Flat)};
+    const TileExtent& mapExtent{tileMap.getTileExtent()};
+    for (int y{mapExtent.y}; y <= mapExtent.yMax(); y += 2) {
+        for (int x{mapExtent.x}; x <= mapExtent.xMax(); ++x) {
+            TilePosition tilePosition{x, y, 0};
+            ChunkPosition chunkPosition{tilePosition};
+            if (((chunkPosition.x + chunkPosition.y) % 2) == 0) {
+                tileMap.addTerrain(tilePosition, NULL_TERRAIN_GRAPHIC_SET_ID,
+                                   flatTerrain);
+            }
+        }
+    }
+}
+
+/** A view-sized extent that straddles chunk boundaries. */
+const TileExtent VIEW_EXTENT{-21, -13, 0, 42, 26, 1};
+} // namespace
+
+TEST_CASE("TestTileMapIteration")
+{
+    GraphicDataBase graphicData{getEmptyResourceData()};
+    CollisionLocator collisionLocator{};
+    TestTileMap tileMap{graphicData, collisionLocator,
+                        ChunkExtent::fromMapLengths(16, 16, 1)};
+    const TileExtent& mapExtent{tileMap.getTileExtent()};
+    fillCheckerboard(tileMap);
+    const TileExtent& viewExtent{VIEW_EXTENT};
+
+    SECTION("Visits the same tiles as getTile()")
+    {
+        CHECK(countLayersByChunk(tileMap, viewExtent)
+              == countLayersByPosition(tileMap, viewExtent));
+        CHECK(countLayersByChunk(tileMap, mapExtent)
+              == countLayersByPosition(tileMap, mapExtent));
+
+        // Each tile in an existing chunk should be visited exactly once.
+        std::vector<TilePosition> visited{};
+        tileMap.forEachTile(viewExtent,
+                            [&](const TilePosition& tilePosition, const Tile&) {
+                                CHECK(viewExtent.contains(tilePosition));
+                                visited.push_back(tilePosition);
+                            });
+        std::size_t expectedCount{0};
+        for (int y{viewExtent.y}; y <= viewExtent.yMax(); ++y) {
+            for (int x{viewExtent.x}; x <= viewExtent.xMax(); ++x) {
+                if (tileMap.cgetTile({x, y, 0})) {
+                    expectedCount++;
+                }
+            }
+        }
+        CHECK(visited.size() == expectedCount);
+
+        std::unordered_set<TilePosition> uniqueVisited(visited.begin(),
+                                                       visited.end());
+        CHECK(uniqueVisited.size() == visited.size());
+    }
+
+    SECTION("Skips empty chunks")
+    {
+        // Gather the chunks that the extent touches, and the ones that were
+        // visited.
+        std::unordered_set<ChunkPosition> touchedChunks{};
+        for (int y{viewExtent.y}; y <= viewExtent.yMax(); ++y) {
+            for (int x{viewExtent.x}; x <= viewExtent.xMax(); ++x) {
+                touchedChunks.insert(ChunkPosition{TilePosition{x, y, 0}});
+            }
+        }
+        std::unordered_set<ChunkPosition> visitedChunks{};
+        tileMap.forEachTile(viewExtent,
+                            [&](const TilePosition& tilePosition, const Tile&) {
+                                visitedChunks.insert(
+                                    ChunkPosition{tilePosition});
+                            });
+
+        // Only the filled half of the checkerboard should have been visited.
+        std::size_t emptyChunkCount{0};
+        for (const ChunkPosition& chunkPosition : touchedChunks) {
+            bool isFilled{((chunkPosition.x + chunkPosition.y) % 2) == 0};
+            CHECK(visitedChunks.contains(chunkPosition) == isFilled);
+            if (!isFilled) {
+                emptyChunkCount++;
+            }
+        }
+        CHECK(emptyChunkCount > 0);
+    }
+
+    SECTION("Ignores the parts of the extent that are outside of the map")
+    {
+        TileExtent overhangingExtent{mapExtent.x - 10, mapExtent.y - 10, 0,
+                                     30, 30, 2};
+        CHECK(countLayersByChunk(tileMap, overhangingExtent)
+              == countLayersByPosition(tileMap, overhangingExtent));
+    }
+}
+
+TEST_CASE("TestTileMapIterationBenchmark", "[.][benchmark]")
+{
+    GraphicDataBase graphicData{getEmptyResourceData()};
+    CollisionLocator collisionLocator{};
+    TestTileMap tileMap{graphicData, collisionLocator,
+                        ChunkExtent::fromMapLengths(16, 16, 1)};
+    fillCheckerboard(tileMap);
+
+    BENCHMARK("View extent, getTile() per position")
+    {
+        return countLayersByPosition(tileMap, VIEW_EXTENT);
+    };
+
+    BENCHMARK("View extent, forEachTile()")
+    {
+        return countLayersByChunk(tileMap, VIEW_EXTENT);
+    };
+}
@@ -0,0 +1,106 @@
+#include "catch2/catch_all.hpp"
+#include "TestMapStore.h"
+#include "TestTileMap.h"
+#include "TileMap.h"
+#include "TileMapWriter.h"
+#include "GraphicData.h"
+#include "ChunkPosition.h"
+#include "Rotation.h"
+#include <memory>
+
+using namespace AM;
+using namespace AM::Server;
+
+TEST_CASE("TestTileMapSave")
+{
+#ifndef NDEBUG
+    // Note: Failed writes call LOG_ERROR, which aborts in debug builds.
+    SKIP("Write failures can only be tested in release builds.");
+#endif
+
+    TestMapStore mapStore{"AmalgamTestTileMapSave", 2, 2, 1};
+    GraphicData graphicData{getTestResourceData()};
+    CollisionLocator collisionLocator{};
+    auto tileMap{std::make_unique<TileMap>(graphicData, collisionLocator,
+                                           mapStore.getBasePath())};
+    auto waitForSave = [&]() {
+        waitWhile([&]() { return tileMap->saveIsInProgress(); });
+    };
+
+    const TileExtent& mapExtent{tileMap->getTileExtent()};
+    const TilePosition tilePosition{mapExtent.x, mapExtent.y, 0};
+    const ChunkPosition chunkPosition{tilePosition};
+    tileMap->addObject(tilePosition, {}, TestGraphicSets::BLOCK,
+                       Rotation::Direction::South);
+
+    // Fail to write the edit.
+    mapStore.blockWrites();
+    tileMap->save();
+    waitForSave();
+    mapStore.unblockWrites();
+    REQUIRE(!(mapStore.hasChunk(chunkPosition)));
+
+    SECTION("A failed save is retried without further edits")
+    {
+        REQUIRE(tileMap->getDirtyChunks().empty());
+        tileMap->save();
+        waitForSave();
+        CHECK(mapStore.hasChunk(chunkPosition));
+    }
+
+    SECTION("A failed save is retried on shutdown")
+    {
+        tileMap.reset();
+        CHECK(mapStore.hasChunk(chunkPosition));
+    }
+}
+
+TEST_CASE("TestTileMapWriterRetry")
+{
+#ifndef NDEBUG
+    // Note: Failed writes call LOG_ERROR, which aborts in debug builds.
+    SKIP("Write failures can only be tested in release builds.");
+#endif
+
+    TestMapStore mapStore{"AmalgamTestTileMapWriterRetry", 2, 2, 1};
+    ChunkStore chunkStore{mapStore.getBasePath()};
+    REQUIRE(chunkStore.open());
+    auto tileMapWriter{std::make_unique<TileMapWriter>(chunkStore)};
+    auto waitForWrite = [&]() {
+        waitWhile([&]() { return tileMapWriter->writeIsInProgress(); });
+    };
+
+    // Fail to write a chunk.
+    const ChunkPosition chunkPosition{1, 0, 0};
+    TileMapWriter::WriteRequest writeRequest{};
+    writeRequest.version = 1;
+    writeRequest.xLengthChunks = 2;
+    writeRequest.yLengthChunks = 2;
+    writeRequest.zLengthChunks = 1;
+    writeRequest.chunks.emplace(chunkPosition, ChunkSnapshot{});
+    mapStore.blockWrites();
+    tileMapWriter->write(std::move(writeRequest));
+    waitForWrite();
+    mapStore.unblockWrites();
+    REQUIRE(tileMapWriter->lastWriteFailed());
+    REQUIRE(!(mapStore.hasChunk(chunkPosition)));
+
+    SECTION("An empty write retries the failed chunks")
+    {
+        TileMapWriter::WriteRequest emptyRequest{};
+        emptyRequest.version = 1;
+        emptyRequest.xLengthChunks = 2;
+        emptyRequest.yLengthChunks = 2;
+        emptyRequest.zLengthChunks = 1;
+        tileMapWriter->write(std::move(emptyRequest));
+        waitForWrite();
+        CHECK(!(tileMapWriter->lastWriteFailed()));
+        CHECK(mapStore.hasChunk(chunkPosition));
+    }
+
+    SECTION("The failed chunks are retried before the writer exits")
+    {
+        tileMapWriter.reset();
+        CHECK(mapStore.hasChunk(chunkPosition));
+    }
+}
@@ -0,0 +1,128 @@
+#include "catch2/catch_all.hpp"
+#include "TimingWheel.h"
+#include <vector>
+
+using namespace AM;
+using namespace AM::Server;
+
+TEST_CASE("TestTimingWheel")
+{
+    TimingWheel timingWheel{100};
+
+    // Each fired timer pushes its ID and the tick that it fired on.
+    std::vector<int> firedIDs{};
+    std::vector<Uint32> firedTicks{};
+    auto scheduleRecorder = [&](Uint32 targetTick, int id) {
+        return timingWheel.schedule(targetTick, [&, id]() {
+            firedIDs.push_back(id);
+            firedTicks.push_back(timingWheel.getCurrentTick());
+        });
+    };
+
+    SECTION("Timers in the same slot fire together")
+    {
+        scheduleRecorder(105, 0);
+        scheduleRecorder(105, 1);
+        scheduleRecorder(106, 2);
+        scheduleRecorder(105, 3);
+        CHECK(timingWheel.getTimerCount() == 4);
+
+        timingWheel.advance(104);
+        CHECK(firedIDs.empty());
+
+        timingWheel.advance(105);
+        CHECK(firedIDs == std::vector<int>{0, 1, 3});
+        CHECK(firedTicks == std::vector<Uint32>{105, 105, 105});
+        CHECK(timingWheel.getTimerCount() == 1);
+
+        timingWheel.advance(106);
+        CHECK(firedIDs == std::vector<int>{0, 1, 3, 2});
+        CHECK(timingWheel.getTimerCount() == 0);
+    }
+
+    SECTION("Past ticks fire on the next tick")
+    {
+        scheduleRecorder(50, 0);
+        scheduleRecorder(100, 1);
+        timingWheel.scheduleAfter(0, [&]() { firedIDs.push_back(2); });
+
+        timingWheel.advance(101);
+        CHECK(firedIDs == std::vector<int>{0, 1, 2});
+        CHECK(firedTicks == std::vector<Uint32>{101, 101});
+    }
+
+    SECTION("Timers cascade down from the upper levels")
+    {
+        // Delays that land in each level, and on the edges between them.
+        const std::vector<Uint32> delays{255,   256,   300,    65535,
+                                         65536, 70000, 200000, 16777300};
+        for (std::size_t i{0}; i < delays.size(); ++i) {
+            scheduleRecorder((100 + delays[i]), static_cast<int>(i));
+        }
+
+        timingWheel.advance(100 + 16777300);
+        REQUIRE(firedTicks.size() == delays.size());
+        for (std::size_t i{0}; i < delays.size(); ++i) {
+            CHECK(firedIDs[i] == static_cast<int>(i));
+            CHECK(firedTicks[i] == (100 + delays[i]));
+        }
+        CHECK(timingWheel.getTimerCount() == 0);
+    }
+
+    SECTION("Ticks can wrap around")
+    {
+        TimingWheel wrappingWheel{0xFFFFFF00};
+        Uint32 firedTick{0};
+        wrappingWheel.scheduleAfter(
+            512, [&]() { firedTick = wrappingWheel.getCurrentTick(); });
+
+        wrappingWheel.advance(0xFFFFFFFF);
+        CHECK(firedTick == 0);
+
+        wrappingWheel.advance(0x100);
+        CHECK(firedTick == 0x100);
+    }
+
+    SECTION("Cancelled timers don't fire")
+    {
+        TimerID nearTimer{scheduleRecorder(110, 0)};
+        scheduleRecorder(110, 1);
+        TimerID farTimer{scheduleRecorder(1000, 2)};
+        CHECK(timingWheel.isScheduled(nearTimer));
+        CHECK(timingWheel.getTimerCount() == 3);
+
+        timingWheel.cancel(nearTimer);
+        CHECK(!(timingWheel.isScheduled(nearTimer)));
+        CHECK(timingWheel.getTimerCount() == 2);
+
+        // Cancel the far timer after it's had a chance to cascade.
+        timingWheel.advance(600);
+        CHECK(firedIDs == std::vector<int>{1});
+        timingWheel.cancel(farTimer);
+        CHECK(timingWheel.getTimerCount() == 0);
+
+        timingWheel.advance(2000);
+        CHECK(firedIDs == std::vector<int>{1});
+
+        // Cancelling again, or cancelling a fired timer, does nothing.
+        timingWheel.cancel(nearTimer);
+        timingWheel.cancel(farTimer);
+        CHECK(timingWheel.getTimerCount() == 0);
+    }
+
+    SECTION("Callbacks can schedule and cancel timers")
+    {
+        TimerID cancelledTimer{0};
+        timingWheel.schedule(105, [&]() {
+            firedIDs.push_back(0);
+            timingWheel.cancel(cancelledTimer);
+            scheduleRecorder(105, 1);
+            scheduleRecorder(107, 2);
+        });
+        cancelledTimer = scheduleRecorder(106, 3);
+
+        timingWheel.advance(110);
+        CHECK(firedIDs == std::vector<int>{0, 1, 2});
+        CHECK(firedTicks == std::vector<Uint32>{106, 107});
+    }
+}
@@ -0,0 +1,121 @@
+#include "ChunkStore.h"
+#include "TileMapSnapshot.h"
+#include "Deserialize.h"
+#include "Log.h"
+#include <string>
+#include <string_view>
+
+using namespace AM;
+
+/**
+ * Command-line tool for maintaining tile map files.
+ *
+ * Usage:
+ *   MapTool convert <TileMap.bin path> <store base path>
+ *     Converts an old single-file map into a chunk store.
+ *   MapTool compact <store base path>
+ *     Rewrites a chunk store's data file so it only contains live records.
+ *   MapTool info <store base path>
+ *     Prints a chunk store's header data and size.
+ *
+ * The store base path is the path to the store's files, without extension
+ * (e.g. "Path/To/TileMap" for "Path/To/TileMap.index").
+ */
+namespace
+{
+void printUsage()
+{
+    LOG_INFO("Usage:\n"
+             "  MapTool convert <TileMap.bin path> <store base path>\n"
+             "  MapTool compact <store base path>\n"
+             "  MapTool info <store base path>");
+}
+
+void printInfo(const ChunkStore& chunkStore)
+{
+    Uint64 dataFileSize{chunkStore.getDataFileSize()};
+    Uint64 liveDataSize{chunkStore.getLiveDataSize()};
+    LOG_INFO("Size: (%u, %u, %u)ch. Chunks: %zu. Data file: %llu bytes "
+             "(%llu live, %llu garbage).",
+             chunkStore.getXLengthChunks(), chunkStore.getYLengthChunks(),
+             chunkStore.getZLengthChunks(),
+             chunkStore.getRecordLocations().size(),
+             static_cast<unsigned long long>(dataFileSize),
+             static_cast<unsigned long long>(liveDataSize),
+             static_cast<unsigned long long>(dataFileSize - liveDataSize));
+}
+
+int convert(const std::string& mapPath, const std::string& storePath)
+{
+    TileMapSnapshot mapSnapshot{};
+    if (!Deserialize::fromFile(mapPath, mapSnapshot)) {
+        LOG_INFO("Failed to deserialize map at path: %s", mapPath.c_str());
+        return 1;
+    }
+
+    ChunkStore chunkStore{storePath};
+    if (chunkStore.exists()) {
+        LOG_INFO("A chunk store already exists at: %s", storePath.c_str());
+        return 1;
+    }
+    if (!chunkStore.importSnapshot(mapSnapshot)) {
+        LOG_INFO("Failed to write chunk store.");
+        return 1;
+    }
+
+    LOG_INFO("Converted %zu chunks.", mapSnapshot.chunks.size());
+    printInfo(chunkStore);
+    return 0;
+}
+
+int compact(const std::string& storePath)
+{
+    ChunkStore chunkStore{storePath};
+    if (!chunkStore.open()) {
+        return 1;
+    }
+
+    printInfo(chunkStore);
+    if (!chunkStore.compact()) {
+        LOG_INFO("Failed to compact chunk store.");
+        return 1;
+    }
+
+    LOG_INFO("Compacted.");
+    printInfo(chunkStore);
+    return 0;
+}
+
+int info(const std::string& storePath)
+{
+    ChunkStore chunkStore{storePath};
+    if (!chunkStore.open()) {
+        return 1;
+    }
+
+    printInfo(chunkStore);
+    return 0;
+}
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    if (argc < 3) {
+        printUsage();
+        return 1;
+    }
+
+    std::string_view command{argv[1]};
+    if ((command == "convert") && (argc == 4)) {
+        return convert(argv[2], argv[3]);
+    }
+    else if ((command == "compact") && (argc == 3)) {
+        return compact(argv[2]);
+    }
+    else if ((command == "info") && (argc == 3)) {
+        return info(argv[2]);
+    }
+
+    printUsage();
+    return 1;
+}